@@ -286,9 +286,9 @@ TODO: We probably want quaternions. Too much of a headache to figure out for me
 #define realloc_arr(T, i_ptr, i_len)                  (T*)realloc((i_ptr), (i_len) * sizeof(T))
 
 /* Math. */
-#if defined(f32_mod) || defined(f32_sin) || defined(f32_cos) || defined(f32_tan) || defined(f32_sqrt) || defined(f32_pow) || defined(f32_atan2) || defined(f64_mod) || defined(f64_sin) || defined(f64_cos) || defined(f64_tan) || defined(f64_sqrt) || defined(f64_pow) || defined(f64_atan2)
-    #if !defined(f32_sin) || !defined(f32_sin) || !defined(f32_cos) || !defined(f32_tan) || !defined(f32_sqrt) || !defined(f32_pow) || !defined(f32_atan2) || !defined(f64_mod) || !defined(f64_sin) || !defined(f64_cos) || !defined(f64_tan) || !defined(f64_sqrt) || !defined(f64_pow) || !defined(f64_atan2)
-        #error "You must define all of f32_mod, f32_sin, f32_cos, f32_tan, f32_sqrt, f32_pow, f32_atan2, f64_mod, f64_sin, f64_cos, f64_tan, f64_sqrt, f64_pow and f64_atan2."
+#if defined(f32_mod) || defined(f32_sin) || defined(f32_cos) || defined(f32_tan) || defined(f32_sqrt) || defined(f32_pow) || defined(f32_atan2) || defined(f32_floor) || defined(f32_round) || defined(f32_exp2) || defined(f32_log2) || defined(f64_mod) || defined(f64_sin) || defined(f64_cos) || defined(f64_tan) || defined(f64_sqrt) || defined(f64_pow) || defined(f64_atan2) || defined(f64_floor) || defined(f64_round) || defined(f64_exp2) || defined(f64_log2)
+    #if !defined(f32_sin) || !defined(f32_sin) || !defined(f32_cos) || !defined(f32_tan) || !defined(f32_sqrt) || !defined(f32_pow) || !defined(f32_atan2) || !defined(f32_floor) || !defined(f32_round) || !defined(f32_exp2) || !defined(f32_log2) || !defined(f64_mod) || !defined(f64_sin) || !defined(f64_cos) || !defined(f64_tan) || !defined(f64_sqrt) || !defined(f64_pow) || !defined(f64_atan2) || !defined(f64_floor) || !defined(f64_round) || !defined(f64_exp2) || !defined(f64_log2)
+        #error "You must define all of f32_mod, f32_sin, f32_cos, f32_tan, f32_sqrt, f32_pow, f32_atan2, f32_floor, f32_round, f32_exp2, f32_log2, f64_mod, f64_sin, f64_cos, f64_tan, f64_sqrt, f64_pow, f64_atan2, f64_floor, f64_round, f64_exp2 and f64_log2."
     #endif
 #else
     #if defined(__cplusplus)
@@ -303,6 +303,10 @@ TODO: We probably want quaternions. Too much of a headache to figure out for me
     #define f32_sqrt(i_value)                  ((f32_t)sqrtf(i_value))
     #define f32_pow(i_value, i_exponent)       ((f32_t)powf(i_value, i_exponent))
     #define f32_atan2(i_y, i_x)                ((f32_t)atan2f(i_y, i_x))
+    #define f32_floor(i_value)                 ((f32_t)floorf(i_value))
+    #define f32_round(i_value)                 ((f32_t)roundf(i_value))
+    #define f32_exp2(i_value)                  ((f32_t)exp2f(i_value))
+    #define f32_log2(i_value)                  ((f32_t)log2f(i_value))
     
     #define f64_mod(i_x, i_y)                  ((f64_t)fmod(i_x, i_y))
     #define f64_sin(i_value)                   ((f64_t)sin(i_value))
@@ -311,6 +315,10 @@ TODO: We probably want quaternions. Too much of a headache to figure out for me
     #define f64_sqrt(i_value)                  ((f64_t)sqrt(i_value))
     #define f64_pow(i_value, i_exponent)       ((f64_t)pow(i_value, i_exponent))
     #define f64_atan2(i_y, i_x)                ((f64_t)atan2(i_y, i_x))
+    #define f64_floor(i_value)                 ((f64_t)floor(i_value))
+    #define f64_round(i_value)                 ((f64_t)round(i_value))
+    #define f64_exp2(i_value)                  ((f64_t)exp2(i_value))
+    #define f64_log2(i_value)                  ((f64_t)log2(i_value))
 #endif
 
 typedef union   
@@ -0,0 +1,4499 @@
+/* Platform independent game state, collision, navigation and entity logic.
+ * Shared by the game and the offline tools in tools/. The includer provides core.h, assert, printf and 
+ * profile_time_ms. */
+#ifndef GAME_H
+#define GAME_H
+
+typedef enum {
+    BACKGROUND_TYPE_CREDITS = 0,
+    BACKGROUND_TYPE_MAIN_MENU,
+    BACKGROUND_TYPE_LEVEL,
+    BACKGROUND_TYPE_END,
+    _BACKGROUND_TYPE_COUNT,
+    _BACKGROUND_TYPE_MAX = 0xFF
+} background_type;
+background_type g_background_type;
+
+typedef struct {
+    fvec2 position;
+    fvec2 debug;
+    f32 radius;
+    u32 growth_state;
+    f32 growth_factor; /* 0-1, range splits into thirds. */
+    f32 time;
+    u32 level_edit_object;
+    f32 screen_fade;
+    f32 scale;
+    u32 maggots;
+    u32 deaths;
+    b8 is_dead;
+    b8 enable_input;
+} player_data;
+player_data g_player;
+
+typedef enum
+{
+    ENTITY_TYPE_INVALID = 0,
+    ENTITY_TYPE_TUMOR,
+    ENTITY_TYPE_T_CELL,
+    ENTITY_TYPE_WALL,
+    ENTITY_TYPE_PORTAL,
+    ENTITY_TYPE_MAGGOT,
+    ENTITY_TYPE_PARTICLES,
+    ENTITY_TYPE_BOX_TEXT,
+    ENTITY_TYPE_MOTHER,
+    _ENTITY_TYPE_COUNT,
+    _ENTITY_TYPE_MAX = 0xFF,
+} entity_type;
+
+typedef struct {
+    entity_type type;
+    fvec2 position;
+    fvec3 growth_sizes1;
+    fvec3 growth_sizes2;
+    f32 sprite_index[2];
+    f32 timer;
+    b8 should_grow;
+    b8 is_talking;
+} entity_data;
+
+/* Worlds are a grid of level sized chunks, the original levels are single chunk worlds.
+ * Only the chunks around the camera are resident, their entities live in g_entities. See world_stream. */
+#define LEVEL_WIDTH 1600
+#define LEVEL_HEIGHT 900
+#define WORLD_CHUNK_WIDTH LEVEL_WIDTH
+#define WORLD_CHUNK_HEIGHT LEVEL_HEIGHT
+#define WORLD_CHUNKS_COUNT_MAX 128
+#define WORLD_CHUNK_ENTITIES_COUNT_MAX 128
+#define WORLD_RESIDENT_REACH 1 /* Chunks kept resident on every side of the chunk the camera is in. */
+#define WORLD_RESIDENT_CHUNKS (WORLD_RESIDENT_REACH * 2 + 1)
+#define WORLD_RESIDENT_WIDTH (WORLD_RESIDENT_CHUNKS * WORLD_CHUNK_WIDTH)
+#define WORLD_RESIDENT_HEIGHT (WORLD_RESIDENT_CHUNKS * WORLD_CHUNK_HEIGHT)
+
+#define ENTITIES_COUNT_MAX (WORLD_CHUNK_ENTITIES_COUNT_MAX * WORLD_RESIDENT_CHUNKS * WORLD_RESIDENT_CHUNKS)
+
+/* Level layout as levels.h writes it, world_from_entities moves it into the chunks. Chunks keep entity_data 
+ * records too, only the resident entities are split up into g_entity_store. */
+entity_data g_entities[ENTITIES_COUNT_MAX];
+sz g_entities_count;
+
+/* Handles pack the slot index with the generation of the slot. Despawning bumps the generation, 
+ * so handles to despawned entities stay invalid after their slot is reused. */
+typedef u32 entity_handle;
+#define ENTITY_HANDLE_INDEX_BITS 20
+#define ENTITY_HANDLE_INDEX_MASK ((1u << ENTITY_HANDLE_INDEX_BITS) - 1)
+#define ENTITY_HANDLE_GENERATION_MASK (0xFFFFFFFFu >> ENTITY_HANDLE_INDEX_BITS)
+#define ENTITY_HANDLE_INVALID 0xFFFFFFFF
+#define ENTITIES_CAPACITY_MAX ENTITY_HANDLE_INDEX_MASK
+
+typedef f32 entity_sprite_index[2];
+
+#define PARTICLES_NOT_EMITTED 0xFFFFFFFF /* See particles_first below. */
+#define ENTITY_GPU_SLOTS_COUNT 3          /* See gpu_slots below. */
+
+/* Resident entities as a pool of parallel arrays, so per frame loops only pull in the fields they use. 
+ * The hot fields come first, the rest is component data only some entity types use. 
+ * Free slots have type ENTITY_TYPE_INVALID and are reused last in first out. The arrays start at 
+ * ENTITIES_COUNT_MAX slots and double when full. Iterate live entities in slot order with entity_first and entity_next, 
+ * or the live entities of one type through members. */
+typedef struct {
+    entity_type* type;
+    f32* position_x;
+    f32* position_y;
+    fvec3* growth_sizes1;
+    fvec3* growth_sizes2;
+
+    /* Faces and text boxes. */
+    entity_sprite_index* sprite_index;
+    /* Tumors, mothers. */
+    f32* timer;
+    /* Text boxes. */
+    b8* should_grow;
+    /* Mothers. */
+    b8* is_talking;
+    /* Maggots. */
+    f32* velocity_x;
+    f32* velocity_y;
+    /* Particles, the range of their burst in the particle arrays. First is PARTICLES_NOT_EMITTED until the burst is emitted. */
+    u32* particles_first;
+    u32* particles_count;
+
+    /* Set whenever anything the primitives of an entity are made from changes, world_cull_primitives clears it. 
+     * gpu_slots are the GPU list slots of the level primitive and up to two overlay primitives, see world_cull_list. */
+    b8* is_dirty;
+    u32* gpu_slots;
+
+    /* Live entities of each type in no particular order, member_slot is where an entity is in the members of its type. */
+    u32* members[_ENTITY_TYPE_COUNT];
+    u32 members_count[_ENTITY_TYPE_COUNT];
+    u32* member_slot;
+
+    u16* generation;
+    u32* free_slots;
+    u32 free_count;
+    u32 end;      /* One past the last live slot, iteration stops here. */
+    u32 count;    /* Live entities. */
+    u32 capacity;
+
+    /* Statistics. */
+    u64 spawns;
+    u64 despawns;
+} entity_store;
+entity_store g_entity_store;
+
+/* Grows every array to at least i_capacity slots, new slots are free. */
+void entity_store_reserve(u32 i_capacity)
+{
+    if (i_capacity <= g_entity_store.capacity)
+    {
+        return;
+    }
+
+    u32 capacity = math_max(g_entity_store.capacity * 2, i_capacity);
+    assert(capacity <= ENTITIES_CAPACITY_MAX);
+    g_entity_store.type = realloc_arr(entity_type, g_entity_store.type, capacity);
+    g_entity_store.position_x = realloc_arr(f32, g_entity_store.position_x, capacity);
+    g_entity_store.position_y = realloc_arr(f32, g_entity_store.position_y, capacity);
+    g_entity_store.growth_sizes1 = realloc_arr(fvec3, g_entity_store.growth_sizes1, capacity);
+    g_entity_store.growth_sizes2 = realloc_arr(fvec3, g_entity_store.growth_sizes2, capacity);
+    g_entity_store.sprite_index = realloc_arr(entity_sprite_index, g_entity_store.sprite_index, capacity);
+    g_entity_store.timer = realloc_arr(f32, g_entity_store.timer, capacity);
+    g_entity_store.should_grow = realloc_arr(b8, g_entity_store.should_grow, capacity);
+    g_entity_store.is_talking = realloc_arr(b8, g_entity_store.is_talking, capacity);
+    g_entity_store.velocity_x = realloc_arr(f32, g_entity_store.velocity_x, capacity);
+    g_entity_store.velocity_y = realloc_arr(f32, g_entity_store.velocity_y, capacity);
+    g_entity_store.particles_first = realloc_arr(u32, g_entity_store.particles_first, capacity);
+    g_entity_store.particles_count = realloc_arr(u32, g_entity_store.particles_count, capacity);
+    g_entity_store.is_dirty = realloc_arr(b8, g_entity_store.is_dirty, capacity);
+    g_entity_store.gpu_slots = realloc_arr(u32, g_entity_store.gpu_slots, capacity * ENTITY_GPU_SLOTS_COUNT);
+    for (u32 i = 0; i < _ENTITY_TYPE_COUNT; ++i)
+    {
+        g_entity_store.members[i] = realloc_arr(u32, g_entity_store.members[i], capacity);
+    }
+    g_entity_store.member_slot = realloc_arr(u32, g_entity_store.member_slot, capacity);
+    g_entity_store.generation = realloc_arr(u16, g_entity_store.generation, capacity);
+    g_entity_store.free_slots = realloc_arr(u32, g_entity_store.free_slots, capacity);
+    assert(g_entity_store.type != NULL && g_entity_store.free_slots != NULL);
+
+    u32 added = capacity - g_entity_store.capacity;
+    memzero(&g_entity_store.type[g_entity_store.capacity], added * sizeof(entity_type));
+    memzero(&g_entity_store.generation[g_entity_store.capacity], added * sizeof(u16));
+    memzero(&g_entity_store.is_dirty[g_entity_store.capacity], added * sizeof(b8));
+    g_entity_store.capacity = capacity;
+}
+
+/* Bytes used by the pool arrays. */
+sz entity_store_size()
+{
+    sz slot_size = sizeof(entity_type) + sizeof(f32) * 2 + sizeof(fvec3) * 2 + sizeof(entity_sprite_index) + 
+        sizeof(f32) * 3 + sizeof(b8) * 2 + sizeof(u32) * 2 + sizeof(b8) + sizeof(u32) * ENTITY_GPU_SLOTS_COUNT + 
+        sizeof(u32) * (_ENTITY_TYPE_COUNT + 1) + sizeof(u16) + sizeof(u32);
+    return slot_size * g_entity_store.capacity;
+}
+
+entity_handle entity_handle_of(u32 i_entity)
+{
+    return (((u32)g_entity_store.generation[i_entity] & ENTITY_HANDLE_GENERATION_MASK) << ENTITY_HANDLE_INDEX_BITS) | i_entity;
+}
+
+b8 entity_is_alive(entity_handle i_handle)
+{
+    u32 entity = i_handle & ENTITY_HANDLE_INDEX_MASK;
+    if (i_handle == ENTITY_HANDLE_INVALID || entity >= g_entity_store.end || g_entity_store.type[entity] == ENTITY_TYPE_INVALID)
+    {
+        return FALSE;
+    }
+    return entity_handle_of(entity) == i_handle ? TRUE : FALSE;
+}
+
+/* Slot index of a live entity. */
+u32 entity_index(entity_handle i_handle)
+{
+    assert(entity_is_alive(i_handle));
+    return i_handle & ENTITY_HANDLE_INDEX_MASK;
+}
+
+/* Live entities in slot order: for (u32 i = entity_first(); i < g_entity_store.end; i = entity_next(i)) */
+u32 entity_next(u32 i_entity)
+{
+    u32 entity = i_entity + 1;
+    while (entity < g_entity_store.end && g_entity_store.type[entity] == ENTITY_TYPE_INVALID)
+    {
+        entity += 1;
+    }
+    return entity;
+}
+
+u32 entity_first()
+{
+    if (g_entity_store.end > 0 && g_entity_store.type[0] != ENTITY_TYPE_INVALID)
+    {
+        return 0;
+    }
+    return entity_next(0);
+}
+
+fvec2 entity_position(u32 i_entity)
+{
+    return { g_entity_store.position_x[i_entity], g_entity_store.position_y[i_entity] };
+}
+
+void entity_set_position(u32 i_entity, fvec2 i_position)
+{
+    g_entity_store.position_x[i_entity] = i_position.x;
+    g_entity_store.position_y[i_entity] = i_position.y;
+    g_entity_store.is_dirty[i_entity] = TRUE;
+}
+
+/* Sets sprite coordinate i_axis, 0 for x and 1 for y, of the sprite sheet cell the primitives of an entity show. */
+void entity_set_sprite_index(u32 i_entity, u32 i_axis, f32 i_value)
+{
+    assert(i_axis < 2);
+    g_entity_store.sprite_index[i_entity][i_axis] = i_value;
+    g_entity_store.is_dirty[i_entity] = TRUE;
+}
+
+/* Gathers a resident entity back into a record. */
+entity_data entity_get(u32 i_entity)
+{
+    entity_data entity;
+    entity.type = g_entity_store.type[i_entity];
+    entity.position = entity_position(i_entity);
+    entity.growth_sizes1 = g_entity_store.growth_sizes1[i_entity];
+    entity.growth_sizes2 = g_entity_store.growth_sizes2[i_entity];
+    entity.sprite_index[0] = g_entity_store.sprite_index[i_entity][0];
+    entity.sprite_index[1] = g_entity_store.sprite_index[i_entity][1];
+    entity.timer = g_entity_store.timer[i_entity];
+    entity.should_grow = g_entity_store.should_grow[i_entity];
+    entity.is_talking = g_entity_store.is_talking[i_entity];
+    return entity;
+}
+
+void entity_members_add(u32 i_entity)
+{
+    entity_type type = g_entity_store.type[i_entity];
+    g_entity_store.member_slot[i_entity] = g_entity_store.members_count[type];
+    g_entity_store.members[type][g_entity_store.members_count[type]] = i_entity;
+    g_entity_store.members_count[type] += 1;
+}
+
+/* Moves the last member of the type into the hole, so removing while walking the members backwards is fine. */
+void entity_members_remove(u32 i_entity)
+{
+    entity_type type = g_entity_store.type[i_entity];
+    u32 slot = g_entity_store.member_slot[i_entity];
+    u32 last = g_entity_store.members[type][g_entity_store.members_count[type] - 1];
+    g_entity_store.members[type][slot] = last;
+    g_entity_store.member_slot[last] = slot;
+    g_entity_store.members_count[type] -= 1;
+}
+
+/* Changes the type of a live entity, keeping the members of both types up to date. */
+void entity_set_type(u32 i_entity, entity_type i_type)
+{
+    assert(i_type != ENTITY_TYPE_INVALID);
+    entity_members_remove(i_entity);
+    g_entity_store.type[i_entity] = i_type;
+    g_entity_store.particles_first[i_entity] = PARTICLES_NOT_EMITTED;
+    g_entity_store.particles_count[i_entity] = 0;
+    g_entity_store.is_dirty[i_entity] = TRUE;
+    entity_members_add(i_entity);
+}
+
+/* Overwrites every field of a slot, use entity_set_type to change the type of a live entity. */
+void entity_set(u32 i_entity, entity_data const* i_entity_data)
+{
+    g_entity_store.type[i_entity] = i_entity_data->type;
+    entity_set_position(i_entity, i_entity_data->position);
+    g_entity_store.growth_sizes1[i_entity] = i_entity_data->growth_sizes1;
+    g_entity_store.growth_sizes2[i_entity] = i_entity_data->growth_sizes2;
+    g_entity_store.sprite_index[i_entity][0] = i_entity_data->sprite_index[0];
+    g_entity_store.sprite_index[i_entity][1] = i_entity_data->sprite_index[1];
+    g_entity_store.timer[i_entity] = i_entity_data->timer;
+    g_entity_store.should_grow[i_entity] = i_entity_data->should_grow;
+    g_entity_store.is_talking[i_entity] = i_entity_data->is_talking;
+    g_entity_store.velocity_x[i_entity] = 0.0f;
+    g_entity_store.velocity_y[i_entity] = 0.0f;
+    g_entity_store.particles_first[i_entity] = PARTICLES_NOT_EMITTED;
+    g_entity_store.particles_count[i_entity] = 0;
+}
+
+/* Takes the most recently freed slot, or the slot at the end when none are free. */
+entity_handle entity_spawn(entity_data const* i_entity_data)
+{
+    assert(i_entity_data->type != ENTITY_TYPE_INVALID);
+    u32 entity = ENTITY_HANDLE_INDEX_MASK;
+    while (g_entity_store.free_count > 0 && entity >= g_entity_store.end)
+    {
+        g_entity_store.free_count -= 1;
+        entity = g_entity_store.free_slots[g_entity_store.free_count];
+    }
+    if (entity >= g_entity_store.end)
+    {
+        entity_store_reserve(math_max(g_entity_store.end + 1, (u32)ENTITIES_COUNT_MAX));
+        entity = g_entity_store.end;
+        g_entity_store.end += 1;
+    }
+
+    entity_set(entity, i_entity_data);
+    entity_members_add(entity);
+    g_entity_store.count += 1;
+    g_entity_store.spawns += 1;
+    return entity_handle_of(entity);
+}
+
+void entity_despawn(entity_handle i_handle)
+{
+    u32 entity = entity_index(i_handle);
+    entity_members_remove(entity);
+    g_entity_store.type[entity] = ENTITY_TYPE_INVALID;
+    g_entity_store.generation[entity] = (u16)(g_entity_store.generation[entity] + 1);
+    g_entity_store.free_slots[g_entity_store.free_count] = entity;
+    g_entity_store.free_count += 1;
+    g_entity_store.count -= 1;
+    g_entity_store.despawns += 1;
+
+    /* Slots past the end are free anyway, spawn drops them from the free list as it comes across them. 
+     * The end is only moved out while the free list is empty, so those slots can not be handed out twice. */
+    while (g_entity_store.end > 0 && g_entity_store.type[g_entity_store.end - 1] == ENTITY_TYPE_INVALID)
+    {
+        g_entity_store.end -= 1;
+    }
+}
+
+/* Despawns everything and forgets the free slots, so the next spawns get slots in order again. */
+void entity_store_clear()
+{
+    for (u32 i = entity_first(); i < g_entity_store.end; i = entity_next(i))
+    {
+        g_entity_store.type[i] = ENTITY_TYPE_INVALID;
+        g_entity_store.generation[i] = (u16)(g_entity_store.generation[i] + 1);
+        g_entity_store.despawns += 1;
+    }
+    memzero(g_entity_store.members_count, sizeof(g_entity_store.members_count));
+    g_entity_store.free_count = 0;
+    g_entity_store.end = 0;
+    g_entity_store.count = 0;
+}
+
+/* Defines so we can share these with the shader as a nice trick. */
+#define SDF_PRIMITIVES_COUNT_MAX        512 /* Per GPU list, a view overlaps at most four chunks. */
+#define SDF_PRIMITIVE_INVALID           0
+#define SDF_PRIMITIVE_CIRCLE            1
+#define SDF_PRIMITIVE_SPIKED_CIRCLE     2
+#define SDF_PRIMITIVE_BOX               3
+#define SDF_PRIMITIVE_BOX_TEXTURED      4
+#define SDF_PRIMITIVE_BOX_TEXT          5
+#define SDF_PRIMITIVE_BOX_FLOWER        6
+#define SDF_PRIMITIVE_PORTAL            7
+#define SDF_PRIMITIVE_MAGGOT            8
+#define SDF_PRIMITIVE_PARTICLES         9
+
+typedef struct {
+    /* The unpacked form the CPU builds and culls, the GPU gets sdf_primitive_packed instead. */
+    u32 type;
+    u32 entity;
+    fvec3 growth_sizes1; /* Or x: size.x, y: pad, z: scale */
+    fvec3 growth_sizes2; /* Or x: size.y, y: pad, z: pad */
+    fvec2 position;
+    f32 sprite_index[2];
+} sdf_primitive;
+
+/* The GPU lists hold primitives packed into 20 bytes instead of 48. Growth sizes are half floats, sprite indices
+ * are in 1/256 steps below 16 so hand tuned rows like 8.05 land within a texel, and positions are signed 16 bit 1/8
+ * pixel steps relative to world_primitives_origin, the top left of the center resident chunk. Anything in view is
+ * well within that range. The shader does not need the entity, so it is left out. The fragment shader unpacks them
+ * the same way as sdf_primitive_unpack. */
+#define SDF_PACKED_POSITION_SCALE 8.0f
+#define SDF_PACKED_SPRITE_SCALE 256.0f
+
+typedef struct {
+    u32 type_sprite;     /* type: bits 0-7, sprite_index[0]: bits 8-19, sprite_index[1]: bits 20-31. */
+    u16 growth_sizes[6]; /* growth_sizes1 then growth_sizes2. */
+    i16 position[2];
+} sdf_primitive_packed;
+
+sdf_primitive_packed g_level_primitives[SDF_PRIMITIVES_COUNT_MAX];
+sdf_primitive_packed g_overlay_primitives[SDF_PRIMITIVES_COUNT_MAX];
+
+u32 sdf_primitive_packed_type(sdf_primitive_packed const* i_packed)
+{
+    return i_packed->type_sprite & 0xFF;
+}
+
+/* SSE2 is always there on x64, elsewhere the scalar versions below are used. */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define SDF_PACK_SSE2 1
+    #include <emmintrin.h>
+#else
+    #define SDF_PACK_SSE2 0
+#endif
+
+/* Float to half float rounding to nearest even, values beyond the half range become infinity. */
+u16 f32_to_f16(f32 i_value)
+{
+    u32 bits;
+    memcpy(&bits, &i_value, sizeof(bits));
+    u32 sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    u32 result;
+    if (bits >= (127u + 16u) << 23)
+    {
+        result = bits > (255u << 23) ? 0x7E00 : 0x7C00; /* NaN or infinity. */
+    }
+    else if (bits < (127u - 14u) << 23)
+    {
+        /* Subnormal, adding the magic number lines the mantissa up so float addition does the rounding. */
+        u32 magic_bits = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+        f32 value;
+        f32 magic;
+        memcpy(&value, &bits, sizeof(value));
+        memcpy(&magic, &magic_bits, sizeof(magic));
+        value += magic;
+        memcpy(&bits, &value, sizeof(bits));
+        result = bits - magic_bits;
+    }
+    else
+    {
+        u32 mantissa_odd = (bits >> 13) & 1;
+        bits = bits - ((127u - 15u) << 23) + 0xFFF + mantissa_odd;
+        result = bits >> 13;
+    }
+    return (u16)(result | (sign >> 16));
+}
+
+f32 f16_to_f32(u16 i_value)
+{
+    u32 exponent_mask = 0x7C00u << 13;
+    u32 bits = ((u32)i_value & 0x7FFF) << 13;
+    u32 exponent = bits & exponent_mask;
+    bits += (127u - 15u) << 23;
+    if (exponent == exponent_mask)
+    {
+        bits += (128u - 16u) << 23; /* NaN or infinity. */
+    }
+    else if (exponent == 0)
+    {
+        /* Subnormal, renormalise through float subtraction. */
+        u32 magic_bits = 113u << 23;
+        f32 value;
+        f32 magic;
+        bits += 1u << 23;
+        memcpy(&value, &bits, sizeof(value));
+        memcpy(&magic, &magic_bits, sizeof(magic));
+        value -= magic;
+        memcpy(&bits, &value, sizeof(bits));
+    }
+    bits |= ((u32)i_value & 0x8000) << 16;
+
+    f32 result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+/* Rounds to nearest even like the SSE2 conversion does, exact while |i_value| < 2^22. */
+f32 sdf_pack_round(f32 i_value)
+{
+    return (i_value + 12582912.0f) - 12582912.0f;
+}
+
+u32 sdf_primitive_pack_type_sprite(sdf_primitive const* i_primitive)
+{
+    assert(i_primitive->sprite_index[0] * SDF_PACKED_SPRITE_SCALE < 4096.0f && i_primitive->sprite_index[1] * SDF_PACKED_SPRITE_SCALE < 4096.0f);
+    u32 sprite_x = (u32)math_clamp(i_primitive->sprite_index[0] * SDF_PACKED_SPRITE_SCALE + 0.5f, 0.0f, 4095.0f);
+    u32 sprite_y = (u32)math_clamp(i_primitive->sprite_index[1] * SDF_PACKED_SPRITE_SCALE + 0.5f, 0.0f, 4095.0f);
+    return (i_primitive->type & 0xFF) | (sprite_x << 8) | (sprite_y << 20);
+}
+
+/* Particle primitives keep the range of their burst in growth_sizes2.x and y, see particles_primitive_add. 
+ * Those go to the GPU as exact 16 bit integers instead of half floats. */
+void sdf_primitive_pack_particles(sdf_primitive const* i_primitive, sdf_primitive_packed* io_packed)
+{
+    if (i_primitive->type == SDF_PRIMITIVE_PARTICLES)
+    {
+        io_packed->growth_sizes[3] = (u16)i_primitive->growth_sizes2.x;
+        io_packed->growth_sizes[4] = (u16)i_primitive->growth_sizes2.y;
+    }
+}
+
+void sdf_primitive_unpack_particles(sdf_primitive_packed const* i_packed, sdf_primitive* io_primitive)
+{
+    if (io_primitive->type == SDF_PRIMITIVE_PARTICLES)
+    {
+        io_primitive->growth_sizes2.x = (f32)i_packed->growth_sizes[3];
+        io_primitive->growth_sizes2.y = (f32)i_packed->growth_sizes[4];
+    }
+}
+
+/* One value at a time, the same result as sdf_primitive_pack. */
+void sdf_primitive_pack_reference(sdf_primitive const* i_primitive, fvec2 i_origin, sdf_primitive_packed* o_packed)
+{
+    o_packed->type_sprite = sdf_primitive_pack_type_sprite(i_primitive);
+    o_packed->growth_sizes[0] = f32_to_f16(i_primitive->growth_sizes1.x);
+    o_packed->growth_sizes[1] = f32_to_f16(i_primitive->growth_sizes1.y);
+    o_packed->growth_sizes[2] = f32_to_f16(i_primitive->growth_sizes1.z);
+    o_packed->growth_sizes[3] = f32_to_f16(i_primitive->growth_sizes2.x);
+    o_packed->growth_sizes[4] = f32_to_f16(i_primitive->growth_sizes2.y);
+    o_packed->growth_sizes[5] = f32_to_f16(i_primitive->growth_sizes2.z);
+    f32 x = sdf_pack_round((i_primitive->position.x - i_origin.x) * SDF_PACKED_POSITION_SCALE);
+    f32 y = sdf_pack_round((i_primitive->position.y - i_origin.y) * SDF_PACKED_POSITION_SCALE);
+    o_packed->position[0] = (i16)math_clamp(x, -32768.0f, 32767.0f);
+    o_packed->position[1] = (i16)math_clamp(y, -32768.0f, 32767.0f);
+    sdf_primitive_pack_particles(i_primitive, o_packed);
+}
+
+void sdf_primitive_unpack_reference(sdf_primitive_packed const* i_packed, fvec2 i_origin, sdf_primitive* o_primitive)
+{
+    memzero(o_primitive, sizeof(*o_primitive));
+    o_primitive->type = sdf_primitive_packed_type(i_packed);
+    o_primitive->sprite_index[0] = (f32)((i_packed->type_sprite >> 8) & 0xFFF) / SDF_PACKED_SPRITE_SCALE;
+    o_primitive->sprite_index[1] = (f32)(i_packed->type_sprite >> 20) / SDF_PACKED_SPRITE_SCALE;
+    o_primitive->growth_sizes1 = { f16_to_f32(i_packed->growth_sizes[0]), f16_to_f32(i_packed->growth_sizes[1]), f16_to_f32(i_packed->growth_sizes[2]) };
+    o_primitive->growth_sizes2 = { f16_to_f32(i_packed->growth_sizes[3]), f16_to_f32(i_packed->growth_sizes[4]), f16_to_f32(i_packed->growth_sizes[5]) };
+    o_primitive->position.x = i_origin.x + (f32)i_packed->position[0] / SDF_PACKED_POSITION_SCALE;
+    o_primitive->position.y = i_origin.y + (f32)i_packed->position[1] / SDF_PACKED_POSITION_SCALE;
+    sdf_primitive_unpack_particles(i_packed, o_primitive);
+}
+
+#if SDF_PACK_SSE2
+/* Four floats to half floats at once, same rounding as f32_to_f16. Lanes hold the halves sign extended to 32 bits, 
+ * so a saturating pack to 16 bits keeps them intact. */
+__m128i sdf_pack_f16x4(__m128 i_values)
+{
+    __m128 sign = _mm_and_ps(i_values, _mm_set1_ps(-0.0f));
+    __m128 absolute = _mm_xor_ps(i_values, sign);
+    __m128i bits = _mm_castps_si128(absolute);
+    __m128i is_regular = _mm_cmpgt_epi32(_mm_set1_epi32((127 + 16) << 23), bits);
+    __m128i is_subnormal = _mm_cmpgt_epi32(_mm_set1_epi32((127 - 14) << 23), bits);
+    __m128i is_nan = _mm_castps_si128(_mm_cmpunord_ps(absolute, absolute));
+    __m128i special = _mm_or_si128(_mm_and_si128(is_nan, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7C00));
+
+    __m128i magic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+    __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absolute, _mm_castsi128_ps(magic))), magic);
+
+    __m128i mantissa_odd = _mm_srai_epi32(_mm_slli_epi32(bits, 31 - 13), 31);
+    __m128i normal = _mm_add_epi32(bits, _mm_set1_epi32(0xFFF - ((127 - 15) << 23)));
+    normal = _mm_srli_epi32(_mm_sub_epi32(normal, mantissa_odd), 13);
+
+    __m128i result = _mm_or_si128(_mm_and_si128(is_subnormal, subnormal), _mm_andnot_si128(is_subnormal, normal));
+    result = _mm_or_si128(_mm_and_si128(is_regular, result), _mm_andnot_si128(is_regular, special));
+    return _mm_or_si128(result, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+}
+
+/* Four half floats, zero extended to 32 bits, to floats. */
+__m128 sdf_unpack_f16x4(__m128i i_halves)
+{
+    __m128i exponent_mantissa = _mm_and_si128(i_halves, _mm_set1_epi32(0x7FFF));
+    __m128i sign = _mm_slli_epi32(_mm_xor_si128(i_halves, exponent_mantissa), 16);
+    __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(exponent_mantissa, 13)), _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23)));
+    __m128i was_special = _mm_cmpgt_epi32(exponent_mantissa, _mm_set1_epi32(0x7BFF));
+    __m128 special = _mm_and_ps(_mm_castsi128_ps(was_special), _mm_castsi128_ps(_mm_set1_epi32(255 << 23)));
+    return _mm_or_ps(scaled, _mm_or_ps(_mm_castsi128_ps(sign), special));
+}
+#endif
+
+/* growth_sizes1, growth_sizes2 and position are eight consecutive floats, packed as six halves and two 16 bit 
+ * positions in two SSE2 registers. */
+void sdf_primitive_pack(sdf_primitive const* i_primitive, fvec2 i_origin, sdf_primitive_packed* o_packed)
+{
+    #if SDF_PACK_SSE2
+    o_packed->type_sprite = sdf_primitive_pack_type_sprite(i_primitive);
+    __m128 sizes = _mm_loadu_ps(&i_primitive->growth_sizes1.x);
+    __m128 sizes_position = _mm_loadu_ps(&i_primitive->growth_sizes2.y);
+    __m128 origin = _mm_setr_ps(0.0f, 0.0f, i_origin.x, i_origin.y);
+    __m128i position = _mm_cvtps_epi32(_mm_mul_ps(_mm_sub_ps(sizes_position, origin), _mm_set1_ps(SDF_PACKED_POSITION_SCALE)));
+    __m128i halves = sdf_pack_f16x4(sizes_position);
+    __m128i tail = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(halves), _mm_castsi128_ps(position), _MM_SHUFFLE(3, 2, 1, 0)));
+    _mm_storeu_si128((__m128i*)o_packed->growth_sizes, _mm_packs_epi32(sdf_pack_f16x4(sizes), tail));
+    sdf_primitive_pack_particles(i_primitive, o_packed);
+    #else
+    sdf_primitive_pack_reference(i_primitive, i_origin, o_packed);
+    #endif
+}
+
+void sdf_primitive_unpack(sdf_primitive_packed const* i_packed, fvec2 i_origin, sdf_primitive* o_primitive)
+{
+    #if SDF_PACK_SSE2
+    memzero(o_primitive, sizeof(*o_primitive));
+    o_primitive->type = sdf_primitive_packed_type(i_packed);
+    o_primitive->sprite_index[0] = (f32)((i_packed->type_sprite >> 8) & 0xFFF) / SDF_PACKED_SPRITE_SCALE;
+    o_primitive->sprite_index[1] = (f32)(i_packed->type_sprite >> 20) / SDF_PACKED_SPRITE_SCALE;
+    __m128i packed = _mm_loadu_si128((__m128i const*)i_packed->growth_sizes);
+    __m128i zero = _mm_setzero_si128();
+    __m128 sizes = sdf_unpack_f16x4(_mm_unpacklo_epi16(packed, zero));
+    __m128 halves = sdf_unpack_f16x4(_mm_unpackhi_epi16(packed, zero));
+    __m128 position = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(zero, packed), 16));
+    position = _mm_add_ps(_mm_mul_ps(position, _mm_set1_ps(1.0f / SDF_PACKED_POSITION_SCALE)), _mm_setr_ps(0.0f, 0.0f, i_origin.x, i_origin.y));
+    _mm_storeu_ps(&o_primitive->growth_sizes1.x, sizes);
+    _mm_storeu_ps(&o_primitive->growth_sizes2.y, _mm_shuffle_ps(halves, position, _MM_SHUFFLE(3, 2, 1, 0)));
+    sdf_primitive_unpack_particles(i_packed, o_primitive);
+    #else
+    sdf_primitive_unpack_reference(i_packed, i_origin, o_primitive);
+    #endif
+}
+
+/* The GPU lists above mirror the GPU buffers and persist between frames. Every visible entity owns a slot for each of 
+ * its primitives for as long as it stays in view, so entities entering or leaving the view leave all other slots alone. 
+ * Slots are only repacked for dirty entities, the rewritten slots are gathered into ascending ranges and only those are 
+ * uploaded. Ranges closer than SDF_DIRTY_RANGES_GAP slots are merged, a few clean slots are cheaper than another upload. */
+#define SDF_DIRTY_RANGES_COUNT_MAX 8
+#define SDF_DIRTY_RANGES_GAP 4
+typedef struct {
+    u32 begin;
+    u32 end; /* Exclusive. */
+} sdf_dirty_range;
+
+typedef struct {
+    sdf_dirty_range ranges[SDF_DIRTY_RANGES_COUNT_MAX];
+    u32 count;
+} sdf_dirty_ranges;
+
+sdf_dirty_ranges g_level_primitives_dirty;
+sdf_dirty_ranges g_overlay_primitives_dirty;
+
+/* Owners of the slots of a GPU list. Free slots hold invalid primitives and are reused lowest first, so the parts of 
+ * an entity sit in ascending slots like they did in the resident lists and overlapping parts keep their priority. 
+ * The list ends at end and the shader only gets to slots through the bins. */
+#define SDF_GPU_SLOT_NONE 0xFFFFFFFF
+typedef struct {
+    u32 owners[SDF_PRIMITIVES_COUNT_MAX];   /* Entity handle, ENTITY_HANDLE_INVALID for free slots. */
+    u8 parts[SDF_PRIMITIVES_COUNT_MAX];     /* Which of the gpu_slots of the owner the slot is. */
+    u32 seen[SDF_PRIMITIVES_COUNT_MAX];     /* Cull the owner was last visible in, slots not seen by a cull are freed. */
+    b8 is_written[SDF_PRIMITIVES_COUNT_MAX];
+    u32 free_slots[SDF_PRIMITIVES_COUNT_MAX];   /* Highest first, rebuilt every cull. */
+    u32 free_count;
+    u32 end;           /* One past the last owned slot. */
+    u32 visible_count;
+    u32 culls;
+    fvec2 origin;      /* The slots are packed relative to this origin, moving it repacks every slot. */
+} sdf_gpu_slots;
+
+sdf_gpu_slots g_level_slots;
+sdf_gpu_slots g_overlay_slots;
+
+/* Primitives of every resident entity. Collision uses all of them, the GPU lists above only get the ones in view. 
+ * They grow with the entity pool, entities create at most one level and two overlay primitives. */
+sdf_primitive* g_resident_level_primitives;
+sdf_primitive* g_resident_overlay_primitives;
+u32 g_resident_level_primitives_count;
+u32 g_resident_overlay_primitives_count;
+u32 g_resident_level_primitives_capacity;
+u32 g_resident_overlay_primitives_capacity;
+
+#define SDF_RESULT_DISTANCE_INVALID 999999
+#define SDF_RESULT_OBJECT_INVALID 0xFFFFFF
+
+typedef struct {
+    f32 distance;
+    u32 closest_object;
+    f32 overlapped_distance;
+    u32 overlapped_object;
+} sdf_result;
+
+/* The sdf shapes, shared with the fragment shader. */
+#include "sdf_shapes.h"
+
+/* Baked noise texture, sampled by the fragment shader and sample_noise. */
+#include "assets/noise_texture.h"
+
+/* Baked versions of the procedural noise, so no query pays for a sin.
+ * noise_value blends four noise_random lattice values, each a sin hash. The atlas stores all four corners of every
+ * cell of a NOISE_ATLAS_SIZE grid, so a query is one fetch. The corners wrap at the edges, which makes the atlas
+ * tileable and exact on [0, NOISE_ATLAS_SIZE - 1). The channel weights of sample_noise only depend on the offset and
+ * repeat every 2, one period is baked and interpolated. Baked once at startup by noise_atlas_bake. */
+#define NOISE_ATLAS_SIZE 256
+#define NOISE_ATLAS_PHASES 1024
+
+typedef struct {
+    f32 corners[NOISE_ATLAS_SIZE * NOISE_ATLAS_SIZE][4]; /* At x, x + 1, then at y + 1 the same, like noise_value. */
+    fvec4 weights[NOISE_ATLAS_PHASES + 1];
+    b8 is_baked;
+} noise_atlas;
+noise_atlas g_noise_atlas;
+
+/* The channel weights sample_noise used to compute for every query. Cost: 4 sin. */
+fvec4 noise_weights_procedural(f32 i_offset)
+{
+    fvec4 result;
+    f32 t = 6.283185f * sdf_fract(i_offset / 2.0f);
+    f32 k = 1.57079625f;
+    for (u32 channel = 0; channel < 4; ++channel)
+    {
+        result.data[channel] = (f32_sin(t + k * (f32)channel) + 1.0f) * 0.4f;
+    }
+    return result;
+}
+
+void noise_atlas_bake()
+{
+    static f32 lattice[NOISE_ATLAS_SIZE * NOISE_ATLAS_SIZE];
+    for (u32 y = 0; y < NOISE_ATLAS_SIZE; ++y)
+    {
+        for (u32 x = 0; x < NOISE_ATLAS_SIZE; ++x)
+        {
+            lattice[y * NOISE_ATLAS_SIZE + x] = noise_random(sdf_vec2((f32)x, (f32)y));
+        }
+    }
+    for (u32 y = 0; y < NOISE_ATLAS_SIZE; ++y)
+    {
+        for (u32 x = 0; x < NOISE_ATLAS_SIZE; ++x)
+        {
+            u32 x1 = (x + 1) & (NOISE_ATLAS_SIZE - 1);
+            u32 y1 = (y + 1) & (NOISE_ATLAS_SIZE - 1);
+            f32* corners = g_noise_atlas.corners[y * NOISE_ATLAS_SIZE + x];
+            corners[0] = lattice[y * NOISE_ATLAS_SIZE + x];
+            corners[1] = lattice[y * NOISE_ATLAS_SIZE + x1];
+            corners[2] = lattice[y1 * NOISE_ATLAS_SIZE + x];
+            corners[3] = lattice[y1 * NOISE_ATLAS_SIZE + x1];
+        }
+    }
+    for (u32 i = 0; i <= NOISE_ATLAS_PHASES; ++i)
+    {
+        g_noise_atlas.weights[i] = noise_weights_procedural(2.0f * (f32)i / (f32)NOISE_ATLAS_PHASES);
+    }
+    g_noise_atlas.is_baked = TRUE;
+}
+
+/* noise_weights_procedural from the atlas, within 2e-6. */
+fvec4 noise_weights(f32 i_offset)
+{
+    assert(g_noise_atlas.is_baked);
+    f32 phase = sdf_fract(i_offset / 2.0f) * (f32)NOISE_ATLAS_PHASES;
+    u32 index = math_min((u32)phase, (u32)NOISE_ATLAS_PHASES - 1);
+    f32 fraction = phase - (f32)index;
+    fvec4 result;
+    for (u32 channel = 0; channel < 4; ++channel)
+    {
+        result.data[channel] = f32_lerp(g_noise_atlas.weights[index].data[channel], g_noise_atlas.weights[index + 1].data[channel], fraction);
+    }
+    return result;
+}
+
+/* noise_value from the atlas, the same on [0, NOISE_ATLAS_SIZE - 1) and tiling beyond that. */
+f32 noise_value_baked(fvec2 i_position, f32 i_offset)
+{
+    assert(g_noise_atlas.is_baked);
+    fvec2 position = { i_position.x + i_offset, i_position.y };
+    fvec2 i = { f32_floor(position.x), f32_floor(position.y) };
+    fvec2 f = fvec2_sub(position, i);
+    f = fvec2_mul(fvec2_mul(f, f), fvec2_sub(sdf_vec2(3.0f, 3.0f), fvec2_mul_s(f, 2.0f)));
+    u32 x = (u32)((i32)i.x & (NOISE_ATLAS_SIZE - 1));
+    u32 y = (u32)((i32)i.y & (NOISE_ATLAS_SIZE - 1));
+    f32 const* corners = g_noise_atlas.corners[y * NOISE_ATLAS_SIZE + x];
+    return f32_lerp(f32_lerp(corners[0], corners[1], f.x), f32_lerp(corners[2], corners[3], f.x), f.y);
+}
+
+/* CPU version of sample_noise in the fragment shader for the shared sdf shapes.
+ * Filters bilinearly and wraps like noise_sampler, so both sides see the same noise. */
+f32 sample_noise(fvec2 i_position, f32 i_offset)
+{
+    f32 u = i_position.x / 1600.0f * (f32)TEXTURE_NOISE_WIDTH - 0.5f;
+    f32 v = i_position.y / 900.0f * (f32)TEXTURE_NOISE_HEIGHT - 0.5f;
+    f32 u_floor = f32_floor(u);
+    f32 v_floor = f32_floor(v);
+    f32 u_fraction = u - u_floor;
+    f32 v_fraction = v - v_floor;
+
+    u32 x0 = (u32)((i32)u_floor & (TEXTURE_NOISE_WIDTH - 1));
+    u32 y0 = (u32)((i32)v_floor & (TEXTURE_NOISE_HEIGHT - 1));
+    u32 x1 = (x0 + 1) & (TEXTURE_NOISE_WIDTH - 1);
+    u32 y1 = (y0 + 1) & (TEXTURE_NOISE_HEIGHT - 1);
+    u32 texel00 = g_texture_noise[y0 * TEXTURE_NOISE_WIDTH + x0];
+    u32 texel10 = g_texture_noise[y0 * TEXTURE_NOISE_WIDTH + x1];
+    u32 texel01 = g_texture_noise[y1 * TEXTURE_NOISE_WIDTH + x0];
+    u32 texel11 = g_texture_noise[y1 * TEXTURE_NOISE_WIDTH + x1];
+
+    /* Blend the four channels with weights cycling over time. */
+    fvec4 weights = noise_weights(i_offset);
+    f32 result = 0.0f;
+    for (u32 channel = 0; channel < 4; ++channel)
+    {
+        u32 shift = channel * 8;
+        f32 top = f32_lerp((f32)((texel00 >> shift) & 0xFF), (f32)((texel10 >> shift) & 0xFF), u_fraction);
+        f32 bottom = f32_lerp((f32)((texel01 >> shift) & 0xFF), (f32)((texel11 >> shift) & 0xFF), u_fraction);
+        result += weights.data[channel] * f32_lerp(top, bottom, v_fraction) / 255.0f;
+    }
+    return result;
+}
+
+/* Converts growth_factor into a weight per growth state, so each size is a single dot(weights, sizes).
+ * Growth states are points on a circle at 0, 1/3 and 2/3. A state's weight falls off linearly with the 
+ * distance along the circle to it, which is exactly lerping between the two nearest states but without 
+ * branching on which third we are in. Mirrored by growth_factor_to_weights in the shader. */
+fvec3 growth_factor_to_weights(f32 i_factor)
+{
+    fvec3 result;
+    result.x = math_max(1.0f - f32_abs(f32_mod(i_factor * 3.0f + 4.5f, 3.0f) - 1.5f), 0.0f);
+    result.y = math_max(1.0f - f32_abs(f32_mod(i_factor * 3.0f + 3.5f, 3.0f) - 1.5f), 0.0f);
+    result.z = math_max(1.0f - f32_abs(f32_mod(i_factor * 3.0f + 2.5f, 3.0f) - 1.5f), 0.0f);
+    return result;
+}
+
+#if DEBUG
+/* Branching version growth_factor_to_weights replaced, kept to test against. */
+f32 lerp_growth_factors(fvec3 i_sizes, f32 i_factor)
+{
+    f32 f = i_factor;
+    if (f >= 0.0f/3.0f && f < 1.0f/3.0f)            return f32_lerp(i_sizes.x, i_sizes.y, (f - 0.0f/3.0f) * 3.0f);
+    else if (f >= 1.0f/3.0f && f < 2.0f/3.0f)       return f32_lerp(i_sizes.y, i_sizes.z, (f - 1.0f/3.0f) * 3.0f);
+    else/* if (f >= 2.0f/3.0f && f < 3.0f/3.0f) */  return f32_lerp(i_sizes.z, i_sizes.x, (f - 2.0f/3.0f) * 3.0f);
+}
+
+/* Sweeps the full [0, 1) range, including the wrap around from the last state back to the first. */
+void growth_factor_to_weights_test()
+{
+    fvec3 sizes = { 100.0f, -50.0f, 300.0f };
+    u32 steps = 1 << 16;
+    for (u32 i = 0; i < steps; ++i)
+    {
+        f32 factor = (f32)i / (f32)steps;
+        fvec3 weights = growth_factor_to_weights(factor);
+        f32 expected = lerp_growth_factors(sizes, factor);
+        f32 actual = fvec3_dot(weights, sizes);
+        assert(f32_abs(expected - actual) < 0.01f);
+        assert(f32_abs(weights.x + weights.y + weights.z - 1.0f) < 0.0001f);
+    }
+}
+#endif
+
+/* --------------------------------------------------
+   World 
+   -------------------------------------------------- */
+
+/* Chunks own the entities of their area while not resident. Memory is fixed at 
+ * WORLD_CHUNKS_COUNT_MAX * WORLD_CHUNK_ENTITIES_COUNT_MAX entities, no matter how much of the world is used. */
+typedef struct {
+    entity_data entities[WORLD_CHUNK_ENTITIES_COUNT_MAX];
+    u32 entities_count;
+} world_chunk;
+
+#define WORLD_STREAM_HYSTERESIS 0.25f /* How far, in chunks, the view center may leave the center chunk before restreaming. */
+
+typedef struct {
+    world_chunk chunks[WORLD_CHUNKS_COUNT_MAX];
+    u32 width;    /* In chunks. */
+    u32 height;
+    fvec2 size;   /* In pixels. */
+    fvec2 camera; /* Top left of the view, a view is exactly one chunk. */
+
+    /* Resident chunks are the WORLD_RESIDENT_CHUNKS squared chunks around the center chunk, some may lie outside the world. 
+     * resident_origin is the top left of that area and the origin of the collision grid and navigation. */
+    i32 resident_x;
+    i32 resident_y;
+    fvec2 resident_origin;
+    b8 is_resident;
+
+    /* Statistics. */
+    u64 streams;
+    u64 entities_streamed;
+    f64 stream_time_ms;
+    u64 culls;
+    u64 primitives_visible;
+    u64 primitives_culled;
+    f64 cull_time_ms;
+    u64 primitives_touched;
+    u64 bytes_written;
+    u64 primitives_dropped;
+    u32 frame_primitives_touched; /* GPU list slots rewritten by the last cull. */
+    u32 frame_bytes_written;      /* Bytes covered by the dirty ranges of the last cull. */
+    u32 frame_primitives_dropped; /* Visible primitives the last cull had no GPU list slot left for. */
+} world_data;
+world_data g_world;
+
+f64 profile_time_ms();
+void sdf_collision_snapshot_clear();
+
+world_chunk* world_chunk_at(i32 i_x, i32 i_y)
+{
+    if (i_x < 0 || i_y < 0 || i_x >= (i32)g_world.width || i_y >= (i32)g_world.height)
+    {
+        return NULL;
+    }
+    return &g_world.chunks[(u32)i_y * g_world.width + (u32)i_x];
+}
+
+/* Adds the entity to the chunk it is in, entities outside the world go to the closest chunk. */
+void world_add_entity(entity_data const* i_entity)
+{
+    i32 x = (i32)math_clamp(f32_floor(i_entity->position.x / (f32)WORLD_CHUNK_WIDTH), 0.0f, (f32)(g_world.width - 1));
+    i32 y = (i32)math_clamp(f32_floor(i_entity->position.y / (f32)WORLD_CHUNK_HEIGHT), 0.0f, (f32)(g_world.height - 1));
+    world_chunk* chunk = world_chunk_at(x, y);
+    assert(chunk->entities_count < WORLD_CHUNK_ENTITIES_COUNT_MAX);
+    chunk->entities[chunk->entities_count] = *i_entity;
+    chunk->entities_count += 1;
+}
+
+/* Empties the world and resizes it to i_width by i_height chunks, fill it with world_add_entity. */
+void world_clear(u32 i_width, u32 i_height)
+{
+    assert(i_width > 0 && i_height > 0 && i_width * i_height <= WORLD_CHUNKS_COUNT_MAX);
+    for (u32 i = 0; i < WORLD_CHUNKS_COUNT_MAX; ++i)
+    {
+        g_world.chunks[i].entities_count = 0;
+    }
+    g_world.width = i_width;
+    g_world.height = i_height;
+    g_world.size = { (f32)(i_width * WORLD_CHUNK_WIDTH), (f32)(i_height * WORLD_CHUNK_HEIGHT) };
+    g_world.is_resident = FALSE;
+    entity_store_clear();
+}
+
+/* Moves the resident entities back into the chunks they are in now, which need not be the chunk they came from. 
+ * Particles are short lived effects and are dropped instead. */
+void world_evict()
+{
+    for (u32 i = entity_first(); i < g_entity_store.end; i = entity_next(i))
+    {
+        if (g_entity_store.type[i] == ENTITY_TYPE_PARTICLES)
+        {
+            continue;
+        }
+        entity_data entity = entity_get(i);
+        world_add_entity(&entity);
+    }
+    entity_store_clear();
+    g_world.is_resident = FALSE;
+}
+
+/* Makes the chunks around chunk i_x, i_y resident. Handles to resident entities do not survive this, 
+ * call it before anything holds on to them for the frame. Chunk order is kept, so single chunk worlds keep 
+ * their entity indices. The collision snapshot refers to entities by handle, so it is cleared until the next build. */
+void world_make_resident(i32 i_x, i32 i_y)
+{
+    f64 start = profile_time_ms();
+    if (g_world.is_resident)
+    {
+        world_evict();
+        sdf_collision_snapshot_clear();
+    }
+
+    for (i32 y = i_y - WORLD_RESIDENT_REACH; y <= i_y + WORLD_RESIDENT_REACH; ++y)
+    {
+        for (i32 x = i_x - WORLD_RESIDENT_REACH; x <= i_x + WORLD_RESIDENT_REACH; ++x)
+        {
+            world_chunk* chunk = world_chunk_at(x, y);
+            if (chunk == NULL)
+            {
+                continue;
+            }
+            for (u32 i = 0; i < chunk->entities_count; ++i)
+            {
+                entity_spawn(&chunk->entities[i]);
+            }
+            g_world.entities_streamed += chunk->entities_count;
+            chunk->entities_count = 0;
+        }
+    }
+
+    g_world.resident_x = i_x;
+    g_world.resident_y = i_y;
+    g_world.resident_origin = { (f32)((i_x - WORLD_RESIDENT_REACH) * WORLD_CHUNK_WIDTH), (f32)((i_y - WORLD_RESIDENT_REACH) * WORLD_CHUNK_HEIGHT) };
+    g_world.is_resident = TRUE;
+    g_world.streams += 1;
+    g_world.stream_time_ms += profile_time_ms() - start;
+}
+
+/* Turns the entities levels.h placed in g_entities into a world of i_width by i_height chunks. */
+void world_from_entities(u32 i_width, u32 i_height)
+{
+    world_clear(i_width, i_height);
+    for (u32 i = 0; i < ENTITIES_COUNT_MAX; ++i)
+    {
+        if (g_entities[i].type == ENTITY_TYPE_INVALID)
+        {
+            break;
+        }
+        world_add_entity(&g_entities[i]);
+    }
+    memzero(&g_entities, sizeof(g_entities));
+    g_entities_count = 0;
+}
+
+/* Centers the view on i_target, staying within the world, and streams chunks once the view center 
+ * moved far enough out of the center chunk. The view then always lies within the resident chunks. */
+void world_update_camera(fvec2 i_target)
+{
+    fvec2 view = { (f32)WORLD_CHUNK_WIDTH, (f32)WORLD_CHUNK_HEIGHT };
+    g_world.camera.x = math_clamp(i_target.x - view.x * 0.5f, 0.0f, g_world.size.x - view.x);
+    g_world.camera.y = math_clamp(i_target.y - view.y * 0.5f, 0.0f, g_world.size.y - view.y);
+
+    f32 chunk_x = (g_world.camera.x + view.x * 0.5f) / view.x;
+    f32 chunk_y = (g_world.camera.y + view.y * 0.5f) / view.y;
+    if (!g_world.is_resident || 
+        f32_abs(chunk_x - ((f32)g_world.resident_x + 0.5f)) > 0.5f + WORLD_STREAM_HYSTERESIS ||
+        f32_abs(chunk_y - ((f32)g_world.resident_y + 0.5f)) > 0.5f + WORLD_STREAM_HYSTERESIS)
+    {
+        world_make_resident((i32)f32_floor(chunk_x), (i32)f32_floor(chunk_y));
+    }
+}
+
+/* Furthest a primitive draws from its position in any growth state. */
+f32 sdf_primitive_bounds_radius(sdf_primitive const* i_primitive)
+{
+    fvec3 sizes1 = fvec3_abs(i_primitive->growth_sizes1);
+    fvec3 sizes2 = fvec3_abs(i_primitive->growth_sizes2);
+    f32 size1 = math_max(math_max(sizes1.x, sizes1.y), sizes1.z);
+    f32 size2 = math_max(math_max(sizes2.x, sizes2.y), sizes2.z);
+    f32 wobble = 25.0f * 1.6f; /* sample_noise stays below 1.6. */
+    switch (i_primitive->type)
+    {
+        case SDF_PRIMITIVE_CIRCLE: return size1 + wobble;
+        case SDF_PRIMITIVE_SPIKED_CIRCLE: return size1 * 1.05f;
+        case SDF_PRIMITIVE_BOX: return fvec2_len({ size1, size2 }) + wobble;
+        case SDF_PRIMITIVE_PORTAL: return size1 * 2.1f;
+        case SDF_PRIMITIVE_MAGGOT: return size1 * 2.6f; /* The breathing magnifies it by up to 1.625. */
+        case SDF_PRIMITIVE_PARTICLES: return 500.0f + 14.0f; /* Particles fly out up to 500 pixels. */
+    }
+    return fvec2_len({ size1, size2 });
+}
+
+/* Marks must come in ascending order. Once out of ranges the last one grows to cover the rest. */
+void sdf_dirty_ranges_mark(sdf_dirty_ranges* io_dirty, u32 i_index)
+{
+    if (io_dirty->count > 0)
+    {
+        sdf_dirty_range* last = &io_dirty->ranges[io_dirty->count - 1];
+        assert(last->end <= i_index);
+        if (i_index < last->end + SDF_DIRTY_RANGES_GAP || io_dirty->count == SDF_DIRTY_RANGES_COUNT_MAX)
+        {
+            last->end = i_index + 1;
+            return;
+        }
+    }
+    io_dirty->ranges[io_dirty->count].begin = i_index;
+    io_dirty->ranges[io_dirty->count].end = i_index + 1;
+    io_dirty->count += 1;
+}
+
+u32 sdf_dirty_ranges_size(sdf_dirty_ranges const* i_dirty)
+{
+    u32 size = 0;
+    for (u32 i = 0; i < i_dirty->count; ++i)
+    {
+        size += (i_dirty->ranges[i].end - i_dirty->ranges[i].begin) * (u32)sizeof(sdf_primitive_packed);
+    }
+    return size;
+}
+
+/* Top left of the center resident chunk, packed primitive positions are relative to it. */
+fvec2 world_primitives_origin()
+{
+    return { (f32)(g_world.resident_x * WORLD_CHUNK_WIDTH), (f32)(g_world.resident_y * WORLD_CHUNK_HEIGHT) };
+}
+
+/* Takes the lowest free slot, or the slot at the end when none are free. Successive takes are ascending. */
+u32 sdf_gpu_slots_take(sdf_gpu_slots* io_slots)
+{
+    if (io_slots->free_count > 0)
+    {
+        io_slots->free_count -= 1;
+        return io_slots->free_slots[io_slots->free_count];
+    }
+    if (io_slots->end == SDF_PRIMITIVES_COUNT_MAX)
+    {
+        return SDF_GPU_SLOT_NONE;
+    }
+    io_slots->end += 1;
+    return io_slots->end - 1;
+}
+
+/* Culls the resident primitives i_primitives into the slots of their entities in io_visible, i_first_part is the first 
+ * of the gpu_slots of an entity this list uses. Primitives of one entity come one after the other, in the order of its slots. 
+ * Visible entities keep their slots, dirty ones are repacked. Then the slots of entities that went out of view are freed 
+ * and entities that came into view get one. An entity that needs a slot for any part takes new ones for all its visible 
+ * parts, so they stay in ascending slot order. Returns the number of visible primitives. */
+u32 world_cull_list(sdf_primitive const* i_primitives, u32 i_count, u32 i_first_part, sdf_primitive_packed* io_visible, sdf_gpu_slots* io_slots, sdf_dirty_ranges* io_dirty)
+{
+    fvec2 origin = world_primitives_origin();
+    b8 is_origin_moved = memcmp(&origin, &io_slots->origin, sizeof(fvec2)) != 0 ? TRUE : FALSE;
+    io_slots->origin = origin;
+    io_slots->culls += 1;
+
+    fvec2 view_min = g_world.camera;
+    fvec2 view_max = { g_world.camera.x + (f32)WORLD_CHUNK_WIDTH, g_world.camera.y + (f32)WORLD_CHUNK_HEIGHT };
+    u32 entering[SDF_PRIMITIVES_COUNT_MAX];
+    u8 entering_parts[SDF_PRIMITIVES_COUNT_MAX];
+    u32 entering_count = 0;
+    u32 visible_count = 0;
+    for (u32 first = 0; first < i_count;)
+    {
+        u32 entity_handle = i_primitives[first].entity;
+        u32 entity = entity_handle & ENTITY_HANDLE_INDEX_MASK;
+        assert(entity < g_entity_store.capacity);
+        u32 last = first + 1;
+        while (last < i_count && i_primitives[last].entity == entity_handle)
+        {
+            last += 1;
+        }
+
+        u32 visible_parts = 0;
+        b8 is_entering = FALSE;
+        for (u32 i = first; i < last; ++i)
+        {
+            sdf_primitive const* primitive = &i_primitives[i];
+            f32 radius = sdf_primitive_bounds_radius(primitive);
+            if (primitive->position.x + radius < view_min.x || primitive->position.x - radius > view_max.x ||
+                primitive->position.y + radius < view_min.y || primitive->position.y - radius > view_max.y)
+            {
+                continue;
+            }
+
+            u32 slot_part = i_first_part + i - first;
+            assert(slot_part < ENTITY_GPU_SLOTS_COUNT);
+            visible_parts |= 1u << (i - first);
+            u32 slot = g_entity_store.gpu_slots[entity * ENTITY_GPU_SLOTS_COUNT + slot_part];
+            if (slot >= io_slots->end || io_slots->owners[slot] != entity_handle || io_slots->parts[slot] != slot_part)
+            {
+                is_entering = TRUE;
+            }
+        }
+
+        for (u32 i = first; i < last; ++i)
+        {
+            if ((visible_parts & (1u << (i - first))) == 0)
+            {
+                continue;
+            }
+
+            u32 slot_part = i_first_part + i - first;
+            if (is_entering)
+            {
+                /* Slots are handed out once the slots of everything that left the view are free. */
+                if (entering_count < SDF_PRIMITIVES_COUNT_MAX)
+                {
+                    entering[entering_count] = i;
+                    entering_parts[entering_count] = (u8)slot_part;
+                    entering_count += 1;
+                }
+                else
+                {
+                    g_world.frame_primitives_dropped += 1;
+                }
+                continue;
+            }
+
+            u32 slot = g_entity_store.gpu_slots[entity * ENTITY_GPU_SLOTS_COUNT + slot_part];
+            io_slots->seen[slot] = io_slots->culls;
+            visible_count += 1;
+            if (is_origin_moved || g_entity_store.is_dirty[entity])
+            {
+                sdf_primitive_packed packed;
+                sdf_primitive_pack(&i_primitives[i], origin, &packed);
+                if (memcmp(&io_visible[slot], &packed, sizeof(packed)) != 0)
+                {
+                    io_visible[slot] = packed;
+                    io_slots->is_written[slot] = TRUE;
+                }
+            }
+        }
+        first = last;
+    }
+
+    /* Free the slots of entities that are gone or out of view, invalid primitives are skipped by the bins. 
+     * The free list is rebuilt from the top down, so takes from its back go up from the lowest free slot. */
+    io_slots->free_count = 0;
+    for (u32 slot = io_slots->end; slot > 0; --slot)
+    {
+        u32 index = slot - 1;
+        if (io_slots->owners[index] != ENTITY_HANDLE_INVALID)
+        {
+            if (io_slots->seen[index] == io_slots->culls)
+            {
+                continue;
+            }
+            io_slots->owners[index] = ENTITY_HANDLE_INVALID;
+            io_visible[index].type_sprite = SDF_PRIMITIVE_INVALID;
+            io_slots->is_written[index] = TRUE;
+        }
+        io_slots->free_slots[io_slots->free_count] = index;
+        io_slots->free_count += 1;
+    }
+
+    for (u32 i = 0; i < entering_count; ++i)
+    {
+        u32 slot = sdf_gpu_slots_take(io_slots);
+        assert(slot != SDF_GPU_SLOT_NONE);
+        if (slot == SDF_GPU_SLOT_NONE)
+        {
+            g_world.frame_primitives_dropped += entering_count - i;
+            break;
+        }
+
+        sdf_primitive const* primitive = &i_primitives[entering[i]];
+        u32 entity = primitive->entity & ENTITY_HANDLE_INDEX_MASK;
+        g_entity_store.gpu_slots[entity * ENTITY_GPU_SLOTS_COUNT + entering_parts[i]] = slot;
+        io_slots->owners[slot] = primitive->entity;
+        io_slots->parts[slot] = entering_parts[i];
+        io_slots->seen[slot] = io_slots->culls;
+        sdf_primitive_pack(primitive, origin, &io_visible[slot]);
+        io_slots->is_written[slot] = TRUE;
+        visible_count += 1;
+    }
+
+    /* Freed slots at the end shorten the list, they already hold invalid primitives. */
+    while (io_slots->end > 0 && io_slots->owners[io_slots->end - 1] == ENTITY_HANDLE_INVALID)
+    {
+        io_slots->end -= 1;
+    }
+
+    for (u32 slot = 0; slot < SDF_PRIMITIVES_COUNT_MAX; ++slot)
+    {
+        if (io_slots->is_written[slot])
+        {
+            io_slots->is_written[slot] = FALSE;
+            sdf_dirty_ranges_mark(io_dirty, slot);
+            g_world.frame_primitives_touched += 1;
+        }
+    }
+    io_slots->visible_count = visible_count;
+    return visible_count;
+}
+
+/* Culls the resident primitives into the GPU lists and clears the dirty flags of every entity. 
+ * Starts new dirty ranges, the lists must be uploaded before the next cull. */
+void world_cull_primitives()
+{
+    f64 start = profile_time_ms();
+    g_level_primitives_dirty.count = 0;
+    g_overlay_primitives_dirty.count = 0;
+    g_world.frame_primitives_touched = 0;
+    g_world.frame_primitives_dropped = 0;
+    u32 level_count = world_cull_list(g_resident_level_primitives, g_resident_level_primitives_count, 0, g_level_primitives, &g_level_slots, &g_level_primitives_dirty);
+    u32 overlay_count = world_cull_list(g_resident_overlay_primitives, g_resident_overlay_primitives_count, 1, g_overlay_primitives, &g_overlay_slots, &g_overlay_primitives_dirty);
+    u32 resident_count = g_resident_level_primitives_count + g_resident_overlay_primitives_count;
+    memzero(g_entity_store.is_dirty, g_entity_store.end * sizeof(b8));
+
+    g_world.frame_bytes_written = sdf_dirty_ranges_size(&g_level_primitives_dirty) + sdf_dirty_ranges_size(&g_overlay_primitives_dirty);
+    g_world.primitives_touched += g_world.frame_primitives_touched;
+    g_world.bytes_written += g_world.frame_bytes_written;
+    g_world.primitives_dropped += g_world.frame_primitives_dropped;
+
+    g_world.culls += 1;
+    g_world.primitives_visible += level_count + overlay_count;
+    g_world.primitives_culled += resident_count - (level_count + overlay_count);
+    g_world.cull_time_ms += profile_time_ms() - start;
+}
+
+void world_print()
+{
+    f64 culls = g_world.culls > 0 ? (f64)g_world.culls : 1.0;
+    printf("World: %ux%u chunks, %llu resident entities, %llu streams moving %llu entities in %.3fms, %.4fms average cull drawing %.1f and culling %.1f primitives\n", 
+        g_world.width, 
+        g_world.height, 
+        (unsigned long long)g_entity_store.count, 
+        (unsigned long long)g_world.streams, 
+        (unsigned long long)g_world.entities_streamed, 
+        g_world.stream_time_ms, 
+        g_world.cull_time_ms / culls, 
+        (f64)g_world.primitives_visible / culls, 
+        (f64)g_world.primitives_culled / culls);
+    printf("Primitive uploads: last frame touched %u primitives writing %u bytes, on average %.1f primitives and %.1f bytes of %llu, %llu dropped\n", 
+        g_world.frame_primitives_touched, 
+        g_world.frame_bytes_written, 
+        (f64)g_world.primitives_touched / culls, 
+        (f64)g_world.bytes_written / culls, 
+        (unsigned long long)(sizeof(g_level_primitives) + sizeof(g_overlay_primitives)), 
+        (unsigned long long)g_world.primitives_dropped);
+}
+
+/* --------------------------------------------------
+   Collision 
+   -------------------------------------------------- */
+
+/* Collision snapshot, built once per frame after the entity to primitive pass.
+ * growth_factor is constant within a frame so we resolve the growth sizes of every level primitive 
+ * once instead of on every query. Zero sized primitives have collision disabled and are dropped. */
+typedef struct {
+    u32 type;
+    u32 primitive;
+    u32 entity;
+    fvec2 position;
+    fvec2 half_size;    /* Or x: radius for circular shapes. */
+    f32 bounds_radius;  /* Bounding circle around position. */
+    fvec2 bounds_min;
+    fvec2 bounds_max;
+} sdf_collision_shape;
+
+/* Uniform grid over the resident chunks used to accelerate ray and bounded distance queries.
+ * Each cell lists every shape whose bounds are within SDF_GRID_REACH of the cell, so any shape 
+ * closer than that to a point is guaranteed to be in the list of the cell containing it. */
+#define SDF_GRID_CELL_SIZE 64.0f
+#define SDF_GRID_REACH 64.0f
+#define SDF_GRID_WIDTH ((WORLD_RESIDENT_WIDTH + 63) / 64)
+#define SDF_GRID_HEIGHT ((WORLD_RESIDENT_HEIGHT + 63) / 64)
+#define SDF_GRID_CELLS_COUNT (SDF_GRID_WIDTH * SDF_GRID_HEIGHT)
+#define SDF_GRID_CELL_INVALID 0xFFFFFFFF
+
+/* The shapes grow with the entity pool, as every entity creates at most one level primitive. */
+typedef struct {
+    sdf_collision_shape* shapes;
+    sdf_collision_shape* build_shapes; /* Shapes of the build in progress, swapped with shapes when they differ. */
+    u32* grid_ranges;                  /* Cells every shape covers, min x, min y, max x and max y. */
+    u32 shapes_count;
+    u32 shapes_capacity;
+    u32 primitives_count;
+    u32 version; /* Incremented whenever the shapes change, used to invalidate cached queries. */
+    f32 time;    /* Time animated shapes are evaluated at. Not versioned, animation stays within the bounds. */
+
+    /* Shape indices per grid cell, cell i owns grid_shapes[grid_offsets[i]] up to grid_offsets[i + 1]. 
+     * The grid starts at the top left of the resident chunks. */
+    fvec2 grid_origin;
+    u32 grid_offsets[SDF_GRID_CELLS_COUNT + 1];
+    u32* grid_shapes;
+    u32 grid_shapes_capacity;
+
+    /* Statistics. */
+    u64 builds;
+    f64 build_time_ms;
+} sdf_collision_snapshot;
+sdf_collision_snapshot g_collision_snapshot;
+
+/* Grows the shape arrays to at least i_count shapes. */
+void sdf_collision_snapshot_reserve(u32 i_count)
+{
+    if (i_count <= g_collision_snapshot.shapes_capacity)
+    {
+        return;
+    }
+
+    u32 capacity = math_max(g_collision_snapshot.shapes_capacity * 2, math_max(i_count, (u32)ENTITIES_COUNT_MAX));
+    g_collision_snapshot.shapes = realloc_arr(sdf_collision_shape, g_collision_snapshot.shapes, capacity);
+    g_collision_snapshot.build_shapes = realloc_arr(sdf_collision_shape, g_collision_snapshot.build_shapes, capacity);
+    g_collision_snapshot.grid_ranges = realloc_arr(u32, g_collision_snapshot.grid_ranges, capacity * 4);
+    assert(g_collision_snapshot.shapes != NULL && g_collision_snapshot.build_shapes != NULL && g_collision_snapshot.grid_ranges != NULL);
+    g_collision_snapshot.shapes_capacity = capacity;
+}
+
+/* Bytes used by the shape arrays and cell lists. */
+sz sdf_collision_snapshot_size()
+{
+    return (sz)g_collision_snapshot.shapes_capacity * (sizeof(sdf_collision_shape) * 2 + sizeof(u32) * 4) + 
+        (sz)g_collision_snapshot.grid_shapes_capacity * sizeof(u32) + sizeof(g_collision_snapshot);
+}
+
+void sdf_collision_snapshot_clear()
+{
+    g_collision_snapshot.shapes_count = 0;
+    g_collision_snapshot.primitives_count = 0;
+    g_collision_snapshot.version += 1;
+    memzero(g_collision_snapshot.grid_offsets, sizeof(g_collision_snapshot.grid_offsets));
+}
+
+/* Grid cell containing i_position, SDF_GRID_CELL_INVALID outside the resident chunks. */
+u32 sdf_collision_grid_cell(sdf_collision_snapshot const* i_snapshot, fvec2 i_position)
+{
+    fvec2 position = fvec2_sub(i_position, i_snapshot->grid_origin);
+    if (position.x < 0.0f || position.y < 0.0f || 
+        position.x >= (f32)SDF_GRID_WIDTH * SDF_GRID_CELL_SIZE || position.y >= (f32)SDF_GRID_HEIGHT * SDF_GRID_CELL_SIZE)
+    {
+        return SDF_GRID_CELL_INVALID;
+    }
+    return (u32)(position.y / SDF_GRID_CELL_SIZE) * SDF_GRID_WIDTH + (u32)(position.x / SDF_GRID_CELL_SIZE);
+}
+
+/* Counts the shapes per cell, turns the counts into offsets and scatters the shapes into their cells. 
+ * Only cells within reach of a shape are touched, so the cost follows the shapes and not the grid size. 
+ * Shapes are scattered in snapshot order, so cell lists are in snapshot order as well. */
+void sdf_collision_grid_build()
+{
+    u32* offsets = g_collision_snapshot.grid_offsets;
+    memzero(offsets, sizeof(g_collision_snapshot.grid_offsets));
+
+    u32* ranges = g_collision_snapshot.grid_ranges;
+    for (u32 i = 0; i < g_collision_snapshot.shapes_count; ++i)
+    {
+        sdf_collision_shape* shape = &g_collision_snapshot.shapes[i];
+        u32* range = &ranges[i * 4];
+        fvec2 min = fvec2_sub(shape->bounds_min, g_collision_snapshot.grid_origin);
+        fvec2 max = fvec2_sub(shape->bounds_max, g_collision_snapshot.grid_origin);
+        f32 min_x = f32_floor((min.x - SDF_GRID_REACH) / SDF_GRID_CELL_SIZE);
+        f32 min_y = f32_floor((min.y - SDF_GRID_REACH) / SDF_GRID_CELL_SIZE);
+        f32 max_x = f32_floor((max.x + SDF_GRID_REACH) / SDF_GRID_CELL_SIZE);
+        f32 max_y = f32_floor((max.y + SDF_GRID_REACH) / SDF_GRID_CELL_SIZE);
+
+        /* Shapes entirely outside the grid get an empty range. */
+        range[0] = (u32)math_clamp(min_x, 0.0f, (f32)SDF_GRID_WIDTH);
+        range[1] = (u32)math_clamp(min_y, 0.0f, (f32)SDF_GRID_HEIGHT);
+        range[2] = (u32)math_clamp(max_x + 1.0f, 0.0f, (f32)SDF_GRID_WIDTH);
+        range[3] = (u32)math_clamp(max_y + 1.0f, 0.0f, (f32)SDF_GRID_HEIGHT);
+        for (u32 y = range[1]; y < range[3]; ++y)
+        {
+            for (u32 x = range[0]; x < range[2]; ++x)
+            {
+                offsets[y * SDF_GRID_WIDTH + x + 1] += 1;
+            }
+        }
+    }
+
+    for (u32 i = 1; i <= SDF_GRID_CELLS_COUNT; ++i)
+    {
+        offsets[i] += offsets[i - 1];
+    }
+    if (offsets[SDF_GRID_CELLS_COUNT] > g_collision_snapshot.grid_shapes_capacity)
+    {
+        u32 capacity = math_max(g_collision_snapshot.grid_shapes_capacity * 2, offsets[SDF_GRID_CELLS_COUNT]);
+        g_collision_snapshot.grid_shapes = realloc_arr(u32, g_collision_snapshot.grid_shapes, capacity);
+        assert(g_collision_snapshot.grid_shapes != NULL);
+        g_collision_snapshot.grid_shapes_capacity = capacity;
+    }
+
+    /* Scatter using each cell's offset as its cursor, which leaves every offset at the start of the next cell. */
+    for (u32 i = 0; i < g_collision_snapshot.shapes_count; ++i)
+    {
+        u32* range = &ranges[i * 4];
+        for (u32 y = range[1]; y < range[3]; ++y)
+        {
+            for (u32 x = range[0]; x < range[2]; ++x)
+            {
+                u32 cell = y * SDF_GRID_WIDTH + x;
+                g_collision_snapshot.grid_shapes[offsets[cell]] = i;
+                offsets[cell] += 1;
+            }
+        }
+    }
+    for (u32 i = SDF_GRID_CELLS_COUNT; i > 0; --i)
+    {
+        offsets[i] = offsets[i - 1];
+    }
+    offsets[0] = 0;
+}
+
+void sdf_collision_snapshot_build(f32 growth_factor, f32 time)
+{
+    f64 start = profile_time_ms();
+
+    /* Every level primitive gets a shape at most, so the build never runs out of room. */
+    sdf_collision_snapshot_reserve(math_max(g_entity_store.capacity, g_resident_level_primitives_count));
+
+    u32 primitives_count = 0;
+    u32 shapes_count = 0;
+    sdf_collision_shape* shapes = g_collision_snapshot.build_shapes;
+    fvec3 growth_weights = growth_factor_to_weights(growth_factor);
+    for (u32 i = 0; i < g_resident_level_primitives_count; ++i)
+    {
+        sdf_primitive* primitive = &g_resident_level_primitives[i];
+        primitives_count += 1;
+
+        f32 growth_size1 = fvec3_dot(growth_weights, primitive->growth_sizes1);
+        f32 growth_size2 = fvec3_dot(growth_weights, primitive->growth_sizes2);
+
+        /* Disable collision for 0 sized objects. */
+        if (growth_size1 <= 0.0f) {
+            continue;
+        }
+
+        sdf_collision_shape shape;
+        memzero(&shape, sizeof(shape));
+        shape.type = primitive->type;
+        shape.primitive = i;
+        shape.entity = primitive->entity;
+        shape.position = primitive->position;
+        shape.half_size = { growth_size1, growth_size1 };
+        switch (primitive->type)
+        {
+            case SDF_PRIMITIVE_CIRCLE:
+            {
+                shape.bounds_radius = growth_size1;
+            } break;
+            case SDF_PRIMITIVE_SPIKED_CIRCLE:
+            {
+                shape.bounds_radius = growth_size1 * 1.05f;
+            } break;
+            case SDF_PRIMITIVE_PORTAL:
+            {
+                shape.bounds_radius = growth_size1 * 2.1f;
+            } break;
+            case SDF_PRIMITIVE_BOX:
+            {
+                /* Adjust size to account for effects. */
+                shape.half_size = { growth_size1 * 0.85f, growth_size2 * 0.85f };
+                shape.bounds_radius = fvec2_len(shape.half_size);
+            } break;
+            default:
+            {
+                /* No collision for this primitive type. */
+                continue;
+            }
+        }
+
+        fvec2 extent = { shape.bounds_radius, shape.bounds_radius };
+        if (shape.type == SDF_PRIMITIVE_BOX)
+        {
+            extent = fvec2_abs(shape.half_size);
+        }
+        shape.bounds_min = fvec2_sub(shape.position, extent);
+        shape.bounds_max = fvec2_add(shape.position, extent);
+
+        shapes[shapes_count] = shape;
+        shapes_count += 1;
+    }
+
+    /* Only bump the version if something actually changed so cached queries survive static scenes. */
+    g_collision_snapshot.primitives_count = primitives_count;
+    g_collision_snapshot.time = time;
+    if (shapes_count != g_collision_snapshot.shapes_count || 
+        memcmp(shapes, g_collision_snapshot.shapes, shapes_count * sizeof(sdf_collision_shape)) != 0 ||
+        memcmp(&g_world.resident_origin, &g_collision_snapshot.grid_origin, sizeof(fvec2)) != 0)
+    {
+        g_collision_snapshot.build_shapes = g_collision_snapshot.shapes;
+        g_collision_snapshot.shapes = shapes;
+        g_collision_snapshot.shapes_count = shapes_count;
+        g_collision_snapshot.grid_origin = g_world.resident_origin;
+        g_collision_snapshot.version += 1;
+        sdf_collision_grid_build();
+    }
+
+    g_collision_snapshot.builds += 1;
+    g_collision_snapshot.build_time_ms += profile_time_ms() - start;
+}
+
+sdf_result sdf_result_init()
+{
+    sdf_result result;
+    result.distance = SDF_RESULT_DISTANCE_INVALID;
+    result.closest_object = SDF_RESULT_OBJECT_INVALID;
+    result.overlapped_distance = SDF_RESULT_DISTANCE_INVALID;
+    result.overlapped_object = SDF_RESULT_OBJECT_INVALID;
+    return result;
+}
+
+/* Distance from i_position to a collision shape of the given type.
+ * Spiked circles and portals use the exact shapes the player sees, boxes stay shrunk to account for the wobble. 
+ * Maggots are not collision shapes, the crowd tests them against the player itself. */
+f32 sdf_collision_shape_evaluate(u32 i_type, fvec2 i_shape_position, fvec2 i_half_size, fvec2 i_position, f32 i_time)
+{
+    switch (i_type)
+    {
+        case SDF_PRIMITIVE_CIRCLE:
+        {
+            return sdf_circle(i_position, i_shape_position, i_half_size.x);
+        }
+        case SDF_PRIMITIVE_SPIKED_CIRCLE:
+        {
+            return sdf_spiked_circle(i_position, i_shape_position, i_half_size.x, i_time);
+        }
+        case SDF_PRIMITIVE_PORTAL:
+        {
+            return sdf_portal(i_position, i_shape_position, i_half_size.x, i_time);
+        }
+        case SDF_PRIMITIVE_BOX:
+        {
+            return sdf_box(i_position, i_shape_position, i_half_size);
+        }
+    }
+    return SDF_RESULT_DISTANCE_INVALID;
+}
+
+/* Result objects are indices into g_collision_snapshot.shapes. */
+void sdf_result_add_shape(sdf_result* io_result, u32 i_index, fvec2 i_position)
+{
+    float prev_distance = io_result->distance;
+    float prev_overlapped_distance = io_result->overlapped_distance;
+
+    /* Calculate the distance to this sdf shape. */
+    sdf_collision_shape* shape = &g_collision_snapshot.shapes[i_index];
+    f32 distance = sdf_collision_shape_evaluate(shape->type, shape->position, shape->half_size, i_position, g_collision_snapshot.time);
+    switch (shape->type)
+    {
+        case SDF_PRIMITIVE_CIRCLE: 
+        case SDF_PRIMITIVE_SPIKED_CIRCLE: 
+        {
+            /* Use a smooth min to help with collision resolution. */
+            io_result->distance = f32_min_smooth(io_result->distance, distance, 10.0f);
+        } break;
+        case SDF_PRIMITIVE_BOX: 
+        {
+            io_result->distance = math_min(io_result->distance, distance);
+        } break;
+        case SDF_PRIMITIVE_PORTAL:
+        {
+            io_result->overlapped_distance = math_min(io_result->overlapped_distance, distance);
+        } break;
+    }
+
+    /* Track the closest object for hit detection. */
+    if (prev_distance > io_result->distance) {
+        io_result->closest_object = i_index;
+    }
+    if (prev_overlapped_distance > io_result->overlapped_distance) {
+        io_result->overlapped_object = i_index;
+    }
+}
+
+sdf_result sdf_get_distance(fvec2 i_position)
+{
+    sdf_result result = sdf_result_init();
+    for (u32 i = 0; i < g_collision_snapshot.shapes_count; ++i)
+    {
+        sdf_result_add_shape(&result, i, i_position);
+    }
+
+    result.distance -= g_player.radius;
+    result.overlapped_distance -= g_player.radius;
+    return result;
+}
+
+fvec2 sdf_get_surface_normal(fvec2 i_position)
+{
+    f32 epsilon = 10.0f; /* Rather large sample distance to get around the non continuous sdf interior. */
+    f32 x1 = sdf_get_distance({ i_position.x + epsilon, i_position.y }).distance; 
+    f32 x2 = sdf_get_distance({ i_position.x - epsilon, i_position.y }).distance;
+    f32 y1 = sdf_get_distance({ i_position.x, i_position.y + epsilon }).distance;
+    f32 y2 = sdf_get_distance({ i_position.x, i_position.y - epsilon }).distance;
+
+    f32 x_gradient = x1 - x2;
+    f32 y_gradient = y1 - y2;
+    return fvec2_norm({ x_gradient, y_gradient }); 
+}
+
+/* Temporal coherence cache for repeated queries by the same querier, e.g. the player.
+ * The player moves at most max_velocity * delta_time per frame, so the set of shapes that can 
+ * influence its queries hardly ever changes between frames. On a rebuild we gather every shape 
+ * whose bounds lie within a conservative radius of the query and only test those until the querier 
+ * leaves the safe region or the collision snapshot changes.
+ *
+ * Results are exact for distances up to SDF_QUERY_CACHE_REACH. Shapes further away than that are 
+ * not tested, which is fine as gameplay only cares about (near) contacts. */
+#define SDF_QUERY_CACHE_SAFE_RADIUS 64.0f  /* How far a query may be from the rebuild position. */
+#define SDF_QUERY_CACHE_REACH 64.0f        /* Well beyond the contact threshold and normal sample distance. */
+#define SDF_QUERY_CACHE_CANDIDATES_COUNT_MAX 1024 /* Past this many nearby shapes queries test every shape instead. */
+
+typedef struct {
+    fvec2 position;
+    f32 radius;
+    u32 snapshot_version;
+    b8 is_valid;
+    u32 candidates[SDF_QUERY_CACHE_CANDIDATES_COUNT_MAX];
+    u32 candidates_count;
+
+    /* Statistics. */
+    u64 queries;
+    u64 hits;
+    u64 shapes_tested;
+    u64 shapes_skipped;
+} sdf_query_cache;
+
+void sdf_query_cache_rebuild(sdf_query_cache* io_cache, fvec2 i_position)
+{
+    io_cache->position = i_position;
+    io_cache->radius = g_player.radius;
+    io_cache->snapshot_version = g_collision_snapshot.version;
+    io_cache->candidates_count = 0;
+    io_cache->is_valid = TRUE;
+
+    /* Pad by twice the smooth min range so blending matches the uncached query exactly. */
+    f32 reach = SDF_QUERY_CACHE_SAFE_RADIUS + SDF_QUERY_CACHE_REACH + io_cache->radius + 20.0f;
+    for (u32 i = 0; i < g_collision_snapshot.shapes_count; ++i)
+    {
+        sdf_collision_shape* shape = &g_collision_snapshot.shapes[i];
+        f32 bounds_distance = fvec2_len(fvec2_sub(shape->position, i_position)) - shape->bounds_radius;
+        if (bounds_distance <= reach)
+        {
+            if (io_cache->candidates_count == SDF_QUERY_CACHE_CANDIDATES_COUNT_MAX)
+            {
+                io_cache->candidates_count = 0;
+                io_cache->is_valid = FALSE;
+                return;
+            }
+            io_cache->candidates[io_cache->candidates_count] = i;
+            io_cache->candidates_count += 1;
+        }
+    }
+}
+
+sdf_result sdf_get_distance_cached(sdf_query_cache* io_cache, fvec2 i_position)
+{
+    io_cache->queries += 1;
+    if (io_cache->is_valid && 
+        io_cache->snapshot_version == g_collision_snapshot.version &&
+        io_cache->radius == g_player.radius &&
+        fvec2_len(fvec2_sub(i_position, io_cache->position)) <= SDF_QUERY_CACHE_SAFE_RADIUS)
+    {
+        io_cache->hits += 1;
+    }
+    else
+    {
+        sdf_query_cache_rebuild(io_cache, i_position);
+        if (!io_cache->is_valid)
+        {
+            io_cache->shapes_tested += g_collision_snapshot.shapes_count;
+            return sdf_get_distance(i_position);
+        }
+    }
+    io_cache->shapes_tested += io_cache->candidates_count;
+    io_cache->shapes_skipped += g_collision_snapshot.shapes_count - io_cache->candidates_count;
+
+    /* Candidates are stored in snapshot order so smooth min blending matches the uncached query. */
+    sdf_result result = sdf_result_init();
+    for (u32 i = 0; i < io_cache->candidates_count; ++i)
+    {
+        sdf_result_add_shape(&result, io_cache->candidates[i], i_position);
+    }
+
+    result.distance -= g_player.radius;
+    result.overlapped_distance -= g_player.radius;
+    return result;
+}
+
+fvec2 sdf_get_surface_normal_cached(sdf_query_cache* io_cache, fvec2 i_position)
+{
+    f32 epsilon = 10.0f; /* Rather large sample distance to get around the non continuous sdf interior. */
+    f32 x1 = sdf_get_distance_cached(io_cache, { i_position.x + epsilon, i_position.y }).distance; 
+    f32 x2 = sdf_get_distance_cached(io_cache, { i_position.x - epsilon, i_position.y }).distance;
+    f32 y1 = sdf_get_distance_cached(io_cache, { i_position.x, i_position.y + epsilon }).distance;
+    f32 y2 = sdf_get_distance_cached(io_cache, { i_position.x, i_position.y - epsilon }).distance;
+
+    f32 x_gradient = x1 - x2;
+    f32 y_gradient = y1 - y2;
+    return fvec2_norm({ x_gradient, y_gradient }); 
+}
+
+void sdf_query_cache_print(sdf_query_cache* i_cache, char const* i_name)
+{
+    f64 hit_rate = i_cache->queries > 0 ? (f64)i_cache->hits / (f64)i_cache->queries * 100.0 : 0.0;
+    printf("%s: %llu queries, %.1f%% cache hits, %llu shapes tested, %llu skipped\n", 
+        i_name, 
+        (unsigned long long)i_cache->queries, 
+        hit_rate, 
+        (unsigned long long)i_cache->shapes_tested, 
+        (unsigned long long)i_cache->shapes_skipped);
+}
+
+void sdf_collision_snapshot_print()
+{
+    f64 build_time = g_collision_snapshot.builds > 0 ? g_collision_snapshot.build_time_ms / (f64)g_collision_snapshot.builds : 0.0;
+    printf("Collision snapshot: %u shapes from %u primitives, %u cell entries, %.4fms average build\n", 
+        g_collision_snapshot.shapes_count, 
+        g_collision_snapshot.primitives_count, 
+        g_collision_snapshot.grid_offsets[SDF_GRID_CELLS_COUNT], 
+        build_time);
+}
+
+/* Ray queries sphere tracing the solid shapes of the collision snapshot. 
+ * Distances are looked up through the grid, so open space is crossed a cell at a time. */
+#define SDF_RAYCAST_STEPS_MAX 64
+#define SDF_RAYCAST_EPSILON 0.5f
+#define SDF_RAYCAST_MASK_SOLID ((1u << SDF_PRIMITIVE_CIRCLE) | (1u << SDF_PRIMITIVE_SPIKED_CIRCLE) | (1u << SDF_PRIMITIVE_BOX))
+#define SDF_RAYCAST_MASK_ALL 0xFFFFFFFF
+#define SDF_RAYCAST_ENTITY_NONE 0xFFFFFFFF
+
+typedef struct {
+    b8 hit;
+    f32 distance;
+    fvec2 point;
+    fvec2 normal;
+    u32 shape; /* Index into g_collision_snapshot.shapes or SDF_RESULT_OBJECT_INVALID. */
+} sdf_raycast_result;
+
+typedef struct {
+    u64 rays;
+    u64 steps;
+    f64 time_ms;
+} sdf_raycast_stats;
+sdf_raycast_stats g_raycast_stats;
+
+/* Rays use the circle and box proxies, they must be a lower bound on the distance for sphere tracing 
+ * which the noise displaced exact shapes are not. */
+f32 sdf_shape_distance(sdf_collision_shape* i_shape, fvec2 i_position)
+{
+    if (i_shape->type == SDF_PRIMITIVE_BOX)
+    {
+        return sdf_box(i_position, i_shape->position, i_shape->half_size);
+    }
+    return sdf_circle(i_position, i_shape->position, i_shape->half_size.x);
+}
+
+fvec2 sdf_shape_normal(sdf_collision_shape* i_shape, fvec2 i_position)
+{
+    fvec2 offset = fvec2_sub(i_position, i_shape->position);
+    if (i_shape->type == SDF_PRIMITIVE_BOX)
+    {
+        fvec2 sign = { offset.x < 0.0f ? -1.0f : 1.0f, offset.y < 0.0f ? -1.0f : 1.0f };
+        fvec2 d = fvec2_sub(fvec2_abs(offset), i_shape->half_size);
+        if (d.x > 0.0f || d.y > 0.0f)
+        {
+            fvec2 outside = { math_max(d.x, 0.0f) * sign.x, math_max(d.y, 0.0f) * sign.y };
+            return fvec2_norm(outside);
+        }
+        return d.x > d.y ? fvec2{ sign.x, 0.0f } : fvec2{ 0.0f, sign.y };
+    }
+    if (fvec2_dot(offset, offset) == 0.0f)
+    {
+        return { 0.0f, -1.0f };
+    }
+    return fvec2_norm(offset);
+}
+
+/* Returns the distance to the closest shape matching the mask, or at most SDF_GRID_REACH. 
+ * The result is never larger than the true distance, which is all sphere tracing needs. */
+f32 sdf_get_distance_bounded(fvec2 i_position, u32 i_mask, u32 i_ignore_entity, u32* o_shape)
+{
+    u32 first = 0;
+    u32 last = g_collision_snapshot.shapes_count;
+    u32* indices = NULL;
+    u32 cell = sdf_collision_grid_cell(&g_collision_snapshot, i_position);
+    if (cell != SDF_GRID_CELL_INVALID)
+    {
+        first = g_collision_snapshot.grid_offsets[cell];
+        last = g_collision_snapshot.grid_offsets[cell + 1];
+        indices = g_collision_snapshot.grid_shapes;
+    }
+
+    /* Outside the grid we simply test every shape. */
+    f32 result = SDF_GRID_REACH;
+    *o_shape = SDF_RESULT_OBJECT_INVALID;
+    for (u32 i = first; i < last; ++i)
+    {
+        u32 index = indices ? indices[i] : i;
+        sdf_collision_shape* shape = &g_collision_snapshot.shapes[index];
+        if ((i_mask & (1u << shape->type)) == 0 || shape->entity == i_ignore_entity)
+        {
+            continue;
+        }
+
+        f32 distance = sdf_shape_distance(shape, i_position);
+        if (distance < result)
+        {
+            result = distance;
+            *o_shape = index;
+        }
+    }
+    return result;
+}
+
+sdf_raycast_result sdf_raycast_masked(fvec2 i_origin, fvec2 i_direction, f32 i_max_distance, u32 i_mask, u32 i_ignore_entity)
+{
+    sdf_raycast_result result;
+    memzero(&result, sizeof(result));
+    result.shape = SDF_RESULT_OBJECT_INVALID;
+    result.distance = i_max_distance;
+
+    f32 t = 0.0f;
+    u32 steps = 0;
+    for (; steps < SDF_RAYCAST_STEPS_MAX && t <= i_max_distance; ++steps)
+    {
+        fvec2 position = fvec2_add(i_origin, fvec2_mul_s(i_direction, t));
+        u32 shape = SDF_RESULT_OBJECT_INVALID;
+        f32 distance = sdf_get_distance_bounded(position, i_mask, i_ignore_entity, &shape);
+        if (distance < SDF_RAYCAST_EPSILON)
+        {
+            result.hit = TRUE;
+            result.distance = t;
+            result.point = position;
+            result.normal = sdf_shape_normal(&g_collision_snapshot.shapes[shape], position);
+            result.shape = shape;
+            break;
+        }
+        t += distance;
+    }
+
+    g_raycast_stats.rays += 1;
+    g_raycast_stats.steps += steps;
+    return result;
+}
+
+/* i_direction must be normalized. */
+sdf_raycast_result sdf_raycast(fvec2 i_origin, fvec2 i_direction, f32 i_max_distance)
+{
+    return sdf_raycast_masked(i_origin, i_direction, i_max_distance, SDF_RAYCAST_MASK_SOLID, SDF_RAYCAST_ENTITY_NONE);
+}
+
+b8 sdf_segment_occluded(fvec2 i_from, fvec2 i_to, u32 i_ignore_entity)
+{
+    fvec2 offset = fvec2_sub(i_to, i_from);
+    f32 length = fvec2_len(offset);
+    if (length <= 0.0f)
+    {
+        return FALSE;
+    }
+    return sdf_raycast_masked(i_from, fvec2_mul_s(offset, 1.0f / length), length, SDF_RAYCAST_MASK_SOLID, i_ignore_entity).hit;
+}
+
+void sdf_raycast_batch(fvec2* i_origins, fvec2* i_directions, f32* i_max_distances, sz i_count, u32 i_mask, sdf_raycast_result* o_results)
+{
+    f64 start = profile_time_ms();
+    for (sz i = 0; i < i_count; ++i)
+    {
+        o_results[i] = sdf_raycast_masked(i_origins[i], i_directions[i], i_max_distances[i], i_mask, SDF_RAYCAST_ENTITY_NONE);
+    }
+    g_raycast_stats.time_ms += profile_time_ms() - start;
+}
+
+void sdf_raycast_stats_print()
+{
+    f64 steps = g_raycast_stats.rays > 0 ? (f64)g_raycast_stats.steps / (f64)g_raycast_stats.rays : 0.0;
+    printf("Raycasts: %llu rays, %.1f steps per ray\n", (unsigned long long)g_raycast_stats.rays, steps);
+}
+
+/* --------------------------------------------------
+   Navigation 
+   -------------------------------------------------- */
+
+/* Flow field navigation for enemies chasing the player.
+ * Walkable space is rasterised from the collision snapshot at the current growth state, after which a 
+ * breadth first search from the target gives every cell the direction of its shortest path. Any number 
+ * of agents can then steer with a single lookup each, no matter how many there are.
+ * Only cells near shapes that changed are rasterised again, and the search only reruns when walkable 
+ * space or the target cell changes. The grid covers the resident chunks that exist, so a single chunk level
+ * only searches its own cells, NAV_WIDTH by NAV_HEIGHT is the most it covers. */
+#define NAV_CELL_SIZE 16.0f
+#define NAV_WIDTH ((WORLD_RESIDENT_WIDTH + 15) / 16)
+#define NAV_HEIGHT ((WORLD_RESIDENT_HEIGHT + 15) / 16)
+#define NAV_CELLS_COUNT (NAV_WIDTH * NAV_HEIGHT)
+#define NAV_CLEARANCE 12.0f    /* Space agents keep from walls. */
+#define NAV_CHASE_SPEED 80.0f
+#define NAV_MASK_WALLS ((1u << SDF_PRIMITIVE_CIRCLE) | (1u << SDF_PRIMITIVE_BOX))
+#define NAV_DISTANCE_UNREACHABLE 0xFFFF
+#define NAV_CELL_INVALID 0xFFFFFFFF
+
+typedef struct {
+    /* Walkable space and the shapes it was rasterised from. */
+    b8 walkable[NAV_CELLS_COUNT];
+    sdf_collision_shape* shapes;
+    u32 shapes_count;
+    u32 shapes_capacity;
+    fvec2 origin;
+    u32 width;  /* Cells in use, rows are width cells apart. */
+    u32 height;
+    u32 snapshot_version;
+    b8 is_rasterised;
+    b8 is_dirty;
+
+    /* Flow field, distances are in cells to the nearest source. */
+    u16 distances[NAV_CELLS_COUNT];
+    fvec2 directions[NAV_CELLS_COUNT];
+    u32 frontiers[2][NAV_CELLS_COUNT];
+    u32 target_cell;
+    fvec2 target;
+
+    b8 chase_player; /* Let T-cells chase the player, off by default as the levels are not designed for it. */
+
+    /* Statistics. */
+    u64 cells_rasterised;
+    u64 flow_builds;
+    f64 rasterise_time_ms;
+    f64 flow_time_ms;
+} nav_grid;
+nav_grid g_nav;
+
+u32 nav_cell(fvec2 i_position)
+{
+    fvec2 position = fvec2_sub(i_position, g_nav.origin);
+    if (position.x < 0.0f || position.y < 0.0f || position.x >= (f32)g_nav.width * NAV_CELL_SIZE || position.y >= (f32)g_nav.height * NAV_CELL_SIZE)
+    {
+        return NAV_CELL_INVALID;
+    }
+    return (u32)(position.y / NAV_CELL_SIZE) * g_nav.width + (u32)(position.x / NAV_CELL_SIZE);
+}
+
+/* The part of the resident chunks that lies within the world, clamped to the grid capacity. */
+void nav_bounds(fvec2* o_origin, u32* o_width, u32* o_height)
+{
+    fvec2 resident_max = fvec2_add(g_collision_snapshot.grid_origin, fvec2{ (f32)WORLD_RESIDENT_WIDTH, (f32)WORLD_RESIDENT_HEIGHT });
+    fvec2 min = { math_max(g_collision_snapshot.grid_origin.x, 0.0f), math_max(g_collision_snapshot.grid_origin.y, 0.0f) };
+    fvec2 max = { math_min(resident_max.x, g_world.size.x), math_min(resident_max.y, g_world.size.y) };
+    *o_origin = min;
+    *o_width = (u32)math_clamp((max.x - min.x + NAV_CELL_SIZE - 1.0f) / NAV_CELL_SIZE, 1.0f, (f32)NAV_WIDTH);
+    *o_height = (u32)math_clamp((max.y - min.y + NAV_CELL_SIZE - 1.0f) / NAV_CELL_SIZE, 1.0f, (f32)NAV_HEIGHT);
+}
+
+void nav_rasterise(u32 i_min_x, u32 i_min_y, u32 i_max_x, u32 i_max_y)
+{
+    for (u32 y = i_min_y; y <= i_max_y; ++y)
+    {
+        for (u32 x = i_min_x; x <= i_max_x; ++x)
+        {
+            fvec2 center = { g_nav.origin.x + ((f32)x + 0.5f) * NAV_CELL_SIZE, g_nav.origin.y + ((f32)y + 0.5f) * NAV_CELL_SIZE };
+            u32 shape;
+            f32 distance = sdf_get_distance_bounded(center, NAV_MASK_WALLS, SDF_RAYCAST_ENTITY_NONE, &shape);
+            g_nav.walkable[y * g_nav.width + x] = distance > NAV_CLEARANCE ? TRUE : FALSE;
+        }
+    }
+    g_nav.cells_rasterised += (u64)((i_max_x - i_min_x + 1) * (i_max_y - i_min_y + 1));
+}
+
+/* Rasterises the cells around every wall that differs between the rasterised and current snapshot.
+ * Falls back to the whole grid when shapes were added or removed, as indices no longer line up, 
+ * or when other chunks became resident or the world changed size. */
+void nav_rasterise_changes()
+{
+    if (g_nav.is_rasterised && g_nav.snapshot_version == g_collision_snapshot.version)
+    {
+        return;
+    }
+
+    f64 start = profile_time_ms();
+    fvec2 origin;
+    u32 width;
+    u32 height;
+    nav_bounds(&origin, &width, &height);
+    fvec2 nav_size = { (f32)width * NAV_CELL_SIZE, (f32)height * NAV_CELL_SIZE };
+    fvec2 dirty_min = fvec2_add(origin, nav_size);
+    fvec2 dirty_max = origin;
+    if (!g_nav.is_rasterised || g_nav.shapes_count != g_collision_snapshot.shapes_count ||
+        memcmp(&g_nav.origin, &origin, sizeof(fvec2)) != 0 || g_nav.width != width || g_nav.height != height)
+    {
+        g_nav.origin = origin;
+        g_nav.width = width;
+        g_nav.height = height;
+        dirty_min = g_nav.origin;
+        dirty_max = fvec2_add(g_nav.origin, nav_size);
+    }
+    else
+    {
+        for (u32 i = 0; i < g_collision_snapshot.shapes_count; ++i)
+        {
+            sdf_collision_shape* old_shape = &g_nav.shapes[i];
+            sdf_collision_shape* new_shape = &g_collision_snapshot.shapes[i];
+            b8 is_wall = (NAV_MASK_WALLS & ((1u << old_shape->type) | (1u << new_shape->type))) != 0 ? TRUE : FALSE;
+            if (!is_wall || memcmp(old_shape, new_shape, sizeof(sdf_collision_shape)) == 0)
+            {
+                continue;
+            }
+            dirty_min.x = math_min(dirty_min.x, math_min(old_shape->bounds_min.x, new_shape->bounds_min.x));
+            dirty_min.y = math_min(dirty_min.y, math_min(old_shape->bounds_min.y, new_shape->bounds_min.y));
+            dirty_max.x = math_max(dirty_max.x, math_max(old_shape->bounds_max.x, new_shape->bounds_max.x));
+            dirty_max.y = math_max(dirty_max.y, math_max(old_shape->bounds_max.y, new_shape->bounds_max.y));
+        }
+    }
+
+    /* Any cell within clearance of a changed shape may have changed. */
+    if (dirty_min.x <= dirty_max.x && dirty_min.y <= dirty_max.y)
+    {
+        f32 reach = NAV_CLEARANCE + NAV_CELL_SIZE;
+        dirty_min = fvec2_sub(dirty_min, g_nav.origin);
+        dirty_max = fvec2_sub(dirty_max, g_nav.origin);
+        u32 min_x = (u32)math_clamp((dirty_min.x - reach) / NAV_CELL_SIZE, 0.0f, (f32)(g_nav.width - 1));
+        u32 min_y = (u32)math_clamp((dirty_min.y - reach) / NAV_CELL_SIZE, 0.0f, (f32)(g_nav.height - 1));
+        u32 max_x = (u32)math_clamp((dirty_max.x + reach) / NAV_CELL_SIZE, 0.0f, (f32)(g_nav.width - 1));
+        u32 max_y = (u32)math_clamp((dirty_max.y + reach) / NAV_CELL_SIZE, 0.0f, (f32)(g_nav.height - 1));
+        nav_rasterise(min_x, min_y, max_x, max_y);
+        g_nav.is_dirty = TRUE;
+    }
+
+    if (g_collision_snapshot.shapes_count > g_nav.shapes_capacity)
+    {
+        g_nav.shapes_capacity = g_collision_snapshot.shapes_capacity;
+        g_nav.shapes = realloc_arr(sdf_collision_shape, g_nav.shapes, g_nav.shapes_capacity);
+        assert(g_nav.shapes != NULL);
+    }
+    memcpy(g_nav.shapes, g_collision_snapshot.shapes, g_collision_snapshot.shapes_count * sizeof(sdf_collision_shape));
+    g_nav.shapes_count = g_collision_snapshot.shapes_count;
+    g_nav.snapshot_version = g_collision_snapshot.version;
+    g_nav.is_rasterised = TRUE;
+    g_nav.rasterise_time_ms += profile_time_ms() - start;
+}
+
+/* Multi source breadth first search, one frontier at a time. Every cell of a frontier only writes its own
+ * unvisited neighbours, so a frontier could be split over threads. A single chunk level is 5.7k cells and
+ * builds in about 0.2ms, the full resident area of a large world is 50.7k cells and about 2ms, spread over
+ * some 230 frontiers. That leaves around 10us of work per frontier, no more than waking threads for it
+ * costs, so the search stays on one thread. */
+void nav_flow_build(u32 const* i_sources, u32 i_sources_count)
+{
+    f64 start = profile_time_ms();
+    u32 width = g_nav.width;
+    u32 height = g_nav.height;
+    u32 cells_count = width * height;
+    for (u32 i = 0; i < cells_count; ++i)
+    {
+        g_nav.distances[i] = NAV_DISTANCE_UNREACHABLE;
+    }
+
+    u32 frontier = 0;
+    u32 frontier_count = 0;
+    for (u32 i = 0; i < i_sources_count; ++i)
+    {
+        g_nav.distances[i_sources[i]] = 0;
+        g_nav.frontiers[frontier][frontier_count] = i_sources[i];
+        frontier_count += 1;
+    }
+
+    for (u16 distance = 1; frontier_count > 0; ++distance)
+    {
+        u32 next_count = 0;
+        for (u32 i = 0; i < frontier_count; ++i)
+        {
+            u32 cell = g_nav.frontiers[frontier][i];
+            u32 x = cell % width;
+            u32 y = cell / width;
+            u32 neighbours[4] = {
+                x > 0 ? cell - 1 : NAV_CELL_INVALID,
+                x + 1 < width ? cell + 1 : NAV_CELL_INVALID,
+                y > 0 ? cell - width : NAV_CELL_INVALID,
+                y + 1 < height ? cell + width : NAV_CELL_INVALID,
+            };
+            for (u32 j = 0; j < 4; ++j)
+            {
+                u32 neighbour = neighbours[j];
+                if (neighbour != NAV_CELL_INVALID && g_nav.walkable[neighbour] && g_nav.distances[neighbour] == NAV_DISTANCE_UNREACHABLE)
+                {
+                    g_nav.distances[neighbour] = distance;
+                    g_nav.frontiers[1 - frontier][next_count] = neighbour;
+                    next_count += 1;
+                }
+            }
+        }
+        frontier = 1 - frontier;
+        frontier_count = next_count;
+    }
+
+    /* Point every cell at its closest neighbour, diagonals only when both sides are reachable to not cut corners. */
+    for (u32 cell = 0; cell < cells_count; ++cell)
+    {
+        g_nav.directions[cell] = { 0.0f, 0.0f };
+        u16 best = g_nav.distances[cell];
+        if (best == NAV_DISTANCE_UNREACHABLE || best == 0)
+        {
+            continue;
+        }
+
+        i32 x = (i32)(cell % width);
+        i32 y = (i32)(cell / width);
+        for (i32 dy = -1; dy <= 1; ++dy)
+        {
+            for (i32 dx = -1; dx <= 1; ++dx)
+            {
+                i32 nx = x + dx;
+                i32 ny = y + dy;
+                if ((dx == 0 && dy == 0) || nx < 0 || ny < 0 || nx >= (i32)width || ny >= (i32)height)
+                {
+                    continue;
+                }
+                if (dx != 0 && dy != 0 && 
+                    (g_nav.distances[y * (i32)width + nx] == NAV_DISTANCE_UNREACHABLE || g_nav.distances[ny * (i32)width + x] == NAV_DISTANCE_UNREACHABLE))
+                {
+                    continue;
+                }
+
+                u16 distance = g_nav.distances[ny * (i32)width + nx];
+                if (distance < best)
+                {
+                    best = distance;
+                    g_nav.directions[cell] = fvec2_norm({ (f32)dx, (f32)dy });
+                }
+            }
+        }
+    }
+
+    g_nav.flow_builds += 1;
+    g_nav.flow_time_ms += profile_time_ms() - start;
+}
+
+/* Call once per frame after the collision snapshot was built. */
+void nav_update(fvec2 i_target)
+{
+    nav_rasterise_changes();
+
+    fvec2 nav_max = { g_nav.origin.x + (f32)g_nav.width * NAV_CELL_SIZE - 1.0f, g_nav.origin.y + (f32)g_nav.height * NAV_CELL_SIZE - 1.0f };
+    u32 target_cell = nav_cell(fvec2{ math_clamp(i_target.x, g_nav.origin.x, nav_max.x), math_clamp(i_target.y, g_nav.origin.y, nav_max.y) });
+    if (g_nav.is_dirty || target_cell != g_nav.target_cell)
+    {
+        nav_flow_build(&target_cell, 1);
+        g_nav.target_cell = target_cell;
+        g_nav.is_dirty = FALSE;
+    }
+    g_nav.target = i_target;
+}
+
+/* Direction an agent at i_position should move in, zero if the target can not be reached from there. */
+fvec2 nav_flow_direction(fvec2 i_position)
+{
+    u32 cell = nav_cell(i_position);
+    if (cell == NAV_CELL_INVALID)
+    {
+        return { 0.0f, 0.0f };
+    }
+    if (cell == g_nav.target_cell)
+    {
+        fvec2 offset = fvec2_sub(g_nav.target, i_position);
+        return fvec2_dot(offset, offset) > 0.0f ? fvec2_norm(offset) : fvec2{ 0.0f, 0.0f };
+    }
+    return g_nav.directions[cell];
+}
+
+void nav_print()
+{
+    printf("Navigation: %llu cells rasterised in %.3fms, %llu flow builds in %.3fms\n", 
+        (unsigned long long)g_nav.cells_rasterised, g_nav.rasterise_time_ms, (unsigned long long)g_nav.flow_builds, g_nav.flow_time_ms);
+}
+
+/* --------------------------------------------------
+   Player 
+   -------------------------------------------------- */
+
+/* Moves the player along io_velocity against the distance field, gliding along surfaces, pushing out of 
+ * anything it still overlaps and staying within the world. Returns the collision at the position the velocity 
+ * moved the player to, which tells what the player touched this frame. */
+sdf_result player_move(sdf_query_cache* io_cache, fvec2* io_velocity, f32 i_delta_time, f32 i_push_strength)
+{
+    fvec2 velocity = *io_velocity;
+    fvec2 new_position = fvec2_add(g_player.position, fvec2_mul_s(velocity, i_delta_time));
+
+    /* Collision against distance field. */
+    sdf_result collision_result = sdf_get_distance_cached(io_cache, new_position);
+    g_player.debug = sdf_get_surface_normal_cached(io_cache, new_position);
+    if (collision_result.distance < 0.1f)
+    {
+        /* Reflect  velocity along surface normal to allow gliding against objects. */
+        fvec2 normal = sdf_get_surface_normal_cached(io_cache, new_position);
+        f32 along_normal = fvec2_dot(velocity, normal);
+        if (along_normal < 0.0f)
+        {
+            velocity = fvec2_sub(velocity, fvec2_mul_s(normal, along_normal));
+        }
+
+        new_position = g_player.position;
+        new_position = fvec2_add(new_position, fvec2_mul_s(velocity, i_delta_time));
+    }
+
+    /* Iteratively check if our resolved position is still inside an object in the distance field. 
+     * If so, slowly push the player out along the surface normal. */
+    for (u32 i = 0; i < 4; ++i) 
+    {
+        sdf_result new_position_collision = sdf_get_distance_cached(io_cache, new_position);
+        if (new_position_collision.distance < 0.1f)
+        {
+            fvec2 normal = sdf_get_surface_normal_cached(io_cache, new_position);
+            new_position = fvec2_add(new_position, fvec2_mul_s(normal, i_push_strength *  i_delta_time * -new_position_collision.distance));
+            /* TODO: This is most certainly npt correctly time adjusted... Too bad! */
+        }
+    }
+
+    /* Collision against level bounds. */
+    new_position.x = math_clamp(new_position.x, 0.0f, g_world.size.x);
+    new_position.y = math_clamp(new_position.y, 0.0f, g_world.size.y);
+
+    g_player.position = new_position;
+    *io_velocity = velocity;
+    return collision_result;
+}
+
+/* --------------------------------------------------
+   HUD 
+   -------------------------------------------------- */
+
+/* The death and maggot counters of player_hud, retained in a small image that is only baked again when the
+ * counters change. The six icons and digits sit in two rows over the pixels below, the shader keeps the wobbly
+ * circles behind them, which move with time, and takes the icons from the image with a single fetch. */
+#define HUD_IMAGE_X 4
+#define HUD_IMAGE_Y 4
+#define HUD_IMAGE_WIDTH 96
+#define HUD_IMAGE_HEIGHT 60
+#define HUD_ICON_SIZE 16.0f
+#define HUD_ICON_SPRITE_SIZE 64.0f
+
+typedef struct {
+    fvec4 colors[HUD_IMAGE_WIDTH * HUD_IMAGE_HEIGHT]; /* The color player_hud blends, white outside the icons. */
+    u32 texels[HUD_IMAGE_WIDTH * HUD_IMAGE_HEIGHT]; /* colors as R8G8B8A8, for the GPU. */
+    b8 is_inside[HUD_IMAGE_WIDTH * HUD_IMAGE_HEIGHT]; /* Within an icon, where the HUD distance is 0. */
+    u32 deaths;
+    u32 maggots;
+    u32 bakes;
+    b8 is_baked;
+} hud_image;
+hud_image g_hud_image;
+
+/* Bilinear and wrapping like the GPU samplers, i_uv is normalised. Like D3D, coordinates that are not finite are 0,
+ * the uv of a zero sized box is. */
+fvec4 texture_sample(u32 const* i_texels, u32 i_width, u32 i_height, fvec2 i_uv)
+{
+    f32 u = (i_uv.x - i_uv.x == 0.0f ? i_uv.x : 0.0f) * (f32)i_width - 0.5f;
+    f32 v = (i_uv.y - i_uv.y == 0.0f ? i_uv.y : 0.0f) * (f32)i_height - 0.5f;
+    f32 u_floor = f32_floor(u);
+    f32 v_floor = f32_floor(v);
+    f32 u_fraction = u - u_floor;
+    f32 v_fraction = v - v_floor;
+
+    u32 x0 = (u32)sdf_mod(u_floor, (f32)i_width);
+    u32 y0 = (u32)sdf_mod(v_floor, (f32)i_height);
+    u32 x1 = x0 + 1 < i_width ? x0 + 1 : 0;
+    u32 y1 = y0 + 1 < i_height ? y0 + 1 : 0;
+    u32 texel00 = i_texels[y0 * i_width + x0];
+    u32 texel10 = i_texels[y0 * i_width + x1];
+    u32 texel01 = i_texels[y1 * i_width + x0];
+    u32 texel11 = i_texels[y1 * i_width + x1];
+
+    fvec4 result;
+    for (u32 channel = 0; channel < 4; ++channel)
+    {
+        u32 shift = channel * 8;
+        f32 top = f32_lerp((f32)((texel00 >> shift) & 0xFF), (f32)((texel10 >> shift) & 0xFF), u_fraction);
+        f32 bottom = f32_lerp((f32)((texel01 >> shift) & 0xFF), (f32)((texel11 >> shift) & 0xFF), u_fraction);
+        result.data[channel] = f32_lerp(top, bottom, v_fraction) / 255.0f;
+    }
+    return result;
+}
+
+/* One icon of player_hud blended over io_color at i_uv, returns whether i_uv is inside it. */
+b8 hud_icon_blend(fvec4* io_color, fvec2 i_uv, fvec2 i_position, fvec2 i_sprite_index, u32 const* i_spritesheet, u32 i_width, u32 i_height)
+{
+    fvec2 size = { HUD_ICON_SIZE, HUD_ICON_SIZE };
+    if (sdf_box(i_uv, i_position, size) > 0.0f)
+    {
+        return FALSE;
+    }
+
+    fvec2 top_left = fvec2_sub(i_position, size);
+    fvec2 box_uv = fvec2_mul_s(fvec2_div(fvec2_sub(i_uv, top_left), size), 0.5f);
+    fvec2 scale = { HUD_ICON_SPRITE_SIZE / (f32)i_width, HUD_ICON_SPRITE_SIZE / (f32)i_height };
+    box_uv = fvec2_add(fvec2_mul(box_uv, scale), fvec2_mul(scale, i_sprite_index));
+
+    /* The icon colors are inverted. */
+    fvec4 sprite = texture_sample(i_spritesheet, i_width, i_height, box_uv);
+    fvec4 color = { sprite.x, 1.0f - sprite.y, 1.0f - sprite.z, 1.0f - sprite.w };
+    for (u32 channel = 0; channel < 4; ++channel)
+    {
+        io_color->data[channel] = f32_lerp(io_color->data[channel], color.data[channel], color.x);
+    }
+    return TRUE;
+}
+
+/* Bakes the icons for the counters of g_player when they changed since the last bake, returns whether it did. Cost:
+ * six box tests and up to six bilinear samples of the spritesheet for each of the 5760 pixels. */
+b8 hud_image_update(u32 const* i_spritesheet, u32 i_width, u32 i_height)
+{
+    hud_image* image = &g_hud_image;
+    if (image->is_baked && image->deaths == g_player.deaths && image->maggots == g_player.maggots)
+    {
+        return FALSE;
+    }
+
+    /* Same positions and order as player_hud, the blends do not commute. */
+    fvec2 position = { 20.0f, 20.0f };
+    f32 deaths = (f32)g_player.deaths;
+    f32 maggots = (f32)g_player.maggots;
+    fvec2 positions[6] = {
+        fvec2_add(position, sdf_vec2(16.0f, 0.0f)), fvec2_add(position, sdf_vec2(64.0f, 0.0f)), fvec2_add(position, sdf_vec2(48.0f, 0.0f)),
+        fvec2_add(position, sdf_vec2(0.0f, 28.0f)), fvec2_add(position, sdf_vec2(48.0f, 28.0f)), fvec2_add(position, sdf_vec2(32.0f, 28.0f))
+    };
+    fvec2 sprite_indices[6] = {
+        { 19.0f, 1.0f }, { 18.0f, sdf_mod(deaths, 10.0f) }, { 18.0f, f32_floor(deaths / 10.0f) },
+        { 19.0f, 0.0f }, { 18.0f, sdf_mod(maggots, 10.0f) }, { 18.0f, f32_floor(maggots / 10.0f) }
+    };
+
+    for (u32 y = 0; y < HUD_IMAGE_HEIGHT; ++y)
+    {
+        for (u32 x = 0; x < HUD_IMAGE_WIDTH; ++x)
+        {
+            fvec2 uv = { (f32)(HUD_IMAGE_X + x) + 0.5f, (f32)(HUD_IMAGE_Y + y) + 0.5f };
+            fvec4 color = { 1.0f, 1.0f, 1.0f, 1.0f };
+            b8 is_inside = FALSE;
+            for (u32 i = 0; i < 6; ++i)
+            {
+                is_inside = hud_icon_blend(&color, uv, positions[i], sprite_indices[i], i_spritesheet, i_width, i_height) || is_inside ? TRUE : FALSE;
+            }
+
+            u32 texel = 0;
+            for (u32 channel = 0; channel < 4; ++channel)
+            {
+                texel |= (u32)(math_clamp(color.data[channel], 0.0f, 1.0f) * 255.0f + 0.5f) << (channel * 8);
+            }
+            image->colors[y * HUD_IMAGE_WIDTH + x] = color;
+            image->texels[y * HUD_IMAGE_WIDTH + x] = texel;
+            image->is_inside[y * HUD_IMAGE_WIDTH + x] = is_inside;
+        }
+    }
+
+    image->deaths = g_player.deaths;
+    image->maggots = g_player.maggots;
+    image->bakes += 1;
+    image->is_baked = TRUE;
+    return TRUE;
+}
+
+/* --------------------------------------------------
+   Particles 
+   -------------------------------------------------- */
+
+/* Particle bursts are simulated on the CPU, every burst owns a range of the particle arrays. Each frame the 
+ * live ranges are integrated from one set of arrays into the end of the other, which also closes the holes 
+ * finished bursts leave behind. Current positions and radii go into g_particles_packed, the fragment shader 
+ * only looks up the range of a burst in there. */
+#define PARTICLES_COUNT_MAX 0xFFFF    /* The range of a burst goes to the GPU as two 16 bit values. */
+#define PARTICLES_BURST_COUNT 32      /* Particles in a burst that was not given any with particles_emit. */
+#define PARTICLES_BURST_DURATION 0.5f /* entity_grow takes the burst from 0 to 1 in half a second. */
+
+typedef struct {
+    /* Relative to the position of the burst. */
+    f32 position_x[PARTICLES_COUNT_MAX];
+    f32 position_y[PARTICLES_COUNT_MAX];
+    f32 velocity_x[PARTICLES_COUNT_MAX];
+    f32 velocity_y[PARTICLES_COUNT_MAX];
+    f32 radius[PARTICLES_COUNT_MAX]; /* At the start of the burst, it shrinks to 0 over the burst. */
+    u32 count;
+} particle_arrays;
+
+typedef struct {
+    particle_arrays arrays[2];
+    u32 current; /* The arrays holding the particles of the last frame, new bursts are emitted in there too. */
+
+    /* Statistics. */
+    u64 emitted;
+    u64 dropped;
+    u64 simulated;
+} particle_system;
+particle_system g_particles;
+
+/* The GPU list of particles, positions are 1/8 pixel steps relative to the burst like sdf_primitive_packed. */
+typedef struct {
+    i16 position[2];
+    f32 radius;
+} particle_packed;
+particle_packed g_particles_packed[PARTICLES_COUNT_MAX];
+
+/* Gives a particles entity a burst of i_count particles flying out of its position. The seeds are the ones 
+ * the shader used to build the 32 particles of a burst from noise for every pixel. Entities without a burst 
+ * get PARTICLES_BURST_COUNT particles on their first update. */
+void particles_emit(u32 i_entity, u32 i_count)
+{
+    assert(g_entity_store.type[i_entity] == ENTITY_TYPE_PARTICLES);
+    particle_arrays* arrays = &g_particles.arrays[g_particles.current];
+    u32 count = math_min(i_count, PARTICLES_COUNT_MAX - arrays->count);
+    g_particles.emitted += count;
+    g_particles.dropped += i_count - count;
+
+    fvec2 origin = entity_position(i_entity);
+    u32 first = arrays->count;
+    for (u32 i = 0; i < count; ++i)
+    {
+        fvec2 seed = { origin.x, origin.y + (f32)i };
+        fvec2 position = { noise_value_baked(seed, 1.0f) - 0.5f, noise_value_baked(seed, 2.0f) - 0.5f };
+        fvec2 velocity = fvec2_mul_s(fvec2_norm(position), f32_lerp(100.0f, 500.0f, noise_value_baked(seed, 3.0f)) / PARTICLES_BURST_DURATION);
+        arrays->position_x[first + i] = position.x;
+        arrays->position_y[first + i] = position.y;
+        arrays->velocity_x[first + i] = velocity.x;
+        arrays->velocity_y[first + i] = velocity.y;
+        arrays->radius[first + i] = f32_lerp(8.0f, 14.0f, sample_noise(seed, 3.0f));
+    }
+    arrays->count += count;
+    g_entity_store.particles_first[i_entity] = first;
+    g_entity_store.particles_count[i_entity] = count;
+}
+
+/* Moves i_count particles at i_first in i_source i_delta_time ahead and appends them to io_destination, 
+ * writing them to g_particles_packed with their radius at i_factor through the burst. Returns where they start now. */
+u32 particles_integrate(particle_arrays const* i_source, u32 i_first, u32 i_count, particle_arrays* io_destination, f32 i_delta_time, f32 i_factor)
+{
+    assert(io_destination->count + i_count <= PARTICLES_COUNT_MAX);
+    u32 first = io_destination->count;
+    f32 shrink = 1.0f - i_factor;
+    u32 i = 0;
+
+    #if SDF_PACK_SSE2
+    /* Four particles at a time, positions are rounded to 1/8 pixels like sdf_primitive_pack. Bursts stay 
+     * within about 500 pixels, far inside the 16 bit range, so no clamping. */
+    __m128 delta_time = _mm_set1_ps(i_delta_time);
+    __m128 shrink4 = _mm_set1_ps(shrink);
+    __m128 scale = _mm_set1_ps(SDF_PACKED_POSITION_SCALE);
+    __m128i low_mask = _mm_set1_epi32(0xFFFF);
+    for (; i + 4 <= i_count; i += 4)
+    {
+        u32 from = i_first + i;
+        u32 to = first + i;
+        __m128 velocity_x = _mm_loadu_ps(&i_source->velocity_x[from]);
+        __m128 velocity_y = _mm_loadu_ps(&i_source->velocity_y[from]);
+        __m128 position_x = _mm_add_ps(_mm_loadu_ps(&i_source->position_x[from]), _mm_mul_ps(velocity_x, delta_time));
+        __m128 position_y = _mm_add_ps(_mm_loadu_ps(&i_source->position_y[from]), _mm_mul_ps(velocity_y, delta_time));
+        __m128 radius = _mm_loadu_ps(&i_source->radius[from]);
+        _mm_storeu_ps(&io_destination->position_x[to], position_x);
+        _mm_storeu_ps(&io_destination->position_y[to], position_y);
+        _mm_storeu_ps(&io_destination->velocity_x[to], velocity_x);
+        _mm_storeu_ps(&io_destination->velocity_y[to], velocity_y);
+        _mm_storeu_ps(&io_destination->radius[to], radius);
+
+        /* x in the low and y in the high 16 bits of each lane, then interleaved with the radii. */
+        __m128i packed_x = _mm_cvtps_epi32(_mm_mul_ps(position_x, scale));
+        __m128i packed_y = _mm_cvtps_epi32(_mm_mul_ps(position_y, scale));
+        __m128i packed_position = _mm_or_si128(_mm_and_si128(packed_x, low_mask), _mm_slli_epi32(packed_y, 16));
+        __m128i packed_radius = _mm_castps_si128(_mm_mul_ps(radius, shrink4));
+        _mm_storeu_si128((__m128i*)&g_particles_packed[to], _mm_unpacklo_epi32(packed_position, packed_radius));
+        _mm_storeu_si128((__m128i*)&g_particles_packed[to + 2], _mm_unpackhi_epi32(packed_position, packed_radius));
+    }
+    #endif
+
+    for (; i < i_count; ++i)
+    {
+        u32 from = i_first + i;
+        u32 to = first + i;
+        f32 position_x = i_source->position_x[from] + i_source->velocity_x[from] * i_delta_time;
+        f32 position_y = i_source->position_y[from] + i_source->velocity_y[from] * i_delta_time;
+        io_destination->position_x[to] = position_x;
+        io_destination->position_y[to] = position_y;
+        io_destination->velocity_x[to] = i_source->velocity_x[from];
+        io_destination->velocity_y[to] = i_source->velocity_y[from];
+        io_destination->radius[to] = i_source->radius[from];
+        g_particles_packed[to].position[0] = (i16)sdf_pack_round(position_x * SDF_PACKED_POSITION_SCALE);
+        g_particles_packed[to].position[1] = (i16)sdf_pack_round(position_y * SDF_PACKED_POSITION_SCALE);
+        g_particles_packed[to].radius = i_source->radius[from] * shrink;
+    }
+
+    io_destination->count += i_count;
+    return first;
+}
+
+/* Starts a frame of simulation, the arrays of the last frame become the source. Returns the destination. */
+particle_arrays* particles_begin()
+{
+    particle_arrays* destination = &g_particles.arrays[g_particles.current ^ 1];
+    destination->count = 0;
+    return destination;
+}
+
+/* Swaps the arrays, what was integrated this frame becomes the particles of the last frame. */
+void particles_end()
+{
+    g_particles.current ^= 1;
+    g_particles.simulated += g_particles.arrays[g_particles.current].count;
+}
+
+/* Particles visible to the shader, the part of g_particles_packed to upload. */
+u32 particles_packed_count()
+{
+    return g_particles.arrays[g_particles.current].count;
+}
+
+/* --------------------------------------------------
+   Crowd 
+   -------------------------------------------------- */
+
+/* Maggots can wander around as a crowd, keeping apart from each other and clear of solid shapes. Wandering is 
+ * off by default so the maggots of the hand made levels stay where they were placed, swarms turn it on. 
+ * Every update gathers them into parallel arrays sorted by spatial hash bucket with a counting sort, so the 
+ * neighbours of an agent are a few contiguous ranges of those arrays. The passes over the agents are loops over 
+ * the arrays without branches the compiler can vectorise, only the wall queries go through the collision grid. 
+ * Walls come from the snapshot of the last frame, like navigation. The crowd also takes over touching the 
+ * player from the collision snapshot, so any number of maggots costs no collision shapes. */
+#define CROWD_CELL_SIZE 32.0f         /* Equal to the separation radius, neighbours are in the 3x3 cells around an agent. */
+#define CROWD_SEPARATION_RADIUS 32.0f
+#define CROWD_SEPARATION_SPEED 60.0f  /* Speed agents on top of each other push apart with. */
+#define CROWD_WANDER_SPEED 30.0f
+#define CROWD_WANDER_TURN_RATE 0.5f   /* How fast the wander direction drifts through the noise. */
+#define CROWD_STEER_RATE 4.0f         /* How fast the velocity follows the steering, per second. */
+#define CROWD_WALL_CLEARANCE 12.0f    /* Space agents keep from solid shapes on top of their size. */
+#define CROWD_WALL_SPEED 120.0f       /* Speed agents are pushed out of the clearance with. */
+#define CROWD_MASK_SOLID ((1u << SDF_PRIMITIVE_CIRCLE) | (1u << SDF_PRIMITIVE_SPIKED_CIRCLE) | (1u << SDF_PRIMITIVE_BOX))
+#define CROWD_BUCKETS_COUNT_MIN 256
+
+typedef struct {
+    /* Agents sorted by bucket, bucket i owns agents bucket_offsets[i] up to bucket_offsets[i + 1]. 
+     * Buckets are a power of two at least twice the agents, so few cells share one. */
+    u32* entity;
+    f32* position_x;
+    f32* position_y;
+    f32* velocity_x;
+    f32* velocity_y;
+    f32* size;
+    f32* push_x;    /* Separation and wall avoidance. */
+    f32* push_y;
+    u32* touched;   /* 1 where the agent touches the player. */
+    u32* keys;      /* Bucket of every maggot in members order. */
+    u32 count;
+    u32 capacity;
+    u32* bucket_offsets;
+    u32 buckets_count;
+    f32 time;
+    b8 is_wandering; /* Let maggots move, off by default as the levels place them by hand. */
+
+    /* Statistics. */
+    u64 updates;
+    u64 agents_updated;
+    u64 pickups;
+    f64 sort_time_ms;
+    f64 separation_time_ms;
+    f64 walls_time_ms;
+    f64 move_time_ms;
+    u32 frame_pickups; /* Maggots the player picked up in the last update. */
+} crowd_data;
+crowd_data g_crowd;
+
+/* Grows the agent arrays to at least i_count agents and sizes the buckets for them. */
+void crowd_reserve(u32 i_count)
+{
+    if (i_count > g_crowd.capacity)
+    {
+        u32 capacity = math_max(g_crowd.capacity * 2, math_max(i_count, (u32)ENTITIES_COUNT_MAX));
+        g_crowd.entity = realloc_arr(u32, g_crowd.entity, capacity);
+        g_crowd.position_x = realloc_arr(f32, g_crowd.position_x, capacity);
+        g_crowd.position_y = realloc_arr(f32, g_crowd.position_y, capacity);
+        g_crowd.velocity_x = realloc_arr(f32, g_crowd.velocity_x, capacity);
+        g_crowd.velocity_y = realloc_arr(f32, g_crowd.velocity_y, capacity);
+        g_crowd.size = realloc_arr(f32, g_crowd.size, capacity);
+        g_crowd.push_x = realloc_arr(f32, g_crowd.push_x, capacity);
+        g_crowd.push_y = realloc_arr(f32, g_crowd.push_y, capacity);
+        g_crowd.touched = realloc_arr(u32, g_crowd.touched, capacity);
+        g_crowd.keys = realloc_arr(u32, g_crowd.keys, capacity);
+        assert(g_crowd.entity != NULL && g_crowd.keys != NULL);
+        g_crowd.capacity = capacity;
+    }
+
+    u32 buckets_count = CROWD_BUCKETS_COUNT_MIN;
+    while (buckets_count < i_count * 2)
+    {
+        buckets_count *= 2;
+    }
+    if (buckets_count > g_crowd.buckets_count)
+    {
+        g_crowd.bucket_offsets = realloc_arr(u32, g_crowd.bucket_offsets, buckets_count + 1);
+        assert(g_crowd.bucket_offsets != NULL);
+        g_crowd.buckets_count = buckets_count;
+    }
+}
+
+u32 crowd_bucket(i32 i_cell_x, i32 i_cell_y)
+{
+    return (((u32)i_cell_x * 73856093u) ^ ((u32)i_cell_y * 19349663u)) & (g_crowd.buckets_count - 1);
+}
+
+i32 crowd_cell(f32 i_position)
+{
+    return (i32)f32_floor(i_position / CROWD_CELL_SIZE);
+}
+
+/* Counting sort of the maggots by bucket, then gathers them from the entity store in that order. */
+void crowd_sort(fvec3 i_growth_weights)
+{
+    u32 const* members = g_entity_store.members[ENTITY_TYPE_MAGGOT];
+    u32 count = g_entity_store.members_count[ENTITY_TYPE_MAGGOT];
+    crowd_reserve(count);
+    g_crowd.count = count;
+
+    u32* offsets = g_crowd.bucket_offsets;
+    memzero(offsets, (g_crowd.buckets_count + 1) * sizeof(u32));
+    for (u32 i = 0; i < count; ++i)
+    {
+        u32 entity = members[i];
+        u32 key = crowd_bucket(crowd_cell(g_entity_store.position_x[entity]), crowd_cell(g_entity_store.position_y[entity]));
+        g_crowd.keys[i] = key;
+        offsets[key + 1] += 1;
+    }
+    for (u32 i = 0; i < g_crowd.buckets_count; ++i)
+    {
+        offsets[i + 1] += offsets[i];
+    }
+
+    /* Scatter with the offsets as cursors, which leaves every bucket's offset at the start of the next bucket. */
+    for (u32 i = 0; i < count; ++i)
+    {
+        u32 entity = members[i];
+        u32 agent = offsets[g_crowd.keys[i]];
+        offsets[g_crowd.keys[i]] += 1;
+        g_crowd.entity[agent] = entity;
+        g_crowd.position_x[agent] = g_entity_store.position_x[entity];
+        g_crowd.position_y[agent] = g_entity_store.position_y[entity];
+        g_crowd.velocity_x[agent] = g_entity_store.velocity_x[entity];
+        g_crowd.velocity_y[agent] = g_entity_store.velocity_y[entity];
+        g_crowd.size[agent] = fvec3_dot(i_growth_weights, g_entity_store.growth_sizes1[entity]);
+    }
+    for (u32 i = g_crowd.buckets_count; i > 0; --i)
+    {
+        offsets[i] = offsets[i - 1];
+    }
+    offsets[0] = 0;
+}
+
+/* Pushes agents apart, harder the closer they are. The 3x3 cells around an agent can hash to the same bucket, every
+ * bucket is walked once. Agents of cells outside those 3x3 that share a bucket are beyond the radius and add nothing. */
+void crowd_separate()
+{
+    f32 const* position_x = g_crowd.position_x;
+    f32 const* position_y = g_crowd.position_y;
+    f32 inverse_radius = 1.0f / CROWD_SEPARATION_RADIUS;
+    for (u32 i = 0; i < g_crowd.count; ++i)
+    {
+        f32 x = position_x[i];
+        f32 y = position_y[i];
+        i32 cell_x = crowd_cell(x);
+        i32 cell_y = crowd_cell(y);
+        u32 buckets[9];
+        u32 buckets_count = 0;
+        for (i32 offset_y = -1; offset_y <= 1; ++offset_y)
+        {
+            for (i32 offset_x = -1; offset_x <= 1; ++offset_x)
+            {
+                u32 bucket = crowd_bucket(cell_x + offset_x, cell_y + offset_y);
+                b8 is_repeat = FALSE;
+                for (u32 k = 0; k < buckets_count; ++k)
+                {
+                    is_repeat = is_repeat || buckets[k] == bucket ? TRUE : FALSE;
+                }
+                if (!is_repeat)
+                {
+                    buckets[buckets_count++] = bucket;
+                }
+            }
+        }
+
+        f32 push_x = 0.0f;
+        f32 push_y = 0.0f;
+        for (u32 k = 0; k < buckets_count; ++k)
+        {
+            u32 end = g_crowd.bucket_offsets[buckets[k] + 1];
+            u32 j = g_crowd.bucket_offsets[buckets[k]];
+
+            #if SDF_PACK_SSE2
+            /* Four neighbours at a time, summed per lane and folded once the bucket is done. */
+            __m128 x4 = _mm_set1_ps(x);
+            __m128 y4 = _mm_set1_ps(y);
+            __m128 push_x4 = _mm_setzero_ps();
+            __m128 push_y4 = _mm_setzero_ps();
+            for (; j + 4 <= end; j += 4)
+            {
+                __m128 dx = _mm_sub_ps(x4, _mm_loadu_ps(&position_x[j]));
+                __m128 dy = _mm_sub_ps(y4, _mm_loadu_ps(&position_y[j]));
+                __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+                __m128 falloff = _mm_max_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(distance, _mm_set1_ps(inverse_radius))), _mm_setzero_ps());
+                __m128 weight = _mm_div_ps(falloff, _mm_add_ps(distance, _mm_set1_ps(0.001f)));
+                push_x4 = _mm_add_ps(push_x4, _mm_mul_ps(dx, weight));
+                push_y4 = _mm_add_ps(push_y4, _mm_mul_ps(dy, weight));
+            }
+            f32 lanes_x[4];
+            f32 lanes_y[4];
+            _mm_storeu_ps(lanes_x, push_x4);
+            _mm_storeu_ps(lanes_y, push_y4);
+            push_x += (lanes_x[0] + lanes_x[1]) + (lanes_x[2] + lanes_x[3]);
+            push_y += (lanes_y[0] + lanes_y[1]) + (lanes_y[2] + lanes_y[3]);
+            #endif
+
+            for (; j < end; ++j)
+            {
+                /* The agent itself is at distance 0 and adds nothing. */
+                f32 dx = x - position_x[j];
+                f32 dy = y - position_y[j];
+                f32 distance = f32_sqrt(dx * dx + dy * dy);
+                f32 weight = math_max(1.0f - distance * inverse_radius, 0.0f) / (distance + 0.001f);
+                push_x += dx * weight;
+                push_y += dy * weight;
+            }
+        }
+        g_crowd.push_x[i] = push_x * CROWD_SEPARATION_SPEED;
+        g_crowd.push_y[i] = push_y * CROWD_SEPARATION_SPEED;
+    }
+}
+
+/* Pushes agents within the clearance of a solid shape out along the shape normal. */
+void crowd_avoid_walls()
+{
+    for (u32 i = 0; i < g_crowd.count; ++i)
+    {
+        fvec2 position = { g_crowd.position_x[i], g_crowd.position_y[i] };
+        f32 clearance = g_crowd.size[i] + CROWD_WALL_CLEARANCE;
+        u32 shape;
+        f32 distance = sdf_get_distance_bounded(position, CROWD_MASK_SOLID, ENTITY_HANDLE_INVALID, &shape);
+        if (shape == SDF_RESULT_OBJECT_INVALID || distance >= clearance)
+        {
+            continue;
+        }
+
+        fvec2 normal = sdf_shape_normal(&g_collision_snapshot.shapes[shape], position);
+        f32 strength = CROWD_WALL_SPEED * (clearance - distance) / clearance;
+        g_crowd.push_x[i] += normal.x * strength;
+        g_crowd.push_y[i] += normal.y * strength;
+    }
+}
+
+/* Steers toward the wander direction plus the pushes, moves and keeps agents in the world. */
+void crowd_move(f32 i_delta_time)
+{
+    f32 steer = math_min(CROWD_STEER_RATE * i_delta_time, 1.0f);
+    for (u32 i = 0; i < g_crowd.count; ++i)
+    {
+        f32 angle = noise_value_baked(sdf_vec2((f32)g_crowd.entity[i], g_crowd.time * CROWD_WANDER_TURN_RATE), 0.0f) * 12.566370f;
+        f32 desired_x = f32_cos(angle) * CROWD_WANDER_SPEED + g_crowd.push_x[i];
+        f32 desired_y = f32_sin(angle) * CROWD_WANDER_SPEED + g_crowd.push_y[i];
+        f32 velocity_x = g_crowd.velocity_x[i] + (desired_x - g_crowd.velocity_x[i]) * steer;
+        f32 velocity_y = g_crowd.velocity_y[i] + (desired_y - g_crowd.velocity_y[i]) * steer;
+        g_crowd.velocity_x[i] = velocity_x;
+        g_crowd.velocity_y[i] = velocity_y;
+
+        f32 size = g_crowd.size[i];
+        f32 x = g_crowd.position_x[i] + velocity_x * i_delta_time;
+        f32 y = g_crowd.position_y[i] + velocity_y * i_delta_time;
+        g_crowd.position_x[i] = math_clamp(x, size, g_world.size.x - size);
+        g_crowd.position_y[i] = math_clamp(y, size, g_world.size.y - size);
+    }
+}
+
+/* Tests agents against the player the way overlapping a collision shape used to. */
+void crowd_touch()
+{
+    fvec2 player = g_player.position;
+    f32 reach = g_player.radius + 0.1f;
+    for (u32 i = 0; i < g_crowd.count; ++i)
+    {
+        f32 dx = g_crowd.position_x[i] - player.x;
+        f32 dy = g_crowd.position_y[i] - player.y;
+        f32 touch = g_crowd.size[i] + reach;
+        g_crowd.touched[i] = (g_crowd.size[i] > 0.0f && dx * dx + dy * dy < touch * touch) ? 1 : 0;
+    }
+}
+
+/* Moves every maggot i_delta_time ahead when wandering, always tests them against the player. The agent arrays hold the result until the next update. */
+void crowd_update(f32 i_delta_time, fvec3 i_growth_weights)
+{
+    f64 start = profile_time_ms();
+    g_crowd.time += i_delta_time;
+    crowd_sort(i_growth_weights);
+    f64 after_sort = profile_time_ms();
+    f64 after_separation = after_sort;
+    f64 after_walls = after_sort;
+    if (g_crowd.is_wandering)
+    {
+        crowd_separate();
+        after_separation = profile_time_ms();
+        crowd_avoid_walls();
+        after_walls = profile_time_ms();
+        crowd_move(i_delta_time);
+    }
+    crowd_touch();
+    f64 after_move = profile_time_ms();
+
+    g_crowd.updates += 1;
+    g_crowd.agents_updated += g_crowd.count;
+    g_crowd.sort_time_ms += after_sort - start;
+    g_crowd.separation_time_ms += after_separation - after_sort;
+    g_crowd.walls_time_ms += after_walls - after_separation;
+    g_crowd.move_time_ms += after_move - after_walls;
+}
+
+void crowd_print()
+{
+    f64 updates = (f64)math_max(g_crowd.updates, (u64)1);
+    printf("Crowd: %llu updates, %.1f agents per update, %llu pickups, per update: sort %.4fms, separation %.4fms, walls %.4fms, move %.4fms\n", 
+        (unsigned long long)g_crowd.updates, (f64)g_crowd.agents_updated / updates, (unsigned long long)g_crowd.pickups, 
+        g_crowd.sort_time_ms / updates, g_crowd.separation_time_ms / updates, g_crowd.walls_time_ms / updates, g_crowd.move_time_ms / updates);
+}
+
+/* --------------------------------------------------
+   Tile binning 
+   -------------------------------------------------- */
+
+/* Lists per screen tile the primitives of a GPU list that can change a pixel of the tile, so the shader and the CPU
+ * renderer only evaluate those. get_distance blends a primitive with a weight of saturate(1 - distance), a primitive
+ * at a distance of 1 or more leaves color and distance as they are. Bounds therefore only cover where a primitive
+ * comes within a pixel, at the growth sizes of this frame. Lists keep the GPU list order, so blending matches 
+ * looping over the whole list. 
+ *
+ * sdf_bins is uploaded as is: tile t lists indices[offsets[t]] up to indices[offsets[t + 1]], two 16 bit indices to
+ * a 32 bit word. */
+#define SDF_BIN_TILE_SIZE 32
+#define SDF_BIN_TILES_X ((LEVEL_WIDTH + SDF_BIN_TILE_SIZE - 1) / SDF_BIN_TILE_SIZE)
+#define SDF_BIN_TILES_Y ((LEVEL_HEIGHT + SDF_BIN_TILE_SIZE - 1) / SDF_BIN_TILE_SIZE)
+#define SDF_BIN_TILES_COUNT (SDF_BIN_TILES_X * SDF_BIN_TILES_Y)
+#define SDF_BIN_INDICES_COUNT_MAX 65536
+
+typedef struct {
+    u32 offsets[SDF_BIN_TILES_COUNT + 1];
+    u16 indices[SDF_BIN_INDICES_COUNT_MAX];
+} sdf_bins;
+sdf_bins g_level_bins;
+sdf_bins g_overlay_bins;
+
+typedef struct {
+    /* Stats. */
+    u64 builds;
+    u64 primitives;
+    u64 indices;
+    u64 dropped;
+    f64 time_ms;
+} sdf_bins_stats;
+sdf_bins_stats g_bins_stats;
+
+/* World space bounds of where i_primitive comes within a pixel, see sdf_primitive_bounds_radius for the margins.
+ * Returns FALSE when it can not get that close anywhere, like tumors shrunk below zero. */
+b8 sdf_primitive_pixel_bounds(sdf_primitive const* i_primitive, fvec3 i_growth_weights, fvec4* o_bounds)
+{
+    f32 size1 = f32_abs(fvec3_dot(i_growth_weights, i_primitive->growth_sizes1));
+    f32 size2 = f32_abs(fvec3_dot(i_growth_weights, i_primitive->growth_sizes2));
+    f32 wobble = 25.0f * 1.6f;
+    fvec2 extent = { 0.0f, 0.0f };
+    switch (i_primitive->type)
+    {
+        case SDF_PRIMITIVE_CIRCLE:
+        {
+            f32 radius = fvec3_dot(i_growth_weights, i_primitive->growth_sizes1) + wobble + 1.0f;
+            extent = { radius, radius };
+        } break;
+        case SDF_PRIMITIVE_SPIKED_CIRCLE: extent = { size1 * 1.05f + 1.0f, size1 * 1.05f + 1.0f }; break;
+        case SDF_PRIMITIVE_BOX: extent = { size1 + wobble + 1.0f, size2 + wobble + 1.0f }; break;
+        case SDF_PRIMITIVE_BOX_TEXTURED:
+        case SDF_PRIMITIVE_BOX_FLOWER: extent = { size1 + 1.0f, size2 + 1.0f }; break;
+        case SDF_PRIMITIVE_BOX_TEXT:
+        {
+            /* Sized by the unweighted sizes and scale, the text is only drawn where the noisy background is. */
+            f32 scale = f32_abs(i_primitive->growth_sizes1.z);
+            extent.x = (f32_abs(i_primitive->growth_sizes1.x - 10.0f) + wobble) * scale + 1.0f;
+            extent.y = (f32_abs(i_primitive->growth_sizes2.x - 10.0f) + wobble) * scale + 1.0f;
+        } break;
+        case SDF_PRIMITIVE_PORTAL: extent = { size1 * 2.1f + 1.0f, size1 * 2.1f + 1.0f }; break;
+        case SDF_PRIMITIVE_MAGGOT: extent = { size1 * 2.6f + 2.0f, size1 * 2.6f + 2.0f }; break;
+        case SDF_PRIMITIVE_PARTICLES:
+        {
+            /* The burst position plus the bounds of its particles. */
+            u32 first = (u32)i_primitive->growth_sizes2.x;
+            u32 count = (u32)i_primitive->growth_sizes2.y;
+            if (count == 0)
+            {
+                return FALSE;
+            }
+            fvec4 bounds = { 1e9f, 1e9f, -1e9f, -1e9f };
+            for (u32 i = first; i < first + count; ++i)
+            {
+                particle_packed const* particle = &g_particles_packed[i];
+                f32 x = (f32)particle->position[0] / SDF_PACKED_POSITION_SCALE;
+                f32 y = (f32)particle->position[1] / SDF_PACKED_POSITION_SCALE;
+                f32 radius = particle->radius + 1.0f;
+                bounds.x = math_min(bounds.x, x - radius);
+                bounds.y = math_min(bounds.y, y - radius);
+                bounds.z = math_max(bounds.z, x + radius);
+                bounds.w = math_max(bounds.w, y + radius);
+            }
+            o_bounds->top_left = fvec2_add(i_primitive->position, bounds.top_left);
+            o_bounds->bottom_right = fvec2_add(i_primitive->position, bounds.bottom_right);
+            return o_bounds->x <= o_bounds->z ? TRUE : FALSE;
+        }
+    }
+
+    if (extent.x <= 0.0f || extent.y <= 0.0f)
+    {
+        return FALSE;
+    }
+    o_bounds->top_left = fvec2_sub(i_primitive->position, extent);
+    o_bounds->bottom_right = fvec2_add(i_primitive->position, extent);
+    return TRUE;
+}
+
+/* Bins the first i_count primitives of i_packed by their bounds relative to i_camera, skipping free slots. A counting pass
+ * sizes every tile list, a prefix sum lays them out and a second pass fills them in list order. */
+void sdf_bins_build_list(sdf_primitive_packed const* i_packed, u32 i_count, fvec2 i_origin, fvec2 i_camera, fvec3 i_growth_weights, sdf_bins* o_bins)
+{
+    /* Tile rectangle per primitive, first x, first y, end x, end y. */
+    u8 rects[SDF_PRIMITIVES_COUNT_MAX][4];
+    u32 cursors[SDF_BIN_TILES_COUNT];
+    memzero(o_bins->offsets, sizeof(o_bins->offsets));
+
+    u32 count = 0;
+    for (u32 i = 0; i < i_count; ++i)
+    {
+        sdf_primitive primitive;
+        fvec4 bounds;
+        rects[i][0] = rects[i][2] = 0;
+        rects[i][1] = rects[i][3] = 0;
+        if (sdf_primitive_packed_type(&i_packed[i]) == SDF_PRIMITIVE_INVALID)
+        {
+            continue;
+        }
+        count += 1;
+        sdf_primitive_unpack(&i_packed[i], i_origin, &primitive);
+        if (!sdf_primitive_pixel_bounds(&primitive, i_growth_weights, &bounds))
+        {
+            continue;
+        }
+
+        /* Every tile the bounds touch, clamped to the view. */
+        f32 tile_size = (f32)SDF_BIN_TILE_SIZE;
+        f32 first_x = f32_floor((bounds.x - i_camera.x) / tile_size);
+        f32 first_y = f32_floor((bounds.y - i_camera.y) / tile_size);
+        f32 end_x = f32_floor((bounds.z - i_camera.x) / tile_size) + 1.0f;
+        f32 end_y = f32_floor((bounds.w - i_camera.y) / tile_size) + 1.0f;
+        if (end_x <= 0.0f || end_y <= 0.0f || first_x >= (f32)SDF_BIN_TILES_X || first_y >= (f32)SDF_BIN_TILES_Y)
+        {
+            continue;
+        }
+        rects[i][0] = (u8)math_max(first_x, 0.0f);
+        rects[i][1] = (u8)math_max(first_y, 0.0f);
+        rects[i][2] = (u8)math_min(end_x, (f32)SDF_BIN_TILES_X);
+        rects[i][3] = (u8)math_min(end_y, (f32)SDF_BIN_TILES_Y);
+        for (u32 y = rects[i][1]; y < rects[i][3]; ++y)
+        {
+            for (u32 x = rects[i][0]; x < rects[i][2]; ++x)
+            {
+                o_bins->offsets[y * SDF_BIN_TILES_X + x + 1] += 1;
+            }
+        }
+    }
+
+    /* Tiles past the index capacity lose their last primitives. */
+    for (u32 tile = 0; tile < SDF_BIN_TILES_COUNT; ++tile)
+    {
+        u32 tile_count = o_bins->offsets[tile + 1];
+        u32 end = math_min(o_bins->offsets[tile] + tile_count, (u32)SDF_BIN_INDICES_COUNT_MAX);
+        assert(end == o_bins->offsets[tile] + tile_count);
+        g_bins_stats.dropped += o_bins->offsets[tile] + tile_count - end;
+        cursors[tile] = o_bins->offsets[tile];
+        o_bins->offsets[tile + 1] = end;
+    }
+
+    for (u32 i = 0; i < i_count; ++i)
+    {
+        for (u32 y = rects[i][1]; y < rects[i][3]; ++y)
+        {
+            for (u32 x = rects[i][0]; x < rects[i][2]; ++x)
+            {
+                u32 tile = y * SDF_BIN_TILES_X + x;
+                if (cursors[tile] < o_bins->offsets[tile + 1])
+                {
+                    o_bins->indices[cursors[tile]] = (u16)i;
+                    cursors[tile] += 1;
+                }
+            }
+        }
+    }
+
+    g_bins_stats.primitives += count;
+    g_bins_stats.indices += o_bins->offsets[SDF_BIN_TILES_COUNT];
+}
+
+/* Bins both GPU lists for the view at i_camera, after world_cull_primitives. */
+void sdf_bins_build(fvec2 i_camera, f32 i_growth_factor)
+{
+    f64 start = profile_time_ms();
+    fvec2 origin = world_primitives_origin();
+    fvec3 growth_weights = growth_factor_to_weights(i_growth_factor);
+    sdf_bins_build_list(g_level_primitives, g_level_slots.end, origin, i_camera, growth_weights, &g_level_bins);
+    sdf_bins_build_list(g_overlay_primitives, g_overlay_slots.end, origin, i_camera, growth_weights, &g_overlay_bins);
+    g_bins_stats.builds += 1;
+    g_bins_stats.time_ms += profile_time_ms() - start;
+}
+
+/* Number of 32 bit words of i_bins in use, the part to upload. */
+u32 sdf_bins_words_count(sdf_bins const* i_bins)
+{
+    return SDF_BIN_TILES_COUNT + 1 + (i_bins->offsets[SDF_BIN_TILES_COUNT] + 1) / 2;
+}
+
+void sdf_bins_print()
+{
+    f64 builds = (f64)math_max(g_bins_stats.builds, (u64)1);
+    printf("Tile bins: %llu builds of %.4fms, %.1f primitives binned to %.2f per tile on average, %llu dropped\n", 
+        (unsigned long long)g_bins_stats.builds, g_bins_stats.time_ms / builds, (f64)g_bins_stats.primitives / builds, 
+        (f64)g_bins_stats.indices / builds / (f64)SDF_BIN_TILES_COUNT, (unsigned long long)g_bins_stats.dropped);
+}
+
+/* --------------------------------------------------
+   Entities 
+   -------------------------------------------------- */
+
+/* Appends a primitive for i_entity at its position and with its first growth sizes, everything else zeroed. 
+ * The list grows along with the entity pool. */
+sdf_primitive* entity_primitive_add(sdf_primitive** io_primitives, u32* io_count, u32* io_capacity, u32 i_type, u32 i_entity)
+{
+    if (*io_count == *io_capacity)
+    {
+        *io_capacity = math_max(*io_capacity * 2, (u32)ENTITIES_COUNT_MAX);
+        *io_primitives = realloc_arr(sdf_primitive, *io_primitives, *io_capacity);
+        assert(*io_primitives != NULL);
+    }
+
+    sdf_primitive* primitive = &(*io_primitives)[*io_count];
+    memzero(primitive, sizeof(*primitive));
+    primitive->type = i_type;
+    primitive->entity = entity_handle_of(i_entity);
+    primitive->position = entity_position(i_entity);
+    primitive->growth_sizes1 = g_entity_store.growth_sizes1[i_entity];
+    *io_count += 1;
+    return primitive;
+}
+
+sdf_primitive* entity_level_primitive_add(u32 i_type, u32 i_entity)
+{
+    return entity_primitive_add(&g_resident_level_primitives, &g_resident_level_primitives_count, &g_resident_level_primitives_capacity, i_type, i_entity);
+}
+
+sdf_primitive* entity_overlay_primitive_add(u32 i_type, u32 i_entity)
+{
+    return entity_primitive_add(&g_resident_overlay_primitives, &g_resident_overlay_primitives_count, &g_resident_overlay_primitives_capacity, i_type, i_entity);
+}
+
+/* The shader finds the particles of a burst through the range in growth_sizes2, see sdf_primitive_pack_particles. */
+sdf_primitive* particles_primitive_add(u32 i_entity)
+{
+    u32 first = g_entity_store.particles_first[i_entity];
+    sdf_primitive* particles = entity_overlay_primitive_add(SDF_PRIMITIVE_PARTICLES, i_entity);
+    particles->growth_sizes2 = { first == PARTICLES_NOT_EMITTED ? 0.0f : (f32)first, (f32)g_entity_store.particles_count[i_entity], 0.0f };
+    return particles;
+}
+
+/* Moves growth_sizes1.z, which text boxes and particles use as their animation time, toward 1 or 0. */
+void entity_grow(u32 i_entity, f32 i_delta_time, b8 i_should_grow)
+{
+    fvec3* growth_sizes1 = &g_entity_store.growth_sizes1[i_entity];
+    f32 z = math_clamp(growth_sizes1->z + (i_should_grow ? i_delta_time : -i_delta_time) * 2.0f, 0.0f, 1.0f);
+    if (z != growth_sizes1->z)
+    {
+        growth_sizes1->z = z;
+        g_entity_store.is_dirty[i_entity] = TRUE;
+    }
+}
+
+/* Scratch arrays for the tumor face pass, one entry per tumor. */
+typedef struct {
+    f32* x;
+    f32* y;
+    f32* timer;
+    f32* turn;   /* What the timer moves by this update, up while the tumor sees the player and down otherwise. */
+    f32* width;
+    u32 capacity;
+
+    /* What the faces followed last update, a face only changes when these or its timer change. */
+    fvec2 player_position;
+    fvec3 growth_weights;
+} tumor_faces;
+tumor_faces g_tumor_faces;
+
+void tumor_faces_reserve(u32 i_count)
+{
+    if (i_count <= g_tumor_faces.capacity)
+    {
+        return;
+    }
+    u32 capacity = math_max(g_tumor_faces.capacity * 2, i_count);
+    g_tumor_faces.x = realloc_arr(f32, g_tumor_faces.x, capacity);
+    g_tumor_faces.y = realloc_arr(f32, g_tumor_faces.y, capacity);
+    g_tumor_faces.timer = realloc_arr(f32, g_tumor_faces.timer, capacity);
+    g_tumor_faces.turn = realloc_arr(f32, g_tumor_faces.turn, capacity);
+    g_tumor_faces.width = realloc_arr(f32, g_tumor_faces.width, capacity);
+    assert(g_tumor_faces.x != NULL && g_tumor_faces.y != NULL && g_tumor_faces.timer != NULL && g_tumor_faces.turn != NULL && g_tumor_faces.width != NULL);
+    g_tumor_faces.capacity = capacity;
+}
+
+void entity_system_tumors(f32 i_delta_time, fvec3 i_growth_weights)
+{
+    u32 const* members = g_entity_store.members[ENTITY_TYPE_TUMOR];
+    u32 count = g_entity_store.members_count[ENTITY_TYPE_TUMOR];
+    tumor_faces_reserve(count);
+
+    for (u32 i = 0; i < count; ++i)
+    {
+        u32 entity = members[i];
+
+        /* Create body */
+        entity_level_primitive_add(SDF_PRIMITIVE_CIRCLE, entity);
+
+        /* Smoothly turn toward the player only while we can actually see it. 
+         * Tumors do not use their timer otherwise, so it tracks how much we are looking. */
+        fvec2 position = entity_position(entity);
+        b8 can_see_player = !sdf_segment_occluded(position, g_player.position, entity_handle_of(entity));
+
+        g_tumor_faces.x[i] = position.x;
+        g_tumor_faces.y[i] = position.y;
+        g_tumor_faces.timer[i] = g_entity_store.timer[entity];
+        g_tumor_faces.turn[i] = (can_see_player ? i_delta_time : -i_delta_time) * 4.0f;
+        g_tumor_faces.width[i] = fvec3_dot(i_growth_weights, g_entity_store.growth_sizes1[entity]) / 2.0f;
+    }
+
+    /* Advance every look timer and move every face toward the player without leaving the body sphere. 
+     * Only the sight raycasts above are per tumor, this runs over plain arrays several tumors at a time. */
+    f32 player_x = g_player.position.x;
+    f32 player_y = g_player.position.y;
+    f32* face_x = g_tumor_faces.x;
+    f32* face_y = g_tumor_faces.y;
+    f32* face_timer = g_tumor_faces.timer;
+    f32 const* face_turn = g_tumor_faces.turn;
+    f32 const* face_width = g_tumor_faces.width;
+    u32 i = 0;
+
+    #if SDF_PACK_SSE2
+    /* Same operations as the scalar loop below in the same order, so both give identical faces. */
+    __m128 player_x4 = _mm_set1_ps(player_x);
+    __m128 player_y4 = _mm_set1_ps(player_y);
+    __m128 zero = _mm_setzero_ps();
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 quarter = _mm_set1_ps(0.25f);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 timer = _mm_add_ps(_mm_loadu_ps(&face_timer[i]), _mm_loadu_ps(&face_turn[i]));
+        timer = _mm_min_ps(_mm_max_ps(timer, zero), one);
+        _mm_storeu_ps(&face_timer[i], timer);
+
+        __m128 position_x = _mm_loadu_ps(&face_x[i]);
+        __m128 position_y = _mm_loadu_ps(&face_y[i]);
+        __m128 direction_x = _mm_sub_ps(player_x4, position_x);
+        __m128 direction_y = _mm_sub_ps(player_y4, position_y);
+        __m128 length2 = _mm_add_ps(_mm_mul_ps(direction_x, direction_x), _mm_mul_ps(direction_y, direction_y));
+        __m128 length = _mm_sqrt_ps(length2);
+        __m128 inv_length = _mm_div_ps(one, length);
+        __m128 offset = _mm_mul_ps(_mm_min_ps(_mm_mul_ps(length, quarter), _mm_loadu_ps(&face_width[i])), timer);
+        _mm_storeu_ps(&face_x[i], _mm_add_ps(position_x, _mm_mul_ps(_mm_mul_ps(direction_x, inv_length), offset)));
+        _mm_storeu_ps(&face_y[i], _mm_add_ps(position_y, _mm_mul_ps(_mm_mul_ps(direction_y, inv_length), offset)));
+    }
+    #endif
+
+    for (; i < count; ++i)
+    {
+        face_timer[i] = math_clamp(face_timer[i] + face_turn[i], 0.0f, 1.0f);
+
+        f32 direction_x = player_x - face_x[i];
+        f32 direction_y = player_y - face_y[i];
+        f32 length2 = direction_x * direction_x + direction_y * direction_y;
+        f32 inv_length = f32_inv_sqrt(length2);
+        f32 offset = math_min(f32_sqrt(length2) * 0.25f, face_width[i]) * face_timer[i];
+        face_x[i] += (direction_x * inv_length) * offset;
+        face_y[i] += (direction_y * inv_length) * offset;
+    }
+
+    /* Only faces that are looking follow the player, a face with its timer at zero stays centered. */
+    b8 is_player_moved = memcmp(&g_tumor_faces.player_position, &g_player.position, sizeof(fvec2)) != 0 ? TRUE : FALSE;
+    b8 is_growing = memcmp(&g_tumor_faces.growth_weights, &i_growth_weights, sizeof(fvec3)) != 0 ? TRUE : FALSE;
+    g_tumor_faces.player_position = g_player.position;
+    g_tumor_faces.growth_weights = i_growth_weights;
+    for (i = 0; i < count; ++i)
+    {
+        u32 entity = members[i];
+        f32 timer = g_tumor_faces.timer[i];
+        if (timer != g_entity_store.timer[entity] || is_growing || (is_player_moved && timer > 0.0f))
+        {
+            g_entity_store.timer[entity] = g_tumor_faces.timer[i];
+            g_entity_store.is_dirty[entity] = TRUE;
+        }
+        f32 width = g_tumor_faces.width[i];
+        f32 height = width * (16.0f / 48.0f);
+
+        /* Create face */
+        sdf_primitive* face = entity_overlay_primitive_add(SDF_PRIMITIVE_BOX_TEXTURED, entity);
+        face->position = { g_tumor_faces.x[i], g_tumor_faces.y[i] };
+        face->growth_sizes1 = { width, width, width };
+        face->growth_sizes2 = { height, height, height };
+        face->sprite_index[0] = g_entity_store.sprite_index[entity][0];
+        face->sprite_index[1] = g_entity_store.sprite_index[entity][1];
+    }
+}
+
+void entity_system_mothers(f32 i_delta_time, fvec3 i_growth_weights)
+{
+    u32 const* members = g_entity_store.members[ENTITY_TYPE_MOTHER];
+    u32 count = g_entity_store.members_count[ENTITY_TYPE_MOTHER];
+    for (u32 i = 0; i < count; ++i)
+    {
+        u32 entity = members[i];
+        fvec2 position = entity_position(entity);
+        f32* timer = &g_entity_store.timer[entity];
+        f32 mouth_state_time = 0.5f;
+        b8 mouth_state = (*timer < mouth_state_time);
+        if (g_entity_store.is_talking[entity] || mouth_state)
+        {
+            *timer += i_delta_time;
+            if (*timer >= mouth_state_time * 2.0f)
+            {
+                *timer = 0.0f;
+            }
+        }
+
+        /* Create body, the face follows the player and the mouth moves so there is always something to repack. */
+        entity_level_primitive_add(SDF_PRIMITIVE_CIRCLE, entity);
+        g_entity_store.is_dirty[entity] = TRUE;
+
+        /* Calculate face size and position to look at the player without leaving the body sphere. */
+        f32 face_width = fvec3_dot(i_growth_weights, g_entity_store.growth_sizes1[entity]) / 2.0f;
+        f32 face_height = face_width * (16.0f / 48.0f);
+
+        fvec2 face_position = fvec2_add(position, {0.0f, 150.0f});
+        fvec2 player_direction = fvec2_sub(g_player.position, face_position);
+        player_direction = fvec2_mul_s(fvec2_norm(player_direction), math_min(fvec2_len(player_direction) / 4.0f, face_width));
+        face_position = fvec2_add(face_position, player_direction);
+
+        /* Special clamping rules to prevent messy overlap with flower. */
+        face_position.x = math_clamp(
+            face_position.x, 
+            position.x - face_width / 2.0f, 
+            position.x + face_width / 4.0f
+        );
+        face_position.y = math_max(
+            face_position.y, 
+            position.y + face_height / 4.0f
+        );
+
+        /* Create flower */
+        fvec2 flower_position = fvec2_add(position, {280.0f, 180.0f});
+        f32 flower_width = fvec3_dot(i_growth_weights, g_entity_store.growth_sizes1[entity]) / 8.0f;
+        f32 flower_height = flower_width;
+
+        sdf_primitive* flower = entity_overlay_primitive_add(SDF_PRIMITIVE_BOX_FLOWER, entity);
+        flower->position = flower_position;
+        flower->growth_sizes1 = { flower_width, flower_width, flower_width };
+        flower->growth_sizes2 = { flower_height, flower_height, flower_height };
+        flower->sprite_index[0] = 8.0f;
+        flower->sprite_index[1] = 1.0f;
+
+        /* Create face */
+        sdf_primitive* face = entity_overlay_primitive_add(SDF_PRIMITIVE_BOX_TEXTURED, entity);
+        face->position = face_position;
+        face->growth_sizes1 = { face_width, face_width, face_width };
+        face->growth_sizes2 = { face_height, face_height, face_height };
+        face->sprite_index[0] = 2;
+        face->sprite_index[1] = 2 + (f32)mouth_state;
+    }
+}
+
+void entity_system_t_cells(f32 i_delta_time)
+{
+    u32 const* members = g_entity_store.members[ENTITY_TYPE_T_CELL];
+    u32 count = g_entity_store.members_count[ENTITY_TYPE_T_CELL];
+
+    /* Follow the flow field toward the player. */
+    if (g_nav.chase_player && !g_player.is_dead)
+    {
+        for (u32 i = 0; i < count; ++i)
+        {
+            u32 entity = members[i];
+            fvec2 position = entity_position(entity);
+            fvec2 direction = nav_flow_direction(position);
+            entity_set_position(entity, fvec2_add(position, fvec2_mul_s(direction, NAV_CHASE_SPEED * i_delta_time)));
+        }
+    }
+
+    /* Create bodies */
+    for (u32 i = 0; i < count; ++i)
+    {
+        entity_level_primitive_add(SDF_PRIMITIVE_SPIKED_CIRCLE, members[i]);
+    }
+}
+
+void entity_system_walls()
+{
+    u32 const* members = g_entity_store.members[ENTITY_TYPE_WALL];
+    u32 count = g_entity_store.members_count[ENTITY_TYPE_WALL];
+    for (u32 i = 0; i < count; ++i)
+    {
+        sdf_primitive* wall = entity_level_primitive_add(SDF_PRIMITIVE_BOX, members[i]);
+        wall->growth_sizes2 = g_entity_store.growth_sizes2[members[i]];
+    }
+}
+
+/* Entities that are nothing but a single level primitive, portals. */
+void entity_system_bodies(entity_type i_type, u32 i_primitive_type)
+{
+    u32 const* members = g_entity_store.members[i_type];
+    u32 count = g_entity_store.members_count[i_type];
+    for (u32 i = 0; i < count; ++i)
+    {
+        entity_level_primitive_add(i_primitive_type, members[i]);
+    }
+}
+
+/* Maggots move as a crowd, see Crowd. The player picks up the ones it touches while it has control, 
+ * which turns them into particles. */
+void entity_system_maggots(f32 i_delta_time, fvec3 i_growth_weights)
+{
+    crowd_update(i_delta_time, i_growth_weights);
+    g_crowd.frame_pickups = 0;
+    for (u32 i = 0; i < g_crowd.count; ++i)
+    {
+        u32 entity = g_crowd.entity[i];
+        if (g_entity_store.position_x[entity] != g_crowd.position_x[i] || g_entity_store.position_y[entity] != g_crowd.position_y[i])
+        {
+            entity_set_position(entity, { g_crowd.position_x[i], g_crowd.position_y[i] });
+        }
+        g_entity_store.velocity_x[entity] = g_crowd.velocity_x[i];
+        g_entity_store.velocity_y[entity] = g_crowd.velocity_y[i];
+        if (g_crowd.touched[i] && g_player.enable_input)
+        {
+            entity_set_type(entity, ENTITY_TYPE_PARTICLES);
+            g_entity_store.growth_sizes1[entity].z = 0.0f;
+            g_player.maggots += 1;
+            g_crowd.frame_pickups += 1;
+            continue;
+        }
+        entity_level_primitive_add(SDF_PRIMITIVE_MAGGOT, entity);
+    }
+    g_crowd.pickups += g_crowd.frame_pickups;
+}
+
+/* Bursts that finished are simply not carried over into the next particle arrays. */
+void entity_system_particles(f32 i_delta_time)
+{
+    particle_arrays const* source = &g_particles.arrays[g_particles.current];
+    particle_arrays* destination = particles_begin();
+
+    /* Backwards, despawning moves the last member into the current slot. */
+    u32 const* members = g_entity_store.members[ENTITY_TYPE_PARTICLES];
+    for (u32 i = g_entity_store.members_count[ENTITY_TYPE_PARTICLES]; i > 0; --i)
+    {
+        u32 entity = members[i - 1];
+
+        /* Particles have fully shrunk once grown, so they are done. */
+        entity_grow(entity, i_delta_time, TRUE);
+        f32 factor = g_entity_store.growth_sizes1[entity].z;
+        if (factor >= 1.0f)
+        {
+            entity_despawn(entity_handle_of(entity));
+            continue;
+        }
+
+        if (g_entity_store.particles_first[entity] == PARTICLES_NOT_EMITTED)
+        {
+            particles_emit(entity, PARTICLES_BURST_COUNT);
+        }
+        g_entity_store.particles_first[entity] = particles_integrate(
+            source, g_entity_store.particles_first[entity], g_entity_store.particles_count[entity], destination, i_delta_time, factor);
+        particles_primitive_add(entity);
+    }
+    particles_end();
+}
+
+void entity_system_text_boxes(f32 i_delta_time)
+{
+    u32 const* members = g_entity_store.members[ENTITY_TYPE_BOX_TEXT];
+    u32 count = g_entity_store.members_count[ENTITY_TYPE_BOX_TEXT];
+    for (u32 i = 0; i < count; ++i)
+    {
+        u32 entity = members[i];
+        entity_grow(entity, i_delta_time, g_entity_store.should_grow[entity]);
+
+        sdf_primitive* box = entity_overlay_primitive_add(SDF_PRIMITIVE_BOX_TEXT, entity);
+        box->growth_sizes2 = g_entity_store.growth_sizes2[entity];
+        box->sprite_index[0] = g_entity_store.sprite_index[entity][0];
+        box->sprite_index[1] = g_entity_store.sprite_index[entity][1];
+    }
+}
+
+/* Convert entities into primitives we need to render. 
+ * This provides a layer of separation between entities and their visuals. 
+ * Entities can have 1 or more visual elements or be created and destroyed. 
+ * The resident lists are recreated each frame, the GPU lists only get the entities marked dirty, see world_cull_list. 
+ * Each entity type has its own system looping over only the members of that type, so primitives are grouped by type. 
+ * Fills the resident primitive lists, world_cull_primitives picks the ones to render from those.
+ * Returns the level primitive created for i_edit_entity, used by the level editor. */
+u32 entities_to_primitives(f32 i_delta_time, u32 i_edit_entity)
+{
+    g_resident_level_primitives_count = 0;
+    g_resident_overlay_primitives_count = 0;
+    fvec3 growth_weights = growth_factor_to_weights(g_player.growth_factor);
+    entity_system_tumors(i_delta_time, growth_weights);
+    entity_system_mothers(i_delta_time, growth_weights);
+    entity_system_t_cells(i_delta_time);
+    entity_system_walls();
+    entity_system_bodies(ENTITY_TYPE_PORTAL, SDF_PRIMITIVE_PORTAL);
+    entity_system_maggots(i_delta_time, growth_weights);
+    entity_system_particles(i_delta_time);
+    entity_system_text_boxes(i_delta_time);
+
+    u32 edit_primitive = 0;
+    if (i_edit_entity < g_entity_store.end && g_entity_store.type[i_edit_entity] != ENTITY_TYPE_INVALID)
+    {
+        entity_handle edit_handle = entity_handle_of(i_edit_entity);
+        for (u32 i = 0; i < g_resident_level_primitives_count; ++i)
+        {
+            if (g_resident_level_primitives[i].entity == edit_handle)
+            {
+                edit_primitive = i;
+                break;
+            }
+        }
+    }
+    return edit_primitive;
+}
+
+/* --------------------------------------------------
+   Profiling 
+   -------------------------------------------------- */
+
+#if DEBUG
+/* Per entity switch entities_to_primitives used before the per type systems, kept to benchmark against. 
+ * Creates the same primitives in slot order instead of grouped by type. */
+u32 entities_to_primitives_reference(f32 i_delta_time, u32 i_edit_entity)
+{
+    u32 edit_primitive = 0;
+    g_resident_level_primitives_count = 0;
+    g_resident_overlay_primitives_count = 0;
+    fvec3 growth_weights = growth_factor_to_weights(g_player.growth_factor);
+    for (u32 i = entity_first(); i < g_entity_store.end; i = entity_next(i))
+    {
+        if (i_edit_entity == i)
+        {
+            edit_primitive = g_resident_level_primitives_count;
+        }
+
+        fvec2 position = entity_position(i);
+        switch (g_entity_store.type[i])
+        {
+            case ENTITY_TYPE_TUMOR: 
+            {
+                /* Create body */
+                entity_level_primitive_add(SDF_PRIMITIVE_CIRCLE, i);
+
+                /* Smoothly turn toward the player only while we can actually see it. 
+                 * Tumors do not use their timer otherwise, so it tracks how much we are looking. */
+                f32* timer = &g_entity_store.timer[i];
+                b8 can_see_player = !sdf_segment_occluded(position, g_player.position, entity_handle_of(i));
+                *timer = math_clamp(*timer + (can_see_player ? i_delta_time : -i_delta_time) * 4.0f, 0.0f, 1.0f);
+
+                /* Calculate face size and position to look at the player without leaving the body sphere. */
+                f32 face_width = fvec3_dot(growth_weights, g_entity_store.growth_sizes1[i]) / 2.0f;
+                f32 face_height = face_width * (16.0f / 48.0f);
+
+                fvec2 face_position = position;
+                fvec2 player_direction = fvec2_sub(g_player.position, face_position);
+                player_direction = fvec2_mul_s(fvec2_norm(player_direction), math_min(fvec2_len(player_direction) / 4.0f, face_width) * *timer);
+                face_position = fvec2_add(face_position, player_direction);
+
+                /* Create face */
+                sdf_primitive* face = entity_overlay_primitive_add(SDF_PRIMITIVE_BOX_TEXTURED, i);
+                face->position = face_position;
+                face->growth_sizes1 = { face_width, face_width, face_width };
+                face->growth_sizes2 = { face_height, face_height, face_height };
+                face->sprite_index[0] = g_entity_store.sprite_index[i][0];
+                face->sprite_index[1] = g_entity_store.sprite_index[i][1];
+            } break;
+            case ENTITY_TYPE_MOTHER:
+            {
+                f32* timer = &g_entity_store.timer[i];
+                f32 mouth_state_time = 0.5f;
+                b8 mouth_state = (*timer < mouth_state_time);
+                if (g_entity_store.is_talking[i] || mouth_state)
+                {
+                    *timer += i_delta_time;
+                    if (*timer >= mouth_state_time * 2.0f)
+                    {
+                        *timer = 0.0f;
+                    }
+                }
+
+                /* Create body */
+                entity_level_primitive_add(SDF_PRIMITIVE_CIRCLE, i);
+
+                /* Calculate face size and position to look at the player without leaving the body sphere. */
+                f32 face_width = fvec3_dot(growth_weights, g_entity_store.growth_sizes1[i]) / 2.0f;
+                f32 face_height = face_width * (16.0f / 48.0f);
+
+                fvec2 face_position = fvec2_add(position, {0.0f, 150.0f});
+                fvec2 player_direction = fvec2_sub(g_player.position, face_position);
+                player_direction = fvec2_mul_s(fvec2_norm(player_direction), math_min(fvec2_len(player_direction) / 4.0f, face_width));
+                face_position = fvec2_add(face_position, player_direction);
+
+                /* Special clamping rules to prevent messy overlap with flower. */
+                face_position.x = math_clamp(
+                    face_position.x, 
+                    position.x - face_width / 2.0f, 
+                    position.x + face_width / 4.0f
+                );
+                face_position.y = math_max(
+                    face_position.y, 
+                    position.y + face_height / 4.0f
+                );
+
+                /* Create flower */
+                fvec2 flower_position = fvec2_add(position, {280.0f, 180.0f});
+                f32 flower_width = fvec3_dot(growth_weights, g_entity_store.growth_sizes1[i]) / 8.0f;
+                f32 flower_height = flower_width;
+
+                sdf_primitive* flower = entity_overlay_primitive_add(SDF_PRIMITIVE_BOX_FLOWER, i);
+                flower->position = flower_position;
+                flower->growth_sizes1 = { flower_width, flower_width, flower_width };
+                flower->growth_sizes2 = { flower_height, flower_height, flower_height };
+                flower->sprite_index[0] = 8.0f;
+                flower->sprite_index[1] = 1.0f;
+
+                /* Create face */
+                sdf_primitive* face = entity_overlay_primitive_add(SDF_PRIMITIVE_BOX_TEXTURED, i);
+                face->position = face_position;
+                face->growth_sizes1 = { face_width, face_width, face_width };
+                face->growth_sizes2 = { face_height, face_height, face_height };
+                face->sprite_index[0] = 2;
+                face->sprite_index[1] = 2 + (f32)mouth_state;
+            } break;
+            case ENTITY_TYPE_T_CELL: 
+            {
+                /* Follow the flow field toward the player. */
+                if (g_nav.chase_player && !g_player.is_dead)
+                {
+                    fvec2 direction = nav_flow_direction(position);
+                    entity_set_position(i, fvec2_add(position, fvec2_mul_s(direction, NAV_CHASE_SPEED * i_delta_time)));
+                }
+
+                /* Create body */
+                entity_level_primitive_add(SDF_PRIMITIVE_SPIKED_CIRCLE, i);
+            } break;
+            case ENTITY_TYPE_WALL:
+            {
+                sdf_primitive* wall = entity_level_primitive_add(SDF_PRIMITIVE_BOX, i);
+                wall->growth_sizes2 = g_entity_store.growth_sizes2[i];
+            } break;
+            case ENTITY_TYPE_PORTAL:
+            {
+                entity_level_primitive_add(SDF_PRIMITIVE_PORTAL, i);
+            } break;
+            case ENTITY_TYPE_MAGGOT:
+            {
+                entity_level_primitive_add(SDF_PRIMITIVE_MAGGOT, i);
+            } break;
+            case ENTITY_TYPE_PARTICLES:
+            {
+                /* Particles have fully shrunk once grown, so they are done. */
+                entity_grow(i, i_delta_time, TRUE);
+                if (g_entity_store.growth_sizes1[i].z >= 1.0f)
+                {
+                    entity_despawn(entity_handle_of(i));
+                    break;
+                }
+                particles_primitive_add(i);
+            } break;
+            case ENTITY_TYPE_BOX_TEXT:
+            {
+                entity_grow(i, i_delta_time, g_entity_store.should_grow[i]);
+
+                sdf_primitive* box = entity_overlay_primitive_add(SDF_PRIMITIVE_BOX_TEXT, i);
+                box->growth_sizes2 = g_entity_store.growth_sizes2[i];
+                box->sprite_index[0] = g_entity_store.sprite_index[i][0];
+                box->sprite_index[1] = g_entity_store.sprite_index[i][1];
+            } break;
+        }
+    }
+    return edit_primitive;
+}
+
+/* Reference implementation resolving growth sizes per query, as collision worked before the snapshot. */
+sdf_result sdf_get_distance_reference(fvec2 i_position, f32 growth_factor)
+{
+    sdf_result result = sdf_result_init();
+    fvec3 growth_weights = growth_factor_to_weights(growth_factor);
+    for (u32 i = 0; i < g_resident_level_primitives_count; ++i)
+    {
+        float prev_distance = result.distance;
+        float prev_overlapped_distance = result.overlapped_distance;
+
+        sdf_primitive* primitive = &g_resident_level_primitives[i];
+
+        f32 growth_size1 = fvec3_dot(growth_weights, primitive->growth_sizes1);
+        f32 growth_size2 = fvec3_dot(growth_weights, primitive->growth_sizes2);
+        if (growth_size1 <= 0.0f) {
+            continue;
+        }
+
+        fvec2 half_size = { growth_size1, growth_size1 };
+        if (primitive->type == SDF_PRIMITIVE_BOX)
+        {
+            half_size = { growth_size1 * 0.85f, growth_size2 * 0.85f };
+        }
+        f32 distance = sdf_collision_shape_evaluate(primitive->type, primitive->position, half_size, i_position, g_collision_snapshot.time);
+        switch (primitive->type)
+        {
+            case SDF_PRIMITIVE_CIRCLE: 
+            case SDF_PRIMITIVE_SPIKED_CIRCLE: 
+            {
+                result.distance = f32_min_smooth(result.distance, distance, 10.0f);
+            } break;
+            case SDF_PRIMITIVE_BOX: 
+            {
+                result.distance = math_min(result.distance, distance);
+            } break;
+            case SDF_PRIMITIVE_PORTAL:
+            {
+                result.overlapped_distance = math_min(result.overlapped_distance, distance);
+            } break;
+        }
+
+        if (prev_distance > result.distance) {
+            result.closest_object = i;
+        }
+        if (prev_overlapped_distance > result.overlapped_distance) {
+            result.overlapped_object = i;
+        }
+    }
+
+    result.distance -= g_player.radius;
+    result.overlapped_distance -= g_player.radius;
+    return result;
+}
+
+/* Ring buffer of recent player movement so we can replay it against the current level. */
+#define PLAYER_PATH_SAMPLES_MAX 4096
+fvec2 g_player_path[PLAYER_PATH_SAMPLES_MAX];
+u32 g_player_path_count;
+
+void player_path_record(fvec2 i_position)
+{
+    g_player_path[g_player_path_count % PLAYER_PATH_SAMPLES_MAX] = i_position;
+    g_player_path_count += 1;
+}
+
+/* Replays the recorded path with the same query pattern as the player physics, a distance query 
+ * plus surface normal, against the current collision snapshot. Once resolving growth sizes per query 
+ * like we used to, once against the snapshot and once through a fresh cache. */
+void benchmark_player_path()
+{
+    u32 samples_count = math_min(g_player_path_count, (u32)PLAYER_PATH_SAMPLES_MAX);
+    if (samples_count == 0)
+    {
+        return;
+    }
+
+    static f32 distances[PLAYER_PATH_SAMPLES_MAX];
+    f32 epsilon = 10.0f;
+    f64 start_reference = profile_time_ms();
+    for (u32 i = 0; i < samples_count; ++i)
+    {
+        fvec2 position = g_player_path[i];
+        distances[i] = sdf_get_distance_reference(position, g_player.growth_factor).distance;
+        sdf_get_distance_reference({ position.x + epsilon, position.y }, g_player.growth_factor);
+        sdf_get_distance_reference({ position.x - epsilon, position.y }, g_player.growth_factor);
+        sdf_get_distance_reference({ position.x, position.y + epsilon }, g_player.growth_factor);
+        sdf_get_distance_reference({ position.x, position.y - epsilon }, g_player.growth_factor);
+    }
+    f64 time_reference = profile_time_ms() - start_reference;
+
+    u32 snapshot_mismatches = 0;
+    f64 start_snapshot = profile_time_ms();
+    for (u32 i = 0; i < samples_count; ++i)
+    {
+        fvec2 position = g_player_path[i];
+        f32 distance = sdf_get_distance(position).distance;
+        sdf_get_surface_normal(position);
+        if (distance != distances[i])
+        {
+            snapshot_mismatches += 1;
+        }
+    }
+    f64 time_snapshot = profile_time_ms() - start_snapshot;
+
+    sdf_query_cache cache;
+    memzero(&cache, sizeof(cache));
+    u32 cache_mismatches = 0;
+    f64 start_cached = profile_time_ms();
+    for (u32 i = 0; i < samples_count; ++i)
+    {
+        fvec2 position = g_player_path[i];
+        f32 distance = sdf_get_distance_cached(&cache, position).distance;
+        sdf_get_surface_normal_cached(&cache, position);
+        if (distances[i] < SDF_QUERY_CACHE_REACH && distance != distances[i])
+        {
+            cache_mismatches += 1;
+        }
+    }
+    f64 time_cached = profile_time_ms() - start_cached;
+
+    u32 queries_count = samples_count * 5;
+    printf("Player path replay, %u queries: per query resolve %.3fms, snapshot %.3fms (%u mismatches), cached %.3fms (%u mismatches)\n", 
+        queries_count, time_reference, time_snapshot, snapshot_mismatches, time_cached, cache_mismatches);
+    printf("Per query: resolve %.5fms, snapshot %.5fms, cached %.5fms\n", 
+        time_reference / (f64)queries_count, time_snapshot / (f64)queries_count, time_cached / (f64)queries_count);
+    sdf_collision_snapshot_print();
+    sdf_query_cache_print(&cache, "Player path replay");
+}
+
+/* Casts rays from every recorded player position in evenly spread directions. */
+void benchmark_raycasts()
+{
+    #define BENCHMARK_RAYS_COUNT 8192
+    static fvec2 origins[BENCHMARK_RAYS_COUNT];
+    static fvec2 directions[BENCHMARK_RAYS_COUNT];
+    static f32 max_distances[BENCHMARK_RAYS_COUNT];
+    static sdf_raycast_result results[BENCHMARK_RAYS_COUNT];
+
+    u32 samples_count = math_min(g_player_path_count, (u32)PLAYER_PATH_SAMPLES_MAX);
+    for (u32 i = 0; i < BENCHMARK_RAYS_COUNT; ++i)
+    {
+        f32 angle = (f32)i * 2.39996f; /* Golden angle. */
+        origins[i] = samples_count > 0 ? g_player_path[i % samples_count] : g_player.position;
+        directions[i] = { f32_cos(angle), f32_sin(angle) };
+        max_distances[i] = (f32)LEVEL_WIDTH;
+    }
+
+    sdf_raycast_stats stats = g_raycast_stats;
+    memzero(&g_raycast_stats, sizeof(g_raycast_stats));
+    sdf_raycast_batch(origins, directions, max_distances, BENCHMARK_RAYS_COUNT, SDF_RAYCAST_MASK_SOLID, results);
+
+    u32 hits = 0;
+    for (u32 i = 0; i < BENCHMARK_RAYS_COUNT; ++i)
+    {
+        hits += results[i].hit ? 1 : 0;
+    }
+    printf("Raycast batch, %u rays: %.3fms, %.5fms per ray, %u hits\n", 
+        BENCHMARK_RAYS_COUNT, g_raycast_stats.time_ms, g_raycast_stats.time_ms / (f64)BENCHMARK_RAYS_COUNT, hits);
+    sdf_raycast_stats_print();
+    g_raycast_stats = stats;
+    #undef BENCHMARK_RAYS_COUNT
+}
+
+/* Steers 10, 1k and 10k agents spread over the level toward the player for a second of frames. */
+void benchmark_navigation()
+{
+    #define BENCHMARK_AGENTS_COUNT_MAX 10000
+    #define BENCHMARK_NAV_FRAMES 60
+    static fvec2 agents[BENCHMARK_AGENTS_COUNT_MAX];
+    u32 agents_counts[3] = { 10, 1000, 10000 };
+
+    g_nav.is_rasterised = FALSE;
+    f64 start = profile_time_ms();
+    nav_update(g_player.position);
+    printf("Navigation rebuild: %.3fms\n", profile_time_ms() - start);
+
+    for (u32 i = 0; i < 3; ++i)
+    {
+        u32 agents_count = agents_counts[i];
+        for (u32 j = 0; j < agents_count; ++j)
+        {
+            agents[j] = { sdf_fract((f32)j * 0.6180339f) * LEVEL_WIDTH, sdf_fract((f32)j * 0.7548777f) * LEVEL_HEIGHT };
+        }
+
+        start = profile_time_ms();
+        for (u32 frame = 0; frame < BENCHMARK_NAV_FRAMES; ++frame)
+        {
+            for (u32 j = 0; j < agents_count; ++j)
+            {
+                agents[j] = fvec2_add(agents[j], fvec2_mul_s(nav_flow_direction(agents[j]), NAV_CHASE_SPEED / (f32)BENCHMARK_NAV_FRAMES));
+            }
+        }
+        f64 time = (profile_time_ms() - start) / (f64)BENCHMARK_NAV_FRAMES;
+
+        u32 arrived = 0;
+        for (u32 j = 0; j < agents_count; ++j)
+        {
+            arrived += nav_cell(agents[j]) == g_nav.target_cell ? 1 : 0;
+        }
+        printf("Navigation, %u agents: %.4fms per frame, %.1fns per agent, %u at the player\n", 
+            agents_count, time, time * 1000000.0 / (f64)agents_count, arrived);
+    }
+    nav_print();
+    #undef BENCHMARK_AGENTS_COUNT_MAX
+    #undef BENCHMARK_NAV_FRAMES
+}
+
+/* Tiles the current level over a 10 by 10 chunk world and flies the camera diagonally across it at 
+ * the players top speed, timing every per frame step. Reloads the level as a single chunk world after. */
+void benchmark_world()
+{
+    #define BENCHMARK_WORLD_SIZE 10
+    static entity_data level[ENTITIES_COUNT_MAX];
+    memzero(level, sizeof(level));
+    u32 level_count = 0;
+    for (u32 i = entity_first(); i < g_entity_store.end && level_count < ENTITIES_COUNT_MAX; i = entity_next(i))
+    {
+        level[level_count] = entity_get(i);
+        level_count += 1;
+    }
+    fvec2 player_position = g_player.position;
+
+    world_clear(BENCHMARK_WORLD_SIZE, BENCHMARK_WORLD_SIZE);
+    u32 entities_count = 0;
+    for (u32 chunk = 0; chunk < BENCHMARK_WORLD_SIZE * BENCHMARK_WORLD_SIZE; ++chunk)
+    {
+        fvec2 offset = { (f32)((chunk % BENCHMARK_WORLD_SIZE) * WORLD_CHUNK_WIDTH), (f32)((chunk / BENCHMARK_WORLD_SIZE) * WORLD_CHUNK_HEIGHT) };
+        for (u32 i = 0; i < ENTITIES_COUNT_MAX && level[i].type != ENTITY_TYPE_INVALID; ++i)
+        {
+            entity_data entity = level[i];
+            entity.position = fvec2_add(entity.position, offset);
+            entity.position.x = math_clamp(entity.position.x, offset.x, offset.x + (f32)WORLD_CHUNK_WIDTH - 1.0f);
+            entity.position.y = math_clamp(entity.position.y, offset.y, offset.y + (f32)WORLD_CHUNK_HEIGHT - 1.0f);
+            world_add_entity(&entity);
+            entities_count += 1;
+        }
+    }
+
+    fvec2 from = { (f32)WORLD_CHUNK_WIDTH * 0.5f, (f32)WORLD_CHUNK_HEIGHT * 0.5f };
+    fvec2 to = fvec2_sub(g_world.size, from);
+    f32 delta_time = 1.0f / 60.0f;
+    u32 frames = (u32)(fvec2_len(fvec2_sub(to, from)) / (900.0f * delta_time));
+    u64 streams = g_world.streams;
+    f64 time_stream = 0.0;
+    f64 time_entities = 0.0;
+    f64 time_cull = 0.0;
+    f64 time_snapshot = 0.0;
+    f64 time_nav = 0.0;
+    f64 time_frame_max = 0.0;
+    f64 time_nav_max = 0.0;
+    u64 primitives_visible = 0;
+    u64 primitives_resident = 0;
+    u64 primitives_touched = g_world.primitives_touched;
+    u64 bytes_written = g_world.bytes_written;
+    for (u32 frame = 0; frame <= frames; ++frame)
+    {
+        g_player.position = fvec2_add(from, fvec2_mul_s(fvec2_sub(to, from), (f32)frame / (f32)frames));
+
+        f64 start = profile_time_ms();
+        world_update_camera(g_player.position);
+        f64 after_stream = profile_time_ms();
+        entities_to_primitives(delta_time, ENTITIES_COUNT_MAX);
+        f64 after_entities = profile_time_ms();
+        world_cull_primitives();
+        f64 after_cull = profile_time_ms();
+        sdf_collision_snapshot_build(g_player.growth_factor, g_player.time);
+        f64 after_snapshot = profile_time_ms();
+        nav_update(g_player.position);
+        f64 after_nav = profile_time_ms();
+
+        time_stream += after_stream - start;
+        time_entities += after_entities - after_stream;
+        time_cull += after_cull - after_entities;
+        time_snapshot += after_snapshot - after_cull;
+        time_nav += after_nav - after_snapshot;
+        time_frame_max = math_max(time_frame_max, after_snapshot - start);
+        time_nav_max = math_max(time_nav_max, after_nav - after_snapshot);
+        primitives_resident += g_resident_level_primitives_count + g_resident_overlay_primitives_count;
+        primitives_visible += g_level_slots.visible_count + g_overlay_slots.visible_count;
+    }
+
+    f64 frames_count = (f64)(frames + 1);
+    printf("World %ux%u chunks, %u entities, %u frames: %llu streams, %.1f resident and %.1f visible primitives per frame\n", 
+        g_world.width, g_world.height, entities_count, frames + 1, (unsigned long long)(g_world.streams - streams), 
+        (f64)primitives_resident / frames_count, (f64)primitives_visible / frames_count);
+    printf("World uploads per frame: %.1f primitives touched, %.1f bytes written of %llu\n", 
+        (f64)(g_world.primitives_touched - primitives_touched) / frames_count, (f64)(g_world.bytes_written - bytes_written) / frames_count, 
+        (unsigned long long)(sizeof(g_level_primitives) + sizeof(g_overlay_primitives)));
+    printf("World per frame: stream %.4fms, entities %.4fms, cull %.4fms, snapshot %.4fms, worst %.3fms, navigation %.4fms, worst %.3fms\n", 
+        time_stream / frames_count, time_entities / frames_count, time_cull / frames_count, time_snapshot / frames_count, time_frame_max, 
+        time_nav / frames_count, time_nav_max);
+    printf("World memory: chunks %.1fKB, resident entities %.1fKB, resident primitives %.1fKB, gpu primitives %.1fKB, collision %.1fKB, navigation %.1fKB\n", 
+        (f64)sizeof(g_world.chunks) / 1024.0, 
+        (f64)entity_store_size() / 1024.0, 
+        (f64)((g_resident_level_primitives_capacity + g_resident_overlay_primitives_capacity) * sizeof(sdf_primitive)) / 1024.0, 
+        (f64)(sizeof(g_level_primitives) + sizeof(g_overlay_primitives)) / 1024.0, 
+        (f64)sdf_collision_snapshot_size() / 1024.0, 
+        (f64)(sizeof(g_nav) + g_nav.shapes_capacity * sizeof(sdf_collision_shape)) / 1024.0);
+
+    memcpy(g_entities, level, sizeof(level));
+    g_player.position = player_position;
+    world_from_entities(1, 1);
+    world_update_camera(g_player.position);
+    #undef BENCHMARK_WORLD_SIZE
+}
+
+/* Resolves both sizes of every level primitive over a sweep of growth factors, branching per primitive 
+ * versus converting the factor into weights once. */
+void benchmark_growth_factors()
+{
+    u32 steps = 4096;
+    f32 checksum_branching = 0.0f;
+    f64 start_branching = profile_time_ms();
+    for (u32 step = 0; step < steps; ++step)
+    {
+        f32 factor = (f32)step / (f32)steps;
+        for (u32 i = 0; i < g_resident_level_primitives_count; ++i)
+        {
+            checksum_branching += lerp_growth_factors(g_resident_level_primitives[i].growth_sizes1, factor);
+            checksum_branching += lerp_growth_factors(g_resident_level_primitives[i].growth_sizes2, factor);
+        }
+    }
+    f64 time_branching = profile_time_ms() - start_branching;
+
+    f32 checksum_weights = 0.0f;
+    f64 start_weights = profile_time_ms();
+    for (u32 step = 0; step < steps; ++step)
+    {
+        fvec3 growth_weights = growth_factor_to_weights((f32)step / (f32)steps);
+        for (u32 i = 0; i < g_resident_level_primitives_count; ++i)
+        {
+            checksum_weights += fvec3_dot(growth_weights, g_resident_level_primitives[i].growth_sizes1);
+            checksum_weights += fvec3_dot(growth_weights, g_resident_level_primitives[i].growth_sizes2);
+        }
+    }
+    f64 time_weights = profile_time_ms() - start_weights;
+
+    printf("Growth sizes, %u resolves: branching %.3fms, weights %.3fms (checksums %f / %f)\n", 
+        steps * g_resident_level_primitives_count * 2, time_branching, time_weights, checksum_branching, checksum_weights);
+}
+
+/* Runs a second of frames through the old per entity switch and through the per type systems, timing the tumors apart. */
+void benchmark_entity_systems_run(char const* i_label)
+{
+    #define BENCHMARK_SYSTEMS_FRAMES 60
+    f32 delta_time = 1.0f / 60.0f;
+    f64 start = profile_time_ms();
+    for (u32 frame = 0; frame < BENCHMARK_SYSTEMS_FRAMES; ++frame)
+    {
+        entities_to_primitives_reference(delta_time, ENTITIES_CAPACITY_MAX);
+    }
+    f64 time_switch = (profile_time_ms() - start) / (f64)BENCHMARK_SYSTEMS_FRAMES;
+    u32 primitives_switch = g_resident_level_primitives_count + g_resident_overlay_primitives_count;
+
+    /* Same as entities_to_primitives. */
+    f64 time_tumors = 0.0;
+    start = profile_time_ms();
+    for (u32 frame = 0; frame < BENCHMARK_SYSTEMS_FRAMES; ++frame)
+    {
+        g_resident_level_primitives_count = 0;
+        g_resident_overlay_primitives_count = 0;
+        fvec3 growth_weights = growth_factor_to_weights(g_player.growth_factor);
+        f64 tumors_start = profile_time_ms();
+        entity_system_tumors(delta_time, growth_weights);
+        time_tumors += profile_time_ms() - tumors_start;
+        entity_system_mothers(delta_time, growth_weights);
+        entity_system_t_cells(delta_time);
+        entity_system_walls();
+        entity_system_bodies(ENTITY_TYPE_PORTAL, SDF_PRIMITIVE_PORTAL);
+        entity_system_maggots(delta_time, growth_weights);
+        entity_system_particles(delta_time);
+        entity_system_text_boxes(delta_time);
+    }
+    f64 time_systems = (profile_time_ms() - start) / (f64)BENCHMARK_SYSTEMS_FRAMES;
+    time_tumors /= (f64)BENCHMARK_SYSTEMS_FRAMES;
+    u32 primitives_systems = g_resident_level_primitives_count + g_resident_overlay_primitives_count;
+
+    assert(primitives_switch == primitives_systems);
+    printf("Entity systems, %u entities, %u tumors, %s: switch %.4fms, systems %.4fms per frame (tumors %.4fms, others %.4fms), %u primitives\n", 
+        g_entity_store.count, g_entity_store.members_count[ENTITY_TYPE_TUMOR], i_label, time_switch, time_systems, 
+        time_tumors, time_systems - time_tumors, primitives_systems);
+    #undef BENCHMARK_SYSTEMS_FRAMES
+}
+
+/* Fills the resident area with copies of the level entities up to 10k, keeping the mix of types. 
+ * Runs them with the tumor sight rays, which cost the same either way and dominate, and without them. */
+void benchmark_entity_systems()
+{
+    #define BENCHMARK_SYSTEMS_ENTITIES_COUNT 10000
+    static entity_handle copies[BENCHMARK_SYSTEMS_ENTITIES_COUNT];
+    u32 level_count = g_entity_store.count;
+    if (level_count == 0 || level_count >= BENCHMARK_SYSTEMS_ENTITIES_COUNT)
+    {
+        return;
+    }
+
+    u32 copies_count = BENCHMARK_SYSTEMS_ENTITIES_COUNT - level_count;
+    u32 source = entity_first();
+    for (u32 i = 0; i < copies_count; ++i)
+    {
+        entity_data entity = entity_get(source);
+        entity.position.x = g_world.resident_origin.x + sdf_fract((f32)i * 0.6180339f) * (f32)WORLD_RESIDENT_WIDTH;
+        entity.position.y = g_world.resident_origin.y + sdf_fract((f32)i * 0.7548777f) * (f32)WORLD_RESIDENT_HEIGHT;
+        copies[i] = entity_spawn(&entity);
+        source = entity_next(source);
+        source = source < g_entity_store.end ? source : entity_first();
+    }
+
+    /* No maggot pickups, the switch has none and the primitive counts have to match. */
+    b8 enable_input = g_player.enable_input;
+    g_player.enable_input = FALSE;
+    benchmark_entity_systems_run("sight rays");
+    sdf_collision_snapshot_clear();
+    benchmark_entity_systems_run("no sight rays");
+    g_player.enable_input = enable_input;
+
+    for (u32 i = 0; i < copies_count; ++i)
+    {
+        entity_despawn(copies[i]);
+    }
+    entities_to_primitives(0.0f, ENTITIES_CAPACITY_MAX);
+    sdf_collision_snapshot_build(g_player.growth_factor, g_player.time);
+    #undef BENCHMARK_SYSTEMS_ENTITIES_COUNT
+}
+
+/* Spawns a burst of particles every frame for two seconds and despawns each half a second later, about as long 
+ * as their effect lasts. Checks that handles of despawned entities stay invalid once their slot is reused. */
+void benchmark_entity_spawns()
+{
+    #define BENCHMARK_SPAWNS_PER_FRAME 2048
+    #define BENCHMARK_SPAWN_FRAMES 120
+    #define BENCHMARK_SPAWN_LIFETIME 30
+    static entity_handle handles[BENCHMARK_SPAWNS_PER_FRAME * BENCHMARK_SPAWN_LIFETIME];
+
+    entity_data particles;
+    memzero(&particles, sizeof(particles));
+    particles.type = ENTITY_TYPE_PARTICLES;
+    particles.position = g_player.position;
+
+    u32 capacity = g_entity_store.capacity;
+    u32 stale_alive = 0;
+    f64 start = profile_time_ms();
+    for (u32 frame = 0; frame < BENCHMARK_SPAWN_FRAMES; ++frame)
+    {
+        entity_handle* frame_handles = &handles[(frame % BENCHMARK_SPAWN_LIFETIME) * BENCHMARK_SPAWNS_PER_FRAME];
+        for (u32 i = 0; i < BENCHMARK_SPAWNS_PER_FRAME; ++i)
+        {
+            entity_handle old = frame_handles[i];
+            if (frame >= BENCHMARK_SPAWN_LIFETIME)
+            {
+                entity_despawn(old);
+            }
+            frame_handles[i] = entity_spawn(&particles);
+            if (frame >= BENCHMARK_SPAWN_LIFETIME && entity_is_alive(old))
+            {
+                stale_alive += 1;
+            }
+        }
+    }
+    f64 time = (profile_time_ms() - start) / (f64)BENCHMARK_SPAWN_FRAMES;
+
+    for (u32 i = 0; i < BENCHMARK_SPAWNS_PER_FRAME * BENCHMARK_SPAWN_LIFETIME; ++i)
+    {
+        entity_despawn(handles[i]);
+    }
+    assert(stale_alive == 0);
+    printf("Entity spawns, %u per frame: %.4fms per frame, %.1fns per spawn and despawn, capacity %u to %u, %u stale handles alive\n", 
+        BENCHMARK_SPAWNS_PER_FRAME, time, time * 1000000.0 / (f64)BENCHMARK_SPAWNS_PER_FRAME, capacity, g_entity_store.capacity, stale_alive);
+    #undef BENCHMARK_SPAWNS_PER_FRAME
+    #undef BENCHMARK_SPAWN_FRAMES
+    #undef BENCHMARK_SPAWN_LIFETIME
+}
+
+/* Runs the hot part of the per frame entity update, moving t-cells, growing text boxes and particles and 
+ * testing resolved body sizes against the view, over 128, 10k and 100k copies of the resident entities. 
+ * Once on entity_data records as g_entities used to be and once on parallel arrays like g_entity_store. */
+void benchmark_entity_layouts()
+{
+    #define BENCHMARK_ENTITIES_COUNT_MAX 100000
+    #define BENCHMARK_ENTITY_FRAMES 60
+    static entity_data records[BENCHMARK_ENTITIES_COUNT_MAX];
+    static entity_type types[BENCHMARK_ENTITIES_COUNT_MAX];
+    static f32 positions_x[BENCHMARK_ENTITIES_COUNT_MAX];
+    static f32 positions_y[BENCHMARK_ENTITIES_COUNT_MAX];
+    static fvec3 growth_sizes1[BENCHMARK_ENTITIES_COUNT_MAX];
+    static b8 should_grow[BENCHMARK_ENTITIES_COUNT_MAX];
+    u32 entities_counts[3] = { 128, 10000, 100000 };
+    if (g_entity_store.count == 0)
+    {
+        return;
+    }
+    u32 source = entity_first();
+
+    f32 delta_time = 1.0f / 60.0f;
+    fvec3 growth_weights = growth_factor_to_weights(g_player.growth_factor);
+    fvec2 view_min = g_world.camera;
+    fvec2 view_max = { g_world.camera.x + (f32)WORLD_CHUNK_WIDTH, g_world.camera.y + (f32)WORLD_CHUNK_HEIGHT };
+    for (u32 i = 0; i < 3; ++i)
+    {
+        u32 entities_count = entities_counts[i];
+        for (u32 j = 0; j < entities_count; ++j)
+        {
+            records[j] = entity_get(source);
+            source = entity_next(source);
+            source = source < g_entity_store.end ? source : entity_first();
+            types[j] = records[j].type;
+            positions_x[j] = records[j].position.x;
+            positions_y[j] = records[j].position.y;
+            growth_sizes1[j] = records[j].growth_sizes1;
+            should_grow[j] = records[j].should_grow;
+        }
+
+        u32 visible_records = 0;
+        f64 start = profile_time_ms();
+        for (u32 frame = 0; frame < BENCHMARK_ENTITY_FRAMES; ++frame)
+        {
+            for (u32 j = 0; j < entities_count; ++j)
+            {
+                entity_data* entity = &records[j];
+                if (entity->type == ENTITY_TYPE_T_CELL)
+                {
+                    entity->position.x += NAV_CHASE_SPEED * delta_time;
+                }
+                else if (entity->type == ENTITY_TYPE_PARTICLES || entity->type == ENTITY_TYPE_BOX_TEXT)
+                {
+                    b8 grow = (entity->type == ENTITY_TYPE_PARTICLES || entity->should_grow) ? TRUE : FALSE;
+                    entity->growth_sizes1.z = math_clamp(entity->growth_sizes1.z + (grow ? delta_time : -delta_time) * 2.0f, 0.0f, 1.0f);
+                }
+
+                f32 size = f32_abs(fvec3_dot(growth_weights, entity->growth_sizes1));
+                if (entity->position.x + size >= view_min.x && entity->position.x - size <= view_max.x &&
+                    entity->position.y + size >= view_min.y && entity->position.y - size <= view_max.y)
+                {
+                    visible_records += 1;
+                }
+            }
+        }
+        f64 time_records = (profile_time_ms() - start) / (f64)BENCHMARK_ENTITY_FRAMES;
+
+        u32 visible_arrays = 0;
+        start = profile_time_ms();
+        for (u32 frame = 0; frame < BENCHMARK_ENTITY_FRAMES; ++frame)
+        {
+            for (u32 j = 0; j < entities_count; ++j)
+            {
+                entity_type type = types[j];
+                if (type == ENTITY_TYPE_T_CELL)
+                {
+                    positions_x[j] += NAV_CHASE_SPEED * delta_time;
+                }
+                else if (type == ENTITY_TYPE_PARTICLES || type == ENTITY_TYPE_BOX_TEXT)
+                {
+                    b8 grow = (type == ENTITY_TYPE_PARTICLES || should_grow[j]) ? TRUE : FALSE;
+                    growth_sizes1[j].z = math_clamp(growth_sizes1[j].z + (grow ? delta_time : -delta_time) * 2.0f, 0.0f, 1.0f);
+                }
+
+                f32 size = f32_abs(fvec3_dot(growth_weights, growth_sizes1[j]));
+                if (positions_x[j] + size >= view_min.x && positions_x[j] - size <= view_max.x &&
+                    positions_y[j] + size >= view_min.y && positions_y[j] - size <= view_max.y)
+                {
+                    visible_arrays += 1;
+                }
+            }
+        }
+        f64 time_arrays = (profile_time_ms() - start) / (f64)BENCHMARK_ENTITY_FRAMES;
+
+        assert(visible_records == visible_arrays);
+        printf("Entity update, %u entities: records %.4fms, arrays %.4fms per frame, %u visible\n", 
+            entities_count, time_records, time_arrays, visible_arrays / BENCHMARK_ENTITY_FRAMES);
+    }
+    #undef BENCHMARK_ENTITIES_COUNT_MAX
+    #undef BENCHMARK_ENTITY_FRAMES
+}
+/* Packs 128 and 10k copies of the resident primitives like the cull fills the GPU lists, a value at a time and with 
+ * sdf_primitive_pack, and unpacks them again. Reports what a frame rewriting every slot uploads either way and the 
+ * largest round trip error, sizes relative to the size. */
+void benchmark_primitive_packing()
+{
+    #define BENCHMARK_PACK_COUNT_MAX 10000
+    #define BENCHMARK_PACK_REPEATS 100
+    static sdf_primitive primitives[BENCHMARK_PACK_COUNT_MAX];
+    static sdf_primitive_packed packed_reference[BENCHMARK_PACK_COUNT_MAX];
+    static sdf_primitive_packed packed[BENCHMARK_PACK_COUNT_MAX];
+    static sdf_primitive unpacked[BENCHMARK_PACK_COUNT_MAX];
+    u32 primitives_counts[2] = { 128, 10000 };
+    u32 resident_count = g_resident_level_primitives_count + g_resident_overlay_primitives_count;
+    if (resident_count == 0)
+    {
+        return;
+    }
+
+    fvec2 origin = world_primitives_origin();
+    for (u32 i = 0; i < 2; ++i)
+    {
+        u32 primitives_count = primitives_counts[i];
+        for (u32 j = 0; j < primitives_count; ++j)
+        {
+            u32 source = j % resident_count;
+            primitives[j] = source < g_resident_level_primitives_count ? 
+                g_resident_level_primitives[source] : g_resident_overlay_primitives[source - g_resident_level_primitives_count];
+        }
+
+        f64 start = profile_time_ms();
+        for (u32 repeat = 0; repeat < BENCHMARK_PACK_REPEATS; ++repeat)
+        {
+            for (u32 j = 0; j < primitives_count; ++j)
+            {
+                sdf_primitive_pack_reference(&primitives[j], origin, &packed_reference[j]);
+            }
+        }
+        f64 time_reference = (profile_time_ms() - start) / (f64)BENCHMARK_PACK_REPEATS;
+
+        start = profile_time_ms();
+        for (u32 repeat = 0; repeat < BENCHMARK_PACK_REPEATS; ++repeat)
+        {
+            for (u32 j = 0; j < primitives_count; ++j)
+            {
+                sdf_primitive_pack(&primitives[j], origin, &packed[j]);
+            }
+        }
+        f64 time_pack = (profile_time_ms() - start) / (f64)BENCHMARK_PACK_REPEATS;
+
+        start = profile_time_ms();
+        for (u32 repeat = 0; repeat < BENCHMARK_PACK_REPEATS; ++repeat)
+        {
+            for (u32 j = 0; j < primitives_count; ++j)
+            {
+                sdf_primitive_unpack(&packed[j], origin, &unpacked[j]);
+            }
+        }
+        f64 time_unpack = (profile_time_ms() - start) / (f64)BENCHMARK_PACK_REPEATS;
+
+        u32 mismatches = 0;
+        f32 position_error = 0.0f;
+        f32 size_error = 0.0f;
+        for (u32 j = 0; j < primitives_count; ++j)
+        {
+            mismatches += memcmp(&packed[j], &packed_reference[j], sizeof(sdf_primitive_packed)) != 0 ? 1 : 0;
+            position_error = math_max(position_error, fvec2_len(fvec2_sub(unpacked[j].position, primitives[j].position)));
+            f32 const* sizes = &primitives[j].growth_sizes1.x;
+            f32 const* sizes_unpacked = &unpacked[j].growth_sizes1.x;
+            for (u32 k = 0; k < 6; ++k)
+            {
+                size_error = math_max(size_error, f32_abs(sizes_unpacked[k] - sizes[k]) / math_max(f32_abs(sizes[k]), 1.0f));
+            }
+        }
+
+        assert(mismatches == 0);
+        printf("Primitive packing, %u primitives: %u bytes unpacked, %u packed per upload, pack reference %.4fms, pack %.4fms, unpack %.4fms, %u mismatches, error position %.3f size %.5f\n", 
+            primitives_count, primitives_count * (u32)sizeof(sdf_primitive), primitives_count * (u32)sizeof(sdf_primitive_packed), 
+            time_reference, time_pack, time_unpack, mismatches, position_error, size_error);
+    }
+    #undef BENCHMARK_PACK_COUNT_MAX
+    #undef BENCHMARK_PACK_REPEATS
+}
+
+/* Particle throughput for bursts of 32, 1024 and 16384 particles, about 48k particles in total each time. 
+ * Bursts are spawned next to the player, emitted and then simulated for most of their life by the particle system. */
+void benchmark_particles()
+{
+    #define BENCHMARK_PARTICLES_TOTAL 49152
+    #define BENCHMARK_PARTICLES_FRAMES 29 /* Bursts finish after 30 frames at 60Hz. */
+    static entity_handle handles[BENCHMARK_PARTICLES_TOTAL / 32];
+    u32 burst_counts[3] = { 32, 1024, 16384 };
+    f32 delta_time = 1.0f / 60.0f;
+
+    for (u32 i = 0; i < 3; ++i)
+    {
+        u32 burst_count = burst_counts[i];
+        u32 bursts_count = BENCHMARK_PARTICLES_TOTAL / burst_count;
+        entity_data particles;
+        memzero(&particles, sizeof(particles));
+        particles.type = ENTITY_TYPE_PARTICLES;
+        for (u32 j = 0; j < bursts_count; ++j)
+        {
+            particles.position = { g_player.position.x + (f32)(j % 64) * 8.0f, g_player.position.y + (f32)(j / 64) * 8.0f };
+            handles[j] = entity_spawn(&particles);
+        }
+
+        u64 emitted = g_particles.emitted;
+        f64 start = profile_time_ms();
+        for (u32 j = 0; j < bursts_count; ++j)
+        {
+            particles_emit(entity_index(handles[j]), burst_count);
+        }
+        f64 time_emit = profile_time_ms() - start;
+        emitted = g_particles.emitted - emitted;
+
+        u32 overlay_count = g_resident_overlay_primitives_count;
+        u64 simulated = g_particles.simulated;
+        start = profile_time_ms();
+        for (u32 frame = 0; frame < BENCHMARK_PARTICLES_FRAMES; ++frame)
+        {
+            entity_system_particles(delta_time);
+            g_resident_overlay_primitives_count = overlay_count;
+        }
+        f64 time_simulate = (profile_time_ms() - start) / (f64)BENCHMARK_PARTICLES_FRAMES;
+        f64 simulated_per_frame = (f64)(g_particles.simulated - simulated) / (f64)BENCHMARK_PARTICLES_FRAMES;
+
+        /* One more update without time passing drops the particles of the despawned bursts. */
+        for (u32 j = 0; j < bursts_count; ++j)
+        {
+            entity_despawn(handles[j]);
+        }
+        entity_system_particles(0.0f);
+        g_resident_overlay_primitives_count = overlay_count;
+        printf("Particles, %u bursts of %u: emit %.4fms %.1f particles/ms, simulate %.4fms per frame %.1f particles/ms, %u bytes uploaded per frame\n", 
+            bursts_count, burst_count, time_emit, (f64)emitted / math_max(time_emit, 0.0001), 
+            time_simulate, simulated_per_frame / math_max(time_simulate, 0.0001), (u32)(simulated_per_frame * (f64)sizeof(particle_packed)));
+    }
+    #undef BENCHMARK_PARTICLES_TOTAL
+    #undef BENCHMARK_PARTICLES_FRAMES
+}
+
+/* Crowd update of 1k and 10k maggots spread over the world, which is as crowded as a single level gets, 
+ * against the walls of the current collision snapshot. Pickups are off so every agent stays for all frames. */
+void benchmark_crowd()
+{
+    #define BENCHMARK_CROWD_FRAMES 60
+    static entity_handle handles[10000];
+    u32 agents_counts[2] = { 1000, 10000 };
+    f32 delta_time = 1.0f / 60.0f;
+    fvec3 growth_weights = growth_factor_to_weights(g_player.growth_factor);
+    b8 enable_input = g_player.enable_input;
+    b8 is_wandering = g_crowd.is_wandering;
+    g_player.enable_input = FALSE;
+    g_crowd.is_wandering = TRUE;
+
+    for (u32 i = 0; i < 2; ++i)
+    {
+        u32 agents_count = agents_counts[i];
+        entity_data maggot;
+        memzero(&maggot, sizeof(maggot));
+        maggot.type = ENTITY_TYPE_MAGGOT;
+        maggot.growth_sizes1 = { 10.0f, 10.0f, 10.0f };
+        for (u32 j = 0; j < agents_count; ++j)
+        {
+            maggot.position.x = sdf_fract((f32)j * 0.6180339f) * g_world.size.x;
+            maggot.position.y = sdf_fract((f32)j * 0.7548777f) * g_world.size.y;
+            handles[j] = entity_spawn(&maggot);
+        }
+
+        crowd_data stats = g_crowd;
+        u32 level_count = g_resident_level_primitives_count;
+        f64 start = profile_time_ms();
+        for (u32 frame = 0; frame < BENCHMARK_CROWD_FRAMES; ++frame)
+        {
+            entity_system_maggots(delta_time, growth_weights);
+            g_resident_level_primitives_count = level_count;
+        }
+        f64 time = (profile_time_ms() - start) / (f64)BENCHMARK_CROWD_FRAMES;
+        f64 frames = (f64)BENCHMARK_CROWD_FRAMES;
+
+        for (u32 j = 0; j < agents_count; ++j)
+        {
+            entity_despawn(handles[j]);
+        }
+        printf("Crowd, %u agents: %.4fms per frame, sort %.4fms, separation %.4fms, walls %.4fms, move %.4fms, %u buckets\n", 
+            g_crowd.count, time, (g_crowd.sort_time_ms - stats.sort_time_ms) / frames, (g_crowd.separation_time_ms - stats.separation_time_ms) / frames, 
+            (g_crowd.walls_time_ms - stats.walls_time_ms) / frames, (g_crowd.move_time_ms - stats.move_time_ms) / frames, g_crowd.buckets_count);
+    }
+    g_player.enable_input = enable_input;
+    g_crowd.is_wandering = is_wandering;
+    #undef BENCHMARK_CROWD_FRAMES
+}
+
+/* Bins the current view many times and compares the primitives per tile to the full lists every pixel used to loop. */
+void benchmark_bins()
+{
+    #define BENCHMARK_BINS_ITERATIONS 1000
+    sdf_bins_stats stats = g_bins_stats;
+    f64 start = profile_time_ms();
+    for (u32 i = 0; i < BENCHMARK_BINS_ITERATIONS; ++i)
+    {
+        sdf_bins_build(g_world.camera, g_player.growth_factor);
+    }
+    f64 time = (profile_time_ms() - start) / (f64)BENCHMARK_BINS_ITERATIONS;
+
+    u32 tiles_used = 0;
+    u32 tile_max = 0;
+    for (u32 tile = 0; tile < SDF_BIN_TILES_COUNT; ++tile)
+    {
+        u32 count = g_level_bins.offsets[tile + 1] - g_level_bins.offsets[tile] + g_overlay_bins.offsets[tile + 1] - g_overlay_bins.offsets[tile];
+        tiles_used += count > 0 ? 1 : 0;
+        tile_max = math_max(tile_max, count);
+    }
+    u32 indices = g_level_bins.offsets[SDF_BIN_TILES_COUNT] + g_overlay_bins.offsets[SDF_BIN_TILES_COUNT];
+    f64 primitives = (f64)(g_bins_stats.primitives - stats.primitives) / (f64)BENCHMARK_BINS_ITERATIONS;
+    printf("Tile bins: %.4fms per build, %.1f primitives per pixel before, %.2f per tile on average and %u at most, %u of %u tiles used, %u bytes to upload\n", 
+        time, primitives, (f64)indices / (f64)SDF_BIN_TILES_COUNT, tile_max, tiles_used, SDF_BIN_TILES_COUNT, 
+        (sdf_bins_words_count(&g_level_bins) + sdf_bins_words_count(&g_overlay_bins)) * (u32)sizeof(u32));
+    #undef BENCHMARK_BINS_ITERATIONS
+}
+
+/* Compares the noise atlas against the procedural noise it was baked from and times both. noise_value is compared
+ * where the atlas is exact, the sample_noise weights over several periods of the offset. */
+void benchmark_noise()
+{
+    #define BENCHMARK_NOISE_QUERIES 1000000
+    static f32 baked[BENCHMARK_NOISE_QUERIES];
+    static f32 procedural[BENCHMARK_NOISE_QUERIES];
+
+    f64 start = profile_time_ms();
+    for (u32 i = 0; i < BENCHMARK_NOISE_QUERIES; ++i)
+    {
+        fvec2 position = { sdf_fract((f32)i * 0.6180339f) * (f32)(NOISE_ATLAS_SIZE - 1), sdf_fract((f32)i * 0.7548777f) * (f32)(NOISE_ATLAS_SIZE - 1) };
+        procedural[i] = noise_value(position, 0.0f);
+    }
+    f64 time_value_procedural = profile_time_ms() - start;
+    start = profile_time_ms();
+    for (u32 i = 0; i < BENCHMARK_NOISE_QUERIES; ++i)
+    {
+        fvec2 position = { sdf_fract((f32)i * 0.6180339f) * (f32)(NOISE_ATLAS_SIZE - 1), sdf_fract((f32)i * 0.7548777f) * (f32)(NOISE_ATLAS_SIZE - 1) };
+        baked[i] = noise_value_baked(position, 0.0f);
+    }
+    f64 time_value_baked = profile_time_ms() - start;
+    f32 value_error = 0.0f;
+    for (u32 i = 0; i < BENCHMARK_NOISE_QUERIES; ++i)
+    {
+        value_error = math_max(value_error, f32_abs(baked[i] - procedural[i]));
+    }
+
+    start = profile_time_ms();
+    for (u32 i = 0; i < BENCHMARK_NOISE_QUERIES; ++i)
+    {
+        fvec4 weights = noise_weights_procedural((f32)i * 0.00001f);
+        procedural[i] = weights.x + weights.y + weights.z + weights.w;
+    }
+    f64 time_weights_procedural = profile_time_ms() - start;
+    start = profile_time_ms();
+    for (u32 i = 0; i < BENCHMARK_NOISE_QUERIES; ++i)
+    {
+        fvec4 weights = noise_weights((f32)i * 0.00001f);
+        baked[i] = weights.x + weights.y + weights.z + weights.w;
+    }
+    f64 time_weights_baked = profile_time_ms() - start;
+    f32 weights_error = 0.0f;
+    for (u32 i = 0; i < BENCHMARK_NOISE_QUERIES; ++i)
+    {
+        fvec4 weights_procedural = noise_weights_procedural((f32)i * 0.00001f);
+        fvec4 weights = noise_weights((f32)i * 0.00001f);
+        for (u32 channel = 0; channel < 4; ++channel)
+        {
+            weights_error = math_max(weights_error, f32_abs(weights.data[channel] - weights_procedural.data[channel]));
+        }
+    }
+
+    printf("Noise, %u queries: noise_value %.3fms baked %.3fms error %.7f, sample_noise weights %.3fms baked %.3fms error %.7f, atlas %u bytes\n",
+        BENCHMARK_NOISE_QUERIES, time_value_procedural, time_value_baked, value_error, time_weights_procedural, time_weights_baked, weights_error, (u32)sizeof(g_noise_atlas));
+    #undef BENCHMARK_NOISE_QUERIES
+}
+#endif
+
+#endif
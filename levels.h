@@ -2345,6 +2345,9 @@ void level_load(u32 i_num)
     memzero(&g_entities, sizeof(g_entities));
     memzero(&g_level_primitives, sizeof(g_level_primitives));
     memzero(&g_overlay_primitives, sizeof(g_overlay_primitives));
+    g_resident_level_primitives_count = 0;
+    g_resident_overlay_primitives_count = 0;
+    sdf_collision_snapshot_clear();
 
     g_background_type = BACKGROUND_TYPE_LEVEL;
     g_player.growth_state = 1;
@@ -2373,22 +2376,22 @@ void level_load(u32 i_num)
         case 6: level_load_6(); break;
         case 7: level_load_7(); break;
     }
+
+    /* Levels are single chunk worlds. */
+    world_from_entities(1, 1);
+    world_update_camera(g_player.position);
 }
 
 void level_print()
 {
     printf("g_player.position = { %f, %f };\n", g_player.position.x, g_player.position.y);
-    for (u32 i = 0; i < ENTITIES_COUNT_MAX; ++i)
+    for (u32 i = entity_first(); i < g_entity_store.end; i = entity_next(i))
     {
-        if (g_entities[i].type == ENTITY_TYPE_INVALID)
-        {
-            break;
-        }
-
-        printf("g_entities[%u].type = (entity_type)%u;\n", i, g_entities[i].type);
-        printf("g_entities[%u].position = { %ff, %ff };\n", i, g_entities[i].position.x, g_entities[i].position.y);
-        printf("g_entities[%u].growth_sizes1 = { %ff, %ff, %ff };\n", i, g_entities[i].growth_sizes1.x, g_entities[i].growth_sizes1.y, g_entities[i].growth_sizes1.z);
-        printf("g_entities[%u].growth_sizes2 = { %ff, %ff, %ff };\n", i, g_entities[i].growth_sizes2.x, g_entities[i].growth_sizes2.y, g_entities[i].growth_sizes2.z);
+        entity_data entity = entity_get(i);
+        printf("g_entities[%u].type = (entity_type)%u;\n", i, entity.type);
+        printf("g_entities[%u].position = { %ff, %ff };\n", i, entity.position.x, entity.position.y);
+        printf("g_entities[%u].growth_sizes1 = { %ff, %ff, %ff };\n", i, entity.growth_sizes1.x, entity.growth_sizes1.y, entity.growth_sizes1.z);
+        printf("g_entities[%u].growth_sizes2 = { %ff, %ff, %ff };\n", i, entity.growth_sizes2.x, entity.growth_sizes2.y, entity.growth_sizes2.z);
     }
 }
 
@@ -2407,6 +2410,8 @@ void level_next()
     g_level.is_transition = TRUE;
 }
 
+/* The offline tools load levels without a window. */
+#if !defined(GAME_HEADLESS)
 void level_update(window_ctx* i_window, f32 i_delta_time)
 {
     if (g_level.is_transition)
@@ -2484,8 +2489,8 @@ void level_update(window_ctx* i_window, f32 i_delta_time)
                     window_key_pressed(i_window, KEY_E)
                 )
                 {
-                    if (g_level.dialogue_num == 0) g_entities[0].sprite_index[1] = 5.25f;
-                    if (g_level.dialogue_num == 2) g_entities[0].sprite_index[1] = 8.05f;
+                    if (g_level.dialogue_num == 0) entity_set_sprite_index(0, 1, 5.25f);
+                    if (g_level.dialogue_num == 2) entity_set_sprite_index(0, 1, 8.05f);
                     g_level.dialogue_num += 1;
                 }
             }
@@ -2495,7 +2500,7 @@ void level_update(window_ctx* i_window, f32 i_delta_time)
             ))
             {
                 g_level.dialogue_num += 1;
-                g_entities[0].sprite_index[1] = 6.75f;
+                entity_set_sprite_index(0, 1, 6.75f);
             }
             else if (g_level.dialogue_num == 3 && (
                 window_key_pressed(i_window, KEY_W) ||
@@ -2508,8 +2513,8 @@ void level_update(window_ctx* i_window, f32 i_delta_time)
                 window_key_pressed(i_window, KEY_RIGHT)
             ))
             {
-                g_entities[0].should_grow = FALSE;
-                g_entities[1].is_talking = FALSE;
+                g_entity_store.should_grow[0] = FALSE;
+                g_entity_store.is_talking[1] = FALSE;
             }
         } break;
         case 7: {
@@ -2530,3 +2535,4 @@ void level_update(window_ctx* i_window, f32 i_delta_time)
         } break;
     }
 }
+#endif
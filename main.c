@@ -220,10 +220,13 @@ typedef struct {
     graphics_filter_type filter;
     graphics_warp_type wrap_u;
     graphics_warp_type wrap_v;
+    b8_t is_dynamic; /* Can be updated with graphics_image_update, immutable otherwise. */
 } graphics_image_desc;
 
 typedef struct {
+    graphics_d3d11_ctx context;
     DXGI_FORMAT format;
+    u32_t pitch;
     ID3D11Texture2D* texture_2d;
     ID3D11ShaderResourceView* shader_resource_view;
     ID3D11SamplerState* sampler_state; /* TODO: Should this really be part of the image instead of shader? */
@@ -328,9 +331,11 @@ void graphics_buffer_update(graphics_buffer* i_buffer, void* i_data, size_t i_si
 graphics_structured_buffer graphics_structured_buffer_create(graphics_d3d11_ctx* i_d3d11_ctx, graphics_structured_buffer_desc i_desc);
 void graphics_structured_buffer_destory(graphics_structured_buffer* io_buffer);
 void graphics_structured_buffer_update(graphics_structured_buffer* i_buffer, void* i_data, size_t i_size);
+void graphics_structured_buffer_update_range(graphics_structured_buffer* i_buffer, void* i_data, sz_t i_first, sz_t i_count);
 
 graphics_image graphics_image_create(graphics_d3d11_ctx* i_d3d11_ctx, graphics_image_desc i_desc);
 void graphics_image_destroy(graphics_image* io_image);
+void graphics_image_update(graphics_image* i_image, void* i_data);
 
 graphics_shader graphics_shader_create(graphics_d3d11_ctx* i_d3d11_ctx, graphics_shader_desc i_desc);
 void graphics_shader_destroy(graphics_shader* io_shader);
@@ -442,221 +447,27 @@ typedef struct {
 typedef struct {
     fmat44 model_view_projection;
     fvec2 render_size;
+    fvec2 position; /* Top left of the view in the world. */
+    fvec2 primitives_origin; /* See world_primitives_origin. */
+    fvec2 pad;
+    fvec4 noise_weights_time; /* noise_weights of c_player_time and of a tenth of it, see sample_noise. */
+    fvec4 noise_weights_tenth;
 } camera_data;
 
-typedef enum {
-    BACKGROUND_TYPE_CREDITS = 0,
-    BACKGROUND_TYPE_MAIN_MENU,
-    BACKGROUND_TYPE_LEVEL,
-    BACKGROUND_TYPE_END,
-    _BACKGROUND_TYPE_COUNT,
-    _BACKGROUND_TYPE_MAX = 0xFF
-} background_type;
-background_type g_background_type;
-
-typedef struct {
-    fvec2 position;
-    fvec2 debug;
-    f32 radius;
-    u32 growth_state;
-    f32 growth_factor; /* 0-1, range splits into thirds. */
-    f32 time;
-    u32 level_edit_object;
-    f32 screen_fade;
-    f32 scale;
-    u32 maggots;
-    u32 deaths;
-    b8 is_dead;
-    b8 enable_input;
-} player_data;
-player_data g_player;
-
-typedef enum
-{
-    ENTITY_TYPE_INVALID = 0,
-    ENTITY_TYPE_TUMOR,
-    ENTITY_TYPE_T_CELL,
-    ENTITY_TYPE_WALL,
-    ENTITY_TYPE_PORTAL,
-    ENTITY_TYPE_MAGGOT,
-    ENTITY_TYPE_PARTICLES,
-    ENTITY_TYPE_BOX_TEXT,
-    ENTITY_TYPE_MOTHER,
-    _ENTITY_TYPE_COUNT,
-    _ENTITY_TYPE_MAX = 0xFF,
-} entity_type;
-
-typedef struct {
-    entity_type type;
-    fvec2 position;
-    fvec3 growth_sizes1;
-    fvec3 growth_sizes2;
-    f32 sprite_index[2];
-    f32 timer;
-    b8 should_grow;
-    b8 is_talking;
-} entity_data;
-
-#define ENTITIES_COUNT_MAX 128 
-entity_data g_entities[ENTITIES_COUNT_MAX];
-sz g_entities_count;
-
-/* Defines so we can share these with the shader as a nice trick. */
-#define SDF_PRIMITIVES_COUNT_MAX        128
-#define SDF_PRIMITIVE_INVALID           0
-#define SDF_PRIMITIVE_CIRCLE            1
-#define SDF_PRIMITIVE_SPIKED_CIRCLE     2
-#define SDF_PRIMITIVE_BOX               3
-#define SDF_PRIMITIVE_BOX_TEXTURED      4
-#define SDF_PRIMITIVE_BOX_TEXT          5
-#define SDF_PRIMITIVE_BOX_FLOWER        6
-#define SDF_PRIMITIVE_PORTAL            7
-#define SDF_PRIMITIVE_MAGGOT            8
-#define SDF_PRIMITIVE_PARTICLES         9
-
-typedef struct {
-    /* Packing of this struct is important as it will be send to the GPU. */
-    u32 type;
-    u32 entity;
-    fvec3 growth_sizes1; /* Or x: size.x, y: pad, z: scale */
-    fvec3 growth_sizes2; /* Or x: size.y, y: pad, z: pad */
-    fvec2 position;
-    f32 sprite_index[2];
-} sdf_primitive;
-
-sdf_primitive g_level_primitives[SDF_PRIMITIVES_COUNT_MAX];
-sdf_primitive g_overlay_primitives[SDF_PRIMITIVES_COUNT_MAX];
-
-#define LEVEL_WIDTH 1600
-#define LEVEL_HEIGHT 900
-
-#define SDF_RESULT_DISTANCE_INVALID 999999
-#define SDF_RESULT_OBJECT_INVALID 0xFFFFFF
-
-typedef struct {
-    f32 distance;
-    u32 closest_object;
-    f32 overlapped_distance;
-    u32 overlapped_object;
-} sdf_result;
-
-f32 sdf_circle(fvec2 i_position, f32 i_radius)
-{
-    return fvec2_len(i_position) - i_radius;
-}
-
-f32 sdf_box(fvec2 i_position, fvec2 i_size)
-{
-    fvec2 d = fvec2_sub(fvec2_abs(i_position), i_size);
-    fvec2 c = { math_max(d.x, 0.0f), math_max(d.y, 0.0f) };
-    return fvec2_len(c) + math_min(math_max(d.x, d.y), 0.0f);
-}
-
-f32 lerp_growth_factors(fvec3 i_sizes, f32 i_factor)
-{
-    f32 f = i_factor;
-    if (f >= 0.0f/3.0f && f < 1.0f/3.0f)            return f32_lerp(i_sizes.x, i_sizes.y, (f - 0.0f/3.0f) * 3.0f);
-    else if (f >= 1.0f/3.0f && f < 2.0f/3.0f)       return f32_lerp(i_sizes.y, i_sizes.z, (f - 1.0f/3.0f) * 3.0f);
-    else/* if (f >= 2.0f/3.0f && f < 3.0f/3.0f) */  return f32_lerp(i_sizes.z, i_sizes.x, (f - 2.0f/3.0f) * 3.0f);
-}
-
-sdf_result sdf_get_distance(fvec2 i_position, f32 growth_factor, f32 i_time)
-{
-    sdf_result result;
-    result.distance = SDF_RESULT_DISTANCE_INVALID;
-    result.closest_object = SDF_RESULT_OBJECT_INVALID;
-    result.overlapped_distance = SDF_RESULT_DISTANCE_INVALID;
-    result.overlapped_object = SDF_RESULT_OBJECT_INVALID;
-
-    (void)i_time;
+/* The game itself is platform independent so the tools can share it. */
+#include "game.h"
 
-    for (u32 i = 0; i < SDF_PRIMITIVES_COUNT_MAX; ++i)
-    {
-        float prev_distance = result.distance;
-        float prev_overlapped_distance = result.overlapped_distance;
-
-        /* Invalid means end of the list has been reached. */
-        sdf_primitive* primitive = &g_level_primitives[i];
-        if (primitive->type == SDF_PRIMITIVE_INVALID)
-        {
-            break;
-        }
-
-        f32 growth_size1 = lerp_growth_factors(primitive->growth_sizes1, growth_factor);
-        f32 growth_size2 = lerp_growth_factors(primitive->growth_sizes2, growth_factor);
-
-        /* Disable collision for 0 sized objects. */
-        if (growth_size1 <= 0.0f) {
-          continue;
-        }
-
-        /* Calculate the distance to this sdf shape. */
-        switch (primitive->type)
-        {
-            case SDF_PRIMITIVE_CIRCLE: 
-            {
-                if (growth_size1 != 0.0f)
-                {
-                    /* Use a smooth min to help with collision resolution. Correct for 0 sized objects. */
-                    f32 distance = sdf_circle(fvec2_sub(primitive->position, i_position), growth_size1);
-                    result.distance = f32_min_smooth(result.distance, distance, 10.0f);
-                }
-            } break;
-            case SDF_PRIMITIVE_SPIKED_CIRCLE: 
-            {
-                if (growth_size1 != 0.0f)
-                {
-                    /* Use a smooth min to help with collision resolution. Correct for 0 sized objects. 
-                     * Adjust size to account for effects. */
-                    f32 size = growth_size1;
-                    f32 distance = sdf_circle(fvec2_sub(primitive->position, i_position), size);
-                    result.distance = f32_min_smooth(result.distance, distance, 10.0f);
-                }
-            } break;
-            case SDF_PRIMITIVE_BOX: 
-            {
-                /* Adjust size to account for effects. */
-                fvec2 size = fvec2{ growth_size1 * 0.85f, growth_size2 * 0.85f };
-                f32 distance = sdf_box(fvec2_sub(primitive->position, i_position), size);
-                result.distance = math_min(result.distance, distance);
-            } break;
-            case SDF_PRIMITIVE_PORTAL:
-            {
-                f32 distance = sdf_circle(fvec2_sub(primitive->position, i_position), growth_size1);
-                result.overlapped_distance = math_min(result.overlapped_distance, distance);
-            } break;
-            case SDF_PRIMITIVE_MAGGOT:
-            {
-                f32 distance = sdf_circle(fvec2_sub(primitive->position, i_position), growth_size1);
-                result.overlapped_distance = math_min(result.overlapped_distance, distance);
-            } break;
-        }
-
-        /* Track the closest object for hit detection. */
-        if (prev_distance > result.distance) {
-            result.closest_object = i;
-        }
-        if (prev_overlapped_distance > result.overlapped_distance) {
-            result.overlapped_object = i;
-        }
-    }
-
-    result.distance -= g_player.radius;
-    result.overlapped_distance -= g_player.radius;
-    return result;
-}
+/* --------------------------------------------------
+   Profiling 
+   -------------------------------------------------- */
 
-fvec2 sdf_get_surface_normal(fvec2 i_position, f32 growth_factor, f32 i_time)
+f64 profile_time_ms()
 {
-    f32 epsilon = 10.0f; /* Rather large sample distance to get around the non continuous sdf interior. */
-    f32 x1 = sdf_get_distance({ i_position.x + epsilon, i_position.y }, growth_factor, i_time).distance; 
-    f32 x2 = sdf_get_distance({ i_position.x - epsilon, i_position.y }, growth_factor, i_time).distance;
-    f32 y1 = sdf_get_distance({ i_position.x, i_position.y + epsilon }, growth_factor, i_time).distance;
-    f32 y2 = sdf_get_distance({ i_position.x, i_position.y - epsilon }, growth_factor, i_time).distance;
-
-    f32 x_gradient = x1 - x2;
-    f32 y_gradient = y1 - y2;
-    return fvec2_norm({ x_gradient, y_gradient }); 
+    LARGE_INTEGER counter;
+    LARGE_INTEGER frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (f64)counter.QuadPart * 1000.0 / (f64)frequency.QuadPart;
 }
 
 /* --------------------------------------------------
@@ -664,13 +475,13 @@ fvec2 sdf_get_surface_normal(fvec2 i_position, f32 growth_factor, f32 i_time)
    -------------------------------------------------- */
 
 /* Who needs a resource loading system if you can just hard code it into the binary. */
-#include "assets/noise_texture.h"
 #include "assets/credits_texture.h"
 #include "assets/main_menu_texture.h"
 #include "assets/background_texture.h"
 #include "assets/end_texture.h"
 #include "assets/spritesheet_texture.h"
 #include "assets/music.h"
+
 #include "assets/sound_heartbeat.h"
 #include "assets/sound_maggot.h"
 #include "assets/sound_death.h"
@@ -711,12 +522,20 @@ int WINAPI WinMain(
         {
             float4x4 c_camera_model_view_projection;
             float2 c_camera_render_size;
+            float2 c_camera_position;
+            float2 c_camera_primitives_origin;
+            float4 c_camera_noise_weights_time;
+            float4 c_camera_noise_weights_tenth;
         };
 
         struct VOut
         {
             float4 position : SV_POSITION;
             float2 uv : UV;
+            float2 world_uv : WORLD_UV;
+            nointerpolation float2 primitives_origin : PRIMITIVES_ORIGIN;
+            nointerpolation float4 noise_weights_time : NOISE_WEIGHTS_TIME;
+            nointerpolation float4 noise_weights_tenth : NOISE_WEIGHTS_TENTH;
             float4 color : COLOR;
         };
 
@@ -725,6 +544,10 @@ int WINAPI WinMain(
             VOut output;
             output.position = mul(position, c_camera_model_view_projection);
             output.uv = uv * c_camera_render_size;
+            output.world_uv = output.uv + c_camera_position;
+            output.primitives_origin = c_camera_primitives_origin;
+            output.noise_weights_time = c_camera_noise_weights_time;
+            output.noise_weights_tenth = c_camera_noise_weights_tenth;
             output.color = color;
             return output;
         }
@@ -755,6 +578,9 @@ int WINAPI WinMain(
         Texture2D spritesheet_texture : register(t2);
         SamplerState spritesheet_sampler;
 
+        /* See hud_image on the CPU, the HUD icons for the current counters. */
+        Texture2D hud_texture : register(t3);
+
         struct sdf_primitive 
         {
             uint type;
@@ -763,9 +589,44 @@ int WINAPI WinMain(
             float3 growth_sizes2;
             float2 position;
             float2 sprite_index;
+            uint2 particles; /* First and count of the burst, particles only. */
+        };
+
+        /* See sdf_primitive_packed on the CPU. */
+        struct sdf_primitive_packed
+        {
+            uint type_sprite;
+            uint3 growth_sizes;
+            uint position;
         };
-        StructuredBuffer<sdf_primitive> sdf_level_primitives : register(t3);
-        StructuredBuffer<sdf_primitive> sdf_overlay_primitives : register(t4);
+        StructuredBuffer<sdf_primitive_packed> sdf_level_primitives : register(t4);
+        StructuredBuffer<sdf_primitive_packed> sdf_overlay_primitives : register(t5);
+
+        /* See particle_packed on the CPU, the particles of a burst are a range of this list. */
+        StructuredBuffer<uint2> sdf_particles : register(t6);
+
+        /* See sdf_bins on the CPU, the primitives of each list that can touch a tile. */
+        StructuredBuffer<uint> sdf_level_bins : register(t7);
+        StructuredBuffer<uint> sdf_overlay_bins : register(t8);
+
+        uint sdf_bin_index(StructuredBuffer<uint> i_bins, uint i_entry)
+        {
+            uint word = i_bins[SDF_BIN_TILES_COUNT + 1 + i_entry / 2];
+            return (word >> ((i_entry & 1) * 16)) & 0xFFFF;
+        }
+
+        sdf_primitive sdf_primitive_unpack(sdf_primitive_packed i_packed, float2 i_origin)
+        {
+            sdf_primitive primitive;
+            primitive.type = i_packed.type_sprite & 0xFF;
+            primitive.entity = 0;
+            primitive.sprite_index = float2((i_packed.type_sprite >> 8) & 0xFFF, i_packed.type_sprite >> 20) / SDF_PACKED_SPRITE_SCALE;
+            primitive.growth_sizes1 = float3(f16tof32(i_packed.growth_sizes.x), f16tof32(i_packed.growth_sizes.x >> 16), f16tof32(i_packed.growth_sizes.y));
+            primitive.growth_sizes2 = float3(f16tof32(i_packed.growth_sizes.y >> 16), f16tof32(i_packed.growth_sizes.z), f16tof32(i_packed.growth_sizes.z >> 16));
+            primitive.position = i_origin + float2(asint(i_packed.position << 16) >> 16, asint(i_packed.position) >> 16) / SDF_PACKED_POSITION_SCALE;
+            primitive.particles = uint2(i_packed.growth_sizes.y >> 16, i_packed.growth_sizes.z & 0xFFFF);
+            return primitive;
+        }
 
         struct color_distance
         {
@@ -798,161 +659,41 @@ int WINAPI WinMain(
             return min(a, b) - h*h*0.25f/k;
         }
 
-        /* The following are progressively smoother noise functions.
-         * TODO: Should really be a single backed noise map with multiple channels. 
-         * But as this project progressed I kept finding the need to try slightly different noise functions and could not be bothered to bake them... */
-        float random(float2 i_position)
-        {
-            return frac(sin(dot(i_position, float2(12.9898, 4.1414))) * 43758.5453);
-        }
+        static float4 g_noise_weights_time;
+        static float4 g_noise_weights_tenth;
 
-        float noise(float2 i_position, float i_offset)
+        float4 noise_weights(float i_offset)
         {
-            float2 i = floor(i_position + float2(i_offset, 0.0));
-            float2 f = frac(i_position + float2(i_offset, 0.0));
-            f = f * f * (3.0 - 2.0 * f);
-            float a = random(i + float2(0.0, 0.0));
-            float b = random(i + float2(1.0, 0.0));
-            float c = random(i + float2(0.0, 1.0));
-            float d = random(i + float2(1.0, 1.0));
-            return lerp(lerp(a, b, f.x), lerp(c, d, f.x), f.y);
-        }
-
-        float sample_noise(float2 i_position, float i_offset)
-        {
-            float4 noise_sample = noise_texture.Sample(noise_sampler, i_position / float2(1600.0, 900.0));
             float t = 6.283185 * frac(i_offset / 2.0);
             float k = 1.57079625;
             float4 sc = float4(0.0, k, 2.0 * k, 3.0 * k) + t;
-            float4 sn = (sin(sc) + 1.0) * 0.4;
-            return dot(sn, noise_sample);
-        }
-
-        float2 rotate(float2 i_position, float i_rotation){
-            float angle = i_rotation * 3.1415925 * 2.0 * -1.0;
-            return float2(cos(angle) * i_position.x + sin(angle) * i_position.y, 
-                          cos(angle) * i_position.y - sin(angle) * i_position.x);
-        }
-
-        /* Fundamental sdf shapes
-         * Credit to iq (https://iquilezles.org/articles/distfunctions2d/) for the original signed distance functions. */
-
-        float sdf_circle(float2 i_uv, float2 i_position, float i_radius)
-        {
-            return length(i_position - i_uv) - i_radius;
-        }
-
-        float sdf_box(float2 i_uv, float2 i_position, float2 i_size)
-        {
-            float2 distance = abs(i_position - i_uv) - i_size;
-            return length(max(distance, 0.0)) + min(max(distance.x, distance.y), 0.0);
-        }
-
-        float sdf_segment(float2 i_uv, float2 i_position, float2 i_start, float2 i_end)
-        {
-            float2 position_start = (i_position - i_uv) - i_start;
-            float2 end_start = i_end - i_start;
-            float height = clamp( dot(position_start, end_start) / dot(end_start, end_start), 0.0, 1.0 );
-            return length(position_start - end_start * height);
-        }
-
-        float sdf_triangle_isosceles(float2 i_uv, float2 i_position, float2 i_half_width_height)
-        {
-            i_position.x = abs(i_position.x);
-            float2 a = i_position - i_half_width_height * clamp(dot(i_position, i_half_width_height) / dot(i_half_width_height, i_half_width_height), 0.0, 1.0);
-            float2 b = i_position - i_half_width_height * float2(clamp(i_position.x / i_half_width_height.x, 0.0, 1.0 ), 1.0);
-            float s = -sign(i_half_width_height.y);
-            float2 d = min(float2(dot(a, a), s * (i_position.x * i_half_width_height.y - i_position.y * i_half_width_height.x)), float2(dot(b, b), s * (i_position.y - i_half_width_height.y)));
-            return -sqrt(d.x) * sign(d.y);
-        }
-        
-        float sdf_spiral(float2 i_uv, float2 i_position, float i_width, float i_rotations)
-        {
-            /* Body */
-            i_position -= i_uv;
-            float tau = 6.283185307;
-            float r = length(i_position);
-            float a = atan(i_position.y, i_position.x);
-            float n = floor(0.5 / i_width + (log2(r / i_width) * i_rotations-a) / tau);
-            float ra = i_width * exp2((a + tau * (min(n + 0.0, 0.0) - 0.5)) / i_rotations);
-            float rb = i_width * exp2((a + tau * (min(n + 1.0, 0.0) - 0.5)) / i_rotations);
-            float d = min(abs(r - ra), abs(r - rb));
-
-            /* Tip */
-            return min(d, length(i_position + float2(i_width, 0.0))) - 2.0;
+            return (sin(sc) + 1.0) * 0.4;
         }
 
-        /* Assembled sdf shapes. 
-         * TODO: Don't you love random hard coded values... */
-
-        float sdf_player(float2 i_uv, float2 i_position, float i_scale, float i_time)
-        {
-            float2 scale = float2(abs(sin(i_time * 3.0)), abs(cos(i_time * 3.0)));
-            scale *= 0.25;
-            scale = (1.0 + scale) / 2.0;
-            scale *= float2(i_scale, i_scale);
-
-            i_uv += float2(800.0, 450.0) * (i_position / float2(800.0, 450.0)) * scale;
-            i_uv /= 1.0 + scale;
-
-            float radius = 27.0 * i_scale;
-            float circle = sdf_circle(i_uv, i_position, radius);
-            circle = min(circle, sdf_circle(i_uv, i_position - float2(25.0, 10.0), radius * 0.3));
-            circle = min(circle, sdf_circle(i_uv, i_position - float2(10.0, 20.0), radius * 0.5));
-            circle = min(circle, sdf_circle(i_uv, i_position - float2(-15.0, 0.0), radius * 0.6));
-            circle = min(circle, sdf_circle(i_uv, i_position - float2(-15.0, 20.0), radius * 0.3));
-
-            float arm1 = sdf_segment(i_uv, i_position, float2(15.0, 10.0), i_scale * float2(15.0, -20.0 * (1.0 + scale.x * 0.4)));
-            float arm2 = sdf_segment(i_uv, i_position, float2(-15.0, 10.0), i_scale * float2(-15.0, -20.0 * (1.0 + scale.y * 0.4)));
-            arm1 -= 5.0 * i_scale;
-            arm2 -= 5.0 * i_scale;
-            return min(circle, min(arm1, arm2));
-        }
-
-        float sdf_wobbly_circle(float2 i_uv, float2 i_position, float i_radius)
-        {
-            return sdf_circle(i_uv, i_position, i_radius) - 25.0 * sample_noise(i_uv, c_player_time);
-        }
-
-        float sdf_spiked_circle(float2 i_uv, float2 i_position, float i_size)
-        {
-            float2 position = i_position - i_uv;
-            float b = 6.283185 / 24.0;
-            float a = atan(position.y, position.x);
-            float i = floor(a / b);
-
-            float c1 = b*(i+0.0); 
-            float c2 = b*(i+1.0); 
-            float2 p1 = mul(transpose(float2x2(cos(c1), -sin(c1), sin(c1), cos(c1))), position);
-            float2 p2 = mul(transpose(float2x2(cos(c2), -sin(c2), sin(c2), cos(c2))), position);
-
-            float o = mod(round(a / 6.283185 * 16.0), 2.0);
-            float t = (1.0 + sin(c_player_time)) / 2.0;
-            float r = o + t - 2.0 * o * t;
-
-            float m = 4.712388;
-            p1 = mul(transpose(float2x2(cos(m), sin(m), -sin(m), cos(m))), (p1 - float2(i_size * 0.9, 0.0)));
-            p2 = mul(transpose(float2x2(cos(m), sin(m), -sin(m), cos(m))), (p2 - float2(i_size * 0.9, 0.0)));
-            p1.y -= r * 0.15 * i_size;
-            p2.y -= r * 0.15 * i_size;
-
-            float2 spike_size = float2(0.02, 0.15 - r * 0.15) * i_size; 
-            float spikes = min(sdf_triangle_isosceles(float2(0.0, 0.0), p1, spike_size), 
-                               sdf_triangle_isosceles(float2(0.0, 0.0), p2, spike_size));
-
-            return min(spikes, sdf_circle(i_uv, i_position, 0.75f * i_size));
-        }
-
-        float sdf_wobbly_box(float2 i_uv, float2 i_position, float2 i_size)
+        /* The weights of the offsets used every frame are baked on the CPU, a constant offset folds at compile time. */
+        float sample_noise(float2 i_position, float i_offset)
         {
-            float distance = sdf_box(i_uv, i_position, i_size) - 25.0 * sample_noise(i_uv, 0.0);
-            if (distance <= 0.0)
+            float4 noise_sample = noise_texture.Sample(noise_sampler, i_position / float2(1600.0, 900.0));
+            float4 weights;
+            [branch] if (i_offset == c_player_time)
             {
-                distance *= -step(sample_noise(i_uv, c_player_time * 0.1), 0.7);
+                weights = g_noise_weights_time;
             }
-            return distance;
+            else if (i_offset == c_player_time * 0.1)
+            {
+                weights = g_noise_weights_tenth;
+            }
+            else
+            {
+                weights = noise_weights(i_offset);
+            }
+            return dot(weights, noise_sample);
         }
-
+    )
+#define SDF_SHAPES_HLSL
+#include "sdf_shapes.h"
+#undef SDF_SHAPES_HLSL
+    xstringify(
         color_distance sdf_box_textured(float2 i_uv, float2 i_position, float2 i_size, float2 sprite_index, float2 sprite_size, float2 spritesheet_size)
         {
             float2 uv_size = float2(1600.0, 900.0);
@@ -972,131 +713,60 @@ int WINAPI WinMain(
             return result;
         }
         
-        float sdf_portal(float2 i_uv, float2 i_position, float i_size, float i_time)
-        {
-            float2 position = i_position - i_uv;
-            position = rotate(position, 0.1 * c_player_time);
-            float b = 6.283185 / 9.0;
-            float a = atan(position.y, position.x);
-            float i = floor(a / b);
-
-            float c1 = b*(i+0.0); 
-            float c2 = b*(i+1.0); 
-            float2 p1 = mul(transpose(float2x2(cos(c1), -sin(c1), sin(c1), cos(c1))), position);
-            float2 p2 = mul(transpose(float2x2(cos(c2), -sin(c2), sin(c2), cos(c2))), position);
-            p1 -= float2(i_size, 0.0);
-            p2 -= float2(i_size, 0.0);
-
-            float portal = min(sdf_circle(float2(0.0, 0.0), p1, i_size * 0.1), 
-                               sdf_circle(float2(0.0, 0.0), p2, i_size * 0.1));
-            portal -= 0.6 * i_size * sample_noise(i_uv, c_player_time);
-            portal = min(portal, sdf_circle(i_uv, i_position, i_size * 0.5));
-
-            float spiral = sdf_spiral(float2(0.0, 0.0), position, 2.0 * i_size, 6.0);
-            spiral -= 0.1 * i_size * sample_noise(i_uv, c_player_time);
-
-            return max(-spiral, portal);
-        }
-
-        float sdf_maggot(float2 i_uv, float2 i_position, float i_size, float i_time)
-        {
-            float2 scale = float2(abs(sin(i_time * 3.0)), abs(cos(i_time * 3.0)));
-            scale *= 0.25;
-            scale = (1.0 + scale) / 2.0;
-
-            i_uv += float2(800.0, 450.0) * (i_position / float2(800.0, 450.0)) * scale;
-            i_uv /= 1.0 + scale;
-
-            i_position -= i_uv;
-            i_position -= i_size * float2(0.0, -0.1);
-            i_position = rotate(i_position, 0.25 * i_time);
-
-            /* body */
-            float b1 = length(i_position - 2.0 * i_size * float2(0.05, -0.25)) - i_size * 0.95;
-            float b2 = length(i_position - 2.0 * i_size * float2(0.3, -0.05)) - i_size * 0.75;
-            float b3 = length(i_position - 2.0 * i_size * float2(0.35, 0.25)) - i_size * 0.5;
-            float b4 = length(i_position - 2.0 * i_size * float2(0.25, 0.5)) - i_size * 0.3;
-            float b5 = length(i_position - 2.0 * i_size * float2(0.05, 0.59)) - i_size * 0.25;
-            float b6 = length(i_position - 2.0 * i_size * float2(-0.1, 0.57)) - i_size * 0.2;
-
-            /* eyes */
-            float e7 = length(i_position - 2.0 * i_size * float2(-0.4, -0.3)) - i_size * 0.25;
-            float e8 = length(i_position - 2.0 * i_size * float2(0.25, -0.3)) - i_size * 0.25;
-
-            float d1 = min(b1, b2);
-            float d2 = min(d1, b3);
-            float d3 = min(d2, b4);
-            float d4 = min(d3, b5);
-            float d5 = min(d4, b6);
-
-            float d6 = max(d5, -e7);
-            float d7 = max(d6, -e8);
-            return d7;
-        }
-
-        float sdf_particles(float2 i_uv, float2 i_position, float i_factor)
+        /* The particles are simulated on the CPU, only their circles are left to evaluate. */
+        float sdf_particles_burst(float2 i_uv, float2 i_position, uint2 i_particles)
         {
             float distance = SDF_RESULT_DISTANCE_INVALID;
-            for (uint i = 0; i < 32; ++i)
+            for (uint i = i_particles.x; i < i_particles.x + i_particles.y; ++i)
             {
-                float2 seed = float2(i_position.x, i_position.y + float(i));
-                float2 position = float2(noise(seed, 1.0) - 0.5, noise(seed, 2.0) - 0.5);
-
-                float2 velocity = normalize(position) * lerp(100.0, 500.0, noise(seed, 3.0));
-                position += velocity * i_factor;
-
-                float radius = lerp(8.0, 14.0, sample_noise(seed, 3.0));
-                radius *= 1.0 - i_factor;
-                distance = min(distance, sdf_circle(i_uv, i_position + position, radius));
+                uint2 particle = sdf_particles[i];
+                float2 position = i_position + float2(asint(particle.x << 16) >> 16, asint(particle.x) >> 16) / SDF_PACKED_POSITION_SCALE;
+                distance = min(distance, sdf_circle(i_uv, position, asfloat(particle.y)));
             }
             return distance;
         }
 
-        float lerp_growth_factors(float3 i_sizes, float i_factor)
+        /* Weight per growth state, see growth_factor_to_weights on the CPU. */
+        float3 growth_factor_to_weights(float i_factor)
         {
-            /* TODO: Feels like this can be done better... Too lazy to do math. */
-            float f = i_factor;
-            if (f >= 0.0f/3.0f && f < 1.0f/3.0f)            return lerp(i_sizes.x, i_sizes.y, (f - 0.0f/3.0f) * 3.0f);
-            else if (f >= 1.0f/3.0f && f < 2.0f/3.0f)       return lerp(i_sizes.y, i_sizes.z, (f - 1.0f/3.0f) * 3.0f);
-            else/* if (f >= 2.0f/3.0f && f < 3.0f/3.0f) */  return lerp(i_sizes.z, i_sizes.x, (f - 2.0f/3.0f) * 3.0f);
+            float3 d = abs(3.0 * frac((i_factor * 3.0 + float3(4.5, 3.5, 2.5)) / 3.0) - 1.5);
+            return max(1.0 - d, 0.0);
         }
 
-        color_distance get_distance(StructuredBuffer<sdf_primitive> i_primitives, float2 i_uv, float i_growth_factor, float i_time)
+        color_distance get_distance(StructuredBuffer<sdf_primitive_packed> i_primitives, StructuredBuffer<uint> i_bins, uint i_tile, float2 i_primitives_origin, float2 i_uv, float i_growth_factor, float i_time)
         {
             float4 cur_color = float4(0.0, 0.0, 0.0, 0.0);
             float cur_distance = SDF_RESULT_DISTANCE_INVALID;
+            float3 growth_weights = growth_factor_to_weights(i_growth_factor);
 
-            for (uint i = 0; i < SDF_PRIMITIVES_COUNT_MAX; ++i)
+            for (uint entry = i_bins[i_tile]; entry < i_bins[i_tile + 1]; ++entry)
             {
-                sdf_primitive primitive = i_primitives[i];
-                if (primitive.type == SDF_PRIMITIVE_INVALID)
-                {
-                    break;
-                }
+                uint i = sdf_bin_index(i_bins, entry);
+                sdf_primitive primitive = sdf_primitive_unpack(i_primitives[i], i_primitives_origin);
 
                 float prev_distance = cur_distance;
                 float distance = SDF_RESULT_DISTANCE_INVALID;
                 float4 color = float4(0.0, 0.0, 0.0, 0.0);
 
-                float growth_size1 = lerp_growth_factors(primitive.growth_sizes1, i_growth_factor);
-                float growth_size2 = lerp_growth_factors(primitive.growth_sizes2, i_growth_factor);
+                float growth_size1 = dot(growth_weights, primitive.growth_sizes1);
+                float growth_size2 = dot(growth_weights, primitive.growth_sizes2);
 
                 switch (primitive.type)
                 {
                     case SDF_PRIMITIVE_CIRCLE: 
                     {
                         color = float4(1.0, 0.05, 0.0, 0.0);
-                        distance = sdf_wobbly_circle(i_uv, primitive.position, growth_size1);
+                        distance = sdf_wobbly_circle(i_uv, primitive.position, growth_size1, i_time);
                     } break;
                     case SDF_PRIMITIVE_SPIKED_CIRCLE:
                     {
                         color = float4(1.0, 0.05, 0.0, 0.0);
-                        distance = sdf_spiked_circle(i_uv, primitive.position, growth_size1);
+                        distance = sdf_spiked_circle(i_uv, primitive.position, growth_size1, i_time);
                     } break;
                     case SDF_PRIMITIVE_BOX:
                     {
                         color = float4(1.0, 0.05, 0.0, 0.0);
-                        distance = sdf_wobbly_box(i_uv, primitive.position, float2(growth_size1, growth_size2));
+                        distance = sdf_wobbly_box(i_uv, primitive.position, float2(growth_size1, growth_size2), i_time);
                     } break;
                     case SDF_PRIMITIVE_BOX_TEXTURED:
                     {
@@ -1160,7 +830,7 @@ int WINAPI WinMain(
                     case SDF_PRIMITIVE_PARTICLES:
                     {
                         color = float4(1.0, 0.0, 0.0, 0.0);
-                        distance = sdf_particles(i_uv, primitive.position, primitive.growth_sizes1.z);
+                        distance = sdf_particles_burst(i_uv, primitive.position, primitive.particles);
                     } break;
                 }
 
@@ -1222,78 +892,17 @@ int WINAPI WinMain(
 
             float2 position = float2 (20.0, 20.0);
 
-            result.distance = min(result.distance, sdf_wobbly_circle(i_uv, position + float2(0.0, -50.0), 100.0));
-            result.distance = min(result.distance, sdf_wobbly_circle(i_uv, position + float2(100.0, -50.0), 50.0));
+            result.distance = min(result.distance, sdf_wobbly_circle(i_uv, position + float2(0.0, -50.0), 100.0, c_player_time));
+            result.distance = min(result.distance, sdf_wobbly_circle(i_uv, position + float2(100.0, -50.0), 50.0, c_player_time));
 
-            color_distance deaths_icon = sdf_box_textured(
-                i_uv, 
-                position + float2(16.0, 0.0), 
-                float2(16.0, 16.0), 
-                float2(19.0, 1.0), 
-                float2(64.0, 64.0), 
-                float2(TEXTURE_SPRITESHEET_WIDTH, TEXTURE_SPRITESHEET_HEIGHT)
-            );
-            color_distance deaths_10 = sdf_box_textured(
-                i_uv, 
-                position + float2(16.0 + 32.0, 0.0), 
-                float2(16.0, 16.0), 
-                float2(18.0, floor(c_player_deaths / 10.0)), 
-                float2(64.0, 64.0), 
-                float2(TEXTURE_SPRITESHEET_WIDTH, TEXTURE_SPRITESHEET_HEIGHT)
-            );
-            color_distance deaths_01 = sdf_box_textured(
-                i_uv, 
-                position + float2(16.0 + 48.0, 0.0), 
-                float2(16.0, 16.0), 
-                float2(18.0, mod(c_player_deaths, 10.0)), 
-                float2(64.0, 64.0), 
-                float2(TEXTURE_SPRITESHEET_WIDTH, TEXTURE_SPRITESHEET_HEIGHT)
-            );
-            deaths_icon.color = float4(deaths_icon.color.x, float3(1.0, 1.0, 1.0) - deaths_icon.color.yzw);
-            deaths_01.color = float4(deaths_01.color.x, float3(1.0, 1.0, 1.0) - deaths_01.color.yzw);
-            deaths_10.color = float4(deaths_10.color.x, float3(1.0, 1.0, 1.0) - deaths_10.color.yzw);
-
-            result.distance = min(result.distance, deaths_icon.distance);
-            result.distance = min(result.distance, deaths_01.distance);
-            result.distance = min(result.distance, deaths_10.distance);
-            result.color = lerp(result.color, deaths_icon.color, step(deaths_icon.distance, 0.0) * deaths_icon.color.x);
-            result.color = lerp(result.color, deaths_01.color, step(deaths_01.distance, 0.0) * deaths_01.color.x);
-            result.color = lerp(result.color, deaths_10.color, step(deaths_10.distance, 0.0) * deaths_10.color.x);
-
-            color_distance maggots_icon = sdf_box_textured(
-                i_uv, 
-                position + float2(0.0, 28.0), 
-                float2(16.0, 16.0), 
-                float2(19.0, 0.0), 
-                float2(64.0, 64.0), 
-                float2(TEXTURE_SPRITESHEET_WIDTH, TEXTURE_SPRITESHEET_HEIGHT)
-            );
-            color_distance maggots_10 = sdf_box_textured(
-                i_uv, 
-                position + float2(32.0, 28.0), 
-                float2(16.0, 16.0), 
-                float2(18.0, floor(c_player_maggots / 10.0)), 
-                float2(64.0, 64.0), 
-                float2(TEXTURE_SPRITESHEET_WIDTH, TEXTURE_SPRITESHEET_HEIGHT)
-            );
-            color_distance maggots_01 = sdf_box_textured(
-                i_uv, 
-                position + float2(48.0, 28.0), 
-                float2(16.0, 16.0), 
-                float2(18.0, mod(c_player_maggots, 10.0)), 
-                float2(64.0, 64.0), 
-                float2(TEXTURE_SPRITESHEET_WIDTH, TEXTURE_SPRITESHEET_HEIGHT)
-            );
-            maggots_icon.color = float4(maggots_icon.color.x, float3(1.0, 1.0, 1.0) - maggots_icon.color.yzw);
-            maggots_01.color = float4(maggots_01.color.x, float3(1.0, 1.0, 1.0) - maggots_01.color.yzw);
-            maggots_10.color = float4(maggots_10.color.x, float3(1.0, 1.0, 1.0) - maggots_10.color.yzw);
-
-            result.distance = min(result.distance, maggots_icon.distance);
-            result.distance = min(result.distance, maggots_01.distance);
-            result.distance = min(result.distance, maggots_10.distance);
-            result.color = lerp(result.color, maggots_icon.color, step(maggots_icon.distance, 0.0) * maggots_icon.color.x);
-            result.color = lerp(result.color, maggots_01.color, step(maggots_01.distance, 0.0) * maggots_01.color.x);
-            result.color = lerp(result.color, maggots_10.color, step(maggots_10.distance, 0.0) * maggots_10.color.x);
+            /* The icons and counters are retained in hud_texture, baked by hud_image_update when the counters change. 
+             * The deaths and maggots rows cover all of them, outside the HUD is white and their distance of 1 never wins. */
+            float icons = min(sdf_box(i_uv, float2(60.0, 20.0), float2(40.0, 16.0)), sdf_box(i_uv, float2(44.0, 48.0), float2(40.0, 16.0)));
+            if (icons <= 0.0)
+            {
+                result.color = hud_texture.Load(int3(int2(i_uv) - int2(HUD_IMAGE_X, HUD_IMAGE_Y), 0));
+                result.distance = min(result.distance, 0.0);
+            }
             return result;
         }
 
@@ -1315,12 +924,19 @@ int WINAPI WinMain(
         struct VOut
         {
             float4 position : SV_POSITION;
-            float2 uv : UV;
+            float2 uv : UV;             /* Screen space. */
+            float2 world_uv : WORLD_UV; /* World space, everything in the level uses this. */
+            nointerpolation float2 primitives_origin : PRIMITIVES_ORIGIN;
+            nointerpolation float4 noise_weights_time : NOISE_WEIGHTS_TIME;
+            nointerpolation float4 noise_weights_tenth : NOISE_WEIGHTS_TENTH;
             float4 color : COLOR;
         };
 
         float4 main(VOut vertex_input) : SV_TARGET
         {
+            g_noise_weights_time = vertex_input.noise_weights_time;
+            g_noise_weights_tenth = vertex_input.noise_weights_tenth;
+
             float4 background = background_texture.Sample(background_sampler, vertex_input.uv / float2(1600.0, 900.0));
             float3 color = background.wyz;
 
@@ -1330,10 +946,13 @@ int WINAPI WinMain(
             vig = pow(vig, 0.3);
             color *= vig;
 
-            color_distance level_sdf = get_distance(sdf_level_primitives, vertex_input.uv, c_player_growth_factor, c_player_time);
+            uint2 tile_xy = min(uint2(vertex_input.uv / SDF_BIN_TILE_SIZE), uint2(SDF_BIN_TILES_X - 1, SDF_BIN_TILES_Y - 1));
+            uint tile = tile_xy.y * SDF_BIN_TILES_X + tile_xy.x;
+
+            color_distance level_sdf = get_distance(sdf_level_primitives, sdf_level_bins, tile, vertex_input.primitives_origin, vertex_input.world_uv, c_player_growth_factor, c_player_time);
             color = lerp(color, level_sdf.color.yzw, clamp(1.0 - level_sdf.distance, 0.0, 1.0));
 
-            color_distance overlay_sdf = get_distance(sdf_overlay_primitives, vertex_input.uv, c_player_growth_factor, c_player_time);
+            color_distance overlay_sdf = get_distance(sdf_overlay_primitives, sdf_overlay_bins, tile, vertex_input.primitives_origin, vertex_input.world_uv, c_player_growth_factor, c_player_time);
             color = lerp(color, overlay_sdf.color.yzw, clamp(1.0 - overlay_sdf.distance, 0.0, 1.0) * overlay_sdf.color.x);
             
             /* Debug */
@@ -1345,9 +964,9 @@ int WINAPI WinMain(
             color = lerp(color, float3(0.0, 1.0, 1.0), surface_line);
             */
 
-            float player = step(sdf_player(vertex_input.uv, c_player_position, c_player_scale, c_player_time), 0.0);
+            float player = step(sdf_player(vertex_input.world_uv, c_player_position, c_player_scale, c_player_time), 0.0);
             color_distance face = sdf_box_textured(
-                vertex_input.uv, 
+                vertex_input.world_uv, 
                 c_player_position, 
                 float2(c_player_scale * (192.0/3.0), c_player_scale * (64.0/3.0)) * (1.0 + c_player_growth_state * 0.1), 
                 float2(4.0, c_player_growth_state), 
@@ -1385,8 +1004,12 @@ int WINAPI WinMain(
     graphics_image background_image;
     graphics_image end_image;
     graphics_image spritesheet_image;
+    graphics_image hud_icons_image;
     graphics_structured_buffer sdf_level_primitives_buffer;
     graphics_structured_buffer sdf_overlay_primitives_buffer;
+    graphics_structured_buffer sdf_particles_buffer;
+    graphics_structured_buffer sdf_level_bins_buffer;
+    graphics_structured_buffer sdf_overlay_bins_buffer;
     graphics_shader shader;
     graphics_pipeline pipeline;
     graphics_bindings bindings;
@@ -1464,20 +1087,53 @@ int WINAPI WinMain(
         GRAPHICS_WARP_TYPE_REPEAT
     });
 
+    hud_image_update((u32 const*)g_texture_spritesheet, TEXTURE_SPRITESHEET_WIDTH, TEXTURE_SPRITESHEET_HEIGHT);
+    hud_icons_image = graphics_image_create(&d3d11_ctx, {
+        g_hud_image.texels,
+        HUD_IMAGE_WIDTH,
+        HUD_IMAGE_HEIGHT,
+        GRAPHICS_IMAGE_TYPE_R8G8B8A8_UINT,
+        GRAPHICS_FILTER_TYPE_POINT,
+        GRAPHICS_WRAP_TYPE_CLAMP,
+        GRAPHICS_WRAP_TYPE_CLAMP,
+        TRUE
+    });
+
     memzero(g_level_primitives, sizeof(g_level_primitives));
     sdf_level_primitives_buffer = graphics_structured_buffer_create(&d3d11_ctx, {
             g_level_primitives,
-            sizeof(sdf_primitive),
+            sizeof(sdf_primitive_packed),
             SDF_PRIMITIVES_COUNT_MAX
     });
 
     memzero(g_overlay_primitives, sizeof(g_overlay_primitives));
     sdf_overlay_primitives_buffer = graphics_structured_buffer_create(&d3d11_ctx, {
             g_overlay_primitives,
-            sizeof(sdf_primitive),
+            sizeof(sdf_primitive_packed),
             SDF_PRIMITIVES_COUNT_MAX
     });
 
+    memzero(g_particles_packed, sizeof(g_particles_packed));
+    sdf_particles_buffer = graphics_structured_buffer_create(&d3d11_ctx, {
+            g_particles_packed,
+            sizeof(particle_packed),
+            PARTICLES_COUNT_MAX
+    });
+
+    memzero(&g_level_bins, sizeof(g_level_bins));
+    sdf_level_bins_buffer = graphics_structured_buffer_create(&d3d11_ctx, {
+            &g_level_bins,
+            sizeof(u32),
+            sizeof(sdf_bins) / sizeof(u32)
+    });
+
+    memzero(&g_overlay_bins, sizeof(g_overlay_bins));
+    sdf_overlay_bins_buffer = graphics_structured_buffer_create(&d3d11_ctx, {
+            &g_overlay_bins,
+            sizeof(u32),
+            sizeof(sdf_bins) / sizeof(u32)
+    });
+
     shader = graphics_shader_create(&d3d11_ctx, {
         { sizeof(camera) },
         "vs_5_0",
@@ -1504,8 +1160,8 @@ int WINAPI WinMain(
     g_background_type = BACKGROUND_TYPE_LEVEL;
     bindings = graphics_bindings_create(&d3d11_ctx, {
         pipeline,
-        { noise_image, background_image, spritesheet_image },
-        { sdf_level_primitives_buffer, sdf_overlay_primitives_buffer },
+        { noise_image, background_image, spritesheet_image, hud_icons_image },
+        { sdf_level_primitives_buffer, sdf_overlay_primitives_buffer, sdf_particles_buffer, sdf_level_bins_buffer, sdf_overlay_bins_buffer },
         { vertex_buffer }
     });
 
@@ -1513,6 +1169,7 @@ int WINAPI WinMain(
 
     audio_play_sound(xaudio2_ctx, g_sound_music, sizeof(g_sound_music), 1.0f, AUDIO_FLAG_FADE_IN | AUDIO_FLAG_LOOP); 
     audio_play_sound(xaudio2_ctx, g_sound_heartbeat, sizeof(g_sound_heartbeat), 0.75f, AUDIO_FLAG_FADE_IN | AUDIO_FLAG_LOOP); 
+    noise_atlas_bake();
     level_load(0);
 
     u32 level_edit_object = 0;
@@ -1532,10 +1189,17 @@ int WINAPI WinMain(
     f32 push_strength = 4.0f;
     f32 growth_speed = 0.3f;
     f32 growth_time = 0.1f;
-    sz player_death_particle = ENTITIES_COUNT_MAX;
+    entity_handle player_death_particle = ENTITY_HANDLE_INVALID;
 
     fvec2 velocity = { 0.0f, 0.0f };
 
+    sdf_query_cache player_query_cache;
+    memzero(&player_query_cache, sizeof(player_query_cache));
+
+    #if DEBUG
+    growth_factor_to_weights_test();
+    #endif
+
     while (!window->should_close)
     {
         f32 delta_time = (f32)window->delta_time;
@@ -1579,50 +1243,17 @@ int WINAPI WinMain(
             velocity = fvec2_mul_s(fvec2_norm(velocity), max_velocity);
         }
 
-        fvec2 new_position = fvec2_add(g_player.position, fvec2_mul_s(velocity, delta_time));
-
-        /* Collision against distance field. */
-        sdf_result collision_result = sdf_get_distance(new_position, g_player.growth_factor, g_player.time);
-        g_player.debug = sdf_get_surface_normal(new_position, g_player.growth_factor, g_player.time);
-        if (collision_result.distance < 0.1f)
-        {
-            /* Reflect  velocity along surface normal to allow gliding against objects. */
-            fvec2 normal = sdf_get_surface_normal(new_position, g_player.growth_factor, g_player.time);
-            f32 along_normal = fvec2_dot(velocity, normal);
-            if (along_normal < 0.0f)
-            {
-                velocity = fvec2_sub(velocity, fvec2_mul_s(normal, along_normal));
-            }
-
-            new_position = g_player.position;
-            new_position = fvec2_add(new_position, fvec2_mul_s(velocity, delta_time));
-        }
-
-        /* Iteratively check if our resolved position is still inside an object in the distance field. 
-         * If so, slowly push the player out along the surface normal. */
-        for (u32 i = 0; i < 4; ++i) 
-        {
-            sdf_result new_position_collision = sdf_get_distance(new_position, g_player.growth_factor, g_player.time);
-            if (new_position_collision.distance < 0.1f)
-            {
-                fvec2 normal = sdf_get_surface_normal(new_position, g_player.growth_factor, g_player.time);
-                new_position = fvec2_add(new_position, fvec2_mul_s(normal, push_strength *  delta_time * -new_position_collision.distance));
-                /* TODO: This is most certainly npt correctly time adjusted... Too bad! */
-            }
-        }
-
-        /* Collision against level bounds. */
-        new_position.x = math_clamp(new_position.x, 0.0f, LEVEL_WIDTH);
-        new_position.y = math_clamp(new_position.y, 0.0f, LEVEL_HEIGHT);
-
-        g_player.position = new_position;
+        /* Collision against distance field and level bounds. */
+        sdf_result collision_result = player_move(&player_query_cache, &velocity, delta_time, push_strength);
+        #if DEBUG
+        player_path_record(g_player.position);
+        #endif
 
         /* Post physics collision processing. */
         if (collision_result.distance < 0.1f && collision_result.closest_object != SDF_RESULT_OBJECT_INVALID)
         {
-            sdf_primitive* primitive = &g_level_primitives[collision_result.closest_object];
-            entity_data* entity = &g_entities[primitive->entity];
-            switch (entity->type)
+            sdf_collision_shape* shape = &g_collision_snapshot.shapes[collision_result.closest_object];
+            switch (g_entity_store.type[entity_index(shape->entity)])
             {
                 case ENTITY_TYPE_T_CELL:
                 {
@@ -1638,32 +1269,25 @@ int WINAPI WinMain(
 
                         /* Death effect. */
                         audio_play_sound(xaudio2_ctx, g_sound_death, sizeof(g_sound_death), 1.0f, AUDIO_FLAG_NONE);
-                        g_entities[g_entities_count].type = ENTITY_TYPE_PARTICLES; 
-                        g_entities[g_entities_count].position = g_player.position; 
-                        g_entities[g_entities_count].growth_sizes1.x = 0.0f; 
-                        player_death_particle = g_entities_count;
-                        g_entities_count += 1;
+                        entity_data particles;
+                        memzero(&particles, sizeof(particles));
+                        particles.type = ENTITY_TYPE_PARTICLES; 
+                        particles.position = g_player.position; 
+                        player_death_particle = entity_spawn(&particles);
                     }
                 } break;
             }
         }
         if (collision_result.overlapped_distance < 0.1f && collision_result.overlapped_object != SDF_RESULT_OBJECT_INVALID)
         {
-            sdf_primitive* primitive = &g_level_primitives[collision_result.overlapped_object];
-            entity_data* entity = &g_entities[primitive->entity];
-            switch (entity->type)
+            sdf_collision_shape* shape = &g_collision_snapshot.shapes[collision_result.overlapped_object];
+            u32 entity = entity_index(shape->entity);
+            switch (g_entity_store.type[entity])
             {
                 case ENTITY_TYPE_PORTAL:
                 {
                     level_next();
                 } break;
-                case ENTITY_TYPE_MAGGOT:
-                {
-                    g_player.maggots += 1;
-                    entity->type = ENTITY_TYPE_PARTICLES;
-                    entity->growth_sizes1.z = 0.0f;
-                    audio_play_sound(xaudio2_ctx, g_sound_maggot, sizeof(g_sound_maggot), 1.0f, AUDIO_FLAG_NONE);
-                } break;
             }
         }
 
@@ -1675,7 +1299,8 @@ int WINAPI WinMain(
             {
                 g_player.scale = 0.0f;
             }
-            if (g_entities[player_death_particle].growth_sizes1.z >= 1.0f)
+            /* The particles despawn once they are done. */
+            if (!entity_is_alive(player_death_particle))
             {
                 level_reload();
             }
@@ -1713,199 +1338,18 @@ int WINAPI WinMain(
             g_player.growth_factor = 1.0f + g_player.growth_factor;
         }
 
-        /* Convert entities into primitives we need to render. 
-         * This provides a layer of separation between entities and their visuals. 
-         * Entities can have 1 or more visual elements or be created and destroyed. 
-         * Recreating the list each frame is however not the best way to do this... */
-        u32 g_level_primitives_end = 0;
-        u32 g_overlay_primitives_end = 0;
-        memzero(&g_level_primitives, sizeof(g_level_primitives));
-        memzero(&g_overlay_primitives, sizeof(g_overlay_primitives));
-        for (u32 i = 0; i < ENTITIES_COUNT_MAX; ++i)
+        world_update_camera(g_player.position);
+        level_edit_object = entities_to_primitives(delta_time, level_edit_entity);
+        if (g_crowd.frame_pickups > 0)
         {
-            if (level_edit_entity == i)
-            {
-                level_edit_object = g_level_primitives_end;
-            }
-
-            entity_data* entity = &g_entities[i];
-            if (entity->type == ENTITY_TYPE_INVALID)
-            {
-                break;
-            }
-
-            switch (entity->type)
-            {
-                case ENTITY_TYPE_TUMOR: 
-                {
-                    /* Create body */
-                    g_level_primitives[g_level_primitives_end].type = SDF_PRIMITIVE_CIRCLE;
-                    g_level_primitives[g_level_primitives_end].entity = i;
-                    g_level_primitives[g_level_primitives_end].position = entity->position;
-                    g_level_primitives[g_level_primitives_end].growth_sizes1 = entity->growth_sizes1;
-                    ++g_level_primitives_end;
-
-                    /* Calculate face size and position to look at the player without leaving the body sphere. */
-                    f32 face_width = lerp_growth_factors(entity->growth_sizes1, g_player.growth_factor) / 2.0f;
-                    f32 face_height = face_width * (16.0f / 48.0f);
-
-                    fvec2 face_position = entity->position;
-                    fvec2 player_direction = fvec2_sub(g_player.position, face_position);
-                    player_direction = fvec2_mul_s(fvec2_norm(player_direction), math_min(fvec2_len(player_direction) / 4.0f, face_width));
-                    face_position = fvec2_add(face_position, player_direction);
-
-                    /* Create face */
-                    g_overlay_primitives[g_overlay_primitives_end].type = SDF_PRIMITIVE_BOX_TEXTURED;
-                    g_overlay_primitives[g_overlay_primitives_end].entity = i;
-                    g_overlay_primitives[g_overlay_primitives_end].position = face_position;
-                    g_overlay_primitives[g_overlay_primitives_end].growth_sizes1 = { face_width, face_width, face_width };
-                    g_overlay_primitives[g_overlay_primitives_end].growth_sizes2 = { face_height, face_height, face_height };
-                    g_overlay_primitives[g_overlay_primitives_end].sprite_index[0] = entity->sprite_index[0];
-                    g_overlay_primitives[g_overlay_primitives_end].sprite_index[1] = entity->sprite_index[1];
-                    ++g_overlay_primitives_end;
-                } break;
-                case ENTITY_TYPE_MOTHER:
-                {
-                    f32 mouth_state_time = 0.5f;
-                    b8 mouth_state = (entity->timer < mouth_state_time);
-                    if (entity->is_talking || mouth_state)
-                    {
-                        entity->timer += delta_time;
-                        if (entity->timer >= mouth_state_time * 2.0f)
-                        {
-                            entity->timer = 0.0f;
-                        }
-                    }
-
-                    /* Create body */
-                    g_level_primitives[g_level_primitives_end].type = SDF_PRIMITIVE_CIRCLE;
-                    g_level_primitives[g_level_primitives_end].entity = i;
-                    g_level_primitives[g_level_primitives_end].position = entity->position;
-                    g_level_primitives[g_level_primitives_end].growth_sizes1 = entity->growth_sizes1;
-                    ++g_level_primitives_end;
-
-                    /* Calculate face size and position to look at the player without leaving the body sphere. */
-                    f32 face_width = lerp_growth_factors(entity->growth_sizes1, g_player.growth_factor) / 2.0f;
-                    f32 face_height = face_width * (16.0f / 48.0f);
-
-                    fvec2 face_position = fvec2_add(entity->position, {0.0f, 150.0f});
-                    fvec2 player_direction = fvec2_sub(g_player.position, face_position);
-                    player_direction = fvec2_mul_s(fvec2_norm(player_direction), math_min(fvec2_len(player_direction) / 4.0f, face_width));
-                    face_position = fvec2_add(face_position, player_direction);
-
-                    /* Special clamping rules to prevent messy overlap with flower. */
-                    face_position.x = math_clamp(
-                        face_position.x, 
-                        entity->position.x - face_width / 2.0f, 
-                        entity->position.x + face_width / 4.0f
-                    );
-                    face_position.y = math_max(
-                        face_position.y, 
-                        entity->position.y + face_height / 4.0f
-                    );
-
-                    /* Create flower */
-                    fvec2 flower_position = fvec2_add(entity->position, {280.0f, 180.0f});
-                    f32 flower_width = lerp_growth_factors(entity->growth_sizes1, g_player.growth_factor) / 8.0f;
-                    f32 flower_height = flower_width;
-
-                    g_overlay_primitives[g_overlay_primitives_end].type = SDF_PRIMITIVE_BOX_FLOWER;
-                    g_overlay_primitives[g_overlay_primitives_end].entity = i;
-                    g_overlay_primitives[g_overlay_primitives_end].position = flower_position;
-                    g_overlay_primitives[g_overlay_primitives_end].growth_sizes1 = { flower_width, flower_width, flower_width };
-                    g_overlay_primitives[g_overlay_primitives_end].growth_sizes2 = { flower_height, flower_height, flower_height };
-                    g_overlay_primitives[g_overlay_primitives_end].sprite_index[0] = 8.0f;
-                    g_overlay_primitives[g_overlay_primitives_end].sprite_index[1] = 1.0f;
-                    ++g_overlay_primitives_end;
-
-                    /* Create face */
-                    g_overlay_primitives[g_overlay_primitives_end].type = SDF_PRIMITIVE_BOX_TEXTURED;
-                    g_overlay_primitives[g_overlay_primitives_end].entity = i;
-                    g_overlay_primitives[g_overlay_primitives_end].position = face_position;
-                    g_overlay_primitives[g_overlay_primitives_end].growth_sizes1 = { face_width, face_width, face_width };
-                    g_overlay_primitives[g_overlay_primitives_end].growth_sizes2 = { face_height, face_height, face_height };
-                    g_overlay_primitives[g_overlay_primitives_end].sprite_index[0] = 2;
-                    g_overlay_primitives[g_overlay_primitives_end].sprite_index[1] = 2 + (f32)mouth_state;
-                    ++g_overlay_primitives_end;
-                } break;
-                case ENTITY_TYPE_T_CELL: 
-                {
-                    /* Create body */
-                    g_level_primitives[g_level_primitives_end].type = SDF_PRIMITIVE_SPIKED_CIRCLE;
-                    g_level_primitives[g_level_primitives_end].entity = i;
-                    g_level_primitives[g_level_primitives_end].position = entity->position;
-                    g_level_primitives[g_level_primitives_end].growth_sizes1 = entity->growth_sizes1;
-                    ++g_level_primitives_end;
-                } break;
-                case ENTITY_TYPE_WALL:
-                {
-                    g_level_primitives[g_level_primitives_end].type = SDF_PRIMITIVE_BOX;
-                    g_level_primitives[g_level_primitives_end].entity = i;
-                    g_level_primitives[g_level_primitives_end].position = entity->position;
-                    g_level_primitives[g_level_primitives_end].growth_sizes1 = entity->growth_sizes1;
-                    g_level_primitives[g_level_primitives_end].growth_sizes2 = entity->growth_sizes2;
-                    ++g_level_primitives_end;
-                } break;
-                case ENTITY_TYPE_PORTAL:
-                {
-                    g_level_primitives[g_level_primitives_end].type = SDF_PRIMITIVE_PORTAL;
-                    g_level_primitives[g_level_primitives_end].entity = i;
-                    g_level_primitives[g_level_primitives_end].position = entity->position;
-                    g_level_primitives[g_level_primitives_end].growth_sizes1 = entity->growth_sizes1;
-                    ++g_level_primitives_end;
-                } break;
-                case ENTITY_TYPE_MAGGOT:
-                {
-                    g_level_primitives[g_level_primitives_end].type = SDF_PRIMITIVE_MAGGOT;
-                    g_level_primitives[g_level_primitives_end].entity = i;
-                    g_level_primitives[g_level_primitives_end].position = entity->position;
-                    g_level_primitives[g_level_primitives_end].growth_sizes1 = entity->growth_sizes1;
-                    ++g_level_primitives_end;
-                } break;
-                case ENTITY_TYPE_PARTICLES:
-                {
-                    entity->growth_sizes1.z += delta_time * 2.0f;
-                    if (entity->growth_sizes1.z >= 1.0f)
-                    {
-                        entity->growth_sizes1.z = 1.0f;
-                    }
-
-                    g_overlay_primitives[g_overlay_primitives_end].type = SDF_PRIMITIVE_PARTICLES;
-                    g_overlay_primitives[g_overlay_primitives_end].entity = i;
-                    g_overlay_primitives[g_overlay_primitives_end].position = entity->position;
-                    g_overlay_primitives[g_overlay_primitives_end].growth_sizes1 = entity->growth_sizes1;
-                    ++g_overlay_primitives_end;
-                } break;
-                case ENTITY_TYPE_BOX_TEXT:
-                {
-                    if (entity->should_grow)
-                    {
-                        entity->growth_sizes1.z += delta_time * 2.0f;
-                        if (entity->growth_sizes1.z >= 1.0f)
-                        {
-                            entity->growth_sizes1.z = 1.0f;
-                        }
-                    }
-                    else 
-                    {
-                        entity->growth_sizes1.z -= delta_time * 2.0f;
-                        if (entity->growth_sizes1.z <= 0.0f)
-                        {
-                            entity->growth_sizes1.z = 0.0f;
-                        }
-                    }
-
-                    g_overlay_primitives[g_overlay_primitives_end].type = SDF_PRIMITIVE_BOX_TEXT;
-                    g_overlay_primitives[g_overlay_primitives_end].entity = i;
-                    g_overlay_primitives[g_overlay_primitives_end].position = entity->position;
-                    g_overlay_primitives[g_overlay_primitives_end].growth_sizes1 = entity->growth_sizes1;
-                    g_overlay_primitives[g_overlay_primitives_end].growth_sizes2 = entity->growth_sizes2;
-                    g_overlay_primitives[g_overlay_primitives_end].sprite_index[0] = entity->sprite_index[0];
-                    g_overlay_primitives[g_overlay_primitives_end].sprite_index[1] = entity->sprite_index[1];
-                    ++g_overlay_primitives_end;
-                } break;
-            }
-
+            audio_play_sound(xaudio2_ctx, g_sound_maggot, sizeof(g_sound_maggot), 1.0f, AUDIO_FLAG_NONE);
+        }
+        world_cull_primitives();
+        sdf_bins_build(g_world.camera, g_player.growth_factor);
+        sdf_collision_snapshot_build(g_player.growth_factor, g_player.time);
+        if (g_nav.chase_player)
+        {
+            nav_update(g_player.position);
         }
 
         /* Set background image logic. */
@@ -1925,58 +1369,59 @@ int WINAPI WinMain(
         /*
         if (window_key_down(window, KEY_CONTROL_LEFT))
         {
-            if (window_key_pressed(window, KEY_H)) g_entities[level_edit_entity].position.x -= level_edit_move_speed;
-            if (window_key_pressed(window, KEY_J)) g_entities[level_edit_entity].position.y += level_edit_move_speed;
-            if (window_key_pressed(window, KEY_K)) g_entities[level_edit_entity].position.y -= level_edit_move_speed;
-            if (window_key_pressed(window, KEY_L)) g_entities[level_edit_entity].position.x += level_edit_move_speed;
+            if (window_key_pressed(window, KEY_H)) g_entity_store.position_x[level_edit_entity] -= level_edit_move_speed;
+            if (window_key_pressed(window, KEY_J)) g_entity_store.position_y[level_edit_entity] += level_edit_move_speed;
+            if (window_key_pressed(window, KEY_K)) g_entity_store.position_y[level_edit_entity] -= level_edit_move_speed;
+            if (window_key_pressed(window, KEY_L)) g_entity_store.position_x[level_edit_entity] += level_edit_move_speed;
 
-            if (window_key_pressed(window, KEY_1)) g_entities[level_edit_entity].growth_sizes1.x -= level_edit_size_speed;
-            if (window_key_pressed(window, KEY_2)) g_entities[level_edit_entity].growth_sizes1.x += level_edit_size_speed;
-            if (window_key_pressed(window, KEY_5)) g_entities[level_edit_entity].growth_sizes1.y -= level_edit_size_speed;
-            if (window_key_pressed(window, KEY_6)) g_entities[level_edit_entity].growth_sizes1.y += level_edit_size_speed;
-            if (window_key_pressed(window, KEY_9)) g_entities[level_edit_entity].growth_sizes1.z -= level_edit_size_speed;
-            if (window_key_pressed(window, KEY_0)) g_entities[level_edit_entity].growth_sizes1.z += level_edit_size_speed;
+            if (window_key_pressed(window, KEY_1)) g_entity_store.growth_sizes1[level_edit_entity].x -= level_edit_size_speed;
+            if (window_key_pressed(window, KEY_2)) g_entity_store.growth_sizes1[level_edit_entity].x += level_edit_size_speed;
+            if (window_key_pressed(window, KEY_5)) g_entity_store.growth_sizes1[level_edit_entity].y -= level_edit_size_speed;
+            if (window_key_pressed(window, KEY_6)) g_entity_store.growth_sizes1[level_edit_entity].y += level_edit_size_speed;
+            if (window_key_pressed(window, KEY_9)) g_entity_store.growth_sizes1[level_edit_entity].z -= level_edit_size_speed;
+            if (window_key_pressed(window, KEY_0)) g_entity_store.growth_sizes1[level_edit_entity].z += level_edit_size_speed;
 
             if (window_key_down(window, KEY_SHIFT_LEFT))
             {
-                if (window_key_pressed(window, KEY_1)) g_entities[level_edit_entity].growth_sizes2.x -= level_edit_size_speed;
-                if (window_key_pressed(window, KEY_2)) g_entities[level_edit_entity].growth_sizes2.x += level_edit_size_speed;
-                if (window_key_pressed(window, KEY_5)) g_entities[level_edit_entity].growth_sizes2.y -= level_edit_size_speed;
-                if (window_key_pressed(window, KEY_6)) g_entities[level_edit_entity].growth_sizes2.y += level_edit_size_speed;
-                if (window_key_pressed(window, KEY_9)) g_entities[level_edit_entity].growth_sizes2.z -= level_edit_size_speed;
-                if (window_key_pressed(window, KEY_0)) g_entities[level_edit_entity].growth_sizes2.z += level_edit_size_speed;
+                if (window_key_pressed(window, KEY_1)) g_entity_store.growth_sizes2[level_edit_entity].x -= level_edit_size_speed;
+                if (window_key_pressed(window, KEY_2)) g_entity_store.growth_sizes2[level_edit_entity].x += level_edit_size_speed;
+                if (window_key_pressed(window, KEY_5)) g_entity_store.growth_sizes2[level_edit_entity].y -= level_edit_size_speed;
+                if (window_key_pressed(window, KEY_6)) g_entity_store.growth_sizes2[level_edit_entity].y += level_edit_size_speed;
+                if (window_key_pressed(window, KEY_9)) g_entity_store.growth_sizes2[level_edit_entity].z -= level_edit_size_speed;
+                if (window_key_pressed(window, KEY_0)) g_entity_store.growth_sizes2[level_edit_entity].z += level_edit_size_speed;
             }
         }
         else
         {
-            if (window_key_down(window, KEY_H)) g_entities[level_edit_entity].position.x -= level_edit_move_speed;
-            if (window_key_down(window, KEY_J)) g_entities[level_edit_entity].position.y += level_edit_move_speed;
-            if (window_key_down(window, KEY_K)) g_entities[level_edit_entity].position.y -= level_edit_move_speed;
-            if (window_key_down(window, KEY_L)) g_entities[level_edit_entity].position.x += level_edit_move_speed;
+            if (window_key_down(window, KEY_H)) g_entity_store.position_x[level_edit_entity] -= level_edit_move_speed;
+            if (window_key_down(window, KEY_J)) g_entity_store.position_y[level_edit_entity] += level_edit_move_speed;
+            if (window_key_down(window, KEY_K)) g_entity_store.position_y[level_edit_entity] -= level_edit_move_speed;
+            if (window_key_down(window, KEY_L)) g_entity_store.position_x[level_edit_entity] += level_edit_move_speed;
 
-            if (window_key_down(window, KEY_1)) g_entities[level_edit_entity].growth_sizes1.x -= level_edit_size_speed;
-            if (window_key_down(window, KEY_2)) g_entities[level_edit_entity].growth_sizes1.x += level_edit_size_speed;
-            if (window_key_down(window, KEY_5)) g_entities[level_edit_entity].growth_sizes1.y -= level_edit_size_speed;
-            if (window_key_down(window, KEY_6)) g_entities[level_edit_entity].growth_sizes1.y += level_edit_size_speed;
-            if (window_key_down(window, KEY_9)) g_entities[level_edit_entity].growth_sizes1.z -= level_edit_size_speed;
-            if (window_key_down(window, KEY_0)) g_entities[level_edit_entity].growth_sizes1.z += level_edit_size_speed;
+            if (window_key_down(window, KEY_1)) g_entity_store.growth_sizes1[level_edit_entity].x -= level_edit_size_speed;
+            if (window_key_down(window, KEY_2)) g_entity_store.growth_sizes1[level_edit_entity].x += level_edit_size_speed;
+            if (window_key_down(window, KEY_5)) g_entity_store.growth_sizes1[level_edit_entity].y -= level_edit_size_speed;
+            if (window_key_down(window, KEY_6)) g_entity_store.growth_sizes1[level_edit_entity].y += level_edit_size_speed;
+            if (window_key_down(window, KEY_9)) g_entity_store.growth_sizes1[level_edit_entity].z -= level_edit_size_speed;
+            if (window_key_down(window, KEY_0)) g_entity_store.growth_sizes1[level_edit_entity].z += level_edit_size_speed;
 
             if (window_key_down(window, KEY_SHIFT_LEFT))
             {
-                if (window_key_down(window, KEY_1)) g_entities[level_edit_entity].growth_sizes2.x -= level_edit_size_speed;
-                if (window_key_down(window, KEY_2)) g_entities[level_edit_entity].growth_sizes2.x += level_edit_size_speed;
-                if (window_key_down(window, KEY_5)) g_entities[level_edit_entity].growth_sizes2.y -= level_edit_size_speed;
-                if (window_key_down(window, KEY_6)) g_entities[level_edit_entity].growth_sizes2.y += level_edit_size_speed;
-                if (window_key_down(window, KEY_9)) g_entities[level_edit_entity].growth_sizes2.z -= level_edit_size_speed;
-                if (window_key_down(window, KEY_0)) g_entities[level_edit_entity].growth_sizes2.z += level_edit_size_speed;
+                if (window_key_down(window, KEY_1)) g_entity_store.growth_sizes2[level_edit_entity].x -= level_edit_size_speed;
+                if (window_key_down(window, KEY_2)) g_entity_store.growth_sizes2[level_edit_entity].x += level_edit_size_speed;
+                if (window_key_down(window, KEY_5)) g_entity_store.growth_sizes2[level_edit_entity].y -= level_edit_size_speed;
+                if (window_key_down(window, KEY_6)) g_entity_store.growth_sizes2[level_edit_entity].y += level_edit_size_speed;
+                if (window_key_down(window, KEY_9)) g_entity_store.growth_sizes2[level_edit_entity].z -= level_edit_size_speed;
+                if (window_key_down(window, KEY_0)) g_entity_store.growth_sizes2[level_edit_entity].z += level_edit_size_speed;
             }
         }
+        g_entity_store.is_dirty[level_edit_entity] = TRUE;
 
         if (window_key_pressed(window, KEY_T)) 
         {
-            u32 type = (u32)g_entities[level_edit_entity].type;
-            type = (type + 1) % _ENTITY_TYPE_COUNT;
-            g_entities[level_edit_entity].type = (entity_type)type;
+            u32 type = (u32)g_entity_store.type[level_edit_entity];
+            type = type % (_ENTITY_TYPE_COUNT - 1) + 1;
+            entity_set_type(level_edit_entity, (entity_type)type);
         }
 
         if (window_key_pressed(window, KEY_I) && level_edit_entity < ENTITIES_COUNT_MAX) level_edit_entity +=1;
@@ -1996,12 +1441,35 @@ int WINAPI WinMain(
 
         /* -------------------------------------------------- */
 
-        graphics_structured_buffer_update(&sdf_level_primitives_buffer, g_level_primitives, sizeof(g_level_primitives));
-        graphics_structured_buffer_update(&sdf_overlay_primitives_buffer, g_overlay_primitives, sizeof(g_overlay_primitives));
+        /* Only the slots the cull rewrote are uploaded. */
+        for (u32 i = 0; i < g_level_primitives_dirty.count; ++i)
+        {
+            sdf_dirty_range range = g_level_primitives_dirty.ranges[i];
+            graphics_structured_buffer_update_range(&sdf_level_primitives_buffer, g_level_primitives, range.begin, range.end - range.begin);
+        }
+        for (u32 i = 0; i < g_overlay_primitives_dirty.count; ++i)
+        {
+            sdf_dirty_range range = g_overlay_primitives_dirty.ranges[i];
+            graphics_structured_buffer_update_range(&sdf_overlay_primitives_buffer, g_overlay_primitives, range.begin, range.end - range.begin);
+        }
+        if (particles_packed_count() > 0)
+        {
+            graphics_structured_buffer_update_range(&sdf_particles_buffer, g_particles_packed, 0, particles_packed_count());
+        }
+        graphics_structured_buffer_update_range(&sdf_level_bins_buffer, &g_level_bins, 0, sdf_bins_words_count(&g_level_bins));
+        graphics_structured_buffer_update_range(&sdf_overlay_bins_buffer, &g_overlay_bins, 0, sdf_bins_words_count(&g_overlay_bins));
+        if (hud_image_update((u32 const*)g_texture_spritesheet, TEXTURE_SPRITESHEET_WIDTH, TEXTURE_SPRITESHEET_HEIGHT))
+        {
+            graphics_image_update(&hud_icons_image, g_hud_image.texels);
+        }
 
         camera.model_view_projection = graphics_calc_image_projection(window, RENDER_WIDTH, RENDER_HEIGHT);
         camera.model_view_projection = fmat44_transpose(camera.model_view_projection);
+        camera.position = g_world.camera;
+        camera.primitives_origin = world_primitives_origin();
         g_player.time += (f32)window->delta_time;
+        camera.noise_weights_time = noise_weights(g_player.time);
+        camera.noise_weights_tenth = noise_weights(g_player.time * 0.1f);
 
         graphics_pass_begin(&d3d11_ctx, window->width, window->height);
         graphics_bindings_set(&bindings);
@@ -2015,7 +1483,40 @@ int WINAPI WinMain(
         if (window_key_down(window, KEY_F))
         {
             printf("MS: %f, FPS: %f\n", 1.0 / window->delta_time, window->delta_time);
+            sdf_collision_snapshot_print();
+            sdf_query_cache_print(&player_query_cache, "Player collision");
+            sdf_raycast_stats_print();
+            nav_print();
+            crowd_print();
+            sdf_bins_print();
+            world_print();
+        }
+        #if DEBUG
+        if (window_key_pressed(window, KEY_B))
+        {
+            benchmark_player_path();
+            benchmark_raycasts();
+            benchmark_growth_factors();
+            benchmark_navigation();
+            benchmark_world();
+            benchmark_entity_layouts();
+            benchmark_entity_spawns();
+            benchmark_entity_systems();
+            benchmark_primitive_packing();
+            benchmark_particles();
+            benchmark_crowd();
+            benchmark_bins();
+            benchmark_noise();
+        }
+        if (window_key_pressed(window, KEY_N))
+        {
+            g_nav.chase_player = !g_nav.chase_player;
+        }
+        if (window_key_pressed(window, KEY_M))
+        {
+            g_crowd.is_wandering = !g_crowd.is_wandering;
         }
+        #endif
     }
 
     graphics_pipeline_destroy(&pipeline);
@@ -2023,12 +1524,16 @@ int WINAPI WinMain(
     graphics_shader_destroy(&shader);
     graphics_structured_buffer_destory(&sdf_level_primitives_buffer);
     graphics_structured_buffer_destory(&sdf_overlay_primitives_buffer);
+    graphics_structured_buffer_destory(&sdf_particles_buffer);
+    graphics_structured_buffer_destory(&sdf_level_bins_buffer);
+    graphics_structured_buffer_destory(&sdf_overlay_bins_buffer);
     graphics_image_destroy(&noise_image);
     graphics_image_destroy(&credits_image);
     graphics_image_destroy(&main_menu_image);
     graphics_image_destroy(&background_image);
     graphics_image_destroy(&end_image);
     graphics_image_destroy(&spritesheet_image);
+    graphics_image_destroy(&hud_icons_image);
     graphics_buffer_destroy(&vertex_buffer);
 
     audio_xaudio2_destory(xaudio2_ctx);
@@ -2675,6 +2180,27 @@ void graphics_structured_buffer_update(graphics_structured_buffer* i_buffer, voi
     );
 }
 
+/* Uploads i_count elements starting at element i_first, i_data points at the start of the whole buffer. */
+void graphics_structured_buffer_update_range(graphics_structured_buffer* i_buffer, void* i_data, sz_t i_first, sz_t i_count)
+{
+    D3D11_BOX box;
+    box.left = (UINT)(i_first * i_buffer->size);
+    box.right = (UINT)((i_first + i_count) * i_buffer->size);
+    box.top = 0;
+    box.bottom = 1;
+    box.front = 0;
+    box.back = 1;
+
+    i_buffer->context.device_context->UpdateSubresource(
+        i_buffer->buffer,
+        0,
+        &box,
+        (u8*)i_data + box.left,
+        0,
+        0
+    );
+}
+
 graphics_image graphics_image_create(graphics_d3d11_ctx* i_d3d11_ctx, graphics_image_desc i_desc)
 {
     HRESULT result;
@@ -2686,6 +2212,7 @@ graphics_image graphics_image_create(graphics_d3d11_ctx* i_d3d11_ctx, graphics_i
 
     graphics_image image;
     memzero(&image, sizeof(image));
+    image.context = *i_d3d11_ctx;
 
     /* Determine format. */
     switch (i_desc.type)
@@ -2714,15 +2241,16 @@ graphics_image graphics_image_create(graphics_d3d11_ctx* i_d3d11_ctx, graphics_i
     texture_desc.MipLevels = 1;
     texture_desc.ArraySize = 1;
     texture_desc.Format = image.format;
-    texture_desc.Usage = D3D11_USAGE_IMMUTABLE;
+    texture_desc.Usage = i_desc.is_dynamic ? D3D11_USAGE_DEFAULT : D3D11_USAGE_IMMUTABLE;
     texture_desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-    texture_desc.CPUAccessFlags = 0; /* Immutable. No read or write access. */
+    texture_desc.CPUAccessFlags = 0; /* No read or write access, dynamic images are updated with UpdateSubresource. */
     texture_desc.SampleDesc.Count = 1;
     texture_desc.SampleDesc.Quality = 0;
 
     memzero(&init_data, sizeof(init_data));
     init_data.pSysMem = i_desc.bytes;
     init_data.SysMemPitch = i_desc.width * format_byte_size;
+    image.pitch = init_data.SysMemPitch;
 
     result = i_d3d11_ctx->device->CreateTexture2D(&texture_desc, &init_data, &image.texture_2d);
     if (!SUCCEEDED(result))
@@ -2803,6 +2331,19 @@ void graphics_image_destroy(graphics_image* io_image)
     memzero(io_image, sizeof(*io_image));
 }
 
+/* Replaces all texels of an image created with is_dynamic. */
+void graphics_image_update(graphics_image* i_image, void* i_data)
+{
+    i_image->context.device_context->UpdateSubresource(
+        i_image->texture_2d,
+        0,
+        NULL,
+        i_data,
+        i_image->pitch,
+        0
+    );
+}
+
 graphics_shader graphics_shader_create(graphics_d3d11_ctx* i_d3d11_ctx, graphics_shader_desc i_desc)
 {
     HRESULT result;
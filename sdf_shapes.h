@@ -0,0 +1,333 @@
+/* Signed distance shapes shared between the CPU and the fragment shader.
+ *
+ * Every shape is written once in a subset of C++ that is also valid HLSL. This file has no include guard
+ * on purpose, it is included twice:
+ *   - At file scope with SDF_SHAPES_HLSL undefined, which compiles the shapes as C++ using core.h types.
+ *   - Inside the fragment shader source string with SDF_SHAPES_HLSL defined, which stringifies the same
+ *     code after macro expansion and pastes it into the shader between the other string literals.
+ *
+ * Rules for code in a SDF_SHARED block:
+ *   - Only f32, u32 and fvec2 and only core.h functions that have a shim in the HLSL prelude below.
+ *   - No operators on vectors, no temporaries, locals are brace initialized or built with sdf_vec2.
+ *   - math_min and math_max only on plain scalars, use sdf_min and sdf_max on calls to not evaluate them twice.
+ *   - No preprocessor directives and no commas outside of parentheses or braces.
+ *   - Each block must stay below the 16KB string literal limit of msvc once stringified.
+ *
+ * sample_noise is provided by the includer, it is a texture lookup on the GPU and an equivalent bilinear
+ * lookup into g_texture_noise on the CPU.
+ *
+ * Costs below are per evaluation, sqrt/sin/atan2 etc. counting as one transcendental. None of the shapes
+ * branch on anything but the sign of values, so all of them can be evaluated for many points at once.
+ * Credit to iq (https://iquilezles.org/articles/distfunctions2d/) for the original signed distance functions. */
+
+#if defined(SDF_SHAPES_HLSL)
+    #define SDF_SHARED(...) xstringify(__VA_ARGS__)
+#else
+    #define SDF_SHARED(...) __VA_ARGS__
+#endif
+
+#if defined(SDF_SHAPES_HLSL)
+/* Maps the core.h names used by the shared code onto their HLSL equivalents. */
+SDF_SHARED(
+    typedef float f32_t;
+    typedef uint u32_t;
+    typedef float2 fvec2_t;
+
+    float sinf(float i_value)                     { return sin(i_value); }
+    float cosf(float i_value)                     { return cos(i_value); }
+    float sqrtf(float i_value)                    { return sqrt(i_value); }
+    float atan2f(float i_y, float i_x)            { return atan2(i_y, i_x); }
+    float floorf(float i_value)                   { return floor(i_value); }
+    float roundf(float i_value)                   { return round(i_value); }
+    float exp2f(float i_value)                    { return exp2(i_value); }
+    float log2f(float i_value)                    { return log2(i_value); }
+
+    float f32_abs(float i_value)                  { return abs(i_value); }
+    float f32_lerp(float i_start, float i_end, float i_percentage) { return lerp(i_start, i_end, i_percentage); }
+
+    float2 fvec2_add(float2 i_left, float2 i_right) { return i_left + i_right; }
+    float2 fvec2_sub(float2 i_left, float2 i_right) { return i_left - i_right; }
+    float2 fvec2_mul(float2 i_left, float2 i_right) { return i_left * i_right; }
+    float2 fvec2_div(float2 i_left, float2 i_right) { return i_left / i_right; }
+    float2 fvec2_mul_s(float2 i_left, float i_right) { return i_left * i_right; }
+    float2 fvec2_abs(float2 i_vec)                { return abs(i_vec); }
+    float fvec2_dot(float2 i_left, float2 i_right) { return dot(i_left, i_right); }
+    float fvec2_len(float2 i_vec)                 { return length(i_vec); }
+    float2 fvec2_norm(float2 i_vec)               { return normalize(i_vec); }
+)
+#else
+f32 sample_noise(fvec2 i_position, f32 i_offset);
+#endif
+
+/* Helpers and fundamental sdf shapes. */
+SDF_SHARED(
+    fvec2 sdf_vec2(f32 i_x, f32 i_y)
+    {
+        fvec2 result = { i_x, i_y };
+        return result;
+    }
+
+    f32 sdf_min(f32 i_value1, f32 i_value2)
+    {
+        return i_value1 < i_value2 ? i_value1 : i_value2;
+    }
+
+    f32 sdf_max(f32 i_value1, f32 i_value2)
+    {
+        return i_value1 > i_value2 ? i_value1 : i_value2;
+    }
+
+    f32 sdf_sign(f32 i_value)
+    {
+        return i_value > 0.0f ? 1.0f : (i_value < 0.0f ? -1.0f : 0.0f);
+    }
+
+    f32 sdf_fract(f32 i_value)
+    {
+        return i_value - f32_floor(i_value);
+    }
+
+    /* Unlike fmodf this wraps negative values into [0, y). */
+    f32 sdf_mod(f32 i_x, f32 i_y)
+    {
+        return i_x - i_y * f32_floor(i_x / i_y);
+    }
+
+    f32 sdf_atan(f32 i_y, f32 i_x)
+    {
+        if (i_x == 0.0f && i_y == 0.0f)
+        {
+            i_x = 1.0f;
+        }
+        return f32_atan2(i_y, i_x);
+    }
+
+    /* Rotates by i_angle radians, counter clockwise with y pointing up. */
+    fvec2 sdf_rotate_angle(fvec2 i_position, f32 i_angle)
+    {
+        f32 c = f32_cos(i_angle);
+        f32 s = f32_sin(i_angle);
+        return sdf_vec2(c * i_position.x - s * i_position.y, s * i_position.x + c * i_position.y);
+    }
+
+    /* Rotates by i_rotation full turns. */
+    fvec2 sdf_rotate(fvec2 i_position, f32 i_rotation)
+    {
+        return sdf_rotate_angle(i_position, i_rotation * 3.1415925f * 2.0f);
+    }
+
+    /* Progressively smoother procedural noise, used where the baked noise texture is too coarse. The CPU queries
+     * the copy noise_atlas_bake bakes in game.h, see noise_value_baked.
+     * Cost: 1 sin. */
+    f32 noise_random(fvec2 i_position)
+    {
+        fvec2 seed = { 12.9898f, 4.1414f };
+        return sdf_fract(f32_sin(fvec2_dot(i_position, seed)) * 43758.5453f);
+    }
+
+    /* Cost: 4 sin. */
+    f32 noise_value(fvec2 i_position, f32 i_offset)
+    {
+        fvec2 position = { i_position.x + i_offset, i_position.y };
+        fvec2 i = { f32_floor(position.x), f32_floor(position.y) };
+        fvec2 f = fvec2_sub(position, i);
+        f = fvec2_mul(fvec2_mul(f, f), fvec2_sub(sdf_vec2(3.0f, 3.0f), fvec2_mul_s(f, 2.0f)));
+        f32 a = noise_random(i);
+        f32 b = noise_random(fvec2_add(i, sdf_vec2(1.0f, 0.0f)));
+        f32 c = noise_random(fvec2_add(i, sdf_vec2(0.0f, 1.0f)));
+        f32 d = noise_random(fvec2_add(i, sdf_vec2(1.0f, 1.0f)));
+        return f32_lerp(f32_lerp(a, b, f.x), f32_lerp(c, d, f.x), f.y);
+    }
+
+    /* Cost: 1 sqrt. */
+    f32 sdf_circle(fvec2 i_uv, fvec2 i_position, f32 i_radius)
+    {
+        return fvec2_len(fvec2_sub(i_position, i_uv)) - i_radius;
+    }
+
+    /* Cost: 1 sqrt. */
+    f32 sdf_box(fvec2 i_uv, fvec2 i_position, fvec2 i_size)
+    {
+        fvec2 distance = fvec2_sub(fvec2_abs(fvec2_sub(i_position, i_uv)), i_size);
+        fvec2 outside = { math_max(distance.x, 0.0f), math_max(distance.y, 0.0f) };
+        f32 inside = math_max(distance.x, distance.y);
+        return fvec2_len(outside) + math_min(inside, 0.0f);
+    }
+
+    /* Cost: 1 sqrt, 1 div. */
+    f32 sdf_segment(fvec2 i_uv, fvec2 i_position, fvec2 i_start, fvec2 i_end)
+    {
+        fvec2 position_start = fvec2_sub(fvec2_sub(i_position, i_uv), i_start);
+        fvec2 end_start = fvec2_sub(i_end, i_start);
+        f32 height = fvec2_dot(position_start, end_start) / fvec2_dot(end_start, end_start);
+        height = math_clamp(height, 0.0f, 1.0f);
+        return fvec2_len(fvec2_sub(position_start, fvec2_mul_s(end_start, height)));
+    }
+
+    /* Cost: 1 sqrt, 2 div. */
+    f32 sdf_triangle_isosceles(fvec2 i_uv, fvec2 i_position, fvec2 i_half_width_height)
+    {
+        fvec2 q = i_half_width_height;
+        fvec2 position = fvec2_sub(i_position, i_uv);
+        position.x = f32_abs(position.x);
+
+        f32 a_height = fvec2_dot(position, q) / fvec2_dot(q, q);
+        f32 b_width = position.x / q.x;
+        fvec2 a = fvec2_sub(position, fvec2_mul_s(q, math_clamp(a_height, 0.0f, 1.0f)));
+        fvec2 b = fvec2_sub(position, fvec2_mul(q, sdf_vec2(math_clamp(b_width, 0.0f, 1.0f), 1.0f)));
+        f32 s = -sdf_sign(q.y);
+        f32 d_squared = sdf_min(fvec2_dot(a, a), fvec2_dot(b, b));
+        f32 d_sign = sdf_min(s * (position.x * q.y - position.y * q.x), s * (position.y - q.y));
+        return -f32_sqrt(d_squared) * sdf_sign(d_sign);
+    }
+
+    /* Cost: 2 sqrt, 1 atan2, 1 log2, 2 exp2. */
+    f32 sdf_spiral(fvec2 i_uv, fvec2 i_position, f32 i_width, f32 i_rotations)
+    {
+        /* Body */
+        fvec2 position = fvec2_sub(i_position, i_uv);
+        f32 tau = 6.283185307f;
+        f32 r = fvec2_len(position);
+        f32 a = sdf_atan(position.y, position.x);
+        f32 n = f32_floor(0.5f / i_width + (f32_log2(r / i_width) * i_rotations - a) / tau);
+        f32 ra = i_width * f32_exp2((a + tau * (sdf_min(n + 0.0f, 0.0f) - 0.5f)) / i_rotations);
+        f32 rb = i_width * f32_exp2((a + tau * (sdf_min(n + 1.0f, 0.0f) - 0.5f)) / i_rotations);
+        f32 d = sdf_min(f32_abs(r - ra), f32_abs(r - rb));
+
+        /* Tip */
+        return sdf_min(d, fvec2_len(fvec2_add(position, sdf_vec2(i_width, 0.0f)))) - 2.0f;
+    }
+)
+
+/* Assembled sdf shapes.
+ * TODO: Don't you love random hard coded values... */
+SDF_SHARED(
+    /* Cost: 7 sqrt, 2 sin/cos, 2 div. */
+    f32 sdf_player(fvec2 i_uv, fvec2 i_position, f32 i_scale, f32 i_time)
+    {
+        fvec2 scale = { f32_abs(f32_sin(i_time * 3.0f)), f32_abs(f32_cos(i_time * 3.0f)) };
+        scale = fvec2_mul_s(fvec2_add(sdf_vec2(1.0f, 1.0f), fvec2_mul_s(scale, 0.25f)), 0.5f * i_scale);
+
+        fvec2 uv = fvec2_add(i_uv, fvec2_mul(i_position, scale));
+        uv = fvec2_div(uv, fvec2_add(sdf_vec2(1.0f, 1.0f), scale));
+
+        f32 radius = 27.0f * i_scale;
+        f32 circle = sdf_circle(uv, i_position, radius);
+        circle = sdf_min(circle, sdf_circle(uv, fvec2_sub(i_position, sdf_vec2(25.0f, 10.0f)), radius * 0.3f));
+        circle = sdf_min(circle, sdf_circle(uv, fvec2_sub(i_position, sdf_vec2(10.0f, 20.0f)), radius * 0.5f));
+        circle = sdf_min(circle, sdf_circle(uv, fvec2_sub(i_position, sdf_vec2(-15.0f, 0.0f)), radius * 0.6f));
+        circle = sdf_min(circle, sdf_circle(uv, fvec2_sub(i_position, sdf_vec2(-15.0f, 20.0f)), radius * 0.3f));
+
+        fvec2 hand1 = fvec2_mul_s(sdf_vec2(15.0f, -20.0f * (1.0f + scale.x * 0.4f)), i_scale);
+        fvec2 hand2 = fvec2_mul_s(sdf_vec2(-15.0f, -20.0f * (1.0f + scale.y * 0.4f)), i_scale);
+        f32 arm1 = sdf_segment(uv, i_position, sdf_vec2(15.0f, 10.0f), hand1) - 5.0f * i_scale;
+        f32 arm2 = sdf_segment(uv, i_position, sdf_vec2(-15.0f, 10.0f), hand2) - 5.0f * i_scale;
+        return sdf_min(circle, sdf_min(arm1, arm2));
+    }
+
+    /* Cost: 1 sqrt, 1 sample_noise. */
+    f32 sdf_wobbly_circle(fvec2 i_uv, fvec2 i_position, f32 i_radius, f32 i_time)
+    {
+        return sdf_circle(i_uv, i_position, i_radius) - 25.0f * sample_noise(i_uv, i_time);
+    }
+
+    /* Reaches at most 1.05 * i_size from i_position.
+     * Cost: 3 sqrt, 1 atan2, 9 sin/cos, 5 div. */
+    f32 sdf_spiked_circle(fvec2 i_uv, fvec2 i_position, f32 i_size, f32 i_time)
+    {
+        fvec2 position = fvec2_sub(i_position, i_uv);
+        f32 b = 6.283185f / 24.0f;
+        f32 a = sdf_atan(position.y, position.x);
+        f32 i = f32_floor(a / b);
+
+        /* Only the two spikes around the query angle can be closest. */
+        fvec2 p1 = sdf_rotate_angle(position, -b * (i + 0.0f));
+        fvec2 p2 = sdf_rotate_angle(position, -b * (i + 1.0f));
+
+        f32 o = sdf_mod(f32_round(a / 6.283185f * 16.0f), 2.0f);
+        f32 t = (1.0f + f32_sin(i_time)) / 2.0f;
+        f32 r = o + t - 2.0f * o * t;
+
+        f32 m = 4.712388f;
+        fvec2 base = { i_size * 0.9f, 0.0f };
+        p1 = sdf_rotate_angle(fvec2_sub(p1, base), m);
+        p2 = sdf_rotate_angle(fvec2_sub(p2, base), m);
+        p1.y -= r * 0.15f * i_size;
+        p2.y -= r * 0.15f * i_size;
+
+        fvec2 origin = { 0.0f, 0.0f };
+        fvec2 spike_size = { 0.02f * i_size, (0.15f - r * 0.15f) * i_size };
+        f32 spikes = sdf_min(sdf_triangle_isosceles(origin, p1, spike_size),
+                             sdf_triangle_isosceles(origin, p2, spike_size));
+
+        return sdf_min(spikes, sdf_circle(i_uv, i_position, 0.75f * i_size));
+    }
+
+    /* Cost: 1 sqrt, 1 or 2 sample_noise. */
+    f32 sdf_wobbly_box(fvec2 i_uv, fvec2 i_position, fvec2 i_size, f32 i_time)
+    {
+        f32 distance = sdf_box(i_uv, i_position, i_size) - 25.0f * sample_noise(i_uv, 0.0f);
+        if (distance <= 0.0f)
+        {
+            distance *= sample_noise(i_uv, i_time * 0.1f) <= 0.7f ? -1.0f : 0.0f;
+        }
+        return distance;
+    }
+
+    /* Reaches at most 2.1 * i_size from i_position.
+     * Cost: 5 sqrt, 2 atan2, 6 sin/cos, 1 log2, 2 exp2, 1 sample_noise. */
+    f32 sdf_portal(fvec2 i_uv, fvec2 i_position, f32 i_size, f32 i_time)
+    {
+        fvec2 position = sdf_rotate(fvec2_sub(i_position, i_uv), 0.1f * i_time);
+        f32 b = 6.283185f / 9.0f;
+        f32 a = sdf_atan(position.y, position.x);
+        f32 i = f32_floor(a / b);
+
+        fvec2 base = { i_size, 0.0f };
+        fvec2 p1 = fvec2_sub(sdf_rotate_angle(position, -b * (i + 0.0f)), base);
+        fvec2 p2 = fvec2_sub(sdf_rotate_angle(position, -b * (i + 1.0f)), base);
+
+        fvec2 origin = { 0.0f, 0.0f };
+        f32 noise = sample_noise(i_uv, i_time);
+        f32 portal = sdf_min(sdf_circle(origin, p1, i_size * 0.1f), sdf_circle(origin, p2, i_size * 0.1f));
+        portal -= 0.6f * i_size * noise;
+        portal = sdf_min(portal, sdf_circle(i_uv, i_position, i_size * 0.5f));
+
+        f32 spiral = sdf_spiral(origin, position, 2.0f * i_size, 6.0f);
+        spiral -= 0.1f * i_size * noise;
+
+        return sdf_max(-spiral, portal);
+    }
+
+    /* The breathing scales uv around the screen center, so this is not a true distance.
+     * Cost: 8 sqrt, 4 sin/cos, 2 div. */
+    f32 sdf_maggot(fvec2 i_uv, fvec2 i_position, f32 i_size, f32 i_time)
+    {
+        fvec2 scale = { f32_abs(f32_sin(i_time * 3.0f)), f32_abs(f32_cos(i_time * 3.0f)) };
+        scale = fvec2_mul_s(fvec2_add(sdf_vec2(1.0f, 1.0f), fvec2_mul_s(scale, 0.25f)), 0.5f);
+
+        fvec2 uv = fvec2_add(i_uv, fvec2_mul(i_position, scale));
+        uv = fvec2_div(uv, fvec2_add(sdf_vec2(1.0f, 1.0f), scale));
+
+        fvec2 position = fvec2_sub(fvec2_sub(i_position, uv), fvec2_mul_s(sdf_vec2(0.0f, -0.1f), i_size));
+        position = sdf_rotate(position, 0.25f * i_time);
+        f32 s = 2.0f * i_size;
+
+        /* body */
+        f32 b1 = sdf_circle(fvec2_mul_s(sdf_vec2(0.05f, -0.25f), s), position, i_size * 0.95f);
+        f32 b2 = sdf_circle(fvec2_mul_s(sdf_vec2(0.3f, -0.05f), s), position, i_size * 0.75f);
+        f32 b3 = sdf_circle(fvec2_mul_s(sdf_vec2(0.35f, 0.25f), s), position, i_size * 0.5f);
+        f32 b4 = sdf_circle(fvec2_mul_s(sdf_vec2(0.25f, 0.5f), s), position, i_size * 0.3f);
+        f32 b5 = sdf_circle(fvec2_mul_s(sdf_vec2(0.05f, 0.59f), s), position, i_size * 0.25f);
+        f32 b6 = sdf_circle(fvec2_mul_s(sdf_vec2(-0.1f, 0.57f), s), position, i_size * 0.2f);
+
+        /* eyes */
+        f32 e7 = sdf_circle(fvec2_mul_s(sdf_vec2(-0.4f, -0.3f), s), position, i_size * 0.25f);
+        f32 e8 = sdf_circle(fvec2_mul_s(sdf_vec2(0.25f, -0.3f), s), position, i_size * 0.25f);
+
+        f32 body = sdf_min(sdf_min(sdf_min(b1, b2), sdf_min(b3, b4)), sdf_min(b5, b6));
+        return sdf_max(sdf_max(body, -e7), -e8);
+    }
+)
+
+#undef SDF_SHARED
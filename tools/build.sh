@@ -0,0 +1,17 @@
+#!/bin/sh
+
+# usage: tools/build.sh
+# Builds the offline tools in tools/ with g++ or clang++, run from the project directory.
+# On Windows: cl /nologo /O2 /W4 /std:c++14 /Tp tools/level_analyzer.c /I. /Fe:output/level_analyzer.exe
+#             cl /nologo /O2 /W4 /std:c++14 /Tp tools/stress.c /I. /Fe:output/stress.exe
+#             cl /nologo /O2 /W4 /std:c++14 /Tp tools/renderer.c /I. /Fe:output/renderer.exe
+#             cl /nologo /O2 /W4 /std:c++14 /Tp tools/texture_compressor.c /I. /Fe:output/texture_compressor.exe
+#             cl /nologo /O2 /W4 /std:c++14 /Tp tools/sprite_atlas.c /I. /Fe:output/sprite_atlas.exe
+
+CXX=${CXX:-g++}
+mkdir -p output
+$CXX -std=c++14 -O2 -x c++ tools/level_analyzer.c -I. -pthread -Wno-attributes -o output/level_analyzer
+$CXX -std=c++14 -O2 -x c++ tools/stress.c -I. -Wno-attributes -o output/stress
+$CXX -std=c++14 -O2 -x c++ tools/renderer.c -I. -pthread -Wno-attributes -o output/renderer
+$CXX -std=c++14 -O2 -x c++ tools/texture_compressor.c -I. -pthread -Wno-attributes -o output/texture_compressor
+$CXX -std=c++14 -O2 -x c++ tools/sprite_atlas.c -I. -Wno-attributes -o output/sprite_atlas
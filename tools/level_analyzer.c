@@ -0,0 +1,494 @@
+/* Offline reachability analyzer for the levels in levels.h.
+ *
+ * Every level is discretised into cells at a number of growth factors. A cell is free when the player,
+ * inflated by its radius, does not overlap any solid shape there. Moving between free cells within a
+ * growth state is free, switching growth state at a cell costs one switch and is allowed when the cell
+ * is free in the new state and no t-cell grows into the player over the growth factors in between. Walls
+ * and tumors growing into the player only push it, which is not modelled. A flood fill per number of
+ * switches then finds which portals and maggots can be touched and the fewest switches needed to do so.
+ *
+ * Rasterising growth samples and the flood fill of each growth state run in parallel over threads. Cells are
+ * rasterised in blocks, a single query at the center of a block settles every cell in it that is far enough
+ * from the player radius, only blocks along the edges of the free space are queried cell by cell. Queries first
+ * bound spiked circles by circles and only evaluate them when the bounds do not settle a cell.
+ *
+ * usage: level_analyzer [level|all] [tolerance]
+ * tolerance is how many pixels the player may squeeze into solid shapes, the collision response pushes the
+ * player out gradually so tight gaps can be passed in game. Defaults to how far a full speed step into a shape
+ * still overlaps it after the push-out of player_move that frame, 0 is the strictest check.
+ * Exits with 1 if any portal or maggot can not be reached. */
+
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+
+#define DEBUG 0
+#include "core.h"
+
+f64 profile_time_ms()
+{
+    return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#define GAME_HEADLESS 1
+#include "game.h"
+#include "levels.h"
+
+#define ANALYZER_CELL_SIZE 10.0f
+#define ANALYZER_WIDTH ((LEVEL_WIDTH + 9) / 10)
+#define ANALYZER_HEIGHT ((LEVEL_HEIGHT + 9) / 10)
+#define ANALYZER_CELLS_COUNT (ANALYZER_WIDTH * ANALYZER_HEIGHT)
+#define ANALYZER_STATES_COUNT 3
+#define ANALYZER_SAMPLES_PER_STATE 4 /* Growth factors sampled per switch, the first one being the state itself. */
+#define ANALYZER_SAMPLES_COUNT (ANALYZER_STATES_COUNT * ANALYZER_SAMPLES_PER_STATE)
+#define ANALYZER_SWITCHES_UNREACHABLE 0xFF
+#define ANALYZER_TARGETS_COUNT_MAX 32
+
+/* Cells are rasterised in blocks of ANALYZER_BLOCK_CELLS by ANALYZER_BLOCK_CELLS. Distances change no faster than the
+ * position, so a block is settled by its center when the distance there is further from the player radius than
+ * ANALYZER_BLOCK_RADIUS, the furthest cell center of the block. */
+#define ANALYZER_BLOCK_CELLS 4
+#define ANALYZER_BLOCKS_X ((ANALYZER_WIDTH + ANALYZER_BLOCK_CELLS - 1) / ANALYZER_BLOCK_CELLS)
+#define ANALYZER_BLOCKS_Y ((ANALYZER_HEIGHT + ANALYZER_BLOCK_CELLS - 1) / ANALYZER_BLOCK_CELLS)
+#define ANALYZER_BLOCK_RADIUS ((f32)(ANALYZER_BLOCK_CELLS - 1) * 0.5f * ANALYZER_CELL_SIZE * 1.4143f)
+
+/* The collision response of the game loop, max_velocity and push_strength in main.c, at 60 frames a second. 
+ * player_move pushes the player out 4 times a frame, each time by push_strength * delta_time of the overlap. */
+#define ANALYZER_MAX_VELOCITY 900.0f
+#define ANALYZER_PUSH_STRENGTH 4.0f
+#define ANALYZER_DELTA_TIME (1.0f / 60.0f)
+
+typedef struct {
+    u32 entity;
+    entity_type type;
+    u32 switches; /* Fewest growth switches to touch it, ANALYZER_SWITCHES_UNREACHABLE if it can not be touched. */
+} analyzer_target;
+
+typedef struct {
+    /* Snapshot, free cells and cells without t-cells per growth sample. Moving only happens within a growth state, 
+     * so free cells are only rasterised for the first sample of each state, see analyzer_rasterise. */
+    sdf_collision_snapshot snapshots[ANALYZER_SAMPLES_COUNT];
+    b8 free[ANALYZER_SAMPLES_COUNT][ANALYZER_CELLS_COUNT];
+    b8 safe[ANALYZER_SAMPLES_COUNT][ANALYZER_CELLS_COUNT];
+
+    /* A switch from state i to (i + 1) % 3 or back is survived where transition_safe[i] is set. */
+    b8 transition_safe[ANALYZER_STATES_COUNT][ANALYZER_CELLS_COUNT];
+
+    /* Fewest switches to reach each cell per state. */
+    u8 switches[ANALYZER_STATES_COUNT][ANALYZER_CELLS_COUNT];
+    u32 frontiers[ANALYZER_STATES_COUNT][2][ANALYZER_CELLS_COUNT];
+    u32 frontiers_count[ANALYZER_STATES_COUNT];
+
+    analyzer_target targets[ANALYZER_TARGETS_COUNT_MAX];
+    u32 targets_count;
+    f32 player_radius;
+    f32 tolerance;
+} analyzer;
+analyzer g_analyzer;
+
+fvec2 analyzer_cell_center(u32 i_cell)
+{
+    return { ((f32)(i_cell % ANALYZER_WIDTH) + 0.5f) * ANALYZER_CELL_SIZE, ((f32)(i_cell / ANALYZER_WIDTH) + 0.5f) * ANALYZER_CELL_SIZE };
+}
+
+/* Distances from a position to the solid shapes and to the closest t-cell, as ranges the exact distances lie in. */
+typedef struct {
+    f32 solid_min;
+    f32 solid_max;
+    f32 deadly_min;
+    f32 deadly_max;
+} analyzer_distances;
+
+/* Distance to the solid shapes combined the same way as sdf_result_add_shape, and to the closest t-cell.
+ * Only shapes listed in the collision grid cell are tested, anything further is beyond the player radius. Shapes whose
+ * bounds are further than i_reach are skipped as well, callers pad i_reach by twice the smooth min range past the
+ * distances they compare against so blending still decides those comparisons the same way.
+ * Unless i_is_exact, spiked circles are bounded by the circles at 0.75 and 1.05 of their size they lie between 
+ * instead of evaluated. Smooth and plain minimums only grow with their inputs, so the ranges hold the exact distances.
+ * Without i_is_solid only t-cells are tested and the solid distances are left invalid. */
+analyzer_distances analyzer_solid_distances(sdf_collision_snapshot* i_snapshot, fvec2 i_position, f32 i_reach, b8 i_is_solid, b8 i_is_exact)
+{
+    u32 cell = sdf_collision_grid_cell(i_snapshot, i_position);
+    analyzer_distances result = { SDF_RESULT_DISTANCE_INVALID, SDF_RESULT_DISTANCE_INVALID, SDF_RESULT_DISTANCE_INVALID, SDF_RESULT_DISTANCE_INVALID };
+    for (u32 i = i_snapshot->grid_offsets[cell]; i < i_snapshot->grid_offsets[cell + 1]; ++i)
+    {
+        sdf_collision_shape* shape = &i_snapshot->shapes[i_snapshot->grid_shapes[i]];
+        if (shape->type != SDF_PRIMITIVE_CIRCLE && shape->type != SDF_PRIMITIVE_SPIKED_CIRCLE && shape->type != SDF_PRIMITIVE_BOX)
+        {
+            continue;
+        }
+        b8 is_deadly = g_entity_store.type[entity_index(shape->entity)] == ENTITY_TYPE_T_CELL ? TRUE : FALSE;
+        if (!i_is_solid && !is_deadly)
+        {
+            continue;
+        }
+        fvec2 offset = fvec2_sub(shape->position, i_position);
+        f32 reach = i_reach + shape->bounds_radius;
+        if (fvec2_dot(offset, offset) > reach * reach)
+        {
+            continue;
+        }
+
+        f32 shape_min;
+        f32 shape_max;
+        if (!i_is_exact && shape->type == SDF_PRIMITIVE_SPIKED_CIRCLE)
+        {
+            f32 center_distance = fvec2_len(offset);
+            shape_min = center_distance - shape->half_size.x * 1.05f;
+            shape_max = center_distance - shape->half_size.x * 0.75f;
+        }
+        else
+        {
+            shape_min = sdf_collision_shape_evaluate(shape->type, shape->position, shape->half_size, i_position, i_snapshot->time);
+            shape_max = shape_min;
+        }
+
+        if (shape->type == SDF_PRIMITIVE_BOX)
+        {
+            result.solid_min = math_min(result.solid_min, shape_min);
+            result.solid_max = math_min(result.solid_max, shape_max);
+        }
+        else
+        {
+            result.solid_min = f32_min_smooth(result.solid_min, shape_min, 10.0f);
+            result.solid_max = f32_min_smooth(result.solid_max, shape_max, 10.0f);
+        }
+        if (is_deadly)
+        {
+            result.deadly_min = math_min(result.deadly_min, shape_min);
+            result.deadly_max = math_min(result.deadly_max, shape_max);
+        }
+    }
+    return result;
+}
+
+/* Default tolerance, how deep a full speed step into a shape still is after the push-out of the same frame. */
+f32 analyzer_push_out_tolerance()
+{
+    f32 overlap = ANALYZER_MAX_VELOCITY * ANALYZER_DELTA_TIME;
+    for (u32 i = 0; i < 4; ++i)
+    {
+        overlap -= overlap * ANALYZER_PUSH_STRENGTH * ANALYZER_DELTA_TIME;
+    }
+    return overlap;
+}
+
+/* Whether a distance in i_min to i_max is over i_threshold everywhere within i_radius of where it was measured.
+ * Shapes missing from the grid cell are at least SDF_GRID_REACH away. Clears io_is_settled when the range does not
+ * tell, for some points or for the exact distance. */
+b8 analyzer_is_over(f32 i_min, f32 i_max, f32 i_threshold, f32 i_radius, b8* io_is_settled)
+{
+    if (math_min(i_min, SDF_GRID_REACH) - i_radius > i_threshold)
+    {
+        return TRUE;
+    }
+    if (i_max + i_radius <= i_threshold)
+    {
+        return FALSE;
+    }
+    *io_is_settled = FALSE;
+    return FALSE;
+}
+
+void analyzer_rasterise(u32 i_sample)
+{
+    sdf_collision_snapshot* snapshot = &g_analyzer.snapshots[i_sample];
+    b8 is_solid = i_sample % ANALYZER_SAMPLES_PER_STATE == 0 ? TRUE : FALSE;
+    f32 free_distance = g_analyzer.player_radius - g_analyzer.tolerance;
+    f32 cell_reach = is_solid ? math_max(free_distance, g_analyzer.player_radius) + 20.0f : g_analyzer.player_radius;
+    f32 block_reach = cell_reach + ANALYZER_BLOCK_RADIUS;
+    for (u32 block = 0; block < ANALYZER_BLOCKS_X * ANALYZER_BLOCKS_Y; ++block)
+    {
+        u32 first_x = (block % ANALYZER_BLOCKS_X) * ANALYZER_BLOCK_CELLS;
+        u32 first_y = (block / ANALYZER_BLOCKS_X) * ANALYZER_BLOCK_CELLS;
+        u32 end_x = math_min(first_x + ANALYZER_BLOCK_CELLS, (u32)ANALYZER_WIDTH);
+        u32 end_y = math_min(first_y + ANALYZER_BLOCK_CELLS, (u32)ANALYZER_HEIGHT);
+
+        fvec2 center = { (f32)(first_x + end_x) * 0.5f * ANALYZER_CELL_SIZE, (f32)(first_y + end_y) * 0.5f * ANALYZER_CELL_SIZE };
+        analyzer_distances distances = analyzer_solid_distances(snapshot, center, block_reach, is_solid, FALSE);
+        b8 is_settled = TRUE;
+        b8 is_free = is_solid ? analyzer_is_over(distances.solid_min, distances.solid_max, free_distance, ANALYZER_BLOCK_RADIUS, &is_settled) : FALSE;
+        b8 is_safe = analyzer_is_over(distances.deadly_min, distances.deadly_max, g_analyzer.player_radius, ANALYZER_BLOCK_RADIUS, &is_settled);
+        for (u32 y = first_y; y < end_y; ++y)
+        {
+            for (u32 x = first_x; x < end_x; ++x)
+            {
+                u32 cell = y * ANALYZER_WIDTH + x;
+                if (!is_settled)
+                {
+                    /* Bound the cell first, spiked circles are only evaluated when the bounds are not enough. */
+                    b8 is_cell_settled = TRUE;
+                    fvec2 position = analyzer_cell_center(cell);
+                    distances = analyzer_solid_distances(snapshot, position, cell_reach, is_solid, FALSE);
+                    is_free = is_solid ? analyzer_is_over(distances.solid_min, distances.solid_max, free_distance, 0.0f, &is_cell_settled) : FALSE;
+                    is_safe = analyzer_is_over(distances.deadly_min, distances.deadly_max, g_analyzer.player_radius, 0.0f, &is_cell_settled);
+                    if (!is_cell_settled)
+                    {
+                        distances = analyzer_solid_distances(snapshot, position, cell_reach, is_solid, TRUE);
+                        is_free = (is_solid && distances.solid_min > free_distance) ? TRUE : FALSE;
+                        is_safe = distances.deadly_min > g_analyzer.player_radius ? TRUE : FALSE;
+                    }
+                }
+                g_analyzer.free[i_sample][cell] = is_free;
+                g_analyzer.safe[i_sample][cell] = is_safe;
+            }
+        }
+    }
+}
+
+/* Lowers the switches of i_target to those of the cheapest reachable cell in i_state where the player touches the shape. */
+void analyzer_touch(analyzer_target* io_target, u32 i_state, u32 i_type, fvec2 i_position, fvec2 i_half_size, f32 i_time)
+{
+    for (u32 cell = 0; cell < ANALYZER_CELLS_COUNT; ++cell)
+    {
+        u32 switches = g_analyzer.switches[i_state][cell];
+        if (switches >= io_target->switches)
+        {
+            continue;
+        }
+        f32 distance = sdf_collision_shape_evaluate(i_type, i_position, i_half_size, analyzer_cell_center(cell), i_time);
+        if (distance - g_analyzer.player_radius < 0.1f)
+        {
+            io_target->switches = switches;
+        }
+    }
+}
+
+/* Flood fills state i_state from its frontier, marking every newly reached cell with i_switches. */
+void analyzer_flood_fill(u32 i_state, u8 i_switches)
+{
+    b8* free = g_analyzer.free[i_state * ANALYZER_SAMPLES_PER_STATE];
+    u8* switches = g_analyzer.switches[i_state];
+    u32 frontier = 0;
+    u32 frontier_count = g_analyzer.frontiers_count[i_state];
+    while (frontier_count > 0)
+    {
+        u32 next_count = 0;
+        for (u32 i = 0; i < frontier_count; ++i)
+        {
+            u32 cell = g_analyzer.frontiers[i_state][frontier][i];
+            u32 x = cell % ANALYZER_WIDTH;
+            u32 y = cell / ANALYZER_WIDTH;
+            u32 neighbours[4] = {
+                x > 0 ? cell - 1 : cell,
+                x + 1 < ANALYZER_WIDTH ? cell + 1 : cell,
+                y > 0 ? cell - ANALYZER_WIDTH : cell,
+                y + 1 < ANALYZER_HEIGHT ? cell + ANALYZER_WIDTH : cell,
+            };
+            for (u32 j = 0; j < 4; ++j)
+            {
+                u32 neighbour = neighbours[j];
+                if (free[neighbour] && switches[neighbour] == ANALYZER_SWITCHES_UNREACHABLE)
+                {
+                    switches[neighbour] = i_switches;
+                    g_analyzer.frontiers[i_state][1 - frontier][next_count] = neighbour;
+                    next_count += 1;
+                }
+            }
+        }
+        frontier = 1 - frontier;
+        frontier_count = next_count;
+    }
+    g_analyzer.frontiers_count[i_state] = 0;
+}
+
+/* Runs i_function(i) for every i below i_count spread over the available threads. */
+template <typename T>
+void analyzer_parallel_for(u32 i_count, T i_function)
+{
+    u32 threads_count = math_max(math_min((u32)std::thread::hardware_concurrency(), i_count), 1u);
+    std::vector<std::thread> threads;
+    for (u32 t = 0; t < threads_count; ++t)
+    {
+        threads.emplace_back([=]() {
+            for (u32 i = t; i < i_count; i += threads_count)
+            {
+                i_function(i);
+            }
+        });
+    }
+    for (u32 t = 0; t < threads_count; ++t)
+    {
+        threads[t].join();
+    }
+}
+
+b8 analyzer_run(u32 i_level)
+{
+    f64 start = profile_time_ms();
+    level_load(i_level);
+    entities_to_primitives(0.0f, ENTITIES_COUNT_MAX);
+    g_analyzer.player_radius = g_player.radius;
+
+    /* Snapshots are built one at a time as they go through the global snapshot. Each sample keeps the arrays it was
+     * built in and hands the ones it had before back to the global snapshot, so no two samples share shapes. */
+    for (u32 i = 0; i < ANALYZER_SAMPLES_COUNT; ++i)
+    {
+        sdf_collision_snapshot_build((f32)i / (f32)ANALYZER_SAMPLES_COUNT, 0.0f);
+        sdf_collision_snapshot previous = g_analyzer.snapshots[i];
+        g_analyzer.snapshots[i] = g_collision_snapshot;
+        g_collision_snapshot.shapes = previous.shapes;
+        g_collision_snapshot.build_shapes = previous.build_shapes;
+        g_collision_snapshot.grid_ranges = previous.grid_ranges;
+        g_collision_snapshot.shapes_capacity = previous.shapes_capacity;
+        g_collision_snapshot.grid_shapes = previous.grid_shapes;
+        g_collision_snapshot.grid_shapes_capacity = previous.grid_shapes_capacity;
+        sdf_collision_snapshot_clear();
+    }
+    analyzer_parallel_for(ANALYZER_SAMPLES_COUNT, analyzer_rasterise);
+
+    /* Switching from state i to i + 1 passes through all samples in between, wrapping around at 1. */
+    for (u32 state = 0; state < ANALYZER_STATES_COUNT; ++state)
+    {
+        for (u32 cell = 0; cell < ANALYZER_CELLS_COUNT; ++cell)
+        {
+            b8 is_safe = TRUE;
+            for (u32 i = 0; i <= ANALYZER_SAMPLES_PER_STATE; ++i)
+            {
+                is_safe &= g_analyzer.safe[(state * ANALYZER_SAMPLES_PER_STATE + i) % ANALYZER_SAMPLES_COUNT][cell];
+            }
+            g_analyzer.transition_safe[state][cell] = is_safe;
+        }
+    }
+
+    /* Flood fill every state in parallel, then switch state wherever allowed and repeat. */
+    memset(g_analyzer.switches, ANALYZER_SWITCHES_UNREACHABLE, sizeof(g_analyzer.switches));
+    u32 start_state = g_player.growth_state % ANALYZER_STATES_COUNT;
+    u32 start_cell = (u32)(g_player.position.y / ANALYZER_CELL_SIZE) * ANALYZER_WIDTH + (u32)(g_player.position.x / ANALYZER_CELL_SIZE);
+    b8 is_start_free = g_analyzer.free[start_state * ANALYZER_SAMPLES_PER_STATE][start_cell];
+    g_analyzer.switches[start_state][start_cell] = 0;
+    g_analyzer.frontiers[start_state][0][0] = start_cell;
+    g_analyzer.frontiers_count[start_state] = 1;
+    for (u8 switches = 0; switches < 64; ++switches)
+    {
+        analyzer_parallel_for(ANALYZER_STATES_COUNT, [=](u32 i_state) { analyzer_flood_fill(i_state, switches); });
+
+        u32 frontiers_count = 0;
+        for (u32 state = 0; state < ANALYZER_STATES_COUNT; ++state)
+        {
+            u32 next_state = (state + 1) % ANALYZER_STATES_COUNT;
+            for (u32 cell = 0; cell < ANALYZER_CELLS_COUNT; ++cell)
+            {
+                if (!g_analyzer.transition_safe[state][cell])
+                {
+                    continue;
+                }
+
+                /* Switching works both ways along the same stretch of growth factors. */
+                u32 from_to[2][2] = { { state, next_state }, { next_state, state } };
+                for (u32 i = 0; i < 2; ++i)
+                {
+                    u32 from = from_to[i][0];
+                    u32 to = from_to[i][1];
+                    b8 is_to_free = g_analyzer.free[to * ANALYZER_SAMPLES_PER_STATE][cell];
+                    if (is_to_free && g_analyzer.switches[from][cell] == switches && g_analyzer.switches[to][cell] == ANALYZER_SWITCHES_UNREACHABLE)
+                    {
+                        g_analyzer.switches[to][cell] = (u8)(switches + 1);
+                        g_analyzer.frontiers[to][0][g_analyzer.frontiers_count[to]] = cell;
+                        g_analyzer.frontiers_count[to] += 1;
+                        frontiers_count += 1;
+                    }
+                }
+            }
+        }
+        if (frontiers_count == 0)
+        {
+            break;
+        }
+    }
+
+    /* A portal or maggot is touched when the player overlaps it in a reachable cell. */
+    g_analyzer.targets_count = 0;
+    for (u32 i = entity_first(); i < g_entity_store.end && g_analyzer.targets_count < ANALYZER_TARGETS_COUNT_MAX; i = entity_next(i))
+    {
+        if (g_entity_store.type[i] != ENTITY_TYPE_PORTAL && g_entity_store.type[i] != ENTITY_TYPE_MAGGOT)
+        {
+            continue;
+        }
+
+        analyzer_target* target = &g_analyzer.targets[g_analyzer.targets_count];
+        target->entity = i;
+        target->type = g_entity_store.type[i];
+        target->switches = ANALYZER_SWITCHES_UNREACHABLE;
+        g_analyzer.targets_count += 1;
+        for (u32 state = 0; state < ANALYZER_STATES_COUNT; ++state)
+        {
+            /* Maggots are no collision shapes, the crowd touches them as circles of their growth size. */
+            if (target->type == ENTITY_TYPE_MAGGOT)
+            {
+                fvec3 growth_weights = growth_factor_to_weights((f32)(state * ANALYZER_SAMPLES_PER_STATE) / (f32)ANALYZER_SAMPLES_COUNT);
+                f32 size = fvec3_dot(growth_weights, g_entity_store.growth_sizes1[i]);
+                if (size > 0.0f)
+                {
+                    analyzer_touch(target, state, SDF_PRIMITIVE_CIRCLE, entity_position(i), { size, size }, 0.0f);
+                }
+                continue;
+            }
+
+            sdf_collision_snapshot* snapshot = &g_analyzer.snapshots[state * ANALYZER_SAMPLES_PER_STATE];
+            for (u32 j = 0; j < snapshot->shapes_count; ++j)
+            {
+                sdf_collision_shape* shape = &snapshot->shapes[j];
+                if (shape->entity == entity_handle_of(i))
+                {
+                    analyzer_touch(target, state, shape->type, shape->position, shape->half_size, snapshot->time);
+                }
+            }
+        }
+    }
+
+    /* Report. */
+    u32 reachable[ANALYZER_STATES_COUNT] = { 0, 0, 0 };
+    for (u32 state = 0; state < ANALYZER_STATES_COUNT; ++state)
+    {
+        for (u32 cell = 0; cell < ANALYZER_CELLS_COUNT; ++cell)
+        {
+            reachable[state] += g_analyzer.switches[state][cell] != ANALYZER_SWITCHES_UNREACHABLE ? 1 : 0;
+        }
+    }
+    printf("Level %u: %.2fms, %u cells, reachable per growth state %u / %u / %u%s\n",
+        i_level, profile_time_ms() - start, ANALYZER_CELLS_COUNT, reachable[0], reachable[1], reachable[2],
+        is_start_free ? "" : ", start position overlaps geometry");
+
+    b8 result = TRUE;
+    for (u32 i = 0; i < g_analyzer.targets_count; ++i)
+    {
+        analyzer_target* target = &g_analyzer.targets[i];
+        char const* name = target->type == ENTITY_TYPE_PORTAL ? "portal" : "maggot";
+        if (target->switches == ANALYZER_SWITCHES_UNREACHABLE)
+        {
+            printf("    %s (entity %u): UNREACHABLE\n", name, target->entity);
+            result = FALSE;
+        }
+        else
+        {
+            printf("    %s (entity %u): reachable, %u growth switches\n", name, target->entity, target->switches);
+        }
+    }
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    u32 first = 0;
+    u32 last = 7;
+    g_analyzer.tolerance = analyzer_push_out_tolerance();
+    if (argc > 1 && strcmp(argv[1], "all") != 0)
+    {
+        first = (u32)atoi(argv[1]) % 8;
+        last = first;
+    }
+    if (argc > 2)
+    {
+        g_analyzer.tolerance = (f32)atof(argv[2]);
+    }
+    noise_atlas_bake();
+
+    b8 result = TRUE;
+    for (u32 level = first; level <= last; ++level)
+    {
+        result &= analyzer_run(level);
+    }
+    return result ? 0 : 1;
+}
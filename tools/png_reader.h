@@ -0,0 +1,401 @@
+/* Reads the PNG assets for the offline tools.
+ *
+ * Only takes what the assets are, 8 bit RGB or RGBA without interlacing, and does not check CRCs. Needs core.h,
+ * <vector>, <cstdio> and <cstring> included before it. */
+
+#ifndef PNG_READER_H
+#define PNG_READER_H
+
+/* --------------------------------------------------
+   PNG
+   -------------------------------------------------- */
+
+/* Inflate of RFC 1951, decoding Huffman codes a bit at a time from the count of codes per length. */
+#define INFLATE_CODE_LENGTH_MAX 15
+
+typedef struct {
+    u8 const* data;
+    sz size;
+    sz position;
+    u32 bits;
+    u32 bits_count;
+    b8 is_overrun;
+} inflate_stream;
+
+typedef struct {
+    u16 counts[INFLATE_CODE_LENGTH_MAX + 1];
+    u16 symbols[288];
+} inflate_huffman;
+
+u32 inflate_bits(inflate_stream* io_stream, u32 i_count)
+{
+    while (io_stream->bits_count < i_count)
+    {
+        if (io_stream->position >= io_stream->size)
+        {
+            io_stream->is_overrun = TRUE;
+            return 0;
+        }
+        io_stream->bits |= (u32)io_stream->data[io_stream->position++] << io_stream->bits_count;
+        io_stream->bits_count += 8;
+    }
+    u32 result = io_stream->bits & ((1u << i_count) - 1);
+    io_stream->bits >>= i_count;
+    io_stream->bits_count -= i_count;
+    return result;
+}
+
+/* Returns FALSE for lengths that over subscribe the code. */
+b8 inflate_huffman_build(inflate_huffman* o_huffman, u8 const* i_lengths, u32 i_count)
+{
+    memzero(o_huffman->counts, sizeof(o_huffman->counts));
+    for (u32 i = 0; i < i_count; ++i)
+    {
+        o_huffman->counts[i_lengths[i]] += 1;
+    }
+
+    i32 left = 1;
+    for (u32 length = 1; length <= INFLATE_CODE_LENGTH_MAX; ++length)
+    {
+        left = (left << 1) - (i32)o_huffman->counts[length];
+        if (left < 0)
+        {
+            return FALSE;
+        }
+    }
+
+    u16 offsets[INFLATE_CODE_LENGTH_MAX + 1];
+    offsets[1] = 0;
+    for (u32 length = 1; length < INFLATE_CODE_LENGTH_MAX; ++length)
+    {
+        offsets[length + 1] = (u16)(offsets[length] + o_huffman->counts[length]);
+    }
+    for (u32 i = 0; i < i_count; ++i)
+    {
+        if (i_lengths[i] != 0)
+        {
+            o_huffman->symbols[offsets[i_lengths[i]]++] = (u16)i;
+        }
+    }
+    return TRUE;
+}
+
+/* Returns -1 for codes that are not in the table. */
+i32 inflate_decode(inflate_stream* io_stream, inflate_huffman const* i_huffman)
+{
+    i32 code = 0;
+    i32 first = 0;
+    i32 index = 0;
+    for (u32 length = 1; length <= INFLATE_CODE_LENGTH_MAX; ++length)
+    {
+        code |= (i32)inflate_bits(io_stream, 1);
+        i32 count = (i32)i_huffman->counts[length];
+        if (code - count < first)
+        {
+            return (i32)i_huffman->symbols[index + (code - first)];
+        }
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+b8 inflate_codes(inflate_stream* io_stream, inflate_huffman const* i_lengths, inflate_huffman const* i_distances, std::vector<u8>* io_output)
+{
+    static u16 const length_bases[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    static u8 const length_extras[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    static u16 const distance_bases[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    static u8 const distance_extras[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+    for (;;)
+    {
+        i32 symbol = inflate_decode(io_stream, i_lengths);
+        if (symbol < 0 || io_stream->is_overrun)
+        {
+            return FALSE;
+        }
+        if (symbol < 256)
+        {
+            io_output->push_back((u8)symbol);
+        }
+        else if (symbol == 256)
+        {
+            return TRUE;
+        }
+        else
+        {
+            symbol -= 257;
+            if (symbol >= 29)
+            {
+                return FALSE;
+            }
+            u32 length = length_bases[symbol] + inflate_bits(io_stream, length_extras[symbol]);
+            i32 distance_symbol = inflate_decode(io_stream, i_distances);
+            if (distance_symbol < 0 || distance_symbol >= 30)
+            {
+                return FALSE;
+            }
+            u32 distance = distance_bases[distance_symbol] + inflate_bits(io_stream, distance_extras[distance_symbol]);
+            if (distance > io_output->size())
+            {
+                return FALSE;
+            }
+            sz from = io_output->size() - distance;
+            for (u32 i = 0; i < length; ++i)
+            {
+                io_output->push_back((*io_output)[from + i]);
+            }
+        }
+    }
+}
+
+/* Inflates the raw deflate stream i_data into o_output. */
+b8 inflate(u8 const* i_data, sz i_size, std::vector<u8>* o_output)
+{
+    inflate_stream stream;
+    memzero(&stream, sizeof(stream));
+    stream.data = i_data;
+    stream.size = i_size;
+
+    u32 is_last = 0;
+    while (!is_last)
+    {
+        is_last = inflate_bits(&stream, 1);
+        u32 type = inflate_bits(&stream, 2);
+        if (type == 0)
+        {
+            /* Stored, byte aligned with the length and its complement. */
+            stream.bits = 0;
+            stream.bits_count = 0;
+            if (stream.position + 4 > stream.size)
+            {
+                return FALSE;
+            }
+            u32 length = (u32)stream.data[stream.position] | ((u32)stream.data[stream.position + 1] << 8);
+            stream.position += 4;
+            if (stream.position + length > stream.size)
+            {
+                return FALSE;
+            }
+            o_output->insert(o_output->end(), stream.data + stream.position, stream.data + stream.position + length);
+            stream.position += length;
+        }
+        else if (type == 1)
+        {
+            u8 lengths[288 + 30];
+            u32 i = 0;
+            for (; i < 144; ++i) lengths[i] = 8;
+            for (; i < 256; ++i) lengths[i] = 9;
+            for (; i < 280; ++i) lengths[i] = 7;
+            for (; i < 288; ++i) lengths[i] = 8;
+            for (; i < 288 + 30; ++i) lengths[i] = 5;
+            inflate_huffman literals;
+            inflate_huffman distances;
+            inflate_huffman_build(&literals, lengths, 288);
+            inflate_huffman_build(&distances, lengths + 288, 30);
+            if (!inflate_codes(&stream, &literals, &distances, o_output))
+            {
+                return FALSE;
+            }
+        }
+        else if (type == 2)
+        {
+            static u8 const order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+            u32 literals_count = inflate_bits(&stream, 5) + 257;
+            u32 distances_count = inflate_bits(&stream, 5) + 1;
+            u32 code_lengths_count = inflate_bits(&stream, 4) + 4;
+            u8 lengths[288 + 32];
+            memzero(lengths, sizeof(lengths));
+            for (u32 i = 0; i < code_lengths_count; ++i)
+            {
+                lengths[order[i]] = (u8)inflate_bits(&stream, 3);
+            }
+            inflate_huffman code_lengths;
+            if (literals_count > 286 || distances_count > 30 || !inflate_huffman_build(&code_lengths, lengths, 19))
+            {
+                return FALSE;
+            }
+
+            u32 count = 0;
+            while (count < literals_count + distances_count)
+            {
+                i32 symbol = inflate_decode(&stream, &code_lengths);
+                if (symbol < 0 || stream.is_overrun)
+                {
+                    return FALSE;
+                }
+                if (symbol < 16)
+                {
+                    lengths[count++] = (u8)symbol;
+                    continue;
+                }
+
+                u8 repeated = 0;
+                u32 repeat = 0;
+                if (symbol == 16)
+                {
+                    if (count == 0)
+                    {
+                        return FALSE;
+                    }
+                    repeated = lengths[count - 1];
+                    repeat = 3 + inflate_bits(&stream, 2);
+                }
+                else
+                {
+                    repeat = symbol == 17 ? 3 + inflate_bits(&stream, 3) : 11 + inflate_bits(&stream, 7);
+                }
+                if (count + repeat > literals_count + distances_count)
+                {
+                    return FALSE;
+                }
+                for (u32 i = 0; i < repeat; ++i)
+                {
+                    lengths[count++] = repeated;
+                }
+            }
+
+            inflate_huffman literals;
+            inflate_huffman distances;
+            if (!inflate_huffman_build(&literals, lengths, literals_count) ||
+                !inflate_huffman_build(&distances, lengths + literals_count, distances_count) ||
+                !inflate_codes(&stream, &literals, &distances, o_output))
+            {
+                return FALSE;
+            }
+        }
+        else
+        {
+            return FALSE;
+        }
+        if (stream.is_overrun)
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+u32 png_read_u32(u8 const* i_bytes)
+{
+    return ((u32)i_bytes[0] << 24) | ((u32)i_bytes[1] << 16) | ((u32)i_bytes[2] << 8) | (u32)i_bytes[3];
+}
+
+u8 png_paeth(u8 i_left, u8 i_up, u8 i_up_left)
+{
+    i32 estimate = (i32)i_left + (i32)i_up - (i32)i_up_left;
+    i32 to_left = estimate > (i32)i_left ? estimate - (i32)i_left : (i32)i_left - estimate;
+    i32 to_up = estimate > (i32)i_up ? estimate - (i32)i_up : (i32)i_up - estimate;
+    i32 to_up_left = estimate > (i32)i_up_left ? estimate - (i32)i_up_left : (i32)i_up_left - estimate;
+    if (to_left <= to_up && to_left <= to_up_left)
+    {
+        return i_left;
+    }
+    return to_up <= to_up_left ? i_up : i_up_left;
+}
+
+/* Reads an 8 bit RGB or RGBA PNG into o_rgba, RGB gets an opaque alpha. */
+b8 png_read(char const* i_path, std::vector<u8>* o_rgba, u32* o_width, u32* o_height)
+{
+    FILE* file = fopen(i_path, "rb");
+    if (file == NULL)
+    {
+        printf("Could not open %s\n", i_path);
+        return FALSE;
+    }
+    std::vector<u8> bytes;
+    u8 buffer[65536];
+    for (sz read = fread(buffer, 1, sizeof(buffer), file); read > 0; read = fread(buffer, 1, sizeof(buffer), file))
+    {
+        bytes.insert(bytes.end(), buffer, buffer + read);
+    }
+    fclose(file);
+
+    static u8 const signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    if (bytes.size() < 8 || memcmp(bytes.data(), signature, 8) != 0)
+    {
+        printf("%s is not a PNG\n", i_path);
+        return FALSE;
+    }
+
+    u32 width = 0;
+    u32 height = 0;
+    u32 channels = 0;
+    std::vector<u8> compressed;
+    for (sz position = 8; position + 12 <= bytes.size();)
+    {
+        u32 length = png_read_u32(&bytes[position]);
+        u8 const* type = &bytes[position + 4];
+        u8 const* data = &bytes[position + 8];
+        if (position + 12 + length > bytes.size())
+        {
+            break;
+        }
+        if (memcmp(type, "IHDR", 4) == 0)
+        {
+            width = png_read_u32(data);
+            height = png_read_u32(data + 4);
+            channels = data[9] == 6 ? 4 : (data[9] == 2 ? 3 : 0);
+            if (data[8] != 8 || channels == 0 || data[12] != 0)
+            {
+                printf("%s is not 8 bit RGB or RGBA without interlacing\n", i_path);
+                return FALSE;
+            }
+        }
+        else if (memcmp(type, "IDAT", 4) == 0)
+        {
+            compressed.insert(compressed.end(), data, data + length);
+        }
+        position += 12 + length;
+    }
+
+    /* Past the two byte zlib header. */
+    std::vector<u8> filtered;
+    if (channels == 0 || compressed.size() < 2 || !inflate(compressed.data() + 2, compressed.size() - 2, &filtered) ||
+        filtered.size() < (sz)height * (1 + (sz)width * channels))
+    {
+        printf("Could not decompress %s\n", i_path);
+        return FALSE;
+    }
+
+    sz stride = (sz)width * channels;
+    std::vector<u8> pixels((sz)height * stride);
+    for (u32 y = 0; y < height; ++y)
+    {
+        u8 filter = filtered[y * (stride + 1)];
+        u8 const* source = &filtered[y * (stride + 1) + 1];
+        u8* row = &pixels[y * stride];
+        u8 const* up = y > 0 ? &pixels[(y - 1) * stride] : NULL;
+        for (sz i = 0; i < stride; ++i)
+        {
+            u8 left = i >= channels ? row[i - channels] : 0;
+            u8 above = up != NULL ? up[i] : 0;
+            u8 above_left = up != NULL && i >= channels ? up[i - channels] : 0;
+            u8 predicted = 0;
+            switch (filter)
+            {
+                case 1: predicted = left; break;
+                case 2: predicted = above; break;
+                case 3: predicted = (u8)(((u32)left + (u32)above) / 2); break;
+                case 4: predicted = png_paeth(left, above, above_left); break;
+                default: break;
+            }
+            row[i] = (u8)(source[i] + predicted);
+        }
+    }
+
+    o_rgba->resize((sz)width * height * 4);
+    for (sz i = 0; i < (sz)width * height; ++i)
+    {
+        for (u32 channel = 0; channel < 4; ++channel)
+        {
+            (*o_rgba)[i * 4 + channel] = channel < channels ? pixels[i * channels + channel] : 0xFF;
+        }
+    }
+    *o_width = width;
+    *o_height = height;
+    return TRUE;
+}
+
+#endif
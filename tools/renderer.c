@@ -0,0 +1,1704 @@
+/* Headless CPU renderer for the frame the fragment shader draws.
+ *
+ * Reproduces main() of the fragment shader in main.c pixel for pixel: the background texture and vignette, the
+ * level and overlay primitive lists through get_distance, the player and its face, the HUD, the screen noise and
+ * the dust. It reads the same g_player constants and packed primitive lists the GPU gets, so a level can be
+ * rendered, profiled and compared without a Windows GPU.
+ *
+ * The frame is split into tiles that the threads take from a shared counter, cheap tiles of background next to
+ * expensive tiles full of portals even out that way. Each tile only evaluates the primitives sdf_bins_build listed
+ * for it, like the shader. The shapes come from sdf_shapes.h, the same code the shader runs. With SSE2 the rows of a
+ * tile are shaded in spans of four pixels, the pixel at a time path stays as the reference the spans are checked
+ * against. With damage tracking on, only the tiles something changed in since the previous frame are shaded again.
+ * Textures other than the noise are only baked into headers by the asset pipeline, when those headers are missing
+ * the background is a flat color and sprites are transparent.
+ *
+ * usage: renderer [level] [frames] [output.ppm]
+ * Simulates and renders frames frames of the level at 60Hz, 3 by default, reports the milliseconds per frame and
+ * writes the last frame as a binary PPM, renderer.ppm by default. Then reports the cost of the HUD with and without
+ * its retained icons, and the tiles damage tracking shades in gameplay with time animating every 1, 2, 4 and 8
+ * frames. */
+
+#define _CRT_SECURE_NO_WARNINGS 1
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+
+#define DEBUG 0
+#include "core.h"
+
+f64 profile_time_ms()
+{
+    return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#define GAME_HEADLESS 1
+#include "game.h"
+#include "levels.h"
+
+#define RENDERER_WIDTH 1600
+#define RENDERER_HEIGHT 900
+#define RENDERER_TILE_SIZE SDF_BIN_TILE_SIZE /* Shading tiles are the bin tiles. */
+#define RENDERER_TILES_X SDF_BIN_TILES_X
+#define RENDERER_TILES_Y SDF_BIN_TILES_Y
+#define RENDERER_TILES_COUNT SDF_BIN_TILES_COUNT
+
+/* Texels are R8G8B8A8 like the GPU images, x in the lowest byte. */
+#if defined(__has_include)
+    #if __has_include("assets/background_texture.h") && __has_include("assets/spritesheet_texture.h")
+        #include "assets/background_texture.h"
+        #include "assets/spritesheet_texture.h"
+        #define RENDERER_HAS_TEXTURES 1
+    #endif
+#endif
+#if !defined(RENDERER_HAS_TEXTURES)
+    #define RENDERER_HAS_TEXTURES 0
+    #define TEXTURE_SPRITESHEET_WIDTH 1280
+    #define TEXTURE_SPRITESHEET_HEIGHT 2048
+    u32 g_renderer_background_fallback[] = { 0x59140DFF }; /* A dark red once swizzled to wyz. */
+    u32 g_renderer_spritesheet_fallback[] = { 0x00000000 };
+#endif
+
+typedef struct {
+    u32 const* texels;
+    u32 width;
+    u32 height;
+} renderer_texture;
+
+typedef struct {
+    fvec4 color;
+    f32 distance;
+} renderer_color_distance;
+
+typedef struct {
+    renderer_texture background;
+    renderer_texture spritesheet;
+
+    /* The GPU lists unpacked once per frame, up to the first invalid primitive. */
+    sdf_primitive level_primitives[SDF_PRIMITIVES_COUNT_MAX];
+    sdf_primitive overlay_primitives[SDF_PRIMITIVES_COUNT_MAX];
+    u32 level_primitives_count;
+    u32 overlay_primitives_count;
+
+    /* sdf_primitive_pixel_bounds of every primitive and of the player, for the spans to skip shapes. */
+    fvec4 level_bounds[SDF_PRIMITIVES_COUNT_MAX];
+    fvec4 overlay_bounds[SDF_PRIMITIVES_COUNT_MAX];
+    fvec4 player_bounds;
+    fvec4 noise_time; /* noise_weights of the offsets the frame uses. */
+    fvec4 noise_zero;
+    fvec4 noise_tenth;
+    b8 use_spans;
+
+    /* Constants of the frame, see camera_data and the c_player cbuffer in main.c. */
+    player_data player;
+    fvec2 camera;
+
+    u32 framebuffer[RENDERER_WIDTH * RENDERER_HEIGHT];
+    std::atomic<u32> next_tile;
+    u32 threads_count;
+} renderer;
+renderer g_renderer;
+
+fvec4 renderer_sample(renderer_texture const* i_texture, fvec2 i_uv)
+{
+    return texture_sample(i_texture->texels, i_texture->width, i_texture->height, i_uv);
+}
+
+fvec3 renderer_lerp3(fvec3 i_start, fvec3 i_end, f32 i_percentage)
+{
+    return { f32_lerp(i_start.x, i_end.x, i_percentage), f32_lerp(i_start.y, i_end.y, i_percentage), f32_lerp(i_start.z, i_end.z, i_percentage) };
+}
+
+fvec4 renderer_lerp4(fvec4 i_start, fvec4 i_end, f32 i_percentage)
+{
+    fvec4 result;
+    for (u32 i = 0; i < 4; ++i)
+    {
+        result.data[i] = f32_lerp(i_start.data[i], i_end.data[i], i_percentage);
+    }
+    return result;
+}
+
+/* HLSL step(i_edge, i_value). */
+f32 renderer_step(f32 i_edge, f32 i_value)
+{
+    return i_value >= i_edge ? 1.0f : 0.0f;
+}
+
+f32 renderer_saturate(f32 i_value)
+{
+    return math_clamp(i_value, 0.0f, 1.0f);
+}
+
+renderer_color_distance renderer_box_textured(fvec2 i_uv, fvec2 i_position, fvec2 i_size, fvec2 i_sprite_index, fvec2 i_sprite_size)
+{
+    f32 box_distance = sdf_box(i_uv, i_position, i_size);
+    fvec2 top_left = fvec2_sub(i_position, i_size);
+    fvec2 box_uv = fvec2_mul_s(fvec2_div(fvec2_sub(i_uv, top_left), i_size), 0.5f);
+
+    fvec2 scale = { i_sprite_size.x / (f32)TEXTURE_SPRITESHEET_WIDTH, i_sprite_size.y / (f32)TEXTURE_SPRITESHEET_HEIGHT };
+    box_uv = fvec2_add(fvec2_mul(box_uv, scale), fvec2_mul(scale, i_sprite_index));
+
+    renderer_color_distance result;
+    result.color = renderer_sample(&g_renderer.spritesheet, box_uv);
+    result.distance = 1.0f - renderer_step(box_distance, 0.0f);
+    return result;
+}
+
+/* See sdf_particles_burst in the shader, the first and count of the burst are in growth_sizes2.xy. */
+f32 renderer_particles_burst(fvec2 i_uv, sdf_primitive const* i_primitive)
+{
+    f32 distance = SDF_RESULT_DISTANCE_INVALID;
+    u32 first = (u32)i_primitive->growth_sizes2.x;
+    u32 end = first + (u32)i_primitive->growth_sizes2.y;
+    for (u32 i = first; i < end; ++i)
+    {
+        particle_packed particle = g_particles_packed[i];
+        fvec2 position = {
+            i_primitive->position.x + (f32)particle.position[0] / SDF_PACKED_POSITION_SCALE,
+            i_primitive->position.y + (f32)particle.position[1] / SDF_PACKED_POSITION_SCALE
+        };
+        distance = math_min(distance, sdf_circle(i_uv, position, particle.radius));
+    }
+    return distance;
+}
+
+renderer_color_distance renderer_get_distance(sdf_primitive const* i_primitives, sdf_bins const* i_bins, u32 i_tile, fvec2 i_uv, fvec3 i_growth_weights, f32 i_time)
+{
+    renderer_color_distance result;
+    result.color = { 0.0f, 0.0f, 0.0f, 0.0f };
+    result.distance = SDF_RESULT_DISTANCE_INVALID;
+
+    for (u32 entry = i_bins->offsets[i_tile]; entry < i_bins->offsets[i_tile + 1]; ++entry)
+    {
+        sdf_primitive const* primitive = &i_primitives[i_bins->indices[entry]];
+        f32 prev_distance = result.distance;
+        f32 distance = SDF_RESULT_DISTANCE_INVALID;
+        fvec4 color = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+        f32 growth_size1 = fvec3_dot(i_growth_weights, primitive->growth_sizes1);
+        f32 growth_size2 = fvec3_dot(i_growth_weights, primitive->growth_sizes2);
+        fvec2 sprite_index = { primitive->sprite_index[0], primitive->sprite_index[1] };
+
+        switch (primitive->type)
+        {
+            case SDF_PRIMITIVE_CIRCLE:
+            {
+                color = { 1.0f, 0.05f, 0.0f, 0.0f };
+                distance = sdf_wobbly_circle(i_uv, primitive->position, growth_size1, i_time);
+            } break;
+            case SDF_PRIMITIVE_SPIKED_CIRCLE:
+            {
+                color = { 1.0f, 0.05f, 0.0f, 0.0f };
+                distance = sdf_spiked_circle(i_uv, primitive->position, growth_size1, i_time);
+            } break;
+            case SDF_PRIMITIVE_BOX:
+            {
+                color = { 1.0f, 0.05f, 0.0f, 0.0f };
+                distance = sdf_wobbly_box(i_uv, primitive->position, sdf_vec2(growth_size1, growth_size2), i_time);
+            } break;
+            case SDF_PRIMITIVE_BOX_TEXTURED:
+            {
+                renderer_color_distance textured = renderer_box_textured(i_uv, primitive->position, sdf_vec2(growth_size1, growth_size2), sprite_index, sdf_vec2(384.0f, 128.0f));
+                color = textured.color;
+                distance = textured.distance;
+            } break;
+            case SDF_PRIMITIVE_BOX_TEXT:
+            {
+                f32 scale = primitive->growth_sizes1.z;
+                fvec2 background_size = { (primitive->growth_sizes1.x - 10.0f) * scale, (primitive->growth_sizes2.x - 10.0f) * scale };
+                f32 background = sdf_box(i_uv, primitive->position, background_size);
+                background -= 25.0f * sample_noise(i_uv, 0.0f) * scale;
+
+                fvec2 text_size = { primitive->growth_sizes1.x * scale, primitive->growth_sizes2.x * scale };
+                renderer_color_distance text = renderer_box_textured(i_uv, primitive->position, text_size, sprite_index, sdf_vec2(512.0f, 162.0f));
+                fvec4 white = { 1.0f, 1.0f, 1.0f, 1.0f };
+                fvec4 black = { 0.0f, 0.0f, 0.0f, 0.0f };
+                color = renderer_lerp4(white, black, renderer_saturate(1.0f - text.distance) * text.color.x);
+                color.x = 1.0f;
+                distance = background;
+            } break;
+            case SDF_PRIMITIVE_BOX_FLOWER:
+            {
+                renderer_color_distance textured = renderer_box_textured(i_uv, primitive->position, sdf_vec2(growth_size1, growth_size2), sprite_index, sdf_vec2(128.0f, 128.0f));
+                color = textured.color;
+                distance = textured.distance;
+            } break;
+            case SDF_PRIMITIVE_PORTAL:
+            {
+                color = { 1.0f, 0.0f, 0.0f, 0.0f };
+                distance = sdf_portal(i_uv, primitive->position, growth_size1, i_time);
+            } break;
+            case SDF_PRIMITIVE_MAGGOT:
+            {
+                color = { 1.0f, 0.0f, 0.0f, 0.0f };
+                distance = sdf_maggot(i_uv, primitive->position, growth_size1, i_time);
+            } break;
+            case SDF_PRIMITIVE_PARTICLES:
+            {
+                color = { 1.0f, 0.0f, 0.0f, 0.0f };
+                distance = renderer_particles_burst(i_uv, primitive);
+            } break;
+        }
+
+        result.distance = math_min(result.distance, distance);
+        if (result.distance < prev_distance)
+        {
+            result.color = renderer_lerp4(result.color, color, renderer_saturate(1.0f - result.distance) * color.x);
+        }
+    }
+    return result;
+}
+
+f32 renderer_dust_particles(fvec2 i_uv, f32 i_factor)
+{
+    f32 fov = 150.0f;
+    f32 color = 0.0f;
+    for (u32 i = 1; i < 4; ++i)
+    {
+        f32 layer = (f32)i;
+        f32 zoom = f32_tan((layer * 4.0f + fov) * 3.14159265f / 180.0f / 2.0f);
+        fvec2 uv = { (i_uv.x / 900.0f - 0.5f) * zoom, (i_uv.y / 900.0f - 0.5f) * zoom };
+        uv.x += -i_factor / 8.0f + layer / 12.0f;
+        uv.y += f32_sin(layer - i_factor / 4.0f + uv.x) * 0.3f;
+
+        fvec2 cell = { -f32_floor(-(uv.x + layer * 9.0f)) + layer, -f32_floor(-(uv.y + layer * 9.0f)) + layer };
+        f32 strength = 0.01f * sample_noise(cell, i_factor);
+        f32 distance = fvec2_len(sdf_vec2(sdf_fract(uv.x) - 0.5f, sdf_fract(uv.y) - 0.5f));
+        if (distance < strength)
+        {
+            color += 1.0f / layer - distance * layer * 6.0f;
+        }
+    }
+    return color;
+}
+
+/* Draws i_icon over io_result the way player_hud does, the icon colors are inverted. */
+void renderer_hud_icon(renderer_color_distance* io_result, renderer_color_distance i_icon)
+{
+    fvec4 color = { i_icon.color.x, 1.0f - i_icon.color.y, 1.0f - i_icon.color.z, 1.0f - i_icon.color.w };
+    io_result->distance = math_min(io_result->distance, i_icon.distance);
+    io_result->color = renderer_lerp4(io_result->color, color, renderer_step(i_icon.distance, 0.0f) * color.x);
+}
+
+renderer_color_distance renderer_player_hud(fvec2 i_uv)
+{
+    player_data const* player = &g_renderer.player;
+    renderer_color_distance result;
+    result.distance = SDF_RESULT_DISTANCE_INVALID;
+    result.color = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+    fvec2 position = { 20.0f, 20.0f };
+    fvec2 icon_size = { 16.0f, 16.0f };
+    fvec2 sprite_size = { 64.0f, 64.0f };
+    result.distance = math_min(result.distance, sdf_wobbly_circle(i_uv, fvec2_add(position, sdf_vec2(0.0f, -50.0f)), 100.0f, player->time));
+    result.distance = math_min(result.distance, sdf_wobbly_circle(i_uv, fvec2_add(position, sdf_vec2(100.0f, -50.0f)), 50.0f, player->time));
+
+    /* Drawn in the same order as the shader, the blends do not commute. */
+    f32 deaths = (f32)player->deaths;
+    f32 maggots = (f32)player->maggots;
+    renderer_color_distance deaths_icon = renderer_box_textured(i_uv, fvec2_add(position, sdf_vec2(16.0f, 0.0f)), icon_size, sdf_vec2(19.0f, 1.0f), sprite_size);
+    renderer_color_distance deaths_10 = renderer_box_textured(i_uv, fvec2_add(position, sdf_vec2(48.0f, 0.0f)), icon_size, sdf_vec2(18.0f, f32_floor(deaths / 10.0f)), sprite_size);
+    renderer_color_distance deaths_01 = renderer_box_textured(i_uv, fvec2_add(position, sdf_vec2(64.0f, 0.0f)), icon_size, sdf_vec2(18.0f, sdf_mod(deaths, 10.0f)), sprite_size);
+    renderer_hud_icon(&result, deaths_icon);
+    renderer_hud_icon(&result, deaths_01);
+    renderer_hud_icon(&result, deaths_10);
+
+    renderer_color_distance maggots_icon = renderer_box_textured(i_uv, fvec2_add(position, sdf_vec2(0.0f, 28.0f)), icon_size, sdf_vec2(19.0f, 0.0f), sprite_size);
+    renderer_color_distance maggots_10 = renderer_box_textured(i_uv, fvec2_add(position, sdf_vec2(32.0f, 28.0f)), icon_size, sdf_vec2(18.0f, f32_floor(maggots / 10.0f)), sprite_size);
+    renderer_color_distance maggots_01 = renderer_box_textured(i_uv, fvec2_add(position, sdf_vec2(48.0f, 28.0f)), icon_size, sdf_vec2(18.0f, sdf_mod(maggots, 10.0f)), sprite_size);
+    renderer_hud_icon(&result, maggots_icon);
+    renderer_hud_icon(&result, maggots_01);
+    renderer_hud_icon(&result, maggots_10);
+    return result;
+}
+
+/* The icons of the HUD at i_uv from g_hud_image, a distance of 0 inside them and 1 outside like sdf_box_textured. */
+renderer_color_distance renderer_hud_image_fetch(fvec2 i_uv)
+{
+    renderer_color_distance result;
+    result.color = { 1.0f, 1.0f, 1.0f, 1.0f };
+    result.distance = 1.0f;
+    i32 x = (i32)f32_floor(i_uv.x) - HUD_IMAGE_X;
+    i32 y = (i32)f32_floor(i_uv.y) - HUD_IMAGE_Y;
+    if (x >= 0 && x < HUD_IMAGE_WIDTH && y >= 0 && y < HUD_IMAGE_HEIGHT)
+    {
+        result.color = g_hud_image.colors[y * HUD_IMAGE_WIDTH + x];
+        result.distance = g_hud_image.is_inside[y * HUD_IMAGE_WIDTH + x] ? 0.0f : 1.0f;
+    }
+    return result;
+}
+
+/* player_hud of the shader with the retained icons, the two wobbly circles and a fetch. */
+renderer_color_distance renderer_player_hud_retained(fvec2 i_uv)
+{
+    player_data const* player = &g_renderer.player;
+    fvec2 position = { 20.0f, 20.0f };
+    renderer_color_distance result = renderer_hud_image_fetch(i_uv);
+    result.distance = math_min(result.distance, sdf_wobbly_circle(i_uv, fvec2_add(position, sdf_vec2(0.0f, -50.0f)), 100.0f, player->time));
+    result.distance = math_min(result.distance, sdf_wobbly_circle(i_uv, fvec2_add(position, sdf_vec2(100.0f, -50.0f)), 50.0f, player->time));
+    return result;
+}
+
+/* main() of the fragment shader for the pixel centered on i_uv in tile i_tile, as RGBA8. */
+u32 renderer_shade(fvec2 i_uv, u32 i_tile, fvec3 i_growth_weights)
+{
+    player_data const* player = &g_renderer.player;
+    fvec2 world_uv = fvec2_add(i_uv, g_renderer.camera);
+    fvec2 screen_uv = { i_uv.x / (f32)RENDERER_WIDTH, i_uv.y / (f32)RENDERER_HEIGHT };
+
+    fvec4 background = renderer_sample(&g_renderer.background, screen_uv);
+    fvec3 color = { background.w, background.y, background.z };
+
+    f32 vignette = f32_pow(screen_uv.x * (1.0f - screen_uv.y) * screen_uv.y * (1.0f - screen_uv.x) * 25.0f, 0.3f);
+    color = fvec3_mul_s(color, vignette);
+
+    renderer_color_distance level = renderer_get_distance(g_renderer.level_primitives, &g_level_bins, i_tile, world_uv, i_growth_weights, player->time);
+    color = renderer_lerp3(color, level.color.yzw, renderer_saturate(1.0f - level.distance));
+
+    renderer_color_distance overlay = renderer_get_distance(g_renderer.overlay_primitives, &g_overlay_bins, i_tile, world_uv, i_growth_weights, player->time);
+    color = renderer_lerp3(color, overlay.color.yzw, renderer_saturate(1.0f - overlay.distance) * overlay.color.x);
+
+    fvec3 black = { 0.0f, 0.0f, 0.0f };
+    f32 body = renderer_step(sdf_player(world_uv, player->position, player->scale, player->time), 0.0f);
+    f32 state = (f32)player->growth_state;
+    fvec2 face_size = { player->scale * (192.0f / 3.0f) * (1.0f + state * 0.1f), player->scale * (64.0f / 3.0f) * (1.0f + state * 0.1f) };
+    renderer_color_distance face = renderer_box_textured(world_uv, player->position, face_size, sdf_vec2(4.0f, state), sdf_vec2(192.0f, 64.0f));
+    color = renderer_lerp3(color, black, body);
+    color = renderer_lerp3(color, face.color.yzw, renderer_step(face.distance, 0.0f) * face.color.x);
+
+    renderer_color_distance hud = renderer_player_hud(i_uv);
+    color = renderer_lerp3(color, hud.color.yzw, renderer_step(hud.distance, 0.0f) * hud.color.x);
+
+    f32 noise = sample_noise(sdf_vec2(i_uv.x - player->time, i_uv.y), player->time);
+    color = renderer_lerp3(color, fvec3_mul_s(color, noise), 0.5f);
+
+    f32 dust = renderer_dust_particles(i_uv, player->time);
+    color = renderer_lerp3(color, fvec3_mul_s(color, 0.5f), dust);
+
+    color = renderer_lerp3(color, black, player->screen_fade);
+
+    /* UNORM conversion of the render target. */
+    u32 red = (u32)(renderer_saturate(color.x) * 255.0f + 0.5f);
+    u32 green = (u32)(renderer_saturate(color.y) * 255.0f + 0.5f);
+    u32 blue = (u32)(renderer_saturate(color.z) * 255.0f + 0.5f);
+    return red | (green << 8) | (blue << 16) | 0xFF000000;
+}
+
+#if SDF_PACK_SSE2
+/* Spans of four horizontally adjacent pixels shaded at once with SSE2, the widest SIMD every x64 CPU has. Every
+ * function below repeats the operations of its scalar version above in the same order, so both write the same bytes.
+ * Lanes outside the pixel bounds of a shape are masked out and a shape is skipped when all of them are. SSE2 has no
+ * sin, pow or atan2, the spiked circles, portals, vignette and dust call the scalar code for each lane. */
+#define RENDERER_SPAN_WIDTH 4
+
+typedef struct {
+    __m128 x;
+    __m128 y;
+} renderer_span_uv;
+
+typedef struct {
+    __m128 color[4];
+    __m128 distance;
+} renderer_span_color_distance;
+
+/* Exact for anything that fits in an i32, which covers every coordinate on screen or in the world. */
+__m128 renderer_span_floor(__m128 i_value)
+{
+    __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(i_value));
+    return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, i_value), _mm_set1_ps(1.0f)));
+}
+
+__m128 renderer_span_negate(__m128 i_value)
+{
+    return _mm_xor_ps(i_value, _mm_set1_ps(-0.0f));
+}
+
+__m128 renderer_span_abs(__m128 i_value)
+{
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), i_value);
+}
+
+__m128 renderer_span_select(__m128 i_mask, __m128 i_true, __m128 i_false)
+{
+    return _mm_or_ps(_mm_and_ps(i_mask, i_true), _mm_andnot_ps(i_mask, i_false));
+}
+
+__m128 renderer_span_lerp(__m128 i_start, __m128 i_end, __m128 i_percentage)
+{
+    return _mm_add_ps(_mm_mul_ps(i_start, _mm_sub_ps(_mm_set1_ps(1.0f), i_percentage)), _mm_mul_ps(i_end, i_percentage));
+}
+
+__m128 renderer_span_step(__m128 i_edge, __m128 i_value)
+{
+    return _mm_and_ps(_mm_cmpge_ps(i_value, i_edge), _mm_set1_ps(1.0f));
+}
+
+__m128 renderer_span_saturate(__m128 i_value)
+{
+    return _mm_min_ps(_mm_max_ps(i_value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+}
+
+__m128 renderer_span_length(__m128 i_x, __m128 i_y)
+{
+    return _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(i_x, i_x), _mm_mul_ps(i_y, i_y)));
+}
+
+/* Mask of the lanes within i_bounds, see sdf_primitive_pixel_bounds. */
+__m128 renderer_span_inside(renderer_span_uv i_uv, fvec4 i_bounds)
+{
+    __m128 x = _mm_and_ps(_mm_cmpge_ps(i_uv.x, _mm_set1_ps(i_bounds.x)), _mm_cmple_ps(i_uv.x, _mm_set1_ps(i_bounds.z)));
+    __m128 y = _mm_and_ps(_mm_cmpge_ps(i_uv.y, _mm_set1_ps(i_bounds.y)), _mm_cmple_ps(i_uv.y, _mm_set1_ps(i_bounds.w)));
+    return _mm_and_ps(x, y);
+}
+
+/* Byte i_shift / 8 of every texel as a float. */
+__m128 renderer_span_channel(__m128i i_texels, __m128i i_shift)
+{
+    return _mm_cvtepi32_ps(_mm_and_si128(_mm_srl_epi32(i_texels, i_shift), _mm_set1_epi32(0xFF)));
+}
+
+/* Blends the four texel channels of sample_noise with the weights of i_weights. */
+__m128 renderer_span_noise(renderer_span_uv i_position, fvec4 const* i_weights)
+{
+    __m128 u = _mm_sub_ps(_mm_mul_ps(_mm_div_ps(i_position.x, _mm_set1_ps(1600.0f)), _mm_set1_ps((f32)TEXTURE_NOISE_WIDTH)), _mm_set1_ps(0.5f));
+    __m128 v = _mm_sub_ps(_mm_mul_ps(_mm_div_ps(i_position.y, _mm_set1_ps(900.0f)), _mm_set1_ps((f32)TEXTURE_NOISE_HEIGHT)), _mm_set1_ps(0.5f));
+    __m128 u_floor = renderer_span_floor(u);
+    __m128 v_floor = renderer_span_floor(v);
+    __m128 u_fraction = _mm_sub_ps(u, u_floor);
+    __m128 v_fraction = _mm_sub_ps(v, v_floor);
+
+    /* SSE2 has no gather, the texels are loaded lane by lane. */
+    u32 x0[RENDERER_SPAN_WIDTH];
+    u32 y0[RENDERER_SPAN_WIDTH];
+    _mm_storeu_si128((__m128i*)x0, _mm_and_si128(_mm_cvttps_epi32(u_floor), _mm_set1_epi32(TEXTURE_NOISE_WIDTH - 1)));
+    _mm_storeu_si128((__m128i*)y0, _mm_and_si128(_mm_cvttps_epi32(v_floor), _mm_set1_epi32(TEXTURE_NOISE_HEIGHT - 1)));
+    u32 texels[4][RENDERER_SPAN_WIDTH];
+    for (u32 lane = 0; lane < RENDERER_SPAN_WIDTH; ++lane)
+    {
+        u32 x1 = (x0[lane] + 1) & (TEXTURE_NOISE_WIDTH - 1);
+        u32 y1 = (y0[lane] + 1) & (TEXTURE_NOISE_HEIGHT - 1);
+        texels[0][lane] = g_texture_noise[y0[lane] * TEXTURE_NOISE_WIDTH + x0[lane]];
+        texels[1][lane] = g_texture_noise[y0[lane] * TEXTURE_NOISE_WIDTH + x1];
+        texels[2][lane] = g_texture_noise[y1 * TEXTURE_NOISE_WIDTH + x0[lane]];
+        texels[3][lane] = g_texture_noise[y1 * TEXTURE_NOISE_WIDTH + x1];
+    }
+    __m128i texel00 = _mm_loadu_si128((__m128i const*)texels[0]);
+    __m128i texel10 = _mm_loadu_si128((__m128i const*)texels[1]);
+    __m128i texel01 = _mm_loadu_si128((__m128i const*)texels[2]);
+    __m128i texel11 = _mm_loadu_si128((__m128i const*)texels[3]);
+
+    __m128 result = _mm_setzero_ps();
+    for (u32 channel = 0; channel < 4; ++channel)
+    {
+        __m128i shift = _mm_cvtsi32_si128((i32)(channel * 8));
+        __m128 top = renderer_span_lerp(renderer_span_channel(texel00, shift), renderer_span_channel(texel10, shift), u_fraction);
+        __m128 bottom = renderer_span_lerp(renderer_span_channel(texel01, shift), renderer_span_channel(texel11, shift), u_fraction);
+        __m128 texel = renderer_span_lerp(top, bottom, v_fraction);
+        result = _mm_add_ps(result, _mm_div_ps(_mm_mul_ps(_mm_set1_ps(i_weights->data[channel]), texel), _mm_set1_ps(255.0f)));
+    }
+    return result;
+}
+
+void renderer_span_sample(renderer_texture const* i_texture, renderer_span_uv i_uv, __m128 o_color[4])
+{
+    __m128 width = _mm_set1_ps((f32)i_texture->width);
+    __m128 height = _mm_set1_ps((f32)i_texture->height);
+    __m128 finite_x = _mm_cmpeq_ps(_mm_sub_ps(i_uv.x, i_uv.x), _mm_setzero_ps());
+    __m128 finite_y = _mm_cmpeq_ps(_mm_sub_ps(i_uv.y, i_uv.y), _mm_setzero_ps());
+    __m128 u = _mm_sub_ps(_mm_mul_ps(_mm_and_ps(finite_x, i_uv.x), width), _mm_set1_ps(0.5f));
+    __m128 v = _mm_sub_ps(_mm_mul_ps(_mm_and_ps(finite_y, i_uv.y), height), _mm_set1_ps(0.5f));
+    __m128 u_floor = renderer_span_floor(u);
+    __m128 v_floor = renderer_span_floor(v);
+    __m128 u_fraction = _mm_sub_ps(u, u_floor);
+    __m128 v_fraction = _mm_sub_ps(v, v_floor);
+
+    /* sdf_mod wraps the texel coordinates. */
+    u32 x0[RENDERER_SPAN_WIDTH];
+    u32 y0[RENDERER_SPAN_WIDTH];
+    _mm_storeu_si128((__m128i*)x0, _mm_cvttps_epi32(_mm_sub_ps(u_floor, _mm_mul_ps(width, renderer_span_floor(_mm_div_ps(u_floor, width))))));
+    _mm_storeu_si128((__m128i*)y0, _mm_cvttps_epi32(_mm_sub_ps(v_floor, _mm_mul_ps(height, renderer_span_floor(_mm_div_ps(v_floor, height))))));
+    u32 texels[4][RENDERER_SPAN_WIDTH];
+    for (u32 lane = 0; lane < RENDERER_SPAN_WIDTH; ++lane)
+    {
+        u32 x1 = x0[lane] + 1 < i_texture->width ? x0[lane] + 1 : 0;
+        u32 y1 = y0[lane] + 1 < i_texture->height ? y0[lane] + 1 : 0;
+        texels[0][lane] = i_texture->texels[y0[lane] * i_texture->width + x0[lane]];
+        texels[1][lane] = i_texture->texels[y0[lane] * i_texture->width + x1];
+        texels[2][lane] = i_texture->texels[y1 * i_texture->width + x0[lane]];
+        texels[3][lane] = i_texture->texels[y1 * i_texture->width + x1];
+    }
+    __m128i texel00 = _mm_loadu_si128((__m128i const*)texels[0]);
+    __m128i texel10 = _mm_loadu_si128((__m128i const*)texels[1]);
+    __m128i texel01 = _mm_loadu_si128((__m128i const*)texels[2]);
+    __m128i texel11 = _mm_loadu_si128((__m128i const*)texels[3]);
+
+    for (u32 channel = 0; channel < 4; ++channel)
+    {
+        __m128i shift = _mm_cvtsi32_si128((i32)(channel * 8));
+        __m128 top = renderer_span_lerp(renderer_span_channel(texel00, shift), renderer_span_channel(texel10, shift), u_fraction);
+        __m128 bottom = renderer_span_lerp(renderer_span_channel(texel01, shift), renderer_span_channel(texel11, shift), u_fraction);
+        o_color[channel] = _mm_div_ps(renderer_span_lerp(top, bottom, v_fraction), _mm_set1_ps(255.0f));
+    }
+}
+
+__m128 renderer_span_circle(renderer_span_uv i_uv, fvec2 i_position, f32 i_radius)
+{
+    __m128 x = _mm_sub_ps(_mm_set1_ps(i_position.x), i_uv.x);
+    __m128 y = _mm_sub_ps(_mm_set1_ps(i_position.y), i_uv.y);
+    return _mm_sub_ps(renderer_span_length(x, y), _mm_set1_ps(i_radius));
+}
+
+__m128 renderer_span_box(renderer_span_uv i_uv, fvec2 i_position, fvec2 i_size)
+{
+    __m128 x = _mm_sub_ps(renderer_span_abs(_mm_sub_ps(_mm_set1_ps(i_position.x), i_uv.x)), _mm_set1_ps(i_size.x));
+    __m128 y = _mm_sub_ps(renderer_span_abs(_mm_sub_ps(_mm_set1_ps(i_position.y), i_uv.y)), _mm_set1_ps(i_size.y));
+    __m128 outside = renderer_span_length(_mm_max_ps(x, _mm_setzero_ps()), _mm_max_ps(y, _mm_setzero_ps()));
+    return _mm_add_ps(outside, _mm_min_ps(_mm_max_ps(x, y), _mm_setzero_ps()));
+}
+
+/* sdf_segment for a uv already relative to the position, i_uv.x and i_uv.y are position - uv. */
+__m128 renderer_span_segment(__m128 i_x, __m128 i_y, fvec2 i_start, fvec2 i_end)
+{
+    __m128 x = _mm_sub_ps(i_x, _mm_set1_ps(i_start.x));
+    __m128 y = _mm_sub_ps(i_y, _mm_set1_ps(i_start.y));
+    fvec2 end_start = fvec2_sub(i_end, i_start);
+    __m128 end_start_x = _mm_set1_ps(end_start.x);
+    __m128 end_start_y = _mm_set1_ps(end_start.y);
+    __m128 height = _mm_div_ps(_mm_add_ps(_mm_mul_ps(x, end_start_x), _mm_mul_ps(y, end_start_y)), _mm_set1_ps(fvec2_dot(end_start, end_start)));
+    height = renderer_span_saturate(height);
+    return renderer_span_length(_mm_sub_ps(x, _mm_mul_ps(end_start_x, height)), _mm_sub_ps(y, _mm_mul_ps(end_start_y, height)));
+}
+
+__m128 renderer_span_wobbly_circle(renderer_span_uv i_uv, fvec2 i_position, f32 i_radius, fvec4 const* i_noise)
+{
+    return _mm_sub_ps(renderer_span_circle(i_uv, i_position, i_radius), _mm_mul_ps(_mm_set1_ps(25.0f), renderer_span_noise(i_uv, i_noise)));
+}
+
+__m128 renderer_span_wobbly_box(renderer_span_uv i_uv, fvec2 i_position, fvec2 i_size)
+{
+    __m128 distance = _mm_sub_ps(renderer_span_box(i_uv, i_position, i_size), _mm_mul_ps(_mm_set1_ps(25.0f), renderer_span_noise(i_uv, &g_renderer.noise_zero)));
+    __m128 inside = _mm_cmple_ps(distance, _mm_setzero_ps());
+    if (_mm_movemask_ps(inside) != 0)
+    {
+        __m128 holes = _mm_cmple_ps(renderer_span_noise(i_uv, &g_renderer.noise_tenth), _mm_set1_ps(0.7f));
+        __m128 factor = _mm_and_ps(holes, _mm_set1_ps(-1.0f));
+        distance = renderer_span_select(inside, _mm_mul_ps(distance, factor), distance);
+    }
+    return distance;
+}
+
+/* The texture is only sampled when a lane is inside the box, outside the color is blended with a weight of 0. */
+renderer_span_color_distance renderer_span_box_textured(renderer_span_uv i_uv, fvec2 i_position, fvec2 i_size, fvec2 i_sprite_index, fvec2 i_sprite_size)
+{
+    renderer_span_color_distance result;
+    __m128 step = renderer_span_step(renderer_span_box(i_uv, i_position, i_size), _mm_setzero_ps());
+    result.distance = _mm_sub_ps(_mm_set1_ps(1.0f), step);
+    if (_mm_movemask_ps(_mm_cmpgt_ps(step, _mm_setzero_ps())) == 0)
+    {
+        result.color[0] = result.color[1] = result.color[2] = result.color[3] = _mm_setzero_ps();
+        return result;
+    }
+
+    fvec2 top_left = fvec2_sub(i_position, i_size);
+    fvec2 scale = { i_sprite_size.x / (f32)TEXTURE_SPRITESHEET_WIDTH, i_sprite_size.y / (f32)TEXTURE_SPRITESHEET_HEIGHT };
+    fvec2 offset = fvec2_mul(scale, i_sprite_index);
+    renderer_span_uv box_uv;
+    box_uv.x = _mm_mul_ps(_mm_div_ps(_mm_sub_ps(i_uv.x, _mm_set1_ps(top_left.x)), _mm_set1_ps(i_size.x)), _mm_set1_ps(0.5f));
+    box_uv.y = _mm_mul_ps(_mm_div_ps(_mm_sub_ps(i_uv.y, _mm_set1_ps(top_left.y)), _mm_set1_ps(i_size.y)), _mm_set1_ps(0.5f));
+    box_uv.x = _mm_add_ps(_mm_mul_ps(box_uv.x, _mm_set1_ps(scale.x)), _mm_set1_ps(offset.x));
+    box_uv.y = _mm_add_ps(_mm_mul_ps(box_uv.y, _mm_set1_ps(scale.y)), _mm_set1_ps(offset.y));
+    renderer_span_sample(&g_renderer.spritesheet, box_uv, result.color);
+    return result;
+}
+
+__m128 renderer_span_maggot(renderer_span_uv i_uv, fvec2 i_position, f32 i_size, f32 i_time)
+{
+    fvec2 scale = { f32_abs(f32_sin(i_time * 3.0f)), f32_abs(f32_cos(i_time * 3.0f)) };
+    scale = fvec2_mul_s(fvec2_add(sdf_vec2(1.0f, 1.0f), fvec2_mul_s(scale, 0.25f)), 0.5f);
+    __m128 x = _mm_div_ps(_mm_add_ps(i_uv.x, _mm_set1_ps(i_position.x * scale.x)), _mm_set1_ps(1.0f + scale.x));
+    __m128 y = _mm_div_ps(_mm_add_ps(i_uv.y, _mm_set1_ps(i_position.y * scale.y)), _mm_set1_ps(1.0f + scale.y));
+
+    fvec2 offset = fvec2_mul_s(sdf_vec2(0.0f, -0.1f), i_size);
+    x = _mm_sub_ps(_mm_sub_ps(_mm_set1_ps(i_position.x), x), _mm_set1_ps(offset.x));
+    y = _mm_sub_ps(_mm_sub_ps(_mm_set1_ps(i_position.y), y), _mm_set1_ps(offset.y));
+    f32 angle = 0.25f * i_time * 3.1415925f * 2.0f;
+    __m128 c = _mm_set1_ps(f32_cos(angle));
+    __m128 s = _mm_set1_ps(f32_sin(angle));
+    renderer_span_uv position;
+    position.x = _mm_sub_ps(_mm_mul_ps(c, x), _mm_mul_ps(s, y));
+    position.y = _mm_add_ps(_mm_mul_ps(s, x), _mm_mul_ps(c, y));
+    f32 size = 2.0f * i_size;
+
+    /* sdf_circle(point, position, radius) is the length of position - point, the negated circle around point. */
+    __m128 b1 = renderer_span_circle(position, fvec2_mul_s(sdf_vec2(0.05f, -0.25f), size), i_size * 0.95f);
+    __m128 b2 = renderer_span_circle(position, fvec2_mul_s(sdf_vec2(0.3f, -0.05f), size), i_size * 0.75f);
+    __m128 b3 = renderer_span_circle(position, fvec2_mul_s(sdf_vec2(0.35f, 0.25f), size), i_size * 0.5f);
+    __m128 b4 = renderer_span_circle(position, fvec2_mul_s(sdf_vec2(0.25f, 0.5f), size), i_size * 0.3f);
+    __m128 b5 = renderer_span_circle(position, fvec2_mul_s(sdf_vec2(0.05f, 0.59f), size), i_size * 0.25f);
+    __m128 b6 = renderer_span_circle(position, fvec2_mul_s(sdf_vec2(-0.1f, 0.57f), size), i_size * 0.2f);
+    __m128 e7 = renderer_span_circle(position, fvec2_mul_s(sdf_vec2(-0.4f, -0.3f), size), i_size * 0.25f);
+    __m128 e8 = renderer_span_circle(position, fvec2_mul_s(sdf_vec2(0.25f, -0.3f), size), i_size * 0.25f);
+
+    __m128 body = _mm_min_ps(_mm_min_ps(_mm_min_ps(b1, b2), _mm_min_ps(b3, b4)), _mm_min_ps(b5, b6));
+    return _mm_max_ps(_mm_max_ps(body, renderer_span_negate(e7)), renderer_span_negate(e8));
+}
+
+__m128 renderer_span_player(renderer_span_uv i_uv, fvec2 i_position, f32 i_scale, f32 i_time)
+{
+    fvec2 scale = { f32_abs(f32_sin(i_time * 3.0f)), f32_abs(f32_cos(i_time * 3.0f)) };
+    scale = fvec2_mul_s(fvec2_add(sdf_vec2(1.0f, 1.0f), fvec2_mul_s(scale, 0.25f)), 0.5f * i_scale);
+    renderer_span_uv uv;
+    uv.x = _mm_div_ps(_mm_add_ps(i_uv.x, _mm_set1_ps(i_position.x * scale.x)), _mm_set1_ps(1.0f + scale.x));
+    uv.y = _mm_div_ps(_mm_add_ps(i_uv.y, _mm_set1_ps(i_position.y * scale.y)), _mm_set1_ps(1.0f + scale.y));
+
+    f32 radius = 27.0f * i_scale;
+    __m128 circle = renderer_span_circle(uv, i_position, radius);
+    circle = _mm_min_ps(circle, renderer_span_circle(uv, fvec2_sub(i_position, sdf_vec2(25.0f, 10.0f)), radius * 0.3f));
+    circle = _mm_min_ps(circle, renderer_span_circle(uv, fvec2_sub(i_position, sdf_vec2(10.0f, 20.0f)), radius * 0.5f));
+    circle = _mm_min_ps(circle, renderer_span_circle(uv, fvec2_sub(i_position, sdf_vec2(-15.0f, 0.0f)), radius * 0.6f));
+    circle = _mm_min_ps(circle, renderer_span_circle(uv, fvec2_sub(i_position, sdf_vec2(-15.0f, 20.0f)), radius * 0.3f));
+
+    __m128 x = _mm_sub_ps(_mm_set1_ps(i_position.x), uv.x);
+    __m128 y = _mm_sub_ps(_mm_set1_ps(i_position.y), uv.y);
+    fvec2 hand1 = fvec2_mul_s(sdf_vec2(15.0f, -20.0f * (1.0f + scale.x * 0.4f)), i_scale);
+    fvec2 hand2 = fvec2_mul_s(sdf_vec2(-15.0f, -20.0f * (1.0f + scale.y * 0.4f)), i_scale);
+    __m128 arm1 = _mm_sub_ps(renderer_span_segment(x, y, sdf_vec2(15.0f, 10.0f), hand1), _mm_set1_ps(5.0f * i_scale));
+    __m128 arm2 = _mm_sub_ps(renderer_span_segment(x, y, sdf_vec2(-15.0f, 10.0f), hand2), _mm_set1_ps(5.0f * i_scale));
+    return _mm_min_ps(circle, _mm_min_ps(arm1, arm2));
+}
+
+__m128 renderer_span_particles_burst(renderer_span_uv i_uv, sdf_primitive const* i_primitive)
+{
+    __m128 distance = _mm_set1_ps(SDF_RESULT_DISTANCE_INVALID);
+    u32 first = (u32)i_primitive->growth_sizes2.x;
+    u32 end = first + (u32)i_primitive->growth_sizes2.y;
+    for (u32 i = first; i < end; ++i)
+    {
+        particle_packed particle = g_particles_packed[i];
+        fvec2 position = {
+            i_primitive->position.x + (f32)particle.position[0] / SDF_PACKED_POSITION_SCALE,
+            i_primitive->position.y + (f32)particle.position[1] / SDF_PACKED_POSITION_SCALE
+        };
+        distance = _mm_min_ps(distance, renderer_span_circle(i_uv, position, particle.radius));
+    }
+    return distance;
+}
+
+/* Shapes that are mostly transcendentals go through the scalar code, one lane at a time. */
+__m128 renderer_span_per_lane(f32 (*i_shape)(fvec2, fvec2, f32, f32), renderer_span_uv i_uv, __m128 i_inside, fvec2 i_position, f32 i_size, f32 i_time)
+{
+    f32 x[RENDERER_SPAN_WIDTH];
+    f32 y[RENDERER_SPAN_WIDTH];
+    f32 distance[RENDERER_SPAN_WIDTH];
+    _mm_storeu_ps(x, i_uv.x);
+    _mm_storeu_ps(y, i_uv.y);
+    i32 inside = _mm_movemask_ps(i_inside);
+    for (u32 lane = 0; lane < RENDERER_SPAN_WIDTH; ++lane)
+    {
+        distance[lane] = (inside >> lane) & 1 ? i_shape(sdf_vec2(x[lane], y[lane]), i_position, i_size, i_time) : SDF_RESULT_DISTANCE_INVALID;
+    }
+    return _mm_loadu_ps(distance);
+}
+
+/* Primitives of type i_skip_type are left out, for spans those can not reach. */
+renderer_span_color_distance renderer_span_get_distance(sdf_primitive const* i_primitives, fvec4 const* i_bounds, sdf_bins const* i_bins, u32 i_tile, renderer_span_uv i_uv, fvec3 i_growth_weights, f32 i_time, u32 i_skip_type)
+{
+    renderer_span_color_distance result;
+    result.color[0] = result.color[1] = result.color[2] = result.color[3] = _mm_setzero_ps();
+    result.distance = _mm_set1_ps(SDF_RESULT_DISTANCE_INVALID);
+
+    for (u32 entry = i_bins->offsets[i_tile]; entry < i_bins->offsets[i_tile + 1]; ++entry)
+    {
+        /* Outside its bounds a primitive is at least a pixel away and blends with a weight of 0. */
+        u32 index = i_bins->indices[entry];
+        __m128 inside = renderer_span_inside(i_uv, i_bounds[index]);
+        if (_mm_movemask_ps(inside) == 0)
+        {
+            continue;
+        }
+
+        sdf_primitive const* primitive = &i_primitives[index];
+        if (primitive->type == i_skip_type)
+        {
+            continue;
+        }
+        __m128 distance = _mm_set1_ps(SDF_RESULT_DISTANCE_INVALID);
+        fvec4 solid = { 1.0f, 0.0f, 0.0f, 0.0f };
+        renderer_span_color_distance textured;
+        b8 is_textured = FALSE;
+
+        f32 growth_size1 = fvec3_dot(i_growth_weights, primitive->growth_sizes1);
+        f32 growth_size2 = fvec3_dot(i_growth_weights, primitive->growth_sizes2);
+        fvec2 sprite_index = { primitive->sprite_index[0], primitive->sprite_index[1] };
+
+        switch (primitive->type)
+        {
+            case SDF_PRIMITIVE_CIRCLE:
+            {
+                solid = { 1.0f, 0.05f, 0.0f, 0.0f };
+                distance = renderer_span_wobbly_circle(i_uv, primitive->position, growth_size1, &g_renderer.noise_time);
+            } break;
+            case SDF_PRIMITIVE_SPIKED_CIRCLE:
+            {
+                solid = { 1.0f, 0.05f, 0.0f, 0.0f };
+                distance = renderer_span_per_lane(sdf_spiked_circle, i_uv, inside, primitive->position, growth_size1, i_time);
+            } break;
+            case SDF_PRIMITIVE_BOX:
+            {
+                solid = { 1.0f, 0.05f, 0.0f, 0.0f };
+                distance = renderer_span_wobbly_box(i_uv, primitive->position, sdf_vec2(growth_size1, growth_size2));
+            } break;
+            case SDF_PRIMITIVE_BOX_TEXTURED:
+            {
+                textured = renderer_span_box_textured(i_uv, primitive->position, sdf_vec2(growth_size1, growth_size2), sprite_index, sdf_vec2(384.0f, 128.0f));
+                distance = textured.distance;
+                is_textured = TRUE;
+            } break;
+            case SDF_PRIMITIVE_BOX_TEXT:
+            {
+                f32 scale = primitive->growth_sizes1.z;
+                fvec2 background_size = { (primitive->growth_sizes1.x - 10.0f) * scale, (primitive->growth_sizes2.x - 10.0f) * scale };
+                __m128 noise = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(25.0f), renderer_span_noise(i_uv, &g_renderer.noise_zero)), _mm_set1_ps(scale));
+                distance = _mm_sub_ps(renderer_span_box(i_uv, primitive->position, background_size), noise);
+
+                fvec2 text_size = { primitive->growth_sizes1.x * scale, primitive->growth_sizes2.x * scale };
+                renderer_span_color_distance text = renderer_span_box_textured(i_uv, primitive->position, text_size, sprite_index, sdf_vec2(512.0f, 162.0f));
+                __m128 weight = _mm_mul_ps(renderer_span_saturate(_mm_sub_ps(_mm_set1_ps(1.0f), text.distance)), text.color[0]);
+                textured.color[0] = _mm_set1_ps(1.0f);
+                for (u32 channel = 1; channel < 4; ++channel)
+                {
+                    textured.color[channel] = renderer_span_lerp(_mm_set1_ps(1.0f), _mm_setzero_ps(), weight);
+                }
+                is_textured = TRUE;
+            } break;
+            case SDF_PRIMITIVE_BOX_FLOWER:
+            {
+                textured = renderer_span_box_textured(i_uv, primitive->position, sdf_vec2(growth_size1, growth_size2), sprite_index, sdf_vec2(128.0f, 128.0f));
+                distance = textured.distance;
+                is_textured = TRUE;
+            } break;
+            case SDF_PRIMITIVE_PORTAL:
+            {
+                distance = renderer_span_per_lane(sdf_portal, i_uv, inside, primitive->position, growth_size1, i_time);
+            } break;
+            case SDF_PRIMITIVE_MAGGOT:
+            {
+                distance = renderer_span_maggot(i_uv, primitive->position, growth_size1, i_time);
+            } break;
+            case SDF_PRIMITIVE_PARTICLES:
+            {
+                distance = renderer_span_particles_burst(i_uv, primitive);
+            } break;
+        }
+        if (!is_textured)
+        {
+            for (u32 channel = 0; channel < 4; ++channel)
+            {
+                textured.color[channel] = _mm_set1_ps(solid.data[channel]);
+            }
+        }
+
+        __m128 prev_distance = result.distance;
+        result.distance = _mm_min_ps(result.distance, renderer_span_select(inside, distance, _mm_set1_ps(SDF_RESULT_DISTANCE_INVALID)));
+        __m128 closer = _mm_cmplt_ps(result.distance, prev_distance);
+        __m128 weight = _mm_mul_ps(renderer_span_saturate(_mm_sub_ps(_mm_set1_ps(1.0f), result.distance)), textured.color[0]);
+        for (u32 channel = 0; channel < 4; ++channel)
+        {
+            result.color[channel] = renderer_span_select(closer, renderer_span_lerp(result.color[channel], textured.color[channel], weight), result.color[channel]);
+        }
+    }
+    return result;
+}
+
+__m128 renderer_span_dust_particles(renderer_span_uv i_uv, f32 i_factor, fvec4 const* i_noise)
+{
+    f32 fov = 150.0f;
+    __m128 color = _mm_setzero_ps();
+    for (u32 i = 1; i < 4; ++i)
+    {
+        f32 layer = (f32)i;
+        __m128 zoom = _mm_set1_ps(f32_tan((layer * 4.0f + fov) * 3.14159265f / 180.0f / 2.0f));
+        __m128 x = _mm_mul_ps(_mm_sub_ps(_mm_div_ps(i_uv.x, _mm_set1_ps(900.0f)), _mm_set1_ps(0.5f)), zoom);
+        __m128 y = _mm_mul_ps(_mm_sub_ps(_mm_div_ps(i_uv.y, _mm_set1_ps(900.0f)), _mm_set1_ps(0.5f)), zoom);
+        x = _mm_add_ps(x, _mm_set1_ps(-i_factor / 8.0f + layer / 12.0f));
+
+        f32 lanes[RENDERER_SPAN_WIDTH];
+        _mm_storeu_ps(lanes, x);
+        for (u32 lane = 0; lane < RENDERER_SPAN_WIDTH; ++lane)
+        {
+            lanes[lane] = f32_sin(layer - i_factor / 4.0f + lanes[lane]) * 0.3f;
+        }
+        y = _mm_add_ps(y, _mm_loadu_ps(lanes));
+
+        __m128 offset = _mm_set1_ps(layer * 9.0f);
+        renderer_span_uv cell;
+        cell.x = _mm_add_ps(renderer_span_negate(renderer_span_floor(renderer_span_negate(_mm_add_ps(x, offset)))), _mm_set1_ps(layer));
+        cell.y = _mm_add_ps(renderer_span_negate(renderer_span_floor(renderer_span_negate(_mm_add_ps(y, offset)))), _mm_set1_ps(layer));
+        __m128 strength = _mm_mul_ps(_mm_set1_ps(0.01f), renderer_span_noise(cell, i_noise));
+        __m128 half = _mm_set1_ps(0.5f);
+        __m128 distance = renderer_span_length(_mm_sub_ps(_mm_sub_ps(x, renderer_span_floor(x)), half), _mm_sub_ps(_mm_sub_ps(y, renderer_span_floor(y)), half));
+        __m128 dot = _mm_sub_ps(_mm_set1_ps(1.0f / layer), _mm_mul_ps(_mm_mul_ps(distance, _mm_set1_ps(layer)), _mm_set1_ps(6.0f)));
+        color = renderer_span_select(_mm_cmplt_ps(distance, strength), _mm_add_ps(color, dot), color);
+    }
+    return color;
+}
+
+renderer_span_color_distance renderer_span_player_hud(renderer_span_uv i_uv)
+{
+    renderer_span_color_distance result;
+    result.distance = _mm_set1_ps(SDF_RESULT_DISTANCE_INVALID);
+    result.color[0] = result.color[1] = result.color[2] = result.color[3] = _mm_set1_ps(1.0f);
+
+    /* Only the sign of the HUD distance is used, the wobbly circles reach at most 25 * 1.6 past their radius. */
+    fvec3 circles[2] = { { 20.0f, -30.0f, 100.0f }, { 120.0f, -30.0f, 50.0f } };
+    for (u32 i = 0; i < 2; ++i)
+    {
+        f32 reach = circles[i].z + 25.0f * 1.6f;
+        fvec4 bounds = { circles[i].x - reach, circles[i].y - reach, circles[i].x + reach, circles[i].y + reach };
+        if (_mm_movemask_ps(renderer_span_inside(i_uv, bounds)) != 0)
+        {
+            result.distance = _mm_min_ps(result.distance, renderer_span_wobbly_circle(i_uv, circles[i].xy, circles[i].z, &g_renderer.noise_time));
+        }
+    }
+
+    /* The icons come from g_hud_image, outside of them the HUD is white and their distance of 1 never wins. */
+    fvec4 image_bounds = { (f32)HUD_IMAGE_X, (f32)HUD_IMAGE_Y, (f32)(HUD_IMAGE_X + HUD_IMAGE_WIDTH), (f32)(HUD_IMAGE_Y + HUD_IMAGE_HEIGHT) };
+    if (_mm_movemask_ps(renderer_span_inside(i_uv, image_bounds)) == 0)
+    {
+        return result;
+    }
+
+    f32 x[RENDERER_SPAN_WIDTH];
+    f32 y[RENDERER_SPAN_WIDTH];
+    f32 distances[RENDERER_SPAN_WIDTH];
+    f32 colors[4][RENDERER_SPAN_WIDTH];
+    _mm_storeu_ps(x, i_uv.x);
+    _mm_storeu_ps(y, i_uv.y);
+    for (u32 lane = 0; lane < RENDERER_SPAN_WIDTH; ++lane)
+    {
+        renderer_color_distance icons = renderer_hud_image_fetch(sdf_vec2(x[lane], y[lane]));
+        distances[lane] = icons.distance;
+        for (u32 channel = 0; channel < 4; ++channel)
+        {
+            colors[channel][lane] = icons.color.data[channel];
+        }
+    }
+    result.distance = _mm_min_ps(result.distance, _mm_loadu_ps(distances));
+    for (u32 channel = 0; channel < 4; ++channel)
+    {
+        result.color[channel] = _mm_loadu_ps(colors[channel]);
+    }
+    return result;
+}
+
+/* Parts of the frame that only change with the camera, the growth and the walls, baked per pixel for the spans.
+ * The background and vignette never change. For walls the distances of up to RENDERER_LAYER_WALLS boxes that come
+ * within a pixel are kept in list order, from before the holes that move with time are cut. A span takes the level
+ * from the layer when no other level shape is in range, on its own that only skips shapes that blend with a weight
+ * of 0. Pixels with more walls are evaluated in full, like spans near dynamic shapes. */
+#define RENDERER_LAYER_WALLS 2
+
+typedef struct {
+    f32 background[3][RENDERER_WIDTH * RENDERER_HEIGHT];
+    f32 walls[RENDERER_LAYER_WALLS][RENDERER_WIDTH * RENDERER_HEIGHT];
+    u8 walls_count[RENDERER_WIDTH * RENDERER_HEIGHT]; /* RENDERER_LAYER_WALLS + 1 when they did not fit. */
+
+    /* What the walls were baked for. */
+    sdf_primitive walls_primitives[SDF_PRIMITIVES_COUNT_MAX];
+    u32 walls_primitives_count;
+    fvec2 camera;
+    f32 growth_factor;
+
+    b8 is_enabled;
+    b8 is_background_baked;
+    b8 is_walls_baked;
+    b8 bake_background; /* Set for the frame by renderer_layer_update. */
+    b8 bake_walls;
+
+    u32 bakes;
+    std::atomic<u32> spans_layer; /* Spans that took the level from the layer, skipped walls or evaluated everything. */
+    std::atomic<u32> spans_dynamic;
+    std::atomic<u32> spans_full;
+} renderer_layer;
+renderer_layer g_renderer_layer;
+
+/* Rebakes the walls when the camera, the growth factor or any wall moved since they were baked. */
+void renderer_layer_update()
+{
+    renderer_layer* layer = &g_renderer_layer;
+    u32 walls_count = 0;
+    b8 walls_changed = FALSE;
+    for (u32 i = 0; i < g_renderer.level_primitives_count; ++i)
+    {
+        sdf_primitive const* primitive = &g_renderer.level_primitives[i];
+        if (primitive->type == SDF_PRIMITIVE_BOX)
+        {
+            if (walls_count >= layer->walls_primitives_count || memcmp(primitive, &layer->walls_primitives[walls_count], sizeof(sdf_primitive)) != 0)
+            {
+                walls_changed = TRUE;
+                layer->walls_primitives[walls_count] = *primitive;
+            }
+            ++walls_count;
+        }
+    }
+    walls_changed = walls_changed || walls_count != layer->walls_primitives_count ? TRUE : FALSE;
+    walls_changed = walls_changed || layer->camera.x != g_renderer.camera.x || layer->camera.y != g_renderer.camera.y ? TRUE : FALSE;
+    walls_changed = walls_changed || layer->growth_factor != g_renderer.player.growth_factor ? TRUE : FALSE;
+    layer->walls_primitives_count = walls_count;
+    layer->camera = g_renderer.camera;
+    layer->growth_factor = g_renderer.player.growth_factor;
+
+    b8 is_used = layer->is_enabled && g_renderer.use_spans ? TRUE : FALSE;
+    layer->bake_background = is_used && !layer->is_background_baked ? TRUE : FALSE;
+    layer->bake_walls = is_used && (walls_changed || !layer->is_walls_baked) ? TRUE : FALSE;
+    layer->is_background_baked = layer->is_background_baked || layer->bake_background ? TRUE : FALSE;
+    layer->is_walls_baked = layer->is_walls_baked || layer->bake_walls ? TRUE : FALSE;
+    layer->bakes += layer->bake_walls ? 1 : 0;
+}
+
+/* The background with the vignette of the span, the first part of renderer_span_shade. */
+void renderer_span_background(renderer_span_uv i_uv, __m128 o_color[3])
+{
+    __m128 one = _mm_set1_ps(1.0f);
+    renderer_span_uv screen_uv = { _mm_div_ps(i_uv.x, _mm_set1_ps((f32)RENDERER_WIDTH)), _mm_div_ps(i_uv.y, _mm_set1_ps((f32)RENDERER_HEIGHT)) };
+    __m128 background[4];
+    renderer_span_sample(&g_renderer.background, screen_uv, background);
+
+    f32 vignette[RENDERER_SPAN_WIDTH];
+    __m128 vignette_base = _mm_mul_ps(_mm_mul_ps(screen_uv.x, _mm_sub_ps(one, screen_uv.y)), screen_uv.y);
+    vignette_base = _mm_mul_ps(_mm_mul_ps(vignette_base, _mm_sub_ps(one, screen_uv.x)), _mm_set1_ps(25.0f));
+    _mm_storeu_ps(vignette, vignette_base);
+    for (u32 lane = 0; lane < RENDERER_SPAN_WIDTH; ++lane)
+    {
+        vignette[lane] = f32_pow(vignette[lane], 0.3f);
+    }
+    o_color[0] = _mm_mul_ps(background[3], _mm_loadu_ps(vignette));
+    o_color[1] = _mm_mul_ps(background[1], _mm_loadu_ps(vignette));
+    o_color[2] = _mm_mul_ps(background[2], _mm_loadu_ps(vignette));
+}
+
+/* Bakes the layer for the span at i_pixel, the walls with the same code renderer_span_wobbly_box starts with. */
+void renderer_span_layer_bake(renderer_span_uv i_uv, renderer_span_uv i_world_uv, u32 i_tile, u32 i_pixel, fvec3 i_growth_weights)
+{
+    renderer_layer* layer = &g_renderer_layer;
+    if (layer->bake_background)
+    {
+        __m128 background[3];
+        renderer_span_background(i_uv, background);
+        for (u32 channel = 0; channel < 3; ++channel)
+        {
+            _mm_storeu_ps(&layer->background[channel][i_pixel], background[channel]);
+        }
+    }
+    if (!layer->bake_walls)
+    {
+        return;
+    }
+
+    memzero(&layer->walls_count[i_pixel], RENDERER_SPAN_WIDTH);
+    for (u32 entry = g_level_bins.offsets[i_tile]; entry < g_level_bins.offsets[i_tile + 1]; ++entry)
+    {
+        u32 index = g_level_bins.indices[entry];
+        sdf_primitive const* primitive = &g_renderer.level_primitives[index];
+        __m128 inside = renderer_span_inside(i_world_uv, g_renderer.level_bounds[index]);
+        if (primitive->type != SDF_PRIMITIVE_BOX || _mm_movemask_ps(inside) == 0)
+        {
+            continue;
+        }
+
+        fvec2 size = { fvec3_dot(i_growth_weights, primitive->growth_sizes1), fvec3_dot(i_growth_weights, primitive->growth_sizes2) };
+        __m128 noise = _mm_mul_ps(_mm_set1_ps(25.0f), renderer_span_noise(i_world_uv, &g_renderer.noise_zero));
+        __m128 distance = _mm_sub_ps(renderer_span_box(i_world_uv, primitive->position, size), noise);
+        i32 in_range = _mm_movemask_ps(_mm_and_ps(inside, _mm_cmplt_ps(distance, _mm_set1_ps(1.0f))));
+        f32 distances[RENDERER_SPAN_WIDTH];
+        _mm_storeu_ps(distances, distance);
+        for (u32 lane = 0; lane < RENDERER_SPAN_WIDTH; ++lane)
+        {
+            u8* count = &layer->walls_count[i_pixel + lane];
+            if ((in_range >> lane) & 1 && *count <= RENDERER_LAYER_WALLS)
+            {
+                if (*count < RENDERER_LAYER_WALLS)
+                {
+                    layer->walls[*count][i_pixel + lane] = distances[lane];
+                }
+                *count += 1;
+            }
+        }
+    }
+}
+
+/* The level from the layer, renderer_span_get_distance over the walls alone. */
+renderer_span_color_distance renderer_span_layer_walls(renderer_span_uv i_world_uv, u32 i_pixel)
+{
+    renderer_layer const* layer = &g_renderer_layer;
+    renderer_span_color_distance result;
+    result.color[0] = result.color[1] = result.color[2] = result.color[3] = _mm_setzero_ps();
+    result.distance = _mm_set1_ps(SDF_RESULT_DISTANCE_INVALID);
+
+    __m128i counts = _mm_setr_epi32(layer->walls_count[i_pixel], layer->walls_count[i_pixel + 1], layer->walls_count[i_pixel + 2], layer->walls_count[i_pixel + 3]);
+    __m128 holes = _mm_setzero_ps();
+    b8 has_holes = FALSE;
+    fvec4 wall = { 1.0f, 0.05f, 0.0f, 0.0f };
+    for (u32 i = 0; i < RENDERER_LAYER_WALLS; ++i)
+    {
+        __m128 inside = _mm_castsi128_ps(_mm_cmpgt_epi32(counts, _mm_set1_epi32((i32)i)));
+        if (_mm_movemask_ps(inside) == 0)
+        {
+            break;
+        }
+
+        /* The holes of renderer_span_wobbly_box, the noise is shared by the walls of a pixel. */
+        __m128 distance = _mm_loadu_ps(&layer->walls[i][i_pixel]);
+        __m128 is_solid = _mm_and_ps(inside, _mm_cmple_ps(distance, _mm_setzero_ps()));
+        if (_mm_movemask_ps(is_solid) != 0)
+        {
+            if (!has_holes)
+            {
+                holes = _mm_cmple_ps(renderer_span_noise(i_world_uv, &g_renderer.noise_tenth), _mm_set1_ps(0.7f));
+                has_holes = TRUE;
+            }
+            __m128 factor = _mm_and_ps(holes, _mm_set1_ps(-1.0f));
+            distance = renderer_span_select(is_solid, _mm_mul_ps(distance, factor), distance);
+        }
+
+        __m128 prev_distance = result.distance;
+        result.distance = _mm_min_ps(result.distance, renderer_span_select(inside, distance, _mm_set1_ps(SDF_RESULT_DISTANCE_INVALID)));
+        __m128 closer = _mm_cmplt_ps(result.distance, prev_distance);
+        __m128 weight = _mm_mul_ps(renderer_span_saturate(_mm_sub_ps(_mm_set1_ps(1.0f), result.distance)), _mm_set1_ps(wall.x));
+        for (u32 channel = 0; channel < 4; ++channel)
+        {
+            result.color[channel] = renderer_span_select(closer, renderer_span_lerp(result.color[channel], _mm_set1_ps(wall.data[channel]), weight), result.color[channel]);
+        }
+    }
+    return result;
+}
+
+/* The level for the span, from the layer where the level shapes in range allow it. */
+renderer_span_color_distance renderer_span_level(renderer_span_uv i_world_uv, u32 i_tile, u32 i_pixel, fvec3 i_growth_weights)
+{
+    renderer_layer* layer = &g_renderer_layer;
+    f32 time = g_renderer.player.time;
+    if (!layer->is_enabled)
+    {
+        return renderer_span_get_distance(g_renderer.level_primitives, g_renderer.level_bounds, &g_level_bins, i_tile, i_world_uv, i_growth_weights, time, SDF_PRIMITIVE_INVALID);
+    }
+
+    b8 is_dynamic = FALSE;
+    for (u32 entry = g_level_bins.offsets[i_tile]; entry < g_level_bins.offsets[i_tile + 1] && !is_dynamic; ++entry)
+    {
+        u32 index = g_level_bins.indices[entry];
+        is_dynamic = g_renderer.level_primitives[index].type != SDF_PRIMITIVE_BOX && 
+            _mm_movemask_ps(renderer_span_inside(i_world_uv, g_renderer.level_bounds[index])) != 0 ? TRUE : FALSE;
+    }
+    u32 walls_max = 0;
+    for (u32 lane = 0; lane < RENDERER_SPAN_WIDTH; ++lane)
+    {
+        walls_max = math_max(walls_max, (u32)layer->walls_count[i_pixel + lane]);
+    }
+
+    if (!is_dynamic && walls_max <= RENDERER_LAYER_WALLS)
+    {
+        layer->spans_layer.fetch_add(1, std::memory_order_relaxed);
+        return renderer_span_layer_walls(i_world_uv, i_pixel);
+    }
+    if (walls_max == 0)
+    {
+        layer->spans_dynamic.fetch_add(1, std::memory_order_relaxed);
+        return renderer_span_get_distance(g_renderer.level_primitives, g_renderer.level_bounds, &g_level_bins, i_tile, i_world_uv, i_growth_weights, time, SDF_PRIMITIVE_BOX);
+    }
+    layer->spans_full.fetch_add(1, std::memory_order_relaxed);
+    return renderer_span_get_distance(g_renderer.level_primitives, g_renderer.level_bounds, &g_level_bins, i_tile, i_world_uv, i_growth_weights, time, SDF_PRIMITIVE_INVALID);
+}
+
+/* renderer_shade for the RENDERER_SPAN_WIDTH pixels starting at i_x, i_y. */
+void renderer_span_shade(u32 i_x, u32 i_y, u32 i_tile, fvec3 i_growth_weights, u32* o_pixels)
+{
+    player_data const* player = &g_renderer.player;
+    renderer_span_uv uv;
+    uv.x = _mm_add_ps(_mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32((i32)i_x), _mm_setr_epi32(0, 1, 2, 3))), _mm_set1_ps(0.5f));
+    uv.y = _mm_set1_ps((f32)i_y + 0.5f);
+    renderer_span_uv world_uv = { _mm_add_ps(uv.x, _mm_set1_ps(g_renderer.camera.x)), _mm_add_ps(uv.y, _mm_set1_ps(g_renderer.camera.y)) };
+    __m128 one = _mm_set1_ps(1.0f);
+    u32 pixel = i_y * RENDERER_WIDTH + i_x;
+    renderer_layer const* layer = &g_renderer_layer;
+    if (layer->bake_background || layer->bake_walls)
+    {
+        renderer_span_layer_bake(uv, world_uv, i_tile, pixel, i_growth_weights);
+    }
+
+    __m128 color[3];
+    if (layer->is_enabled)
+    {
+        for (u32 channel = 0; channel < 3; ++channel)
+        {
+            color[channel] = _mm_loadu_ps(&layer->background[channel][pixel]);
+        }
+    }
+    else
+    {
+        renderer_span_background(uv, color);
+    }
+
+    renderer_span_color_distance level = renderer_span_level(world_uv, i_tile, pixel, i_growth_weights);
+    __m128 weight = renderer_span_saturate(_mm_sub_ps(one, level.distance));
+    for (u32 channel = 0; channel < 3; ++channel)
+    {
+        color[channel] = renderer_span_lerp(color[channel], level.color[channel + 1], weight);
+    }
+
+    renderer_span_color_distance overlay = renderer_span_get_distance(g_renderer.overlay_primitives, g_renderer.overlay_bounds, &g_overlay_bins, i_tile, world_uv, i_growth_weights, player->time, SDF_PRIMITIVE_INVALID);
+    weight = _mm_mul_ps(renderer_span_saturate(_mm_sub_ps(one, overlay.distance)), overlay.color[0]);
+    for (u32 channel = 0; channel < 3; ++channel)
+    {
+        color[channel] = renderer_span_lerp(color[channel], overlay.color[channel + 1], weight);
+    }
+
+    /* The body and face blend with a weight of 0 outside their bounds. */
+    if (_mm_movemask_ps(renderer_span_inside(world_uv, g_renderer.player_bounds)) != 0)
+    {
+        __m128 body = renderer_span_step(renderer_span_player(world_uv, player->position, player->scale, player->time), _mm_setzero_ps());
+        for (u32 channel = 0; channel < 3; ++channel)
+        {
+            color[channel] = renderer_span_lerp(color[channel], _mm_setzero_ps(), body);
+        }
+    }
+    f32 state = (f32)player->growth_state;
+    fvec2 face_size = { player->scale * (192.0f / 3.0f) * (1.0f + state * 0.1f), player->scale * (64.0f / 3.0f) * (1.0f + state * 0.1f) };
+    fvec4 face_bounds = { player->position.x - face_size.x - 1.0f, player->position.y - face_size.y - 1.0f, player->position.x + face_size.x + 1.0f, player->position.y + face_size.y + 1.0f };
+    if (_mm_movemask_ps(renderer_span_inside(world_uv, face_bounds)) != 0)
+    {
+        renderer_span_color_distance face = renderer_span_box_textured(world_uv, player->position, face_size, sdf_vec2(4.0f, state), sdf_vec2(192.0f, 64.0f));
+        weight = _mm_mul_ps(renderer_span_step(face.distance, _mm_setzero_ps()), face.color[0]);
+        for (u32 channel = 0; channel < 3; ++channel)
+        {
+            color[channel] = renderer_span_lerp(color[channel], face.color[channel + 1], weight);
+        }
+    }
+
+    renderer_span_color_distance hud = renderer_span_player_hud(uv);
+    weight = _mm_mul_ps(renderer_span_step(hud.distance, _mm_setzero_ps()), hud.color[0]);
+    for (u32 channel = 0; channel < 3; ++channel)
+    {
+        color[channel] = renderer_span_lerp(color[channel], hud.color[channel + 1], weight);
+    }
+
+    renderer_span_uv noise_uv = { _mm_sub_ps(uv.x, _mm_set1_ps(player->time)), uv.y };
+    __m128 noise = renderer_span_noise(noise_uv, &g_renderer.noise_time);
+    __m128 dust = renderer_span_dust_particles(uv, player->time, &g_renderer.noise_time);
+    __m128i pixels = _mm_set1_epi32((i32)0xFF000000);
+    for (u32 channel = 0; channel < 3; ++channel)
+    {
+        color[channel] = renderer_span_lerp(color[channel], _mm_mul_ps(color[channel], noise), _mm_set1_ps(0.5f));
+        color[channel] = renderer_span_lerp(color[channel], _mm_mul_ps(color[channel], _mm_set1_ps(0.5f)), dust);
+        color[channel] = renderer_span_lerp(color[channel], _mm_setzero_ps(), _mm_set1_ps(player->screen_fade));
+
+        /* UNORM conversion of the render target. */
+        __m128i value = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(renderer_span_saturate(color[channel]), _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+        pixels = _mm_or_si128(pixels, _mm_sll_epi32(value, _mm_cvtsi32_si128((i32)(channel * 8))));
+    }
+    _mm_storeu_si128((__m128i*)o_pixels, pixels);
+}
+#endif
+
+void renderer_shade_tile(u32 i_tile)
+{
+    u32 x_begin = (i_tile % RENDERER_TILES_X) * RENDERER_TILE_SIZE;
+    u32 y_begin = (i_tile / RENDERER_TILES_X) * RENDERER_TILE_SIZE;
+    u32 x_end = math_min(x_begin + RENDERER_TILE_SIZE, (u32)RENDERER_WIDTH);
+    u32 y_end = math_min(y_begin + RENDERER_TILE_SIZE, (u32)RENDERER_HEIGHT);
+    fvec3 growth_weights = growth_factor_to_weights(g_renderer.player.growth_factor);
+    for (u32 y = y_begin; y < y_end; ++y)
+    {
+        u32 x = x_begin;
+        #if SDF_PACK_SSE2
+        for (; g_renderer.use_spans && x + RENDERER_SPAN_WIDTH <= x_end; x += RENDERER_SPAN_WIDTH)
+        {
+            renderer_span_shade(x, y, i_tile, growth_weights, &g_renderer.framebuffer[y * RENDERER_WIDTH + x]);
+        }
+        #endif
+        for (; x < x_end; ++x)
+        {
+            g_renderer.framebuffer[y * RENDERER_WIDTH + x] = renderer_shade(sdf_vec2((f32)x + 0.5f, (f32)y + 0.5f), i_tile, growth_weights);
+        }
+    }
+}
+
+/* Unpacks every slot up to i_count, free slots included so the bins index the unpacked primitives the same way. */
+u32 renderer_unpack_list(sdf_primitive_packed const* i_packed, u32 i_count, fvec2 i_origin, sdf_primitive* o_primitives)
+{
+    for (u32 i = 0; i < i_count; ++i)
+    {
+        sdf_primitive_unpack(&i_packed[i], i_origin, &o_primitives[i]);
+    }
+    return i_count;
+}
+
+void renderer_bound_list(sdf_primitive const* i_primitives, u32 i_count, fvec3 i_growth_weights, fvec4* o_bounds)
+{
+    for (u32 i = 0; i < i_count; ++i)
+    {
+        if (!sdf_primitive_pixel_bounds(&i_primitives[i], i_growth_weights, &o_bounds[i]))
+        {
+            o_bounds[i] = { 1.0f, 1.0f, 0.0f, 0.0f };
+        }
+    }
+}
+
+/* Damage tracking between frames, only tiles something changed in are shaded again and the rest of the framebuffer
+ * is kept. A primitive that differs from the one at the same index in the previous list damages both its previous and
+ * its current bounds, a pixel outside of all of those sees the same shapes in the same order. The player damages its
+ * bounds when it moves or changes and the HUD its icons when the counters change. The camera, growth, screen fade
+ * and time reach every pixel, through the screen noise and the dust, and damage the whole frame. Time is the one that
+ * changes every frame, so it can be held for animation_interval frames to only refresh everything at a lower rate. */
+#define RENDERER_DAMAGE_HUD_WIDTH 104.0f /* Around the death and maggot counters of renderer_player_hud. */
+#define RENDERER_DAMAGE_HUD_HEIGHT 68.0f
+
+typedef struct {
+    b8 is_enabled;
+    u32 animation_interval; /* Frames time is held for, 1 animates every frame. */
+
+    /* The frame the framebuffer holds. */
+    b8 is_valid;
+    u32 animation_frames;
+    sdf_primitive level_primitives[SDF_PRIMITIVES_COUNT_MAX];
+    sdf_primitive overlay_primitives[SDF_PRIMITIVES_COUNT_MAX];
+    fvec4 level_bounds[SDF_PRIMITIVES_COUNT_MAX];
+    fvec4 overlay_bounds[SDF_PRIMITIVES_COUNT_MAX];
+    u32 level_primitives_count;
+    u32 overlay_primitives_count;
+    player_data player;
+    fvec4 player_bounds;
+    fvec2 camera;
+
+    b8 tiles[RENDERER_TILES_COUNT];
+    u32 tiles_shaded;
+    u32 frames;
+} renderer_damage;
+renderer_damage g_renderer_damage;
+
+/* Holds the time of the frame, in the renderer constants only, while the animation waits for its refresh. */
+void renderer_damage_animate()
+{
+    renderer_damage* damage = &g_renderer_damage;
+    if (damage->is_enabled && damage->is_valid && damage->animation_frames + 1 < math_max(damage->animation_interval, 1u))
+    {
+        g_renderer.player.time = damage->player.time;
+        damage->animation_frames += 1;
+    }
+    else
+    {
+        damage->animation_frames = 0;
+    }
+}
+
+/* Damages the tiles i_bounds overlaps, i_bounds in world pixels like sdf_primitive_pixel_bounds. */
+void renderer_damage_bounds(fvec4 i_bounds, fvec2 i_camera)
+{
+    if (i_bounds.x > i_bounds.z || i_bounds.y > i_bounds.w)
+    {
+        return;
+    }
+
+    f32 tile_size = (f32)RENDERER_TILE_SIZE;
+    i32 x_begin = (i32)math_clamp(f32_floor((i_bounds.x - i_camera.x) / tile_size), 0.0f, (f32)(RENDERER_TILES_X - 1));
+    i32 x_end = (i32)math_clamp(f32_floor((i_bounds.z - i_camera.x) / tile_size), -1.0f, (f32)(RENDERER_TILES_X - 1));
+    i32 y_begin = (i32)math_clamp(f32_floor((i_bounds.y - i_camera.y) / tile_size), 0.0f, (f32)(RENDERER_TILES_Y - 1));
+    i32 y_end = (i32)math_clamp(f32_floor((i_bounds.w - i_camera.y) / tile_size), -1.0f, (f32)(RENDERER_TILES_Y - 1));
+    for (i32 y = y_begin; y <= y_end; ++y)
+    {
+        for (i32 x = x_begin; x <= x_end; ++x)
+        {
+            g_renderer_damage.tiles[y * RENDERER_TILES_X + x] = TRUE;
+        }
+    }
+}
+
+/* Damages the bounds of every primitive that differs between the lists, particles are always damaged since their
+ * positions are not part of the primitive. */
+void renderer_damage_list(sdf_primitive const* i_prev, fvec4 const* i_prev_bounds, u32 i_prev_count, 
+                          sdf_primitive const* i_primitives, fvec4 const* i_bounds, u32 i_count, fvec2 i_camera)
+{
+    for (u32 i = 0; i < math_max(i_prev_count, i_count); ++i)
+    {
+        b8 is_prev = i < i_prev_count ? TRUE : FALSE;
+        b8 is_current = i < i_count ? TRUE : FALSE;
+        b8 is_changed = !is_prev || !is_current || 
+            i_primitives[i].type == SDF_PRIMITIVE_PARTICLES || i_prev[i].type == SDF_PRIMITIVE_PARTICLES ||
+            memcmp(&i_prev[i], &i_primitives[i], sizeof(sdf_primitive)) != 0 ? TRUE : FALSE;
+        if (is_changed && is_prev)
+        {
+            renderer_damage_bounds(i_prev_bounds[i], i_camera);
+        }
+        if (is_changed && is_current)
+        {
+            renderer_damage_bounds(i_bounds[i], i_camera);
+        }
+    }
+}
+
+/* Marks the tiles to shade this frame against the frame the framebuffer holds, then takes this frame as that one. */
+void renderer_damage_update()
+{
+    renderer_damage* damage = &g_renderer_damage;
+    player_data const* prev = &damage->player;
+    player_data const* player = &g_renderer.player;
+    b8 is_all = !damage->is_enabled || !damage->is_valid || 
+        damage->camera.x != g_renderer.camera.x || damage->camera.y != g_renderer.camera.y ||
+        prev->time != player->time || prev->growth_factor != player->growth_factor || prev->screen_fade != player->screen_fade ? TRUE : FALSE;
+    #if SDF_PACK_SSE2
+    /* The layer is baked by the tiles that are shaded, a rebake has to reach all of them. */
+    is_all = is_all || g_renderer_layer.bake_background || g_renderer_layer.bake_walls ? TRUE : FALSE;
+    #endif
+
+    if (is_all)
+    {
+        for (u32 tile = 0; tile < RENDERER_TILES_COUNT; ++tile)
+        {
+            damage->tiles[tile] = TRUE;
+        }
+    }
+    else
+    {
+        memzero(damage->tiles, sizeof(damage->tiles));
+        fvec2 camera = g_renderer.camera;
+        renderer_damage_list(damage->level_primitives, damage->level_bounds, damage->level_primitives_count, 
+            g_renderer.level_primitives, g_renderer.level_bounds, g_renderer.level_primitives_count, camera);
+        renderer_damage_list(damage->overlay_primitives, damage->overlay_bounds, damage->overlay_primitives_count, 
+            g_renderer.overlay_primitives, g_renderer.overlay_bounds, g_renderer.overlay_primitives_count, camera);
+
+        if (prev->position.x != player->position.x || prev->position.y != player->position.y || 
+            prev->scale != player->scale || prev->growth_state != player->growth_state)
+        {
+            renderer_damage_bounds(damage->player_bounds, camera);
+            renderer_damage_bounds(g_renderer.player_bounds, camera);
+        }
+        if (prev->deaths != player->deaths || prev->maggots != player->maggots)
+        {
+            renderer_damage_bounds({ camera.x, camera.y, camera.x + RENDERER_DAMAGE_HUD_WIDTH, camera.y + RENDERER_DAMAGE_HUD_HEIGHT }, camera);
+        }
+    }
+
+    damage->is_valid = TRUE;
+    memcpy(damage->level_primitives, g_renderer.level_primitives, g_renderer.level_primitives_count * sizeof(sdf_primitive));
+    memcpy(damage->overlay_primitives, g_renderer.overlay_primitives, g_renderer.overlay_primitives_count * sizeof(sdf_primitive));
+    memcpy(damage->level_bounds, g_renderer.level_bounds, g_renderer.level_primitives_count * sizeof(fvec4));
+    memcpy(damage->overlay_bounds, g_renderer.overlay_bounds, g_renderer.overlay_primitives_count * sizeof(fvec4));
+    damage->level_primitives_count = g_renderer.level_primitives_count;
+    damage->overlay_primitives_count = g_renderer.overlay_primitives_count;
+    damage->player = g_renderer.player;
+    damage->player_bounds = g_renderer.player_bounds;
+    damage->camera = g_renderer.camera;
+
+    for (u32 tile = 0; tile < RENDERER_TILES_COUNT; ++tile)
+    {
+        damage->tiles_shaded += damage->tiles[tile] ? 1 : 0;
+    }
+    damage->frames += 1;
+}
+
+/* Takes the constants, primitive lists and bins the GPU would get this frame and shades every damaged tile. */
+void renderer_render()
+{
+    g_renderer.player = g_player;
+    g_renderer.camera = g_world.camera;
+    renderer_damage_animate();
+    hud_image_update(g_renderer.spritesheet.texels, g_renderer.spritesheet.width, g_renderer.spritesheet.height);
+    fvec2 origin = world_primitives_origin();
+    g_renderer.level_primitives_count = renderer_unpack_list(g_level_primitives, g_level_slots.end, origin, g_renderer.level_primitives);
+    g_renderer.overlay_primitives_count = renderer_unpack_list(g_overlay_primitives, g_overlay_slots.end, origin, g_renderer.overlay_primitives);
+
+    fvec3 growth_weights = growth_factor_to_weights(g_player.growth_factor);
+    renderer_bound_list(g_renderer.level_primitives, g_renderer.level_primitives_count, growth_weights, g_renderer.level_bounds);
+    renderer_bound_list(g_renderer.overlay_primitives, g_renderer.overlay_primitives_count, growth_weights, g_renderer.overlay_bounds);
+    /* Measured reach of sdf_player is 40 at scale 0.5 and 170 at scale 2, this stays above it. */
+    f32 reach = (1.0f + 0.625f * g_player.scale) * (30.0f + 35.0f * g_player.scale) + 1.0f;
+    g_renderer.player_bounds = { g_player.position.x - reach, g_player.position.y - reach, g_player.position.x + reach, g_player.position.y + reach };
+    g_renderer.noise_time = noise_weights(g_renderer.player.time);
+    g_renderer.noise_zero = noise_weights(0.0f);
+    g_renderer.noise_tenth = noise_weights(g_renderer.player.time * 0.1f);
+    #if SDF_PACK_SSE2
+    renderer_layer_update();
+    #endif
+    renderer_damage_update();
+
+    g_renderer.next_tile = 0;
+    std::vector<std::thread> threads;
+    for (u32 t = 0; t < g_renderer.threads_count; ++t)
+    {
+        threads.emplace_back([]() {
+            for (u32 tile = g_renderer.next_tile++; tile < RENDERER_TILES_COUNT; tile = g_renderer.next_tile++)
+            {
+                if (g_renderer_damage.tiles[tile])
+                {
+                    renderer_shade_tile(tile);
+                }
+            }
+        });
+    }
+    for (u32 t = 0; t < g_renderer.threads_count; ++t)
+    {
+        threads[t].join();
+    }
+}
+
+b8 renderer_write_ppm(char const* i_path)
+{
+    FILE* file = fopen(i_path, "wb");
+    if (file == NULL)
+    {
+        printf("Could not open %s\n", i_path);
+        return FALSE;
+    }
+
+    fprintf(file, "P6\n%d %d\n255\n", RENDERER_WIDTH, RENDERER_HEIGHT);
+    for (u32 i = 0; i < RENDERER_WIDTH * RENDERER_HEIGHT; ++i)
+    {
+        u32 pixel = g_renderer.framebuffer[i];
+        u8 rgb[3] = { (u8)(pixel & 0xFF), (u8)((pixel >> 8) & 0xFF), (u8)((pixel >> 16) & 0xFF) };
+        fwrite(rgb, 1, 3, file);
+    }
+    fclose(file);
+    return TRUE;
+}
+
+#if SDF_PACK_SSE2
+/* Average render time of i_frames frames after a warm up frame, i_growth_step is added to the growth factor every frame. */
+f64 renderer_time_layer(u32 i_frames, b8 i_use_layer, f32 i_growth_step)
+{
+    f32 delta_time = 1.0f / 60.0f;
+    f64 time_render = 0.0;
+    g_renderer_layer.is_enabled = i_use_layer;
+    for (u32 frame = 0; frame <= i_frames; ++frame)
+    {
+        if (i_growth_step != 0.0f)
+        {
+            g_player.growth_factor += g_player.growth_factor + i_growth_step <= 1.0f ? i_growth_step : -i_growth_step;
+        }
+        sdf_bins_build(g_world.camera, g_player.growth_factor);
+        g_player.time += delta_time;
+        if (frame == 1)
+        {
+            g_renderer_layer.spans_layer = 0;
+            g_renderer_layer.spans_dynamic = 0;
+            g_renderer_layer.spans_full = 0;
+            g_renderer_layer.bakes = 0;
+        }
+
+        f64 start = profile_time_ms();
+        renderer_render();
+        time_render += frame > 0 ? profile_time_ms() - start : 0.0;
+    }
+    return time_render / i_frames;
+}
+#endif
+
+/* Evaluates the HUD for every pixel of a frame the way the shader does, with the icons of player_hud and with
+ * them retained in g_hud_image, and reports the time of both, of a bake and the pixels they blend differently. */
+void renderer_report_hud()
+{
+    std::vector<fvec4> blends[2];
+    f64 times[2];
+    for (u32 i = 0; i < 2; ++i)
+    {
+        blends[i].resize(RENDERER_WIDTH * RENDERER_HEIGHT);
+        f64 start = profile_time_ms();
+        for (u32 y = 0; y < RENDERER_HEIGHT; ++y)
+        {
+            for (u32 x = 0; x < RENDERER_WIDTH; ++x)
+            {
+                fvec2 uv = { (f32)x + 0.5f, (f32)y + 0.5f };
+                renderer_color_distance hud = i == 0 ? renderer_player_hud(uv) : renderer_player_hud_retained(uv);
+                blends[i][y * RENDERER_WIDTH + x] = { renderer_step(hud.distance, 0.0f) * hud.color.x, hud.color.y, hud.color.z, hud.color.w };
+            }
+        }
+        times[i] = profile_time_ms() - start;
+    }
+
+    g_hud_image.is_baked = FALSE;
+    f64 start = profile_time_ms();
+    hud_image_update(g_renderer.spritesheet.texels, g_renderer.spritesheet.width, g_renderer.spritesheet.height);
+    f64 time_bake = profile_time_ms() - start;
+
+    u32 differences = 0;
+    for (u32 i = 0; i < RENDERER_WIDTH * RENDERER_HEIGHT; ++i)
+    {
+        differences += memcmp(&blends[0][i], &blends[1][i], sizeof(fvec4)) != 0 && blends[0][i].x + blends[1][i].x > 0.0f ? 1 : 0;
+    }
+    printf("    hud: every pixel %.3fms, retained %.3fms, %.3fms saved a frame, a bake %.3fms, %u pixels blend differently\n", 
+        times[0], times[1], times[0] - times[1], time_bake, differences);
+}
+
+/* Average render time of i_frames frames of gameplay with damage tracking, after a warm up frame that shades
+ * everything. The player walks back and forth over the level without colliding while the entities carry on. Returns
+ * through o_differences the channels that differ from a frame shaded in full, checked on a frame that kept tiles. */
+f64 renderer_time_damage(u32 i_frames, u32 i_animation_interval, u32* o_differences)
+{
+    renderer_damage* damage = &g_renderer_damage;
+    f32 delta_time = 1.0f / 60.0f;
+    f32 walk_speed = 200.0f;
+    f32 walk_length = (f32)LEVEL_WIDTH - 400.0f;
+    fvec2 start_position = g_player.position;
+    f64 time_render = 0.0;
+    u32 tiles_shaded = 0;
+    damage->is_enabled = TRUE;
+    damage->is_valid = FALSE;
+    damage->animation_interval = i_animation_interval;
+    for (u32 frame = 0; frame <= i_frames || (i_animation_interval > 1 && damage->animation_frames == 0); ++frame)
+    {
+        f32 walked = sdf_mod((f32)frame * delta_time * walk_speed, 2.0f * walk_length);
+        g_player.position.x = 200.0f + (walked < walk_length ? walked : 2.0f * walk_length - walked);
+        world_update_camera(g_player.position);
+        entities_to_primitives(delta_time, ENTITIES_COUNT_MAX);
+        world_cull_primitives();
+        sdf_bins_build(g_world.camera, g_player.growth_factor);
+        g_player.time += delta_time;
+        if (frame == 1)
+        {
+            damage->tiles_shaded = 0;
+            damage->frames = 0;
+        }
+
+        f64 start = profile_time_ms();
+        renderer_render();
+        time_render += frame > 0 && frame <= i_frames ? profile_time_ms() - start : 0.0;
+        tiles_shaded = frame == i_frames ? damage->tiles_shaded : tiles_shaded;
+    }
+    damage->tiles_shaded = tiles_shaded;
+    damage->frames = i_frames;
+
+    /* The last frame again in full at the time it was held at. */
+    std::vector<u32> kept(g_renderer.framebuffer, g_renderer.framebuffer + RENDERER_WIDTH * RENDERER_HEIGHT);
+    f32 time = g_player.time;
+    g_player.time = damage->player.time;
+    damage->is_enabled = FALSE;
+    renderer_render();
+    g_player.time = time;
+    g_player.position = start_position;
+
+    *o_differences = 0;
+    for (u32 i = 0; i < RENDERER_WIDTH * RENDERER_HEIGHT; ++i)
+    {
+        for (u32 shift = 0; shift < 24; shift += 8)
+        {
+            *o_differences += ((kept[i] >> shift) & 0xFF) != ((g_renderer.framebuffer[i] >> shift) & 0xFF) ? 1 : 0;
+        }
+    }
+    return time_render / i_frames;
+}
+
+int main(int argc, char** argv)
+{
+    u32 level = argc > 1 ? (u32)atoi(argv[1]) % 8 : 1;
+    u32 frames = argc > 2 ? math_max((u32)atoi(argv[2]), 1u) : 3;
+    char const* output = argc > 3 ? argv[3] : "renderer.ppm";
+
+    #if RENDERER_HAS_TEXTURES
+    g_renderer.background = { g_texture_background, TEXTURE_BACKGROUND_WIDTH, TEXTURE_BACKGROUND_HEIGHT };
+    g_renderer.spritesheet = { g_texture_spritesheet, TEXTURE_SPRITESHEET_WIDTH, TEXTURE_SPRITESHEET_HEIGHT };
+    #else
+    g_renderer.background = { g_renderer_background_fallback, 1, 1 };
+    g_renderer.spritesheet = { g_renderer_spritesheet_fallback, 1, 1 };
+    printf("Texture headers not found, rendering with a flat background and no sprites.\n");
+    #endif
+    g_renderer.threads_count = math_max((u32)std::thread::hardware_concurrency(), 1u);
+    g_renderer.use_spans = SDF_PACK_SSE2 ? TRUE : FALSE;
+    #if SDF_PACK_SSE2
+    g_renderer_layer.is_enabled = TRUE;
+    #endif
+    noise_atlas_bake();
+
+    /* The game fades levels in, skip straight to the faded in frame. */
+    level_load(level);
+    g_player.screen_fade = 0.0f;
+
+    f32 delta_time = 1.0f / 60.0f;
+    f64 time_simulate = 0.0;
+    f64 time_bins = 0.0;
+    f64 time_render = 0.0;
+    f64 time_render_max = 0.0;
+    for (u32 frame = 0; frame < frames; ++frame)
+    {
+        f64 start = profile_time_ms();
+        world_update_camera(g_player.position);
+        entities_to_primitives(delta_time, ENTITIES_COUNT_MAX);
+        world_cull_primitives();
+        f64 culled = profile_time_ms();
+        sdf_bins_build(g_world.camera, g_player.growth_factor);
+        g_player.time += delta_time;
+        f64 simulated = profile_time_ms();
+        renderer_render();
+        f64 rendered = profile_time_ms();
+
+        time_simulate += culled - start;
+        time_bins += simulated - culled;
+        time_render += rendered - simulated;
+        time_render_max = math_max(time_render_max, rendered - simulated);
+    }
+
+    printf("Level %u at %dx%d, %u frames over %u threads in %dx%d tiles\n", level, RENDERER_WIDTH, RENDERER_HEIGHT, frames, g_renderer.threads_count, RENDERER_TILE_SIZE, RENDERER_TILE_SIZE);
+    printf("    primitives: %u level, %u overlay, %u particles, per tile %.2f level and %.2f overlay\n", 
+        g_renderer.level_primitives_count, g_renderer.overlay_primitives_count, particles_packed_count(),
+        (f64)g_level_bins.offsets[SDF_BIN_TILES_COUNT] / (f64)SDF_BIN_TILES_COUNT, (f64)g_overlay_bins.offsets[SDF_BIN_TILES_COUNT] / (f64)SDF_BIN_TILES_COUNT);
+    printf("    per frame: render %.3fms, worst %.3fms, simulation %.3fms, binning %.3fms\n", time_render / frames, time_render_max, time_simulate / frames, time_bins / frames);
+
+    #if SDF_PACK_SSE2
+    /* Renders the last frame again a pixel at a time, the spans should match it exactly. */
+    std::vector<u32> spans(g_renderer.framebuffer, g_renderer.framebuffer + RENDERER_WIDTH * RENDERER_HEIGHT);
+    g_renderer.use_spans = FALSE;
+    f64 start = profile_time_ms();
+    renderer_render();
+    f64 time_scalar = profile_time_ms() - start;
+
+    u32 differences = 0;
+    u32 difference_max = 0;
+    for (u32 i = 0; i < RENDERER_WIDTH * RENDERER_HEIGHT; ++i)
+    {
+        for (u32 shift = 0; shift < 24; shift += 8)
+        {
+            i32 difference = (i32)((spans[i] >> shift) & 0xFF) - (i32)((g_renderer.framebuffer[i] >> shift) & 0xFF);
+            difference = difference < 0 ? -difference : difference;
+            differences += difference != 0 ? 1 : 0;
+            difference_max = math_max(difference_max, (u32)difference);
+        }
+    }
+    printf("    per pixel: render %.3fms, spans of %d are %.2fx faster, %u channels differ by at most %u\n", 
+        time_scalar, RENDERER_SPAN_WIDTH, time_scalar / (time_render / frames), differences, difference_max);
+
+    /* The level shaded in full against the layer, with the player idle and mid growth where the walls rebake every frame. */
+    g_renderer.use_spans = TRUE;
+    f64 pixels = (f64)(RENDERER_WIDTH * RENDERER_HEIGHT);
+    f32 growth_factor = g_player.growth_factor;
+    f64 time_full = renderer_time_layer(frames, FALSE, 0.0f);
+    f64 time_idle = renderer_time_layer(frames, TRUE, 0.0f);
+    u32 spans_layer = g_renderer_layer.spans_layer;
+    u32 spans_dynamic = g_renderer_layer.spans_dynamic;
+    u32 spans_full = g_renderer_layer.spans_full;
+    u32 bakes_idle = g_renderer_layer.bakes;
+    f64 time_growing = renderer_time_layer(frames, TRUE, 0.01f);
+    g_player.growth_factor = growth_factor;
+    f64 spans_count = (f64)math_max(spans_layer + spans_dynamic + spans_full, 1u);
+    printf("    layer: no layer %.3fms (%.1fns a pixel), idle %.3fms (%.1fns a pixel, %u bakes), growing %.3fms (%.1fns a pixel, %u bakes)\n", 
+        time_full, time_full * 1e6 / pixels, time_idle, time_idle * 1e6 / pixels, bakes_idle, 
+        time_growing, time_growing * 1e6 / pixels, g_renderer_layer.bakes);
+    printf("    layer spans: %.1f%% walls from the layer, %.1f%% dynamic shapes without walls, %.1f%% in full\n", 
+        100.0 * spans_layer / spans_count, 100.0 * spans_dynamic / spans_count, 100.0 * spans_full / spans_count);
+    #endif
+    renderer_report_hud();
+
+    /* Tiles shaded per frame of gameplay, with time animating every frame and at lower rates. */
+    for (u32 interval = 1; interval <= 8; interval *= 2)
+    {
+        u32 differences = 0;
+        f64 time_damage = renderer_time_damage(frames, interval, &differences);
+        printf("    damage, animating every %u frames: render %.3fms, %.1f%% of tiles shaded, %u channels differ from a full frame\n", 
+            interval, time_damage, 
+            100.0 * g_renderer_damage.tiles_shaded / math_max(g_renderer_damage.frames * RENDERER_TILES_COUNT, 1u), differences);
+    }
+    #if SDF_PACK_SSE2
+    memcpy(g_renderer.framebuffer, spans.data(), sizeof(g_renderer.framebuffer));
+    #endif
+    return renderer_write_ppm(output) ? 0 : 1;
+}
@@ -0,0 +1,500 @@
+/* Packs the sprites the game draws into a tight atlas with a table of UV rectangles.
+ *
+ * sdf_box_textured finds a sprite in the spritesheet from its size and an index in units of that size, so the sheet
+ * is laid out in cells of 384x128, 512x162, 192x64, 128x128 and 64x64 with rows at fractions like 5.25 and 8.05 where
+ * the text did not fit, and most of it is empty. This cuts every sprite the game addresses out of the sheet, trims
+ * it to its texels with weight plus a margin of one texel, packs them with a skyline packer that places every sprite
+ * where its top ends lowest, and tries every atlas width for the smallest area.
+ *
+ * It writes the atlas as a texture header like the other assets and a header with an id per sprite, the UV rectangle
+ * of the sprite in the atlas and the part of its box the trimmed rectangle covers. Every texel of every sprite is
+ * looked up through that table again and compared to the sheet, then the memory of the atlas is reported against
+ * the sheet. The fractional rows start on the texel below their fraction, half a texel off for 5.25.
+ *
+ * usage: sprite_atlas [output directory]
+ * Writes sprite_atlas_texture.h and sprite_atlas.h to the output directory, output by default, and creates it when it
+ * is missing. */
+
+#define _CRT_SECURE_NO_WARNINGS 1
+#include <algorithm>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+    #include <direct.h>
+    #define atlas_make_directory(i_path) _mkdir(i_path)
+#else
+    #include <sys/stat.h>
+    #define atlas_make_directory(i_path) mkdir(i_path, 0755)
+#endif
+
+#define DEBUG 0
+#include "core.h"
+#include "tools/png_reader.h"
+
+f64 profile_time_ms()
+{
+    return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#define ATLAS_MARGIN 1
+#define ATLAS_WIDTH_MAX 2048
+#define ATLAS_ALIGNMENT 4 /* Dimensions stay a multiple of a compressed block. */
+
+/* Sprites as the game addresses them, count sprites down the column from the index. */
+typedef struct {
+    char const* name;
+    f32 size[2];
+    f32 index[2];
+    u32 count;
+} atlas_source;
+
+static atlas_source const g_atlas_sources[] = {
+    { "FACE_0",      { 384.0f, 128.0f }, {  0.0f, 0.0f  }, 10 }, /* Tumors and t-cells, sprite_index in levels.h. */
+    { "FACE_1",      { 384.0f, 128.0f }, {  1.0f, 0.0f  }, 10 },
+    { "MOTHER",      { 384.0f, 128.0f }, {  2.0f, 2.0f  }, 2 },  /* Mouth closed and open. */
+    { "PLAYER",      { 192.0f, 64.0f  }, {  4.0f, 0.0f  }, 3 },  /* Per growth state. */
+    { "FLOWER",      { 128.0f, 128.0f }, {  8.0f, 1.0f  }, 1 },
+    { "DIGIT",       { 64.0f,  64.0f  }, { 18.0f, 0.0f  }, 10 },
+    { "HUD_MAGGOTS", { 64.0f,  64.0f  }, { 19.0f, 0.0f  }, 1 },
+    { "HUD_DEATHS",  { 64.0f,  64.0f  }, { 19.0f, 1.0f  }, 1 },
+    { "DIALOGUE_0",  { 512.0f, 162.0f }, {  1.5f, 4.0f  }, 1 },  /* The tutorial in the order dialogue_num shows them. */
+    { "DIALOGUE_1",  { 512.0f, 162.0f }, {  1.5f, 5.25f }, 1 },
+    { "DIALOGUE_2",  { 512.0f, 162.0f }, {  1.5f, 6.75f }, 1 },
+    { "DIALOGUE_3",  { 512.0f, 162.0f }, {  1.5f, 8.05f }, 1 },
+    { "CREDITS",     { 384.0f, 512.0f }, {  0.0f, 2.6f  }, 1 },
+};
+
+typedef struct {
+    char name[32];
+    u32 cell[4];   /* x, y, width and height in the sheet. */
+    u32 trim[4];   /* x, y, width and height in the cell, empty when no texel has weight. */
+    u32 atlas[2];  /* x and y of the trimmed rectangle in the atlas. */
+} atlas_sprite;
+
+/* The x and width of a stretch of the skyline at height y. */
+typedef struct {
+    u32 x;
+    u32 y;
+    u32 width;
+} skyline_node;
+
+/* Height the bottom of an i_width wide rectangle rests at when its left side is at node i_node, or -1 when it does
+ * not fit within i_atlas_width. */
+i64 skyline_fit(std::vector<skyline_node> const& i_skyline, u32 i_node, u32 i_width, u32 i_atlas_width)
+{
+    u32 x = i_skyline[i_node].x;
+    if (x + i_width > i_atlas_width)
+    {
+        return -1;
+    }
+    u32 y = 0;
+    for (u32 node = i_node; node < i_skyline.size() && i_skyline[node].x < x + i_width; ++node)
+    {
+        y = math_max(y, i_skyline[node].y);
+    }
+    return (i64)y;
+}
+
+/* Raises the skyline under a rectangle placed at i_x, i_y. */
+void skyline_add(std::vector<skyline_node>* io_skyline, u32 i_node, u32 i_x, u32 i_y, u32 i_width, u32 i_height)
+{
+    skyline_node node = { i_x, i_y + i_height, i_width };
+    io_skyline->insert(io_skyline->begin() + i_node, node);
+
+    /* Cut what the rectangle covers off the nodes to its right. */
+    for (u32 i = i_node + 1; i < io_skyline->size();)
+    {
+        skyline_node* next = &(*io_skyline)[i];
+        u32 right = i_x + i_width;
+        if (next->x >= right)
+        {
+            break;
+        }
+        u32 overlap = right - next->x;
+        if (overlap >= next->width)
+        {
+            io_skyline->erase(io_skyline->begin() + i);
+            continue;
+        }
+        next->x += overlap;
+        next->width -= overlap;
+        break;
+    }
+
+    for (u32 i = 0; i + 1 < io_skyline->size();)
+    {
+        if ((*io_skyline)[i].y == (*io_skyline)[i + 1].y)
+        {
+            (*io_skyline)[i].width += (*io_skyline)[i + 1].width;
+            io_skyline->erase(io_skyline->begin() + i + 1);
+            continue;
+        }
+        ++i;
+    }
+}
+
+/* Places the sprites in i_order into an atlas i_width wide, returns its height. */
+u32 atlas_pack(std::vector<atlas_sprite>* io_sprites, std::vector<u32> const& i_order, u32 i_width)
+{
+    std::vector<skyline_node> skyline;
+    skyline_node floor = { 0, 0, i_width };
+    skyline.push_back(floor);
+
+    u32 height = 0;
+    for (u32 i = 0; i < i_order.size(); ++i)
+    {
+        atlas_sprite* sprite = &(*io_sprites)[i_order[i]];
+        u32 width = sprite->trim[2];
+        u32 sprite_height = sprite->trim[3];
+        if (width == 0)
+        {
+            continue;
+        }
+
+        /* Lowest top first, then the narrowest stretch of skyline to waste the least next to it. */
+        u32 best_node = 0;
+        i64 best_y = -1;
+        u32 best_width = 0;
+        for (u32 node = 0; node < skyline.size(); ++node)
+        {
+            i64 y = skyline_fit(skyline, node, width, i_width);
+            if (y < 0)
+            {
+                continue;
+            }
+            if (best_y < 0 || y < best_y || (y == best_y && skyline[node].width < best_width))
+            {
+                best_node = node;
+                best_y = y;
+                best_width = skyline[node].width;
+            }
+        }
+        if (best_y < 0)
+        {
+            return 0xFFFFFFFF;
+        }
+
+        sprite->atlas[0] = skyline[best_node].x;
+        sprite->atlas[1] = (u32)best_y;
+        skyline_add(&skyline, best_node, sprite->atlas[0], sprite->atlas[1], width, sprite_height);
+        height = math_max(height, sprite->atlas[1] + sprite_height);
+    }
+    return height;
+}
+
+/* Cuts the sprites out of the sheet and trims them to the texels with weight, the weight is in the lowest byte. */
+void atlas_load_sprites(u32 const* i_sheet, u32 i_width, u32 i_height, std::vector<atlas_sprite>* o_sprites)
+{
+    for (u32 source = 0; source < sizeof(g_atlas_sources) / sizeof(g_atlas_sources[0]); ++source)
+    {
+        atlas_source const* current = &g_atlas_sources[source];
+        for (u32 i = 0; i < current->count; ++i)
+        {
+            atlas_sprite sprite;
+            memzero(&sprite, sizeof(sprite));
+            if (current->count > 1)
+            {
+                snprintf(sprite.name, sizeof(sprite.name), "%s_%u", current->name, i);
+            }
+            else
+            {
+                snprintf(sprite.name, sizeof(sprite.name), "%s", current->name);
+            }
+            sprite.cell[0] = (u32)(current->index[0] * current->size[0]);
+            sprite.cell[1] = (u32)((current->index[1] + (f32)i) * current->size[1]);
+            sprite.cell[2] = math_min((u32)current->size[0], i_width - sprite.cell[0]);
+            sprite.cell[3] = math_min((u32)current->size[1], i_height - sprite.cell[1]);
+
+            u32 min_x = sprite.cell[2];
+            u32 min_y = sprite.cell[3];
+            u32 max_x = 0;
+            u32 max_y = 0;
+            for (u32 y = 0; y < sprite.cell[3]; ++y)
+            {
+                for (u32 x = 0; x < sprite.cell[2]; ++x)
+                {
+                    if ((i_sheet[(sprite.cell[1] + y) * i_width + sprite.cell[0] + x] & 0xFF) != 0)
+                    {
+                        min_x = math_min(min_x, x);
+                        min_y = math_min(min_y, y);
+                        max_x = math_max(max_x, x + 1);
+                        max_y = math_max(max_y, y + 1);
+                    }
+                }
+            }
+
+            /* Keep a margin of the sheet around the texels with weight so bilinear samples at the edge match. */
+            if (max_x > min_x)
+            {
+                sprite.trim[0] = min_x >= ATLAS_MARGIN ? min_x - ATLAS_MARGIN : 0;
+                sprite.trim[1] = min_y >= ATLAS_MARGIN ? min_y - ATLAS_MARGIN : 0;
+                sprite.trim[2] = math_min(max_x + ATLAS_MARGIN, sprite.cell[2]) - sprite.trim[0];
+                sprite.trim[3] = math_min(max_y + ATLAS_MARGIN, sprite.cell[3]) - sprite.trim[1];
+            }
+            o_sprites->push_back(sprite);
+        }
+    }
+}
+
+/* The UV rectangle of the sprite in the atlas and the part of its box it covers, in the order sprite_atlas.h
+ * stores them. */
+void atlas_sprite_rect(atlas_sprite const* i_sprite, u32 i_width, u32 i_height, f32* o_rect)
+{
+    o_rect[0] = (f32)i_sprite->atlas[0] / (f32)i_width;
+    o_rect[1] = (f32)i_sprite->atlas[1] / (f32)i_height;
+    o_rect[2] = (f32)(i_sprite->atlas[0] + i_sprite->trim[2]) / (f32)i_width;
+    o_rect[3] = (f32)(i_sprite->atlas[1] + i_sprite->trim[3]) / (f32)i_height;
+    o_rect[4] = (f32)i_sprite->trim[0] / (f32)i_sprite->cell[2];
+    o_rect[5] = (f32)i_sprite->trim[1] / (f32)i_sprite->cell[3];
+    o_rect[6] = (f32)(i_sprite->trim[0] + i_sprite->trim[2]) / (f32)i_sprite->cell[2];
+    o_rect[7] = (f32)(i_sprite->trim[1] + i_sprite->trim[3]) / (f32)i_sprite->cell[3];
+}
+
+/* Same mapping as sprite_atlas_uv in the generated header. */
+b8 atlas_uv(f32 const* i_rect, f32 i_box_u, f32 i_box_v, f32* o_u, f32* o_v)
+{
+    if (i_box_u < i_rect[4] || i_box_v < i_rect[5] || i_box_u >= i_rect[6] || i_box_v >= i_rect[7])
+    {
+        return FALSE;
+    }
+    *o_u = i_rect[0] + (i_box_u - i_rect[4]) / (i_rect[6] - i_rect[4]) * (i_rect[2] - i_rect[0]);
+    *o_v = i_rect[1] + (i_box_v - i_rect[5]) / (i_rect[7] - i_rect[5]) * (i_rect[3] - i_rect[1]);
+    return TRUE;
+}
+
+b8 atlas_write_texture(char const* i_directory, std::vector<u32> const& i_atlas, u32 i_width, u32 i_height)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/sprite_atlas_texture.h", i_directory);
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        printf("Could not open %s\n", path);
+        return FALSE;
+    }
+    fprintf(file, "#define TEXTURE_SPRITE_ATLAS_WIDTH %u\n#define TEXTURE_SPRITE_ATLAS_HEIGHT %u\nu32 g_texture_sprite_atlas[] = {\n", i_width, i_height);
+    for (u32 i = 0; i < i_atlas.size(); ++i)
+    {
+        fprintf(file, i % 16 == 0 ? "  0x%08x," : " 0x%08x,", i_atlas[i]);
+        if (i % 16 == 15)
+        {
+            fprintf(file, "\n");
+        }
+    }
+    fprintf(file, "};\n");
+    fclose(file);
+    return TRUE;
+}
+
+/* A float literal that reads back as i_value, with the decimal point C++ needs before the suffix. */
+void atlas_write_f32(FILE* i_file, f32 i_value)
+{
+    char text[32];
+    snprintf(text, sizeof(text), "%.9g", (f64)i_value);
+    fprintf(i_file, strchr(text, '.') != NULL || strchr(text, 'e') != NULL ? "%sf" : "%s.0f", text);
+}
+
+b8 atlas_write_table(char const* i_directory, std::vector<atlas_sprite> const& i_sprites, u32 i_width, u32 i_height)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/sprite_atlas.h", i_directory);
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        printf("Could not open %s\n", path);
+        return FALSE;
+    }
+
+    fprintf(file,
+        "/* Generated by tools/sprite_atlas.c from the spritesheet, the atlas is sprite_atlas_texture.h.\n"
+        " *\n"
+        " * uv_min and uv_max bound the sprite in the atlas. box_min and box_max bound the same texels in the box of the\n"
+        " * whole sprite, the uv sdf_box_textured computes, everything else in the box has no weight. */\n"
+        "\n"
+        "#ifndef SPRITE_ATLAS_H\n"
+        "#define SPRITE_ATLAS_H\n"
+        "\n"
+        "typedef enum\n"
+        "{\n");
+    for (u32 i = 0; i < i_sprites.size(); ++i)
+    {
+        fprintf(file, "    SPRITE_ID_%s,\n", i_sprites[i].name);
+    }
+    fprintf(file,
+        "    _SPRITE_ID_COUNT,\n"
+        "} sprite_id;\n"
+        "\n"
+        "typedef struct {\n"
+        "    fvec2 uv_min;\n"
+        "    fvec2 uv_max;\n"
+        "    fvec2 box_min;\n"
+        "    fvec2 box_max;\n"
+        "} sprite_atlas_rect;\n"
+        "\n"
+        "static sprite_atlas_rect const g_sprite_atlas[_SPRITE_ID_COUNT] = {\n");
+    for (u32 i = 0; i < i_sprites.size(); ++i)
+    {
+        f32 rect[8];
+        atlas_sprite_rect(&i_sprites[i], i_width, i_height, rect);
+        fprintf(file, "    {");
+        for (u32 j = 0; j < 8; j += 2)
+        {
+            fprintf(file, j > 0 ? ", { " : " { ");
+            atlas_write_f32(file, rect[j]);
+            fprintf(file, ", ");
+            atlas_write_f32(file, rect[j + 1]);
+            fprintf(file, " }");
+        }
+        fprintf(file, " }, /* %s */\n", i_sprites[i].name);
+    }
+    fprintf(file,
+        "};\n"
+        "\n"
+        "/* Maps the uv in the box of i_sprite to the atlas, returns FALSE where the sprite has no weight. */\n"
+        "b8 sprite_atlas_uv(sprite_id i_sprite, fvec2 i_box_uv, fvec2* o_uv)\n"
+        "{\n"
+        "    sprite_atlas_rect const* rect = &g_sprite_atlas[i_sprite];\n"
+        "    if (i_box_uv.x < rect->box_min.x || i_box_uv.y < rect->box_min.y || i_box_uv.x >= rect->box_max.x || i_box_uv.y >= rect->box_max.y)\n"
+        "    {\n"
+        "        return FALSE;\n"
+        "    }\n"
+        "    o_uv->x = rect->uv_min.x + (i_box_uv.x - rect->box_min.x) / (rect->box_max.x - rect->box_min.x) * (rect->uv_max.x - rect->uv_min.x);\n"
+        "    o_uv->y = rect->uv_min.y + (i_box_uv.y - rect->box_min.y) / (rect->box_max.y - rect->box_min.y) * (rect->uv_max.y - rect->uv_min.y);\n"
+        "    return TRUE;\n"
+        "}\n"
+        "\n"
+        "#endif\n");
+    fclose(file);
+    return TRUE;
+}
+
+int main(int argc, char** argv)
+{
+    char const* output = argc > 1 ? argv[1] : "output";
+
+    std::vector<u8> rgba;
+    u32 sheet_width = 0;
+    u32 sheet_height = 0;
+    if (!png_read("assets/spritesheet_texture.png", &rgba, &sheet_width, &sheet_height))
+    {
+        return 1;
+    }
+    std::vector<u32> sheet((sz)sheet_width * sheet_height);
+    for (u32 i = 0; i < sheet.size(); ++i)
+    {
+        sheet[i] = (u32)rgba[i * 4] | ((u32)rgba[i * 4 + 1] << 8) | ((u32)rgba[i * 4 + 2] << 16) | ((u32)rgba[i * 4 + 3] << 24);
+    }
+
+    f64 start = profile_time_ms();
+    std::vector<atlas_sprite> sprites;
+    atlas_load_sprites(sheet.data(), sheet_width, sheet_height, &sprites);
+
+    /* Tallest first, the skyline stays flattest that way. */
+    std::vector<u32> order(sprites.size());
+    u32 width_min = ATLAS_ALIGNMENT;
+    u64 area_sprites = 0;
+    for (u32 i = 0; i < sprites.size(); ++i)
+    {
+        order[i] = i;
+        width_min = math_max(width_min, sprites[i].trim[2]);
+        area_sprites += (u64)sprites[i].trim[2] * sprites[i].trim[3];
+    }
+    std::sort(order.begin(), order.end(), [&sprites](u32 i_a, u32 i_b) {
+        if (sprites[i_a].trim[3] != sprites[i_b].trim[3])
+        {
+            return sprites[i_a].trim[3] > sprites[i_b].trim[3];
+        }
+        return sprites[i_a].trim[2] > sprites[i_b].trim[2];
+    });
+
+    u32 best_width = 0;
+    u32 best_height = 0;
+    for (u32 width = (width_min + ATLAS_ALIGNMENT - 1) / ATLAS_ALIGNMENT * ATLAS_ALIGNMENT; width <= ATLAS_WIDTH_MAX; width += ATLAS_ALIGNMENT)
+    {
+        u32 height = atlas_pack(&sprites, order, width);
+        height = (height + ATLAS_ALIGNMENT - 1) / ATLAS_ALIGNMENT * ATLAS_ALIGNMENT;
+        if (best_width == 0 || (u64)width * height < (u64)best_width * best_height)
+        {
+            best_width = width;
+            best_height = height;
+        }
+    }
+    atlas_pack(&sprites, order, best_width);
+
+    std::vector<u32> atlas((sz)best_width * best_height, 0);
+    for (u32 i = 0; i < sprites.size(); ++i)
+    {
+        atlas_sprite const* sprite = &sprites[i];
+        for (u32 y = 0; y < sprite->trim[3]; ++y)
+        {
+            for (u32 x = 0; x < sprite->trim[2]; ++x)
+            {
+                atlas[(sprite->atlas[1] + y) * best_width + sprite->atlas[0] + x] =
+                    sheet[(sprite->cell[1] + sprite->trim[1] + y) * sheet_width + sprite->cell[0] + sprite->trim[0] + x];
+            }
+        }
+    }
+    f64 time_pack = profile_time_ms() - start;
+
+    /* Look every texel of every sprite up through the table, outside the trimmed rectangle the sheet has no weight. */
+    u32 differences = 0;
+    u64 texels_checked = 0;
+    for (u32 i = 0; i < sprites.size(); ++i)
+    {
+        atlas_sprite const* sprite = &sprites[i];
+        f32 rect[8];
+        atlas_sprite_rect(sprite, best_width, best_height, rect);
+        for (u32 y = 0; y < sprite->cell[3]; ++y)
+        {
+            for (u32 x = 0; x < sprite->cell[2]; ++x)
+            {
+                u32 expected = sheet[(sprite->cell[1] + y) * sheet_width + sprite->cell[0] + x];
+                f32 u = 0.0f;
+                f32 v = 0.0f;
+                ++texels_checked;
+                if (sprite->trim[2] > 0 && atlas_uv(rect, ((f32)x + 0.5f) / (f32)sprite->cell[2], ((f32)y + 0.5f) / (f32)sprite->cell[3], &u, &v))
+                {
+                    u32 atlas_x = math_min((u32)(u * (f32)best_width), best_width - 1);
+                    u32 atlas_y = math_min((u32)(v * (f32)best_height), best_height - 1);
+                    differences += atlas[atlas_y * best_width + atlas_x] != expected ? 1 : 0;
+                }
+                else
+                {
+                    differences += (expected & 0xFF) != 0 ? 1 : 0;
+                }
+            }
+        }
+    }
+
+    u32 empty = 0;
+    for (u32 i = 0; i < sprites.size(); ++i)
+    {
+        atlas_sprite const* sprite = &sprites[i];
+        empty += sprite->trim[2] == 0 ? 1 : 0;
+        if (DEBUG)
+        {
+            printf("%-14s cell %4u,%4u %3ux%3u, trimmed %3ux%3u at %4u,%4u\n", sprite->name, sprite->cell[0], sprite->cell[1],
+                sprite->cell[2], sprite->cell[3], sprite->trim[2], sprite->trim[3], sprite->atlas[0], sprite->atlas[1]);
+        }
+    }
+
+    u64 size_sheet = (u64)sheet_width * sheet_height * 4;
+    u64 size_atlas = (u64)best_width * best_height * 4;
+    printf("%u sprites, %u without weight, packed in %.1fms\n", (u32)sprites.size(), empty, time_pack);
+    printf("sheet %ux%u: %.0fKB\n", sheet_width, sheet_height, (f64)size_sheet / 1024.0);
+    printf("atlas %ux%u: %.0fKB, %.1f%% covered by sprites\n", best_width, best_height, (f64)size_atlas / 1024.0,
+        100.0 * (f64)area_sprites / ((f64)best_width * best_height));
+    printf("saved %.0fKB, %.1f%% of the sheet\n", (f64)(size_sheet - size_atlas) / 1024.0, 100.0 * (f64)(size_sheet - size_atlas) / (f64)size_sheet);
+    printf("%llu texels looked up through the table, %u differ from the sheet\n", (unsigned long long)texels_checked, differences);
+
+    /* Fails when the directory is already there, opening the files reports any other reason. */
+    atlas_make_directory(output);
+    if (!atlas_write_texture(output, atlas, best_width, best_height) || !atlas_write_table(output, sprites, best_width, best_height))
+    {
+        return 1;
+    }
+    return differences == 0 ? 0 : 1;
+}
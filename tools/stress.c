@@ -0,0 +1,279 @@
+/* Headless stress test for the per frame simulation.
+ *
+ * Fills the resident area of a single chunk world with generated tumors, t-cells, walls and maggots and keeps
+ * spawning bursts of particles, then runs the frame the game runs minus rendering and audio: a scripted player
+ * moving through the distance field, the entity systems building primitives, culling into the GPU lists, the
+ * collision snapshot and the navigation flow field the t-cells chase the player along. The scripted player sweeps
+ * through the growth states and ignores whatever it touches, so it never dies or leaves the level.
+ *
+ * The entity count steps from 100 up to 100k. Every step reports the time per stage, the memory the growable
+ * containers hold and how much did not fit in the fixed size GPU lists and particle arrays. The last lines
+ * name the first step that went over a 60Hz frame and the first step where each fixed capacity ran out.
+ *
+ * usage: stress [frames] [max entities]
+ * frames is the number of frames simulated per step, 60 by default. */
+
+#include <chrono>
+#include <cstdio>
+
+/* Fixed capacities have an assert followed by a guard, the stress test wants the guard and counts what it drops. */
+#define NDEBUG 1
+#define DEBUG 0
+#include "core.h"
+
+f64 profile_time_ms()
+{
+    return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#define GAME_HEADLESS 1
+#include "game.h"
+
+#define STRESS_STEPS_COUNT 7
+#define STRESS_FRAME_BUDGET_MS (1000.0 / 60.0)
+#define STRESS_PARTICLE_LIFETIME_FRAMES 30 /* Particles grow for half a second before they despawn. */
+
+/* Out of every 16 entities 7 are tumors, 3 t-cells, 3 walls and 1 a maggot. The other 2 are particle bursts
+ * spawned over the run. */
+#define STRESS_MIX_TUMORS 7
+#define STRESS_MIX_T_CELLS 10
+#define STRESS_MIX_WALLS 13
+#define STRESS_MIX_MAGGOTS 14
+#define STRESS_MIX_COUNT 16
+
+u32 g_stress_counts[STRESS_STEPS_COUNT] = { 100, 300, 1000, 3000, 10000, 30000, 100000 };
+
+typedef struct {
+    u32 count;
+    u32 entities_count;  /* Placed at the start, the rest of the count are particle bursts. */
+    u32 particles_count; /* Particle bursts alive on average. */
+    f64 time_spawns;
+    f64 time_player;
+    f64 time_entities;
+    f64 time_cull;
+    f64 time_snapshot;
+    f64 time_nav;
+    f64 time_frame;
+    f64 time_frame_max;
+    u32 primitives_resident;
+    u32 primitives_visible;
+    u32 shapes;
+    u32 primitives_dropped;
+    u32 particles;           /* Most particles simulated in a frame. */
+    u64 particles_dropped;   /* Particles bursts could not emit for lack of room. */
+    sz memory_entities;
+    sz memory_primitives;
+    sz memory_collision;
+    sz memory_tumor_faces;
+} stress_step;
+
+/* Starts a single chunk world and spreads i_count entities over its resident area, sizing them to the space
+ * each gets so the scene stays about as crowded at any count. Positions follow the same low discrepancy
+ * sequence as the benchmarks in game.h. */
+void stress_spawn(u32 i_count)
+{
+    memzero(&g_player, sizeof(g_player));
+    g_player.position = { (f32)LEVEL_WIDTH * 0.5f, (f32)LEVEL_HEIGHT * 0.5f };
+    g_player.radius = 37.0f;
+    g_player.scale = 1.0f;
+
+    world_clear(1, 1);
+    world_update_camera(g_player.position);
+    sdf_collision_snapshot_clear();
+    g_nav.is_rasterised = FALSE;
+    g_nav.chase_player = TRUE;
+    g_crowd.is_wandering = TRUE;
+
+    f32 spacing = f32_sqrt((f32)WORLD_RESIDENT_WIDTH * (f32)WORLD_RESIDENT_HEIGHT / (f32)i_count);
+    f32 size = math_clamp(spacing * 0.3f, 6.0f, 120.0f);
+    for (u32 i = 0; i < i_count; ++i)
+    {
+        u32 mix = i % STRESS_MIX_COUNT;
+        if (mix >= STRESS_MIX_MAGGOTS)
+        {
+            continue;
+        }
+
+        entity_data entity;
+        memzero(&entity, sizeof(entity));
+        entity.position.x = g_world.resident_origin.x + sdf_fract((f32)i * 0.6180339f) * (f32)WORLD_RESIDENT_WIDTH;
+        entity.position.y = g_world.resident_origin.y + sdf_fract((f32)i * 0.7548777f) * (f32)WORLD_RESIDENT_HEIGHT;
+
+        /* Vary sizes a little per entity and across the growth states, like the hand made levels do. */
+        f32 scale = 0.75f + sdf_fract((f32)i * 0.5698403f) * 0.5f;
+        if (mix < STRESS_MIX_TUMORS)
+        {
+            entity.type = ENTITY_TYPE_TUMOR;
+            entity.growth_sizes1 = { size * scale * 0.6f, size * scale, size * scale * 1.3f };
+            entity.sprite_index[0] = (f32)(i % 2);
+            entity.sprite_index[1] = (f32)(3 + i % 6);
+        }
+        else if (mix < STRESS_MIX_T_CELLS)
+        {
+            entity.type = ENTITY_TYPE_T_CELL;
+            entity.growth_sizes1 = { size * scale * 0.4f, size * scale * 0.7f, size * scale * 0.9f };
+        }
+        else if (mix < STRESS_MIX_WALLS)
+        {
+            entity.type = ENTITY_TYPE_WALL;
+            entity.growth_sizes1 = { size * scale * 1.5f, size * scale * 1.5f, size * scale * 1.5f };
+            entity.growth_sizes2 = { size * 0.3f, size * 0.3f, size * 0.3f };
+        }
+        else
+        {
+            entity.type = ENTITY_TYPE_MAGGOT;
+            entity.growth_sizes1 = { 10.0f, 10.0f, 10.0f };
+        }
+        entity_spawn(&entity);
+    }
+}
+
+/* Runs i_frames frames over i_count entities. Particle bursts are spawned at the rate that keeps the particle
+ * share of the mix alive, spread over the resident area like the rest. */
+stress_step stress_run(u32 i_count, u32 i_frames)
+{
+    stress_step step;
+    memzero(&step, sizeof(step));
+    stress_spawn(i_count);
+    step.count = i_count;
+    step.entities_count = g_entity_store.count;
+
+    u32 particles_count = i_count / STRESS_MIX_COUNT * (STRESS_MIX_COUNT - STRESS_MIX_MAGGOTS);
+    u64 particles_alive = 0;
+    u64 particles_dropped = g_particles.dropped;
+    u64 spawns = 0;
+
+    sdf_query_cache player_query_cache;
+    memzero(&player_query_cache, sizeof(player_query_cache));
+    fvec2 velocity = { 0.0f, 0.0f };
+    f32 delta_time = 1.0f / 60.0f;
+    f32 max_velocity = 900.0f;
+    f32 push_strength = 4.0f;
+    for (u32 frame = 0; frame < i_frames; ++frame)
+    {
+        f64 start = profile_time_ms();
+
+        /* Particle bursts. */
+        u64 spawns_total = (u64)(frame + 1) * particles_count / STRESS_PARTICLE_LIFETIME_FRAMES;
+        for (; spawns < spawns_total; ++spawns)
+        {
+            entity_data particles;
+            memzero(&particles, sizeof(particles));
+            particles.type = ENTITY_TYPE_PARTICLES;
+            particles.position.x = g_world.resident_origin.x + sdf_fract((f32)spawns * 0.6180339f) * (f32)WORLD_RESIDENT_WIDTH;
+            particles.position.y = g_world.resident_origin.y + sdf_fract((f32)spawns * 0.7548777f) * (f32)WORLD_RESIDENT_HEIGHT;
+            entity_spawn(&particles);
+        }
+        f64 after_spawns = profile_time_ms();
+
+        /* Scripted player, steering toward a point tracing a figure over the level at top speed. */
+        f32 time = (f32)frame * delta_time;
+        fvec2 target = {
+            (f32)LEVEL_WIDTH * (0.5f + 0.45f * f32_sin(time * 0.7f)),
+            (f32)LEVEL_HEIGHT * (0.5f + 0.45f * f32_sin(time * 1.1f))
+        };
+        velocity = fvec2_mul_s(fvec2_sub(target, g_player.position), 4.0f);
+        if (fvec2_len(velocity) > max_velocity)
+        {
+            velocity = fvec2_mul_s(fvec2_norm(velocity), max_velocity);
+        }
+        player_move(&player_query_cache, &velocity, delta_time, push_strength);
+        g_player.growth_factor = sdf_fract(time * 0.2f);
+        f64 after_player = profile_time_ms();
+
+        /* Same order as the game loop. */
+        world_update_camera(g_player.position);
+        entities_to_primitives(delta_time, ENTITIES_CAPACITY_MAX);
+        f64 after_entities = profile_time_ms();
+        world_cull_primitives();
+        f64 after_cull = profile_time_ms();
+        sdf_collision_snapshot_build(g_player.growth_factor, g_player.time);
+        f64 after_snapshot = profile_time_ms();
+        nav_update(g_player.position);
+        f64 after_nav = profile_time_ms();
+        g_player.time += delta_time;
+
+        step.time_spawns += after_spawns - start;
+        step.time_player += after_player - after_spawns;
+        step.time_entities += after_entities - after_player;
+        step.time_cull += after_cull - after_entities;
+        step.time_snapshot += after_snapshot - after_cull;
+        step.time_nav += after_nav - after_snapshot;
+        step.time_frame += after_nav - start;
+        step.time_frame_max = math_max(step.time_frame_max, after_nav - start);
+        step.primitives_resident = math_max(step.primitives_resident, g_resident_level_primitives_count + g_resident_overlay_primitives_count);
+        step.shapes = math_max(step.shapes, g_collision_snapshot.shapes_count);
+        step.primitives_dropped = math_max(step.primitives_dropped, g_world.frame_primitives_dropped);
+        step.particles = math_max(step.particles, particles_packed_count());
+        particles_alive += g_entity_store.members_count[ENTITY_TYPE_PARTICLES];
+    }
+    step.particles_dropped = g_particles.dropped - particles_dropped;
+
+    f64 frames = (f64)math_max(i_frames, 1u);
+    step.time_spawns /= frames;
+    step.time_player /= frames;
+    step.time_entities /= frames;
+    step.time_cull /= frames;
+    step.time_snapshot /= frames;
+    step.time_nav /= frames;
+    step.time_frame /= frames;
+    step.particles_count = (u32)((f64)particles_alive / frames);
+    step.primitives_visible = g_level_slots.visible_count + g_overlay_slots.visible_count;
+    step.memory_entities = entity_store_size();
+    step.memory_primitives = (sz)(g_resident_level_primitives_capacity + g_resident_overlay_primitives_capacity) * sizeof(sdf_primitive);
+    step.memory_collision = sdf_collision_snapshot_size();
+    step.memory_tumor_faces = (sz)g_tumor_faces.capacity * 5 * sizeof(f32);
+    return step;
+}
+
+void stress_print(stress_step const* i_step)
+{
+    printf("%u entities, %u placed and %u particle bursts alive: %.3fms per frame, worst %.3fms%s\n",
+        i_step->count, i_step->entities_count, i_step->particles_count, i_step->time_frame, i_step->time_frame_max,
+        i_step->time_frame > STRESS_FRAME_BUDGET_MS ? ", OVER BUDGET" : "");
+    printf("    per frame: spawns %.4fms, player %.4fms, entities %.4fms, cull %.4fms, snapshot %.4fms, navigation %.4fms\n",
+        i_step->time_spawns, i_step->time_player, i_step->time_entities, i_step->time_cull, i_step->time_snapshot, i_step->time_nav);
+    printf("    primitives: %u resident, %u visible, %u dropped from the GPU lists; collision: %u shapes\n",
+        i_step->primitives_resident, i_step->primitives_visible, i_step->primitives_dropped, i_step->shapes);
+    printf("    particles: %u simulated, %llu dropped\n", i_step->particles, (unsigned long long)i_step->particles_dropped);
+    printf("    memory: entities %.1fKB, resident primitives %.1fKB, collision snapshot %.1fKB, tumor faces %.1fKB\n",
+        (f64)i_step->memory_entities / 1024.0, (f64)i_step->memory_primitives / 1024.0, (f64)i_step->memory_collision / 1024.0, 
+        (f64)i_step->memory_tumor_faces / 1024.0);
+}
+
+int main(int argc, char** argv)
+{
+    u32 frames = 60;
+    u32 max_count = g_stress_counts[STRESS_STEPS_COUNT - 1];
+    if (argc > 1)
+    {
+        frames = (u32)atoi(argv[1]);
+    }
+    if (argc > 2)
+    {
+        max_count = (u32)atoi(argv[2]);
+    }
+    noise_atlas_bake();
+
+    printf("Fixed memory: navigation %.1fKB, gpu primitives %.1fKB, particles %.1fKB, world chunks %.1fKB\n",
+        (f64)sizeof(g_nav) / 1024.0,
+        (f64)(sizeof(g_level_primitives) + sizeof(g_overlay_primitives)) / 1024.0,
+        (f64)(sizeof(g_particles) + sizeof(g_particles_packed)) / 1024.0,
+        (f64)sizeof(g_world.chunks) / 1024.0);
+
+    u32 over_budget = 0;
+    u32 primitives_full = 0;
+    u32 particles_full = 0;
+    for (u32 i = 0; i < STRESS_STEPS_COUNT && g_stress_counts[i] <= max_count; ++i)
+    {
+        stress_step step = stress_run(g_stress_counts[i], frames);
+        stress_print(&step);
+        over_budget = (over_budget == 0 && step.time_frame > STRESS_FRAME_BUDGET_MS) ? g_stress_counts[i] : over_budget;
+        primitives_full = (primitives_full == 0 && step.primitives_dropped > 0) ? g_stress_counts[i] : primitives_full;
+        particles_full = (particles_full == 0 && step.particles_dropped > 0) ? g_stress_counts[i] : particles_full;
+    }
+
+    printf("First step over a 60Hz frame: %u, GPU lists full: %u, particles full: %u (0 is never)\n",
+        over_budget, primitives_full, particles_full);
+    return 0;
+}
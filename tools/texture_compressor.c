@@ -0,0 +1,1110 @@
+/* Bake time block compression for the texture assets.
+ *
+ * The textures are uploaded as R8G8B8A8, 4 bytes a texel in the binary, in RAM and in VRAM. This reads the PNGs in
+ * assets/ and the baked noise, picks a block compressed format per texture and encodes it over all threads:
+ * - BC4 for single channel data, 4 bits a texel. The four channels of the noise are blended independently by
+ *   sample_noise, each becomes its own BC4 plane.
+ * - BC1 for opaque color, 4 bits a texel.
+ * - BC7 for color with alpha like the spritesheet, 8 bits a texel. Only the single subset modes 5 and 6 are encoded,
+ *   which suits sprites without partition searches: mode 6 where alpha follows the color, mode 5 with indices of
+ *   its own for alpha where it does not.
+ * Every 4x4 block fits endpoints along the principal axis of its texels and refines them with least squares against
+ * the indices, the index search tests four texels at once with SSE2. Every texture is decoded again on the CPU to
+ * report the PSNR against the source, the decoder reads all of BC1 and BC4 and modes 5 and 6 of BC7.
+ *
+ * usage: texture_compressor [output directory]
+ * Reports the size and PSNR of every asset. With an output directory every texture is also written there as a DDS
+ * file, the noise as an array of four BC4 slices. */
+
+#define _CRT_SECURE_NO_WARNINGS 1
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#define DEBUG 0
+#include "core.h"
+#include "assets/noise_texture.h"
+#include "tools/png_reader.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define BC_SSE2 1
+    #include <emmintrin.h>
+#else
+    #define BC_SSE2 0
+#endif
+
+f64 profile_time_ms()
+{
+    return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/* --------------------------------------------------
+   Block compression
+   -------------------------------------------------- */
+
+typedef enum
+{
+    BC_FORMAT_BC1 = 0,
+    BC_FORMAT_BC4,
+    BC_FORMAT_BC7,
+} bc_format;
+
+/* The 16 texels of a 4x4 block, one channel after the other. */
+typedef struct {
+    f32 channels[4][16];
+    u32 channels_count;
+} bc_block;
+
+/* Index of the closest palette entry for every texel of the block into o_indices, returns the squared error. */
+f32 bc_select_indices(bc_block const* i_block, f32 const (*i_palette)[4], u32 i_palette_count, u8* o_indices)
+{
+    f32 error = 0.0f;
+    #if BC_SSE2
+    for (u32 texel = 0; texel < 16; texel += 4)
+    {
+        __m128 best = _mm_set1_ps(3.0e38f);
+        __m128i best_index = _mm_setzero_si128();
+        for (u32 entry = 0; entry < i_palette_count; ++entry)
+        {
+            __m128 distance = _mm_setzero_ps();
+            for (u32 channel = 0; channel < i_block->channels_count; ++channel)
+            {
+                __m128 difference = _mm_sub_ps(_mm_loadu_ps(&i_block->channels[channel][texel]), _mm_set1_ps(i_palette[entry][channel]));
+                distance = _mm_add_ps(distance, _mm_mul_ps(difference, difference));
+            }
+            __m128i is_closer = _mm_castps_si128(_mm_cmplt_ps(distance, best));
+            best = _mm_min_ps(best, distance);
+            best_index = _mm_or_si128(_mm_and_si128(is_closer, _mm_set1_epi32((i32)entry)), _mm_andnot_si128(is_closer, best_index));
+        }
+
+        f32 errors[4];
+        i32 indices[4];
+        _mm_storeu_ps(errors, best);
+        _mm_storeu_si128((__m128i*)indices, best_index);
+        for (u32 lane = 0; lane < 4; ++lane)
+        {
+            o_indices[texel + lane] = (u8)indices[lane];
+            error += errors[lane];
+        }
+    }
+    #else
+    for (u32 texel = 0; texel < 16; ++texel)
+    {
+        f32 best = 3.0e38f;
+        for (u32 entry = 0; entry < i_palette_count; ++entry)
+        {
+            f32 distance = 0.0f;
+            for (u32 channel = 0; channel < i_block->channels_count; ++channel)
+            {
+                f32 difference = i_block->channels[channel][texel] - i_palette[entry][channel];
+                distance += difference * difference;
+            }
+            if (distance < best)
+            {
+                best = distance;
+                o_indices[texel] = (u8)entry;
+            }
+        }
+        error += best;
+    }
+    #endif
+    return error;
+}
+
+/* Principal axis of the texels through their mean, by power iteration on the covariance. */
+void bc_principal_axis(bc_block const* i_block, f32* o_mean, f32* o_axis)
+{
+    u32 count = i_block->channels_count;
+    for (u32 channel = 0; channel < count; ++channel)
+    {
+        o_mean[channel] = 0.0f;
+        for (u32 texel = 0; texel < 16; ++texel)
+        {
+            o_mean[channel] += i_block->channels[channel][texel] / 16.0f;
+        }
+    }
+
+    f32 covariance[4][4];
+    for (u32 row = 0; row < count; ++row)
+    {
+        for (u32 column = 0; column < count; ++column)
+        {
+            covariance[row][column] = 0.0f;
+            for (u32 texel = 0; texel < 16; ++texel)
+            {
+                covariance[row][column] += (i_block->channels[row][texel] - o_mean[row]) * (i_block->channels[column][texel] - o_mean[column]);
+            }
+        }
+    }
+
+    for (u32 channel = 0; channel < count; ++channel)
+    {
+        o_axis[channel] = 1.0f;
+    }
+    for (u32 iteration = 0; iteration < 8; ++iteration)
+    {
+        f32 next[4];
+        f32 length = 0.0f;
+        for (u32 row = 0; row < count; ++row)
+        {
+            next[row] = 0.0f;
+            for (u32 column = 0; column < count; ++column)
+            {
+                next[row] += covariance[row][column] * o_axis[column];
+            }
+            length = math_max(length, f32_abs(next[row]));
+        }
+        if (length <= 0.0f)
+        {
+            break;
+        }
+        for (u32 channel = 0; channel < count; ++channel)
+        {
+            o_axis[channel] = next[channel] / length;
+        }
+    }
+}
+
+/* Ends of the texels projected on the principal axis, the starting endpoints of every format. */
+void bc_axis_endpoints(bc_block const* i_block, f32* o_start, f32* o_end)
+{
+    f32 mean[4];
+    f32 axis[4];
+    bc_principal_axis(i_block, mean, axis);
+    f32 length2 = 0.0f;
+    for (u32 channel = 0; channel < i_block->channels_count; ++channel)
+    {
+        length2 += axis[channel] * axis[channel];
+    }
+
+    f32 low = 0.0f;
+    f32 high = 0.0f;
+    for (u32 texel = 0; texel < 16 && length2 > 0.0f; ++texel)
+    {
+        f32 projected = 0.0f;
+        for (u32 channel = 0; channel < i_block->channels_count; ++channel)
+        {
+            projected += (i_block->channels[channel][texel] - mean[channel]) * axis[channel];
+        }
+        low = math_min(low, projected / length2);
+        high = math_max(high, projected / length2);
+    }
+    for (u32 channel = 0; channel < i_block->channels_count; ++channel)
+    {
+        o_start[channel] = math_clamp(mean[channel] + axis[channel] * low, 0.0f, 255.0f);
+        o_end[channel] = math_clamp(mean[channel] + axis[channel] * high, 0.0f, 255.0f);
+    }
+}
+
+/* Endpoints that minimise the squared error for the interpolation weights the indices picked, returns FALSE when the
+ * weights do not tell the endpoints apart. */
+b8 bc_least_squares(bc_block const* i_block, u8 const* i_indices, f32 const* i_weights, f32* o_start, f32* o_end)
+{
+    f32 aa = 0.0f;
+    f32 ab = 0.0f;
+    f32 bb = 0.0f;
+    f32 ax[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    f32 bx[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for (u32 texel = 0; texel < 16; ++texel)
+    {
+        f32 b = i_weights[i_indices[texel]];
+        f32 a = 1.0f - b;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (u32 channel = 0; channel < i_block->channels_count; ++channel)
+        {
+            ax[channel] += a * i_block->channels[channel][texel];
+            bx[channel] += b * i_block->channels[channel][texel];
+        }
+    }
+
+    f32 determinant = aa * bb - ab * ab;
+    if (f32_abs(determinant) < 1e-6f)
+    {
+        return FALSE;
+    }
+    for (u32 channel = 0; channel < i_block->channels_count; ++channel)
+    {
+        o_start[channel] = math_clamp((ax[channel] * bb - bx[channel] * ab) / determinant, 0.0f, 255.0f);
+        o_end[channel] = math_clamp((bx[channel] * aa - ax[channel] * ab) / determinant, 0.0f, 255.0f);
+    }
+    return TRUE;
+}
+
+/* BC1, two RGB565 endpoints and 2 bit indices. Only the four color mode is encoded, it is the better one without
+ * transparency. */
+u16 bc1_pack_565(f32 const* i_color)
+{
+    u32 red = (u32)(i_color[0] * 31.0f / 255.0f + 0.5f);
+    u32 green = (u32)(i_color[1] * 63.0f / 255.0f + 0.5f);
+    u32 blue = (u32)(i_color[2] * 31.0f / 255.0f + 0.5f);
+    return (u16)((red << 11) | (green << 5) | blue);
+}
+
+void bc1_unpack_565(u16 i_color, u32* o_color)
+{
+    u32 red = (i_color >> 11) & 31;
+    u32 green = (i_color >> 5) & 63;
+    u32 blue = i_color & 31;
+    o_color[0] = (red << 3) | (red >> 2);
+    o_color[1] = (green << 2) | (green >> 4);
+    o_color[2] = (blue << 3) | (blue >> 2);
+}
+
+/* The colors the decoder produces for the endpoints, the alpha of the three color mode is left to the caller. */
+void bc1_palette(u16 i_color0, u16 i_color1, u32 (*o_palette)[4])
+{
+    bc1_unpack_565(i_color0, o_palette[0]);
+    bc1_unpack_565(i_color1, o_palette[1]);
+    for (u32 channel = 0; channel < 3; ++channel)
+    {
+        u32 start = o_palette[0][channel];
+        u32 end = o_palette[1][channel];
+        if (i_color0 > i_color1)
+        {
+            o_palette[2][channel] = (2 * start + end) / 3;
+            o_palette[3][channel] = (start + 2 * end) / 3;
+        }
+        else
+        {
+            o_palette[2][channel] = (start + end) / 2;
+            o_palette[3][channel] = 0;
+        }
+    }
+}
+
+f32 bc1_evaluate(bc_block const* i_block, u16 i_color0, u16 i_color1, u8* o_indices)
+{
+    u32 palette[4][4];
+    f32 palette_f32[4][4];
+    bc1_palette(i_color0, i_color1, palette);
+    for (u32 entry = 0; entry < 4; ++entry)
+    {
+        for (u32 channel = 0; channel < 4; ++channel)
+        {
+            palette_f32[entry][channel] = (f32)palette[entry][channel];
+        }
+    }
+    return bc_select_indices(i_block, palette_f32, i_color0 > i_color1 ? 4 : 3, o_indices);
+}
+
+void bc1_encode_block(bc_block const* i_block, u8* o_bytes)
+{
+    static f32 const weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+    f32 start[4];
+    f32 end[4];
+    bc_axis_endpoints(i_block, start, end);
+
+    u16 best_color0 = 0;
+    u16 best_color1 = 0;
+    u8 best_indices[16];
+    f32 best_error = 3.0e38f;
+    for (u32 iteration = 0; iteration < 3; ++iteration)
+    {
+        /* The four color mode needs color0 above color1, equal endpoints decode as the single color at index 0. */
+        u16 color0 = bc1_pack_565(end);
+        u16 color1 = bc1_pack_565(start);
+        if (color0 < color1)
+        {
+            u16 swap = color0;
+            color0 = color1;
+            color1 = swap;
+        }
+
+        u8 indices[16];
+        f32 error = bc1_evaluate(i_block, color0, color1, indices);
+        if (error < best_error)
+        {
+            best_error = error;
+            best_color0 = color0;
+            best_color1 = color1;
+            memcpy(best_indices, indices, sizeof(indices));
+        }
+        if (color0 == color1 || !bc_least_squares(i_block, indices, weights, end, start))
+        {
+            break;
+        }
+    }
+
+    o_bytes[0] = (u8)(best_color0 & 0xFF);
+    o_bytes[1] = (u8)(best_color0 >> 8);
+    o_bytes[2] = (u8)(best_color1 & 0xFF);
+    o_bytes[3] = (u8)(best_color1 >> 8);
+    for (u32 row = 0; row < 4; ++row)
+    {
+        o_bytes[4 + row] = (u8)(best_indices[row * 4] | (best_indices[row * 4 + 1] << 2) | (best_indices[row * 4 + 2] << 4) | (best_indices[row * 4 + 3] << 6));
+    }
+}
+
+/* Decodes to RGBA, the three color mode has a transparent black at index 3. */
+void bc1_decode_block(u8 const* i_bytes, u8 (*o_texels)[4])
+{
+    u16 color0 = (u16)(i_bytes[0] | (i_bytes[1] << 8));
+    u16 color1 = (u16)(i_bytes[2] | (i_bytes[3] << 8));
+    u32 palette[4][4];
+    bc1_palette(color0, color1, palette);
+    for (u32 entry = 0; entry < 4; ++entry)
+    {
+        palette[entry][3] = color0 <= color1 && entry == 3 ? 0 : 255;
+    }
+    for (u32 texel = 0; texel < 16; ++texel)
+    {
+        u32 index = (i_bytes[4 + texel / 4] >> ((texel % 4) * 2)) & 3;
+        for (u32 channel = 0; channel < 4; ++channel)
+        {
+            o_texels[texel][channel] = (u8)palette[index][channel];
+        }
+    }
+}
+
+/* BC4, two 8 bit endpoints and 3 bit indices. With endpoint0 above endpoint1 there are six steps between them,
+ * otherwise four and 0 and 255 besides. */
+void bc4_palette(u8 i_value0, u8 i_value1, f32* o_palette)
+{
+    o_palette[0] = (f32)i_value0;
+    o_palette[1] = (f32)i_value1;
+    if (i_value0 > i_value1)
+    {
+        for (u32 i = 1; i < 7; ++i)
+        {
+            o_palette[i + 1] = f32_floor(((f32)(7 - i) * (f32)i_value0 + (f32)i * (f32)i_value1) / 7.0f + 0.5f);
+        }
+    }
+    else
+    {
+        for (u32 i = 1; i < 5; ++i)
+        {
+            o_palette[i + 1] = f32_floor(((f32)(5 - i) * (f32)i_value0 + (f32)i * (f32)i_value1) / 5.0f + 0.5f);
+        }
+        o_palette[6] = 0.0f;
+        o_palette[7] = 255.0f;
+    }
+}
+
+f32 bc4_evaluate(bc_block const* i_block, u8 i_value0, u8 i_value1, u8* o_indices)
+{
+    f32 palette[8];
+    f32 palette_rows[8][4];
+    bc4_palette(i_value0, i_value1, palette);
+    for (u32 entry = 0; entry < 8; ++entry)
+    {
+        palette_rows[entry][0] = palette[entry];
+    }
+    return bc_select_indices(i_block, palette_rows, 8, o_indices);
+}
+
+void bc4_encode_block(bc_block const* i_block, u8* o_bytes)
+{
+    static f32 const weights8[8] = { 0.0f, 1.0f, 1.0f / 7.0f, 2.0f / 7.0f, 3.0f / 7.0f, 4.0f / 7.0f, 5.0f / 7.0f, 6.0f / 7.0f };
+    f32 low = 255.0f;
+    f32 high = 0.0f;
+    f32 inner_low = 255.0f;
+    f32 inner_high = 0.0f;
+    for (u32 texel = 0; texel < 16; ++texel)
+    {
+        f32 value = i_block->channels[0][texel];
+        low = math_min(low, value);
+        high = math_max(high, value);
+        if (value > 0.0f && value < 255.0f)
+        {
+            inner_low = math_min(inner_low, value);
+            inner_high = math_max(inner_high, value);
+        }
+    }
+
+    /* The eight value mode from the extremes, refined once, against the six value mode over what is not 0 or 255. */
+    u8 candidates[3][2] = {
+        { (u8)high, (u8)low },
+        { (u8)high, (u8)low },
+        { (u8)math_min(inner_low, inner_high), (u8)inner_high }
+    };
+    u8 indices[16];
+    f32 start = 0.0f;
+    f32 end = 0.0f;
+    bc4_evaluate(i_block, candidates[0][0], candidates[0][1], indices);
+    if (candidates[0][0] > candidates[0][1] && bc_least_squares(i_block, indices, weights8, &start, &end))
+    {
+        candidates[1][0] = (u8)(start + 0.5f);
+        candidates[1][1] = (u8)(end + 0.5f);
+        if (candidates[1][0] <= candidates[1][1])
+        {
+            candidates[1][0] = candidates[0][0];
+            candidates[1][1] = candidates[0][1];
+        }
+    }
+
+    f32 best_error = 3.0e38f;
+    u8 best_indices[16];
+    for (u32 i = 0; i < 3; ++i)
+    {
+        f32 error = bc4_evaluate(i_block, candidates[i][0], candidates[i][1], indices);
+        if (error < best_error)
+        {
+            best_error = error;
+            o_bytes[0] = candidates[i][0];
+            o_bytes[1] = candidates[i][1];
+            memcpy(best_indices, indices, sizeof(indices));
+        }
+    }
+
+    u64 bits = 0;
+    for (u32 texel = 0; texel < 16; ++texel)
+    {
+        bits |= (u64)best_indices[texel] << (texel * 3);
+    }
+    for (u32 i = 0; i < 6; ++i)
+    {
+        o_bytes[2 + i] = (u8)(bits >> (i * 8));
+    }
+}
+
+void bc4_decode_block(u8 const* i_bytes, u8* o_values)
+{
+    f32 palette[8];
+    bc4_palette(i_bytes[0], i_bytes[1], palette);
+    u64 bits = 0;
+    for (u32 i = 0; i < 6; ++i)
+    {
+        bits |= (u64)i_bytes[2 + i] << (i * 8);
+    }
+    for (u32 texel = 0; texel < 16; ++texel)
+    {
+        o_values[texel] = (u8)palette[(bits >> (texel * 3)) & 7];
+    }
+}
+
+/* BC7 in two of its modes, both a single subset. Mode 6 has RGBA endpoints of 7 bits with a p-bit each as their
+ * lowest bit and 4 bit indices. Mode 5 has RGB endpoints of 7 bits and alpha endpoints of 8 bits with 2 bit indices
+ * of their own, for alpha that does not follow the color like the soft edges of white sprites. The first index of
+ * every set is the anchor and stored without its highest bit, which has to be 0. */
+static u32 const g_bc7_weights2[4] = { 0, 21, 43, 64 };
+static u32 const g_bc7_weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+void bc7_palette(u32 const* i_start, u32 const* i_end, u32 const* i_weights, u32 i_weights_count, u32 i_channels_count, f32 (*o_palette)[4])
+{
+    for (u32 entry = 0; entry < i_weights_count; ++entry)
+    {
+        for (u32 channel = 0; channel < i_channels_count; ++channel)
+        {
+            o_palette[entry][channel] = (f32)(((64 - i_weights[entry]) * i_start[channel] + i_weights[entry] * i_end[channel] + 32) >> 6);
+        }
+    }
+}
+
+/* Quantises i_color to 7 bits with the p-bit i_p_bit below them. */
+void bc7_quantize_p_bit(f32 const* i_color, u32 i_p_bit, u32* o_color)
+{
+    for (u32 channel = 0; channel < 4; ++channel)
+    {
+        u32 value = (u32)math_clamp((i_color[channel] - (f32)i_p_bit) / 2.0f + 0.5f, 0.0f, 127.0f);
+        o_color[channel] = (value << 1) | i_p_bit;
+    }
+}
+
+/* Quantises i_color to 7 bits, the decoder repeats the highest bit below them. */
+void bc7_quantize_7(f32 const* i_color, u32* o_color)
+{
+    for (u32 channel = 0; channel < 3; ++channel)
+    {
+        u32 value = (u32)math_clamp(i_color[channel] * 127.0f / 255.0f + 0.5f, 0.0f, 127.0f);
+        o_color[channel] = (value << 1) | (value >> 6);
+    }
+}
+
+/* Best p-bits for the endpoints into o_start and o_end, returns the error with the indices it picked. */
+f32 bc7_mode6_evaluate(bc_block const* i_block, f32 const* i_start, f32 const* i_end, u32* o_start, u32* o_end, u8* o_indices)
+{
+    f32 best_error = 3.0e38f;
+    for (u32 p_bits = 0; p_bits < 4; ++p_bits)
+    {
+        u32 start[4];
+        u32 end[4];
+        f32 palette[16][4];
+        u8 indices[16];
+        bc7_quantize_p_bit(i_start, p_bits & 1, start);
+        bc7_quantize_p_bit(i_end, p_bits >> 1, end);
+        bc7_palette(start, end, g_bc7_weights4, 16, 4, palette);
+        f32 error = bc_select_indices(i_block, palette, 16, indices);
+        if (error < best_error)
+        {
+            best_error = error;
+            memcpy(o_start, start, sizeof(start));
+            memcpy(o_end, end, sizeof(end));
+            memcpy(o_indices, indices, sizeof(indices));
+        }
+    }
+    return best_error;
+}
+
+/* Appends the i_count lowest bits of i_value to the block at io_position. */
+void bc7_write_bits(u8* io_bytes, u32* io_position, u32 i_value, u32 i_count)
+{
+    for (u32 i = 0; i < i_count; ++i, ++*io_position)
+    {
+        io_bytes[*io_position / 8] |= (u8)(((i_value >> i) & 1) << (*io_position % 8));
+    }
+}
+
+u32 bc7_read_bits(u8 const* i_bytes, u32* io_position, u32 i_count)
+{
+    u32 value = 0;
+    for (u32 i = 0; i < i_count; ++i, ++*io_position)
+    {
+        value |= (u32)((i_bytes[*io_position / 8] >> (*io_position % 8)) & 1) << i;
+    }
+    return value;
+}
+
+/* Swaps the endpoints of i_channels_count channels and inverts the indices when the anchor has its highest bit set. */
+void bc7_fix_anchor(u32* io_start, u32* io_end, u32 i_channels_count, u8* io_indices, u32 i_indices_count)
+{
+    if (io_indices[0] < i_indices_count / 2)
+    {
+        return;
+    }
+    for (u32 channel = 0; channel < i_channels_count; ++channel)
+    {
+        u32 swap = io_start[channel];
+        io_start[channel] = io_end[channel];
+        io_end[channel] = swap;
+    }
+    for (u32 texel = 0; texel < 16; ++texel)
+    {
+        io_indices[texel] = (u8)(i_indices_count - 1 - io_indices[texel]);
+    }
+}
+
+f32 bc7_mode6_encode(bc_block const* i_block, u8* o_bytes)
+{
+    f32 weights[16];
+    for (u32 i = 0; i < 16; ++i)
+    {
+        weights[i] = (f32)g_bc7_weights4[i] / 64.0f;
+    }
+    f32 start[4];
+    f32 end[4];
+    bc_axis_endpoints(i_block, start, end);
+
+    u32 best_start[4];
+    u32 best_end[4];
+    u8 best_indices[16];
+    f32 best_error = 3.0e38f;
+    for (u32 iteration = 0; iteration < 3; ++iteration)
+    {
+        u32 quantized_start[4];
+        u32 quantized_end[4];
+        u8 indices[16];
+        f32 error = bc7_mode6_evaluate(i_block, start, end, quantized_start, quantized_end, indices);
+        if (error < best_error)
+        {
+            best_error = error;
+            memcpy(best_start, quantized_start, sizeof(best_start));
+            memcpy(best_end, quantized_end, sizeof(best_end));
+            memcpy(best_indices, indices, sizeof(best_indices));
+        }
+        if (error == 0.0f || !bc_least_squares(i_block, indices, weights, start, end))
+        {
+            break;
+        }
+    }
+    bc7_fix_anchor(best_start, best_end, 4, best_indices, 16);
+
+    memzero(o_bytes, 16);
+    u32 position = 0;
+    bc7_write_bits(o_bytes, &position, 1u << 6, 7);
+    for (u32 channel = 0; channel < 4; ++channel)
+    {
+        bc7_write_bits(o_bytes, &position, best_start[channel] >> 1, 7);
+        bc7_write_bits(o_bytes, &position, best_end[channel] >> 1, 7);
+    }
+    bc7_write_bits(o_bytes, &position, best_start[0] & 1, 1);
+    bc7_write_bits(o_bytes, &position, best_end[0] & 1, 1);
+    for (u32 texel = 0; texel < 16; ++texel)
+    {
+        bc7_write_bits(o_bytes, &position, best_indices[texel], texel == 0 ? 3 : 4);
+    }
+    return best_error;
+}
+
+/* Fits the endpoints of a block of color or of alpha for mode 5, returns the error. */
+f32 bc7_mode5_fit(bc_block const* i_block, u32* o_start, u32* o_end, u8* o_indices)
+{
+    f32 weights[4];
+    for (u32 i = 0; i < 4; ++i)
+    {
+        weights[i] = (f32)g_bc7_weights2[i] / 64.0f;
+    }
+    f32 start[4];
+    f32 end[4];
+    bc_axis_endpoints(i_block, start, end);
+
+    f32 best_error = 3.0e38f;
+    for (u32 iteration = 0; iteration < 3; ++iteration)
+    {
+        u32 quantized_start[4];
+        u32 quantized_end[4];
+        f32 palette[4][4];
+        u8 indices[16];
+        if (i_block->channels_count == 1)
+        {
+            quantized_start[0] = (u32)(start[0] + 0.5f);
+            quantized_end[0] = (u32)(end[0] + 0.5f);
+        }
+        else
+        {
+            bc7_quantize_7(start, quantized_start);
+            bc7_quantize_7(end, quantized_end);
+        }
+        bc7_palette(quantized_start, quantized_end, g_bc7_weights2, 4, i_block->channels_count, palette);
+        f32 error = bc_select_indices(i_block, palette, 4, indices);
+        if (error < best_error)
+        {
+            best_error = error;
+            memcpy(o_start, quantized_start, sizeof(quantized_start));
+            memcpy(o_end, quantized_end, sizeof(quantized_end));
+            memcpy(o_indices, indices, sizeof(indices));
+        }
+        if (error == 0.0f || !bc_least_squares(i_block, indices, weights, start, end))
+        {
+            break;
+        }
+    }
+    return best_error;
+}
+
+f32 bc7_mode5_encode(bc_block const* i_block, u8* o_bytes)
+{
+    bc_block color = *i_block;
+    color.channels_count = 3;
+    bc_block alpha;
+    alpha.channels_count = 1;
+    memcpy(alpha.channels[0], i_block->channels[3], sizeof(alpha.channels[0]));
+
+    u32 color_start[4];
+    u32 color_end[4];
+    u8 color_indices[16];
+    u32 alpha_start[4];
+    u32 alpha_end[4];
+    u8 alpha_indices[16];
+    f32 error = bc7_mode5_fit(&color, color_start, color_end, color_indices) + bc7_mode5_fit(&alpha, alpha_start, alpha_end, alpha_indices);
+    bc7_fix_anchor(color_start, color_end, 3, color_indices, 4);
+    bc7_fix_anchor(alpha_start, alpha_end, 1, alpha_indices, 4);
+
+    memzero(o_bytes, 16);
+    u32 position = 0;
+    bc7_write_bits(o_bytes, &position, 1u << 5, 6);
+    bc7_write_bits(o_bytes, &position, 0, 2); /* No rotation, alpha stays alpha. */
+    for (u32 channel = 0; channel < 3; ++channel)
+    {
+        bc7_write_bits(o_bytes, &position, color_start[channel] >> 1, 7);
+        bc7_write_bits(o_bytes, &position, color_end[channel] >> 1, 7);
+    }
+    bc7_write_bits(o_bytes, &position, alpha_start[0], 8);
+    bc7_write_bits(o_bytes, &position, alpha_end[0], 8);
+    for (u32 texel = 0; texel < 16; ++texel)
+    {
+        bc7_write_bits(o_bytes, &position, color_indices[texel], texel == 0 ? 1 : 2);
+    }
+    for (u32 texel = 0; texel < 16; ++texel)
+    {
+        bc7_write_bits(o_bytes, &position, alpha_indices[texel], texel == 0 ? 1 : 2);
+    }
+    return error;
+}
+
+/* Keeps mode 5 when it beats mode 6. */
+void bc7_encode_block(bc_block const* i_block, u8* o_bytes)
+{
+    u8 mode5[16];
+    f32 error6 = bc7_mode6_encode(i_block, o_bytes);
+    if (error6 > 0.0f && bc7_mode5_encode(i_block, mode5) < error6)
+    {
+        memcpy(o_bytes, mode5, sizeof(mode5));
+    }
+}
+
+/* Returns FALSE for blocks of modes other than 5 and 6, which decode as magenta. */
+b8 bc7_decode_block(u8 const* i_bytes, u8 (*o_texels)[4])
+{
+    u32 position = 0;
+    u32 mode = 0;
+    while (mode < 8 && bc7_read_bits(i_bytes, &position, 1) == 0)
+    {
+        ++mode;
+    }
+
+    if (mode == 6)
+    {
+        u32 start[4];
+        u32 end[4];
+        for (u32 channel = 0; channel < 4; ++channel)
+        {
+            start[channel] = bc7_read_bits(i_bytes, &position, 7) << 1;
+            end[channel] = bc7_read_bits(i_bytes, &position, 7) << 1;
+        }
+        u32 p_start = bc7_read_bits(i_bytes, &position, 1);
+        u32 p_end = bc7_read_bits(i_bytes, &position, 1);
+        for (u32 channel = 0; channel < 4; ++channel)
+        {
+            start[channel] |= p_start;
+            end[channel] |= p_end;
+        }
+
+        f32 palette[16][4];
+        bc7_palette(start, end, g_bc7_weights4, 16, 4, palette);
+        for (u32 texel = 0; texel < 16; ++texel)
+        {
+            u32 index = bc7_read_bits(i_bytes, &position, texel == 0 ? 3 : 4);
+            for (u32 channel = 0; channel < 4; ++channel)
+            {
+                o_texels[texel][channel] = (u8)palette[index][channel];
+            }
+        }
+        return TRUE;
+    }
+
+    if (mode == 5)
+    {
+        u32 rotation = bc7_read_bits(i_bytes, &position, 2);
+        u32 start[4];
+        u32 end[4];
+        for (u32 channel = 0; channel < 3; ++channel)
+        {
+            start[channel] = bc7_read_bits(i_bytes, &position, 7);
+            end[channel] = bc7_read_bits(i_bytes, &position, 7);
+            start[channel] = (start[channel] << 1) | (start[channel] >> 6);
+            end[channel] = (end[channel] << 1) | (end[channel] >> 6);
+        }
+        start[3] = bc7_read_bits(i_bytes, &position, 8);
+        end[3] = bc7_read_bits(i_bytes, &position, 8);
+
+        f32 palette[4][4];
+        bc7_palette(start, end, g_bc7_weights2, 4, 4, palette);
+        for (u32 texel = 0; texel < 16; ++texel)
+        {
+            u32 index = bc7_read_bits(i_bytes, &position, texel == 0 ? 1 : 2);
+            for (u32 channel = 0; channel < 3; ++channel)
+            {
+                o_texels[texel][channel] = (u8)palette[index][channel];
+            }
+        }
+        for (u32 texel = 0; texel < 16; ++texel)
+        {
+            u32 index = bc7_read_bits(i_bytes, &position, texel == 0 ? 1 : 2);
+            o_texels[texel][3] = (u8)palette[index][3];
+            if (rotation != 0)
+            {
+                u8 swap = o_texels[texel][3];
+                o_texels[texel][3] = o_texels[texel][rotation - 1];
+                o_texels[texel][rotation - 1] = swap;
+            }
+        }
+        return TRUE;
+    }
+
+    for (u32 texel = 0; texel < 16; ++texel)
+    {
+        o_texels[texel][0] = 255;
+        o_texels[texel][1] = 0;
+        o_texels[texel][2] = 255;
+        o_texels[texel][3] = 255;
+    }
+    return FALSE;
+}
+
+/* --------------------------------------------------
+   Textures
+   -------------------------------------------------- */
+
+typedef struct {
+    char const* name;
+    std::vector<u8> rgba;
+    u32 width;
+    u32 height;
+    b8 is_data; /* Channels that are sampled independently, not a color. */
+
+    bc_format format;
+    u32 planes_count; /* BC4 encodes every channel as a plane of its own. */
+    std::vector<u8> blocks;
+    std::vector<u8> decoded;
+    f64 time_encode;
+    u32 threads_count;
+} texture;
+
+u32 bc_block_size(bc_format i_format)
+{
+    return i_format == BC_FORMAT_BC7 ? 16 : 8;
+}
+
+/* BC4 for data, BC1 when every texel is opaque and BC7 otherwise. */
+bc_format texture_pick_format(texture const* i_texture)
+{
+    if (i_texture->is_data)
+    {
+        return BC_FORMAT_BC4;
+    }
+    for (sz i = 3; i < i_texture->rgba.size(); i += 4)
+    {
+        if (i_texture->rgba[i] != 0xFF)
+        {
+            return BC_FORMAT_BC7;
+        }
+    }
+    return BC_FORMAT_BC1;
+}
+
+/* The block at i_x, i_y of plane i_plane, texels past the edge repeat the last row or column. */
+void texture_load_block(texture const* i_texture, u32 i_x, u32 i_y, u32 i_plane, bc_block* o_block)
+{
+    o_block->channels_count = i_texture->format == BC_FORMAT_BC4 ? 1 : (i_texture->format == BC_FORMAT_BC1 ? 3 : 4);
+    for (u32 texel = 0; texel < 16; ++texel)
+    {
+        u32 x = math_min(i_x * 4 + texel % 4, i_texture->width - 1);
+        u32 y = math_min(i_y * 4 + texel / 4, i_texture->height - 1);
+        u8 const* rgba = &i_texture->rgba[((sz)y * i_texture->width + x) * 4];
+        for (u32 channel = 0; channel < o_block->channels_count; ++channel)
+        {
+            o_block->channels[channel][texel] = (f32)rgba[o_block->channels_count == 1 ? i_plane : channel];
+        }
+    }
+}
+
+/* Encodes and decodes again every block, threads take rows of blocks from a shared counter. */
+void texture_compress(texture* io_texture)
+{
+    io_texture->format = texture_pick_format(io_texture);
+    io_texture->planes_count = io_texture->format == BC_FORMAT_BC4 ? 4 : 1;
+    u32 blocks_x = (io_texture->width + 3) / 4;
+    u32 blocks_y = (io_texture->height + 3) / 4;
+    u32 block_size = bc_block_size(io_texture->format);
+    u32 rows_count = blocks_y * io_texture->planes_count;
+    io_texture->blocks.assign((sz)rows_count * blocks_x * block_size, 0);
+    io_texture->decoded.assign(io_texture->rgba.size(), 0);
+    io_texture->threads_count = math_max((u32)std::thread::hardware_concurrency(), 1u);
+
+    std::atomic<u32> next_row(0);
+    std::vector<std::thread> threads;
+    f64 start = profile_time_ms();
+    for (u32 t = 0; t < io_texture->threads_count; ++t)
+    {
+        threads.emplace_back([io_texture, &next_row, blocks_x, blocks_y, block_size, rows_count]() {
+            for (u32 row = next_row++; row < rows_count; row = next_row++)
+            {
+                u32 plane = row / blocks_y;
+                u32 block_y = row % blocks_y;
+                for (u32 block_x = 0; block_x < blocks_x; ++block_x)
+                {
+                    bc_block block;
+                    texture_load_block(io_texture, block_x, block_y, plane, &block);
+                    u8* bytes = &io_texture->blocks[((sz)row * blocks_x + block_x) * block_size];
+                    switch (io_texture->format)
+                    {
+                        case BC_FORMAT_BC1: bc1_encode_block(&block, bytes); break;
+                        case BC_FORMAT_BC4: bc4_encode_block(&block, bytes); break;
+                        case BC_FORMAT_BC7: bc7_encode_block(&block, bytes); break;
+                    }
+                }
+            }
+        });
+    }
+    for (u32 t = 0; t < io_texture->threads_count; ++t)
+    {
+        threads[t].join();
+    }
+    io_texture->time_encode = profile_time_ms() - start;
+
+    /* BC1 keeps the source alpha, it is not encoded. */
+    if (io_texture->format == BC_FORMAT_BC1)
+    {
+        io_texture->decoded = io_texture->rgba;
+    }
+    for (u32 row = 0; row < rows_count; ++row)
+    {
+        u32 plane = row / blocks_y;
+        u32 block_y = row % blocks_y;
+        for (u32 block_x = 0; block_x < blocks_x; ++block_x)
+        {
+            u8 const* bytes = &io_texture->blocks[((sz)row * blocks_x + block_x) * block_size];
+            u8 texels[16][4];
+            u8 values[16];
+            switch (io_texture->format)
+            {
+                case BC_FORMAT_BC1: bc1_decode_block(bytes, texels); break;
+                case BC_FORMAT_BC4: bc4_decode_block(bytes, values); break;
+                case BC_FORMAT_BC7: bc7_decode_block(bytes, texels); break;
+            }
+            for (u32 texel = 0; texel < 16; ++texel)
+            {
+                u32 x = block_x * 4 + texel % 4;
+                u32 y = block_y * 4 + texel / 4;
+                if (x >= io_texture->width || y >= io_texture->height)
+                {
+                    continue;
+                }
+                u8* decoded = &io_texture->decoded[((sz)y * io_texture->width + x) * 4];
+                if (io_texture->format == BC_FORMAT_BC4)
+                {
+                    decoded[plane] = values[texel];
+                    continue;
+                }
+                for (u32 channel = 0; channel < (io_texture->format == BC_FORMAT_BC1 ? 3u : 4u); ++channel)
+                {
+                    decoded[channel] = texels[texel][channel];
+                }
+            }
+        }
+    }
+}
+
+/* PSNR of the decoded texels against the source over all four channels, 0 when they match. */
+f64 texture_psnr(texture const* i_texture, u32* o_error_max)
+{
+    f64 error = 0.0;
+    *o_error_max = 0;
+    for (sz i = 0; i < i_texture->rgba.size(); ++i)
+    {
+        i32 difference = (i32)i_texture->rgba[i] - (i32)i_texture->decoded[i];
+        error += (f64)(difference * difference);
+        *o_error_max = math_max(*o_error_max, (u32)(difference < 0 ? -difference : difference));
+    }
+    f64 mse = error / (f64)i_texture->rgba.size();
+    return mse > 0.0 ? 10.0 * f64_log2(255.0 * 255.0 / mse) / f64_log2(10.0) : 0.0;
+}
+
+void dds_write_u32(FILE* i_file, u32 i_value)
+{
+    u8 bytes[4] = { (u8)i_value, (u8)(i_value >> 8), (u8)(i_value >> 16), (u8)(i_value >> 24) };
+    fwrite(bytes, 1, 4, i_file);
+}
+
+/* A DDS file with the DX10 header, the planes of BC4 are the slices of an array. */
+b8 texture_write_dds(texture const* i_texture, char const* i_directory)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s.dds", i_directory, i_texture->name);
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        printf("Could not open %s\n", path);
+        return FALSE;
+    }
+
+    u32 dxgi_formats[3] = { 71, 80, 98 }; /* DXGI_FORMAT_BC1_UNORM, DXGI_FORMAT_BC4_UNORM and DXGI_FORMAT_BC7_UNORM. */
+    u32 plane_size = (u32)(i_texture->blocks.size() / i_texture->planes_count);
+    fwrite("DDS ", 1, 4, file);
+    dds_write_u32(file, 124);
+    dds_write_u32(file, 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000); /* Caps, height, width, pixel format, mips and linear size. */
+    dds_write_u32(file, i_texture->height);
+    dds_write_u32(file, i_texture->width);
+    dds_write_u32(file, plane_size);
+    dds_write_u32(file, 0);
+    dds_write_u32(file, 1);
+    for (u32 i = 0; i < 11; ++i)
+    {
+        dds_write_u32(file, 0);
+    }
+    dds_write_u32(file, 32);
+    dds_write_u32(file, 0x4); /* The format is in the four character code. */
+    fwrite("DX10", 1, 4, file);
+    for (u32 i = 0; i < 5; ++i)
+    {
+        dds_write_u32(file, 0);
+    }
+    dds_write_u32(file, 0x1000); /* A texture. */
+    for (u32 i = 0; i < 4; ++i)
+    {
+        dds_write_u32(file, 0);
+    }
+
+    dds_write_u32(file, dxgi_formats[i_texture->format]);
+    dds_write_u32(file, 3); /* Texture2D. */
+    dds_write_u32(file, 0);
+    dds_write_u32(file, i_texture->planes_count);
+    dds_write_u32(file, 0);
+    fwrite(i_texture->blocks.data(), 1, i_texture->blocks.size(), file);
+    fclose(file);
+    return TRUE;
+}
+
+int main(int argc, char** argv)
+{
+    char const* output = argc > 1 ? argv[1] : NULL;
+    char const* names[] = { "background_texture", "credits_texture", "end_texture", "main_menu_texture", "spritesheet_texture" };
+    u32 names_count = sizeof(names) / sizeof(names[0]);
+
+    std::vector<texture> textures(names_count + 1);
+    for (u32 i = 0; i < names_count; ++i)
+    {
+        char path[256];
+        snprintf(path, sizeof(path), "assets/%s.png", names[i]);
+        textures[i].name = names[i];
+        if (!png_read(path, &textures[i].rgba, &textures[i].width, &textures[i].height))
+        {
+            return 1;
+        }
+    }
+
+    /* The noise is baked into a header already, its channels are x in the lowest byte like sample_noise reads them. */
+    texture* noise = &textures[names_count];
+    noise->name = "noise_texture";
+    noise->width = TEXTURE_NOISE_WIDTH;
+    noise->height = TEXTURE_NOISE_HEIGHT;
+    noise->is_data = TRUE;
+    noise->rgba.resize(TEXTURE_NOISE_WIDTH * TEXTURE_NOISE_HEIGHT * 4);
+    for (u32 i = 0; i < TEXTURE_NOISE_WIDTH * TEXTURE_NOISE_HEIGHT; ++i)
+    {
+        for (u32 channel = 0; channel < 4; ++channel)
+        {
+            noise->rgba[i * 4 + channel] = (u8)(g_texture_noise[i] >> (channel * 8));
+        }
+    }
+
+    char const* format_names[3] = { "BC1", "BC4", "BC7" };
+    sz size_raw = 0;
+    sz size_compressed = 0;
+    printf("%-20s %9s %6s %10s %10s %9s %9s %9s\n", "texture", "size", "format", "raw", "compressed", "reduction", "PSNR", "encode");
+    for (u32 i = 0; i < textures.size(); ++i)
+    {
+        texture* current = &textures[i];
+        texture_compress(current);
+        u32 error_max = 0;
+        f64 psnr = texture_psnr(current, &error_max);
+        sz raw = current->rgba.size();
+        size_raw += raw;
+        size_compressed += current->blocks.size();
+
+        char size[32];
+        char format[16];
+        char quality[16];
+        snprintf(size, sizeof(size), "%ux%u", current->width, current->height);
+        if (current->planes_count > 1)
+        {
+            snprintf(format, sizeof(format), "%ux%s", current->planes_count, format_names[current->format]);
+        }
+        else
+        {
+            snprintf(format, sizeof(format), "%s", format_names[current->format]);
+        }
+        if (psnr > 0.0)
+        {
+            snprintf(quality, sizeof(quality), "%.2fdB", psnr);
+        }
+        else
+        {
+            snprintf(quality, sizeof(quality), "exact");
+        }
+        printf("%-20s %9s %6s %8.0fKB %8.0fKB %8.1fx %9s %7.0fms, max error %u\n", current->name, size, format,
+            (f64)raw / 1024.0, (f64)current->blocks.size() / 1024.0, (f64)raw / (f64)current->blocks.size(), quality, current->time_encode, error_max);
+        if (output != NULL && !texture_write_dds(current, output))
+        {
+            return 1;
+        }
+    }
+    printf("%-20s %9s %6s %8.0fKB %8.0fKB %8.1fx, encoded over %u threads\n", "all", "", "",
+        (f64)size_raw / 1024.0, (f64)size_compressed / 1024.0, (f64)size_raw / (f64)size_compressed, textures[0].threads_count);
+    return 0;
+}